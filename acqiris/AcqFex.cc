@@ -0,0 +1,366 @@
+#include "pds/acqiris/AcqFex.hh"
+
+#include "pdsdata/psddl/acqiris.ddl.h"
+#include "pdsdata/xtc/Xtc.hh"
+
+#include <string>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace Pds;
+
+static Pds::TypeId _acqHitListType(Pds::TypeId::Any, AcqHitList::Version);
+
+//
+//  Raw layout of one channel of the readout, as DMAd by AcqManager
+//
+static inline unsigned _waveformSize(const Acqiris::HorizV1& hconfig)
+{
+  return (hconfig.nbrSamples()*hconfig.nbrSegments()+Acqiris::DataDescV1Elem::_extraSize)*sizeof(short);
+}
+
+static inline const int16_t* _waveform(const Acqiris::DataDescV1Elem* data, const Acqiris::HorizV1& hconfig)
+{
+  return reinterpret_cast<const int16_t*>(reinterpret_cast<const char*>(data)+64+hconfig.nbrSegments()*sizeof(Acqiris::TimestampV1));
+}
+
+static inline const Acqiris::TimestampV1* _timestamp(const Acqiris::DataDescV1Elem* data)
+{
+  return reinterpret_cast<const Acqiris::TimestampV1*>(reinterpret_cast<const char*>(data)+64);
+}
+
+static inline const Acqiris::DataDescV1Elem* _nextChannel(const Acqiris::DataDescV1Elem* data, const Acqiris::HorizV1& hconfig)
+{
+  return reinterpret_cast<const Acqiris::DataDescV1Elem*>(reinterpret_cast<const char*>(_waveform(data,hconfig))+_waveformSize(hconfig));
+}
+
+//
+//  Index of the first sample at or after "i" beyond "level": below it for
+//  negative polarity, above it for positive.  Returns "n" if there is none.
+//
+static unsigned _next(const int16_t* wf, unsigned i, unsigned n, int16_t level, bool negative)
+{
+#ifdef __SSE2__
+  const __m128i vl = _mm_set1_epi16(level);
+  for(; i+16<=n; i+=16) {
+    __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(wf+i));
+    __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(wf+i+8));
+    __m128i c0 = negative ? _mm_cmplt_epi16(v0,vl) : _mm_cmpgt_epi16(v0,vl);
+    __m128i c1 = negative ? _mm_cmplt_epi16(v1,vl) : _mm_cmpgt_epi16(v1,vl);
+    unsigned m = _mm_movemask_epi8(c0) | (_mm_movemask_epi8(c1)<<16);
+    if (m)
+      return i + (__builtin_ctz(m)>>1);
+  }
+#endif
+  if (negative) {
+    for(; i<n; i++)
+      if (wf[i] < level) return i;
+  }
+  else {
+    for(; i<n; i++)
+      if (wf[i] > level) return i;
+  }
+  return n;
+}
+
+//
+//  Sum of "n" samples.  32-bit lanes are safe for n < 128k samples.
+//
+static int64_t _sum(const int16_t* wf, unsigned n)
+{
+  int64_t  sum = 0;
+  unsigned i   = 0;
+#ifdef __SSE2__
+  const __m128i ones = _mm_set1_epi16(1);
+  __m128i vsum = _mm_setzero_si128();
+  for(; i+8<=n; i+=8)
+    vsum = _mm_add_epi32(vsum, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(wf+i)),ones));
+  int32_t a[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(a), vsum);
+  sum = int64_t(a[0])+a[1]+a[2]+a[3];
+#endif
+  for(; i<n; i++)
+    sum += wf[i];
+  return sum;
+}
+
+AcqFex::Settings::Settings() :
+  channelMask(0),
+  polarity   (-1),
+  baseline   (64),
+  threshold  (1024),
+  fraction   (0.5),
+  pre        (4),
+  post       (12),
+  maxHits    (16),
+  rawPrescale(1)
+{
+}
+
+int AcqFex::Settings::parse(const char* arg)
+{
+  std::string s(arg);
+  size_t p = 0;
+  while(p < s.size()) {
+    size_t e = s.find(':',p);
+    if (e == std::string::npos) e = s.size();
+    std::string f(s.substr(p,e-p));
+    p = e+1;
+
+    if (f.compare(0,3,"ch=")==0)
+      channelMask = strtoul(f.c_str()+3,NULL,0);
+    else if (f.compare(0,4,"pol=")==0)
+      polarity = strtol(f.c_str()+4,NULL,0) < 0 ? -1 : 1;
+    else if (f.compare(0,5,"base=")==0)
+      baseline = strtoul(f.c_str()+5,NULL,0);
+    else if (f.compare(0,4,"thr=")==0)
+      threshold = strtoul(f.c_str()+4,NULL,0);
+    else if (f.compare(0,4,"cfd=")==0)
+      fraction = strtod(f.c_str()+4,NULL);
+    else if (f.compare(0,4,"win=")==0) {
+      if (sscanf(f.c_str()+4,"%u,%u",&pre,&post)!=2) {
+        printf("*** AcqFex::Settings bad window \"%s\"\n",f.c_str());
+        return -1;
+      }
+    }
+    else if (f.compare(0,4,"max=")==0)
+      maxHits = strtoul(f.c_str()+4,NULL,0);
+    else if (f.compare(0,4,"raw=")==0)
+      rawPrescale = strtoul(f.c_str()+4,NULL,0);
+    else if (!f.empty()) {
+      printf("*** AcqFex::Settings unknown field \"%s\"\n",f.c_str());
+      return -1;
+    }
+  }
+  if (!channelMask) {
+    printf("*** AcqFex::Settings no channels in \"%s\"\n",arg);
+    return -1;
+  }
+  if (!baseline || baseline > 0x10000 || fraction <= 0 || fraction > 1) {
+    printf("*** AcqFex::Settings bad baseline or fraction in \"%s\"\n",arg);
+    return -1;
+  }
+  return 0;
+}
+
+void AcqFex::Settings::dump() const
+{
+  printf("Acqiris fex: channels 0x%x  polarity %d  baseline %u  threshold %u  cfd %.2f  window -%u,+%u  max %u  raw 1/%u\n",
+         channelMask, polarity, baseline, threshold, fraction, pre, post, maxHits, rawPrescale);
+}
+
+unsigned AcqFex::find(const Settings& s, const int16_t* wf, unsigned n,
+                      Peak* peaks, unsigned maxpeaks,
+                      float& baseline, float& rms)
+{
+  unsigned nb = s.baseline < n ? s.baseline : n;
+  if (!nb) {
+    baseline = rms = 0;
+    return 0;
+  }
+  double base = double(_sum(wf,nb))/double(nb);
+  double var  = 0;
+  for(unsigned i=0; i<nb; i++) {
+    double d = double(wf[i])-base;
+    var += d*d;
+  }
+  baseline = base;
+  rms      = sqrt(var/double(nb));
+
+  bool negative = s.polarity < 0;
+  int  ilevel   = negative ? int(floor(base)) - int(s.threshold) : int(ceil(base)) + int(s.threshold);
+  if (ilevel < -32768 || ilevel > 32767)
+    return 0;
+  int16_t level = ilevel;
+  float   fbase = base;
+  float   pol   = s.polarity;
+
+  unsigned npeaks = 0;
+  unsigned i = 0;
+  while((i = _next(wf,i,n,level,negative)) < n) {
+    //  Walk the excursion for its peak
+    unsigned j = i, ipk = i;
+    int16_t  vpk = wf[i];
+    if (negative) {
+      for(; j<n && wf[j]<level; j++)
+        if (wf[j] < vpk) { vpk = wf[j]; ipk = j; }
+    }
+    else {
+      for(; j<n && wf[j]>level; j++)
+        if (wf[j] > vpk) { vpk = wf[j]; ipk = j; }
+    }
+
+    if (npeaks < maxpeaks) {
+      Peak& pk = peaks[npeaks];
+      pk.amplitude = pol*(float(vpk)-fbase);
+
+      //  Constant fraction of the amplitude on the leading edge
+      float    c = s.fraction*pk.amplitude;
+      unsigned k = ipk;
+      while(k>0 && pol*(float(wf[k-1])-fbase) >= c)
+        k--;
+      if (k==0)
+        pk.time = 0;
+      else {
+        float y0 = pol*(float(wf[k-1])-fbase);
+        float y1 = pol*(float(wf[k  ])-fbase);
+        pk.time = float(k-1) + (c-y0)/(y1-y0);
+      }
+
+      unsigned b = ipk > s.pre ? ipk-s.pre : 0;
+      unsigned e = ipk+s.post+1 < n ? ipk+s.post+1 : n;
+      pk.integral = pol*(float(_sum(wf+b,e-b)) - fbase*float(e-b));
+    }
+    npeaks++;
+    i = j;
+  }
+  return npeaks;
+}
+
+AcqFex::AcqFex() :
+  _nchannels(0),
+  _peaks    (0),
+  _maxPeaks (0),
+  _keepRaw  (true),
+  _samples  (0),
+  _hits     (0)
+{
+  for(unsigned i=0; i<32; i++) {
+    _channel[i] = -1;
+    _events [i] = 0;
+  }
+}
+
+AcqFex::~AcqFex()
+{
+  delete[] _peaks;
+}
+
+int AcqFex::add(const char* arg)
+{
+  Settings s;
+  if (s.parse(arg))
+    return -1;
+  _settings.push_back(s);
+  return 0;
+}
+
+void AcqFex::configure(const AcqConfigType& config)
+{
+  _config    = config;
+  _nchannels = 0;
+  _maxPeaks  = 0;
+  for(unsigned i=0; i<32 && _nchannels<config.nbrChannels(); i++) {
+    if (!(config.channelMask()&(1<<i))) continue;
+    int r = -1;
+    for(unsigned j=0; j<_settings.size() && r<0; j++)
+      if (_settings[j].channelMask & (1<<i)) {
+        r = j;
+        if (_settings[j].maxHits > _maxPeaks)
+          _maxPeaks = _settings[j].maxHits;
+      }
+    _events [_nchannels] = 0;
+    _channel[_nchannels++] = r;
+  }
+  delete[] _peaks;
+  _peaks = new Peak[_maxPeaks ? _maxPeaks : 1];
+
+  for(unsigned i=0; i<_settings.size(); i++)
+    _settings[i].dump();
+}
+
+unsigned AcqFex::maxSize() const
+{
+  unsigned nseg = _config.horiz().nbrSegments();
+  unsigned size = sizeof(Xtc)+sizeof(AcqHitList);
+  for(unsigned r=0; r<_nchannels; r++)
+    if (_channel[r]>=0)
+      size += nseg*(sizeof(AcqHitChannel)+_settings[_channel[r]].maxHits*sizeof(AcqHit));
+  return size;
+}
+
+unsigned AcqFex::process(const Xtc& in, char* out, unsigned maxsize)
+{
+  _keepRaw = false;
+  if (maxsize < sizeof(Xtc)+sizeof(AcqHitList))
+    return 0;
+
+  const Acqiris::HorizV1& hconfig = _config.horiz();
+  unsigned nbrSamples  = hconfig.nbrSamples();
+  unsigned nbrSegments = hconfig.nbrSegments();
+  double   dt          = hconfig.sampInterval();
+
+  Xtc* xtc = new (out) Xtc(_acqHitListType, in.src, in.damage);
+  AcqHitList* list = new (xtc->alloc(sizeof(AcqHitList))) AcqHitList;
+  list->nchannels = 0;
+  list->reserved  = 0;
+
+  const char* end = in.payload()+in.sizeofPayload();
+  const Acqiris::DataDescV1Elem* data = reinterpret_cast<const Acqiris::DataDescV1Elem*>(in.payload());
+  for(unsigned r=0, i=0; r<_nchannels; r++, i++) {
+    while(!(_config.channelMask()&(1<<i))) i++;
+    if (reinterpret_cast<const char*>(_nextChannel(data,hconfig)) > end) {
+      printf("AcqFex::process waveform xtc too small for %u channels\n",_nchannels);
+      _keepRaw = true;
+      break;
+    }
+
+    int js = _channel[r];
+    if (js < 0) {
+      _keepRaw = true;
+      data = _nextChannel(data,hconfig);
+      continue;
+    }
+
+    const Settings& s = _settings[js];
+    if (s.rawPrescale && ++_events[r] >= s.rawPrescale) {
+      _events[r] = 0;
+      _keepRaw = true;
+    }
+
+    const Acqiris::VertV1& vconfig = _config.vert()[r];
+    float slope  = vconfig.slope();
+    float offset = vconfig.offset();
+
+    unsigned nseg = data->nbrSegments() < nbrSegments ? data->nbrSegments() : nbrSegments;
+    unsigned n    = data->nbrSamplesInSeg() < nbrSamples ? data->nbrSamplesInSeg() : nbrSamples;
+    if (data->indexFirstPoint()+n > nbrSamples+Acqiris::DataDescV1Elem::_extraSize)
+      n = 0;
+    for(unsigned seg=0; seg<nseg; seg++) {
+      const int16_t* wf = _waveform(data,hconfig) + seg*nbrSamples + data->indexFirstPoint();
+      float baseline, rms;
+      unsigned nfound = find(s, wf, n, _peaks, s.maxHits, baseline, rms);
+      unsigned nhits  = nfound < s.maxHits ? nfound : s.maxHits;
+      _samples += n;
+      _hits    += nfound;
+
+      if (xtc->extent + sizeof(AcqHitChannel) + nhits*sizeof(AcqHit) > maxsize)
+        return 0;
+
+      AcqHitChannel* ch = new (xtc->alloc(sizeof(AcqHitChannel))) AcqHitChannel;
+      ch->channel   = i;
+      ch->segment   = seg;
+      ch->nhits     = nhits;
+      ch->noverflow = nfound - nhits;
+      ch->baseline  = baseline*slope - offset;
+      ch->rms       = rms*slope;
+
+      double t0 = _timestamp(data)[seg].pos();
+      AcqHit* hit = reinterpret_cast<AcqHit*>(xtc->alloc(nhits*sizeof(AcqHit)));
+      for(unsigned h=0; h<nhits; h++) {
+        hit[h].time      = t0 + _peaks[h].time*dt;
+        hit[h].amplitude = _peaks[h].amplitude*slope;
+        hit[h].integral  = _peaks[h].integral*slope*dt;
+      }
+      list->nchannels++;
+    }
+    data = _nextChannel(data,hconfig);
+  }
+  return xtc->extent;
+}
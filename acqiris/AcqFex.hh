@@ -0,0 +1,138 @@
+#ifndef Pds_AcqFex_hh
+#define Pds_AcqFex_hh
+
+//
+//  Feature extraction of Acqiris waveforms.
+//
+//  Each configured channel has its baseline estimated from the leading
+//  samples of each segment.  The waveform is then scanned for samples
+//  beyond the threshold, eight or sixteen samples at a time.  For each
+//  excursion the peak amplitude, a constant-fraction time (interpolated
+//  on the leading edge), and an integral about the peak are recorded.
+//  Quiet stretches of the waveform are only touched by the vector
+//  compare.
+//
+//  The hits of one digitizer are recorded as an AcqHitList xtc with the
+//  digitizer's source.  It has TypeId::Any until a pdsdata type is
+//  assigned.
+//
+
+#include "pds/config/AcqConfigType.hh"
+
+#include <stdint.h>
+#include <vector>
+
+namespace Pds {
+
+  class Xtc;
+
+  //
+  //  [ AcqHitList | AcqHitChannel | AcqHit x nhits | AcqHitChannel | ... ]
+  //  with one AcqHitChannel per segment of each configured channel.
+  //
+  class AcqHit {
+  public:
+    float time;        // s relative to the trigger
+    float amplitude;   // V, positive for pulses of the configured polarity
+    float integral;    // V s
+  };
+
+  class AcqHitChannel {
+  public:
+    uint16_t channel;  // digitizer input, 0-based
+    uint16_t segment;
+    uint32_t nhits;
+    uint32_t noverflow;  // hits beyond the configured maximum
+    float    baseline;   // V
+    float    rms;        // V, baseline noise
+  public:
+    const AcqHit*        hits() const { return reinterpret_cast<const AcqHit*>(this+1); }
+    const AcqHitChannel* next() const { return reinterpret_cast<const AcqHitChannel*>(hits()+nhits); }
+  };
+
+  class AcqHitList {
+  public:
+    enum { Version = 1 };
+    uint32_t nchannels;  // AcqHitChannel records
+    uint32_t reserved;
+  public:
+    const AcqHitChannel* first() const { return reinterpret_cast<const AcqHitChannel*>(this+1); }
+  };
+
+  class AcqFex {
+  public:
+    //
+    //  Parsed from "ch=<mask>:pol=<+1|-1>:base=<samples>:thr=<counts>:
+    //  cfd=<fraction>:win=<pre>,<post>:max=<hits>:raw=<prescale>", any
+    //  field but "ch" may be omitted.  The threshold is in ADC counts
+    //  beyond the baseline.  "raw" keeps the raw waveform of one event
+    //  in <prescale>; 0 never keeps it.
+    //
+    class Settings {
+    public:
+      Settings();
+    public:
+      int  parse(const char*);
+      void dump () const;
+    public:
+      uint32_t channelMask;
+      int      polarity;
+      unsigned baseline;
+      unsigned threshold;
+      float    fraction;
+      unsigned pre, post;
+      unsigned maxHits;
+      unsigned rawPrescale;
+    };
+    //  A hit in sample units and ADC counts
+    class Peak {
+    public:
+      float time;
+      float amplitude;
+      float integral;
+    };
+  public:
+    AcqFex();
+    ~AcqFex();
+  public:
+    //  Adds the settings of a set of channels; returns 0 on success
+    int      add      (const char*);
+    bool     enabled  () const { return !_settings.empty(); }
+    void     configure(const AcqConfigType&);
+  public:
+    //
+    //  Writes the hit list of the waveform xtc "in" as an xtc at "out"
+    //  (at most "maxsize" bytes) and returns its extent, or 0 if it does
+    //  not fit.  keepRaw() then tells whether the raw waveform must be
+    //  recorded for this event.
+    //
+    unsigned process(const Xtc& in, char* out, unsigned maxsize);
+    bool     keepRaw() const { return _keepRaw; }
+    unsigned maxSize() const;
+  public:
+    uint64_t samples() const { return _samples; }
+    uint64_t hits   () const { return _hits; }
+  public:
+    //
+    //  Finds the peaks of "n" samples whose leading "s.baseline" samples
+    //  are free of pulses.  Returns the number of peaks found, which may
+    //  exceed "maxpeaks"; only the first "maxpeaks" are written.
+    //
+    static unsigned find(const Settings& s, const int16_t* wf, unsigned n,
+                         Peak* peaks, unsigned maxpeaks,
+                         float& baseline, float& rms);
+  private:
+    std::vector<Settings> _settings;
+    AcqConfigType  _config;
+    int            _channel[32];  // settings index by readout order, -1 if none
+    unsigned       _events[32];   // raw prescale counters
+    unsigned       _nchannels;
+    Peak*          _peaks;
+    unsigned       _maxPeaks;
+    bool           _keepRaw;
+    uint64_t       _samples;
+    uint64_t       _hits;
+  };
+};
+
+#endif
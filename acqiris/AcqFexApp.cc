@@ -0,0 +1,117 @@
+#include "pds/acqiris/AcqFexApp.hh"
+
+#include "pdsdata/xtc/XtcIterator.hh"
+
+#include <stdio.h>
+
+using namespace Pds;
+
+namespace Pds {
+  //
+  //  Finds the first undamaged xtc of a type
+  //
+  class AcqFexFinder : public XtcIterator {
+  public:
+    AcqFexFinder(Xtc* root, TypeId::Type type) :
+      XtcIterator(root), _type(type), _found(0) {}
+  public:
+    Xtc* find() { iterate(); return _found; }
+    int  process(Xtc* xtc) {
+      if (xtc->contains.id()==TypeId::Id_Xtc)
+        iterate(xtc);
+      else if (xtc->contains.id()==_type && xtc->damage.value()==0)
+        _found = xtc;
+      return _found==0;
+    }
+  private:
+    TypeId::Type _type;
+    Xtc*         _found;
+  };
+};
+
+AcqFexApp::AcqFexApp() :
+  _buffer    (0),
+  _bufsize   (0),
+  _configured(false),
+  _nevents   (0),
+  _ndropped  (0),
+  _nfailed   (0)
+{
+}
+
+AcqFexApp::~AcqFexApp()
+{
+  delete[] _buffer;
+}
+
+int AcqFexApp::add(const char* arg)
+{
+  return _fex.add(arg);
+}
+
+Transition* AcqFexApp::transitions(Transition* tr)
+{
+  return tr;
+}
+
+InDatagram* AcqFexApp::events(InDatagram* in)
+{
+  if (!_fex.enabled())
+    return in;
+
+  Datagram& dg = in->datagram();
+  switch(dg.seq.service()) {
+  case TransitionId::Configure:
+    { Xtc* xtc = AcqFexFinder(&dg.xtc, TypeId::Id_AcqConfig).find();
+      if (xtc) {
+        _fex.configure(*reinterpret_cast<const AcqConfigType*>(xtc->payload()));
+        if (_fex.maxSize() > _bufsize) {
+          delete[] _buffer;
+          _bufsize = _fex.maxSize();
+          _buffer  = new char[_bufsize];
+        }
+        _configured = true;
+        _nevents = _ndropped = _nfailed = 0;
+      }
+      else
+        printf("AcqFexApp found no acqiris configuration\n");
+      break; }
+  case TransitionId::Unconfigure:
+    if (_configured)
+      _dump();
+    _configured = false;
+    break;
+  case TransitionId::L1Accept:
+    if (_configured) {
+      Xtc* xtc = AcqFexFinder(&dg.xtc, TypeId::Id_AcqWaveform).find();
+      if (!xtc)
+        break;
+      _nevents++;
+      unsigned extent = _fex.process(*xtc, _buffer, _bufsize);
+      if (!extent) {
+        _nfailed++;
+        break;
+      }
+      //  The hit list is taken before the waveform is dropped
+      if (!_fex.keepRaw()) {
+        _transform.clear();
+        _transform.add(xtc->src, TypeId::Id_AcqWaveform, XtcTransform::Drop);
+        _transform.apply(dg.xtc);
+        _ndropped++;
+      }
+      const Xtc* hits = reinterpret_cast<const Xtc*>(_buffer);
+      in->insert(*hits, hits->payload());
+    }
+    break;
+  default:
+    break;
+  }
+  return in;
+}
+
+void AcqFexApp::_dump() const
+{
+  printf("AcqFexApp: %u events, %u raw waveforms dropped, %u failed, %llu samples, %llu hits\n",
+         _nevents, _ndropped, _nfailed,
+         (unsigned long long)_fex.samples(), (unsigned long long)_fex.hits());
+}
@@ -0,0 +1,42 @@
+#ifndef Pds_AcqFexApp_hh
+#define Pds_AcqFexApp_hh
+
+//
+//  Segment level appliance that appends the AcqFex hit list of the
+//  digitizer's waveforms to each L1Accept and drops the raw waveforms of
+//  events in which no channel's raw prescale fires.  The digitizer
+//  configuration is taken from the Configure datagram, so the appliance
+//  must follow the AcqManager's.
+//
+
+#include "pds/utility/Appliance.hh"
+#include "pds/acqiris/AcqFex.hh"
+#include "pds/client/XtcTransform.hh"
+
+namespace Pds {
+
+  class AcqFexApp : public Appliance {
+  public:
+    AcqFexApp();
+    ~AcqFexApp();
+  public:
+    //  Adds the fex settings of a set of channels (see AcqFex::Settings)
+    int         add        (const char*);
+  public:
+    Transition* transitions(Transition*);
+    InDatagram* events     (InDatagram*);
+  private:
+    void        _dump      () const;
+  private:
+    AcqFex       _fex;
+    XtcTransform _transform;
+    char*        _buffer;
+    unsigned     _bufsize;
+    bool         _configured;
+    unsigned     _nevents;
+    unsigned     _ndropped;
+    unsigned     _nfailed;
+  };
+};
+
+#endif
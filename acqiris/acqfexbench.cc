@@ -0,0 +1,200 @@
+//
+//  acqfexbench - single thread throughput of the Acqiris waveform fex, in
+//  samples per second per core.
+//
+//    acqfexbench -f <file.xtc> [-F <settings>]... [-n <events>] [-t <seconds>]
+//      runs AcqFex over the waveforms of a recorded run
+//    acqfexbench [-s <samples>] [-p <pulses>] [-F <settings>] [-t <seconds>]
+//      runs the hit finder over synthetic waveforms
+//
+#include "pds/acqiris/AcqFex.hh"
+
+#include "pdsdata/xtc/XtcFileIterator.hh"
+#include "pdsdata/xtc/XtcIterator.hh"
+#include "pdsdata/xtc/Dgram.hh"
+
+#include <vector>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <math.h>
+
+using namespace Pds;
+
+static double now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return double(ts.tv_sec)+1.e-9*double(ts.tv_nsec);
+}
+
+namespace Pds {
+  class AcqBenchLoader : public XtcIterator {
+  public:
+    AcqBenchLoader(std::vector<char*>& events, AcqConfigType& config, bool& configured) :
+      _events(events), _config(config), _configured(configured) {}
+  public:
+    int process(Xtc* xtc) {
+      if (xtc->contains.id()==TypeId::Id_Xtc)
+        iterate(xtc);
+      else if (xtc->damage.value()==0) {
+        if (xtc->contains.id()==TypeId::Id_AcqConfig && !_configured) {
+          _config = *reinterpret_cast<const AcqConfigType*>(xtc->payload());
+          _configured = true;
+        }
+        else if (xtc->contains.id()==TypeId::Id_AcqWaveform && _configured) {
+          char* p = new char[xtc->extent];
+          memcpy(p, xtc, xtc->extent);
+          _events.push_back(p);
+        }
+      }
+      return 1;
+    }
+  private:
+    std::vector<char*>& _events;
+    AcqConfigType&      _config;
+    bool&               _configured;
+  };
+};
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [-f <xtc file>] [-F <settings>] [-n <events>] [-s <samples>] [-p <pulses>] [-t <seconds>]\n"
+         "Options:\n"
+         "\t-f <file>      benchmark the waveforms of a recorded run\n"
+         "\t-F <settings>  fex settings (repeatable) [ch=0xfffff]\n"
+         "\t-n <events>    maximum events to load [1000]\n"
+         "\t-s <samples>   synthetic waveform length [10000]\n"
+         "\t-p <pulses>    synthetic pulses per waveform [8]\n"
+         "\t-t <seconds>   minimum run time [2]\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  const char* fname    = 0;
+  unsigned    nevents  = 1000;
+  unsigned    nsamples = 10000;
+  unsigned    npulses  = 8;
+  double      tmin     = 2;
+  AcqFex      fex;
+  AcqFex::Settings settings;
+
+  int c;
+  while ((c = getopt(argc, argv, "f:F:n:s:p:t:h")) != -1) {
+    switch(c) {
+    case 'f': fname    = optarg; break;
+    case 'F':
+      if (fex.add(optarg) || settings.parse(optarg))
+        exit(1);
+      break;
+    case 'n': nevents  = strtoul(optarg,NULL,0); break;
+    case 's': nsamples = strtoul(optarg,NULL,0); break;
+    case 'p': npulses  = strtoul(optarg,NULL,0); break;
+    case 't': tmin     = strtod (optarg,NULL); break;
+    case 'h':
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+  if (!fex.enabled()) {
+    fex.add("ch=0xfffff");
+    settings.parse("ch=0xfffff");
+  }
+
+  double   t0, t1;
+  uint64_t samples = 0;
+  uint64_t hits    = 0;
+  unsigned passes  = 0;
+
+  if (fname) {
+    int fd = ::open(fname, O_RDONLY | O_LARGEFILE);
+    if (fd < 0) {
+      perror(fname);
+      return 1;
+    }
+    std::vector<char*> events;
+    AcqConfigType config;
+    bool configured = false;
+    XtcFileIterator iter(fd, 0x2000000);
+    Dgram* dg;
+    while(events.size() < nevents && (dg = iter.next())) {
+      if (dg->seq.service()==TransitionId::Configure ||
+          dg->seq.service()==TransitionId::L1Accept)
+        AcqBenchLoader(events, config, configured).iterate(&dg->xtc);
+    }
+    ::close(fd);
+
+    if (!configured || events.empty()) {
+      printf("No acqiris configuration or waveforms found in %s\n", fname);
+      return 1;
+    }
+
+    fex.configure(config);
+    unsigned bufsize = fex.maxSize();
+    char*    buffer  = new char[bufsize];
+    unsigned nkept   = 0;
+    uint64_t nbytes  = 0, nbytesout = 0;
+
+    t0 = now();
+    do {
+      for(unsigned i=0; i<events.size(); i++) {
+        const Xtc* xtc = reinterpret_cast<const Xtc*>(events[i]);
+        unsigned extent = fex.process(*xtc, buffer, bufsize);
+        if (passes==0) {
+          nbytes    += xtc->extent;
+          nbytesout += extent + (fex.keepRaw() ? xtc->extent : 0);
+          if (fex.keepRaw()) nkept++;
+        }
+      }
+      passes++;
+    } while((t1=now())-t0 < tmin);
+    samples = fex.samples();
+    hits    = fex.hits();
+
+    printf("%zu events, %u with raw waveforms kept; event size %.3f -> %.3f MB\n",
+           events.size(), nkept, double(nbytes)*1.e-6, double(nbytesout)*1.e-6);
+    delete[] buffer;
+    for(unsigned i=0; i<events.size(); i++)
+      delete[] events[i];
+  }
+  else {
+    //  Noisy baseline with unit-height gaussian pulses scaled to 1/4 full scale
+    const unsigned nwf = 16;
+    std::vector<int16_t> wf(nwf*nsamples);
+    srand48(1);
+    for(unsigned w=0; w<nwf; w++) {
+      int16_t* p = &wf[w*nsamples];
+      for(unsigned i=0; i<nsamples; i++)
+        p[i] = int16_t(-8192 + 256*(drand48()-0.5));
+      for(unsigned k=0; k<npulses; k++) {
+        double t = settings.baseline + 16 + drand48()*(nsamples-settings.baseline-32);
+        for(int i=-8; i<24; i++) {
+          int j = int(t)+i;
+          double x = (double(j)-t)/3.;
+          if (j>=0 && unsigned(j)<nsamples)
+            p[j] -= int16_t(8192*exp(-0.5*x*x));
+        }
+      }
+    }
+    std::vector<AcqFex::Peak> peaks(settings.maxHits);
+    float baseline, rms;
+
+    t0 = now();
+    do {
+      for(unsigned w=0; w<nwf; w++)
+        hits += AcqFex::find(settings, &wf[w*nsamples], nsamples, &peaks[0], settings.maxHits, baseline, rms);
+      samples += nwf*nsamples;
+      passes++;
+    } while((t1=now())-t0 < tmin);
+  }
+
+  double dt = t1-t0;
+  printf("%u passes, %llu samples, %llu hits in %.3f s : %.1f Msamples/s/core\n",
+         passes, (unsigned long long)samples, (unsigned long long)hits, dt,
+         double(samples)/dt*1.e-6);
+  return 0;
+}
@@ -1,7 +1,13 @@
 libnames := acqiris
 
-libsrcs_acqiris := $(wildcard *.cc)
+libsrcs_acqiris := $(filter-out acqfexbench.cc,$(wildcard *.cc))
 libincs_acqiris := acqiris pdsdata/include ndarray/include boost/include 
 libincs_acqiris += epics/include epics/include/os/Linux
 
+tgtnames := acqfexbench
+tgtsrcs_acqfexbench := acqfexbench.cc AcqFex.cc
+tgtlibs_acqfexbench := pdsdata/xtcdata pdsdata/psddl_pdsdata
+tgtslib_acqfexbench := $(USRLIBDIR)/rt
+tgtincs_acqfexbench := pdsdata/include ndarray/include boost/include
+
 CPPFLAGS += -D_ACQIRIS -D_LINUX
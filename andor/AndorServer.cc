@@ -38,7 +38,7 @@ AndorServer::AndorServer(int iCamera, bool bDelayMode, bool bInitTest, const Src
  _iReadoutWaitTime(_iMaxReadoutTime),
  _config(),
  _fReadoutTime(0),
- _poolFrameData(_iMaxFrameDataSize, _iPoolDataCount), _pDgOut(NULL),
+ _poolFrameData(_iMaxFrameDataSize, _iPoolDataCount), _pDgOut(NULL), _pReduction(NULL),
  _CaptureState(CAPTURE_STATE_IDLE), _pTaskCapture(NULL), _routineCapture(*this)
 {
   if ( initDevice() != 0 )
@@ -68,6 +68,8 @@ AndorServer::~AndorServer()
 
   if ( _pTaskCapture != NULL )
     _pTaskCapture->destroy(); // task object will destroy the thread and release the object memory by itself
+
+  delete _pReduction;
 }
 
 int AndorServer::initDevice()
@@ -690,6 +692,9 @@ int AndorServer::initCapture()
   if (iError != 0)
     return ERROR_FUNCTION_FAILURE;
 
+  if ( FrameReduction::create(_pReduction, _reductionSettings, _iImageWidth, _iImageHeight, 1, "AndorServer::initCapture()") != 0 )
+    return ERROR_INVALID_CONFIG;
+
   //Set initial exposure time
   iError = SetExposureTime(_config.exposureTime());
   if (!isAndorFuncOk(iError))
@@ -1498,6 +1503,9 @@ int AndorServer::getData(InDatagram* in, InDatagram*& out)
   AndorDataType* pData = (AndorDataType*) pFrameHeader;
   new (pFrameHeader) AndorDataType(in->datagram().seq.stamp().fiducials(), _fReadoutTime, pData->temperature());
 
+  if ( _pReduction != NULL )
+    reduceFrame(_pDgOut);
+
   out       = _pDgOut;
 
   /*
@@ -1684,6 +1692,9 @@ int AndorServer::getDataInBeamRateMode(InDatagram* in, InDatagram*& out)
   //AndorDataType*  pData         = (AndorDataType*) pFrameHeader;
   new (pFrameHeader) AndorDataType(dgIn.seq.stamp().fiducials(), _fReadoutTime, 0 /* temperature undefined */);
 
+  if ( _pReduction != NULL )
+    reduceFrame(out);
+
   if (bFrameError)
     // set damage bit, and still keep the image data
     dgOut.xtc.damage.increase(Pds::Damage::UserDefined);
@@ -1783,7 +1794,7 @@ int AndorServer::processFrame()
     return ERROR_LOGICAL_FAILURE;
   }
 
-  if ( _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5 )
+  if ( _pReduction == NULL && ( _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5 ) )
   {
     unsigned char*  pFrameHeader    = (unsigned char*) _pDgOut + sizeof(CDatagram) + sizeof(Xtc);
     AndorDataType* pFrame           = (AndorDataType*) pFrameHeader;
@@ -1809,6 +1820,22 @@ int AndorServer::processFrame()
   return 0;
 }
 
+/*
+ * Replace the full frame of a composed L1 datagram by its binned/ROI/pedestal
+ * subtracted reduction and the frame statistics, which keep the readout header
+ */
+int AndorServer::reduceFrame(InDatagram* dg)
+{
+  AndorDataType*  pData     = (AndorDataType*) ((unsigned char*) dg + sizeof(CDatagram) + sizeof(Xtc));
+  float           fTemp     = pData->temperature();
+  const uint16_t* pImage    = (const uint16_t*) ((uint8_t*) dg + _iFrameHeaderSize);
+
+  _pReduction->apply(dg->datagram().xtc, pImage, _src,
+                     pData->shotIdStart(), pData->readoutTime(), &fTemp,
+                     _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5);
+  return 0;
+}
+
 int AndorServer::setupFrame()
 {
   if ( _poolFrameData.numberOfFreeObjects() <= 0 )
@@ -2101,7 +2128,7 @@ const int       AndorServer::_iMaxCoolingTime;
 const int       AndorServer::_fTemperatureHiTol;
 const int       AndorServer::_fTemperatureLoTol;
 const int       AndorServer::_iFrameHeaderSize      = sizeof(CDatagram) + sizeof(Xtc) + sizeof(AndorDataType);
-const int       AndorServer::_iMaxFrameDataSize     = _iFrameHeaderSize + 2048*2048*2;
+const int       AndorServer::_iMaxFrameDataSize     = _iFrameHeaderSize + 2048*2048*2 + FrameReduction::Overhead;
 const int       AndorServer::_iPoolDataCount;
 const int       AndorServer::_iMaxReadoutTime;
 const int       AndorServer::_iMaxThreadEndTime;
@@ -2113,6 +2140,7 @@ const float     AndorServer::_fEventDeltaTimeFactor = 1.01f;
  * Definition of private static data
  */
 pthread_mutex_t AndorServer::_mutexPlFuncs = PTHREAD_MUTEX_INITIALIZER;
+FrameReduction::Settings AndorServer::_reductionSettings;
 
 
 AndorServer::CaptureRoutine::CaptureRoutine(AndorServer& server) : _server(server)
@@ -2129,4 +2157,9 @@ void AndorServer::setOccSend(AndorOccurrence* occSend)
   _occSend = occSend;
 }
 
+int AndorServer::setReduction(const char* sSettings)
+{
+  return _reductionSettings.parse(sSettings);
+}
+
 } //namespace Pds
@@ -15,6 +15,7 @@
 #include "pds/service/GenericPool.hh"
 #include "pds/service/Routine.hh"
 #include "pds/utility/EbTimeoutConstants.hh"
+#include "pds/camera/FrameReduction.hh"
 #include "AndorOccurrence.hh"
 
 namespace Pds
@@ -49,6 +50,11 @@ public:
         config()  { return _config; }
   void setOccSend(AndorOccurrence* occSend);
 
+  /*
+   * Software binning/ROI/pedestal reduction of every frame; see FrameReduction::Settings
+   */
+  static int setReduction(const char* sSettings);
+
   enum  ErrorCodeEnum
   {
     ERROR_INVALID_ARGUMENTS = 1,
@@ -134,6 +140,7 @@ private:
   int   setupFrame();
   int   waitForNewFrameAvailable();
   int   processFrame();
+  int   reduceFrame(InDatagram* dg);
   int   resetFrameData(bool bDelOutDatagram);
 
   int   setupCooling(double fCoolingTemperature);
@@ -199,6 +206,7 @@ private:
    */
   GenericPool         _poolFrameData;
   InDatagram*         _pDgOut;          // Datagram for outtputing to the Andor Manager
+  FrameReduction*     _pReduction;      // Software frame reduction, if enabled
 
   /*
    * Occurrence support
@@ -243,6 +251,7 @@ private:
    * private static data
    */
   static pthread_mutex_t _mutexPlFuncs;
+  static FrameReduction::Settings _reductionSettings;
 };
 
 class AndorServerException : public std::runtime_error
@@ -39,7 +39,7 @@ DualAndorServer::DualAndorServer(int iCamera, bool bDelayMode, bool bInitTest, c
  _config(),
  _fReadoutTime(0),
  _iTemperatureMaster(999), _iTemperatureSlave(999), _bCallShutdown(false),
- _poolFrameData(_iMaxFrameDataSize, _iPoolDataCount), _pDgOut(NULL),
+ _poolFrameData(_iMaxFrameDataSize, _iPoolDataCount), _pDgOut(NULL), _pReduction(NULL),
  _CaptureState(CAPTURE_STATE_IDLE), _pTaskCapture(NULL), _routineCapture(*this)
 {
   if ( initDevice() != 0 )
@@ -76,6 +76,8 @@ DualAndorServer::~DualAndorServer()
 
   if ( _pTaskCapture != NULL )
     _pTaskCapture->destroy(); // task object will destroy the thread and release the object memory by itself
+
+  delete _pReduction;
 }
 
 int DualAndorServer::initDevice()
@@ -828,6 +830,9 @@ int DualAndorServer::initCapture()
   if (iError != 0)
     return ERROR_FUNCTION_FAILURE;
 
+  if ( FrameReduction::create(_pReduction, _reductionSettings, _iImageWidth, _iImageHeight, _iDetectorSensor, "DualAndorServer::initCapture()") != 0 )
+    return ERROR_INVALID_CONFIG;
+
   if (checkSlaveSelected())
   {
     printf(" Initializing capture on slave (hcam = %d)\n", (int) _hCamSlave);
@@ -1890,6 +1895,9 @@ int DualAndorServer::getData(InDatagram* in, InDatagram*& out)
   unsigned char*  pFrameHeader  = (unsigned char*) _pDgOut + sizeof(CDatagram) + sizeof(Xtc);
   new (pFrameHeader) Andor3dDataType(in->datagram().seq.stamp().fiducials(), _fReadoutTime);
 
+  if ( _pReduction != NULL )
+    reduceFrame(_pDgOut);
+
   out       = _pDgOut;
 
   /*
@@ -2134,6 +2142,9 @@ int DualAndorServer::getDataInBeamRateMode(InDatagram* in, InDatagram*& out)
   unsigned char*  pFrameHeader  = (unsigned char*) out + sizeof(CDatagram) + sizeof(Xtc);
   new (pFrameHeader) Andor3dDataType(dgIn.seq.stamp().fiducials(), _fReadoutTime);
 
+  if ( _pReduction != NULL )
+    reduceFrame(out);
+
   if (bFrameError)
     // set damage bit, and still keep the image data
     dgOut.xtc.damage.increase(Pds::Damage::UserDefined);
@@ -2268,7 +2279,7 @@ int DualAndorServer::processFrame()
     return ERROR_LOGICAL_FAILURE;
   }
 
-  if ( _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5 )
+  if ( _pReduction == NULL && ( _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5 ) )
   {
     unsigned char*  pFrameHeader    = (unsigned char*) _pDgOut + sizeof(CDatagram) + sizeof(Xtc);
     Andor3dDataType* pFrame           = (Andor3dDataType*) pFrameHeader;
@@ -2294,6 +2305,22 @@ int DualAndorServer::processFrame()
   return 0;
 }
 
+/*
+ * Replace the full frames of a composed L1 datagram by their binned/ROI/pedestal
+ * subtracted reduction and the frame statistics, which keep the readout header
+ */
+int DualAndorServer::reduceFrame(InDatagram* dg)
+{
+  Andor3dDataType* pData    = (Andor3dDataType*) ((unsigned char*) dg + sizeof(CDatagram) + sizeof(Xtc));
+  const float*    pTemp     = (const float*) ((uint8_t*) dg + _iFrameHeaderSize);
+  const uint16_t* pImage    = (const uint16_t*) ((uint8_t*) dg + _iFrameHeaderSize + _iDetectorSensor*sizeof(float));
+
+  _pReduction->apply(dg->datagram().xtc, pImage, _src,
+                     pData->shotIdStart(), pData->readoutTime(), pTemp,
+                     _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5);
+  return 0;
+}
+
 int DualAndorServer::setupFrame()
 {
   if ( _poolFrameData.numberOfFreeObjects() <= 0 )
@@ -2653,7 +2680,7 @@ const int       DualAndorServer::_iMaxCoolingTime;
 const int       DualAndorServer::_fTemperatureHiTol;
 const int       DualAndorServer::_fTemperatureLoTol;
 const int       DualAndorServer::_iFrameHeaderSize      = sizeof(CDatagram) + sizeof(Xtc) + sizeof(Andor3dDataType);
-const int       DualAndorServer::_iMaxFrameDataSize     = _iFrameHeaderSize + _iMaxCamera*sizeof(float) + _iMaxCamera*2048*2048*sizeof(uint16_t);
+const int       DualAndorServer::_iMaxFrameDataSize     = _iFrameHeaderSize + _iMaxCamera*sizeof(float) + _iMaxCamera*2048*2048*sizeof(uint16_t) + FrameReduction::Overhead;
 const int       DualAndorServer::_iPoolDataCount;
 const int       DualAndorServer::_iMaxReadoutTime;
 const int       DualAndorServer::_iMaxThreadEndTime;
@@ -2668,6 +2695,7 @@ const float     DualAndorServer::_fEventDeltaTimeFactor = 1.01f;
  * Definition of private static data
  */
 pthread_mutex_t DualAndorServer::_mutexPlFuncs = PTHREAD_MUTEX_INITIALIZER;
+FrameReduction::Settings DualAndorServer::_reductionSettings;
 
 
 DualAndorServer::CaptureRoutine::CaptureRoutine(DualAndorServer& server) : _server(server)
@@ -2684,4 +2712,9 @@ void DualAndorServer::setOccSend(DualAndorOccurrence* occSend)
   _occSend = occSend;
 }
 
+int DualAndorServer::setReduction(const char* sSettings)
+{
+  return _reductionSettings.parse(sSettings);
+}
+
 } //namespace Pds
@@ -15,6 +15,7 @@
 #include "pds/service/GenericPool.hh"
 #include "pds/service/Routine.hh"
 #include "pds/utility/EbTimeoutConstants.hh"
+#include "pds/camera/FrameReduction.hh"
 #include "DualAndorOccurrence.hh"
 
 namespace Pds
@@ -51,6 +52,11 @@ public:
         config()  { return _config; }
   void setOccSend(DualAndorOccurrence* occSend);
 
+  /*
+   * Software binning/ROI/pedestal reduction of every frame; see FrameReduction::Settings
+   */
+  static int setReduction(const char* sSettings);
+
   enum  ErrorCodeEnum
   {
     ERROR_INVALID_ARGUMENTS = 1,
@@ -145,6 +151,7 @@ private:
   int   setupFrame();
   int   waitForNewFrameAvailable();
   int   processFrame();
+  int   reduceFrame(InDatagram* dg);
   int   resetFrameData(bool bDelOutDatagram);
 
   int   resetCooling();
@@ -226,6 +233,7 @@ private:
    */
   GenericPool         _poolFrameData;
   InDatagram*         _pDgOut;          // Datagram for outtputing to the Dual Andor Manager
+  FrameReduction*     _pReduction;      // Software frame reduction, if enabled
 
   /*
    * Occurrence support
@@ -270,6 +278,7 @@ private:
    * private static data
    */
   static pthread_mutex_t _mutexPlFuncs;
+  static FrameReduction::Settings _reductionSettings;
 };
 
 class DualAndorServerException : public std::runtime_error
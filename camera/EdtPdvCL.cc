@@ -10,9 +10,13 @@
 #include "pds/service/Routine.hh"
 #include "pds/service/Task.hh"
 #include "pds/service/Semaphore.hh"
+#include "pds/service/PollSemaphore.hh"
 #include "pdsdata/xtc/DetInfo.hh"
 
 #include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <deque>
 
 #define DBG
 //#define DBUG
@@ -33,6 +37,30 @@ static const int _tmo_ms = 0x7fffffff;
 
 namespace Pds {
 
+  //
+  //  Messages are allocated by the reader thread and deleted by the event
+  //  builder thread, so the free list is locked.
+  //
+  class EdtMsgPool : public GenericPool {
+  public:
+    EdtMsgPool(size_t sizeofObject, int numberofObjects) :
+      GenericPool(sizeofObject, numberofObjects)
+    { pthread_mutex_init(&_lock, NULL); }
+    ~EdtMsgPool() { pthread_mutex_destroy(&_lock); }
+  protected:
+    void* deque()
+    { pthread_mutex_lock(&_lock);
+      void* p = GenericPool::deque();
+      pthread_mutex_unlock(&_lock);
+      return p; }
+    void  enque(PoolEntry* entry)
+    { pthread_mutex_lock(&_lock);
+      GenericPool::enque(entry);
+      pthread_mutex_unlock(&_lock); }
+  private:
+    pthread_mutex_t _lock;
+  };
+
   class EdtReaderEnable : public Routine {
   public:
     EdtReaderEnable(EdtReader* reader, 
@@ -62,6 +90,9 @@ namespace Pds {
       _last_timeouts  (0),
       _recover_timeout(false),
       _running        (false),
+      _armed          (0),
+      _nreleased      (0),
+      _released       (Semaphore::EMPTY),
       _vmon           (n_ring_buffers)
     {
       _sleepTime.tv_sec = 0;
@@ -81,7 +112,12 @@ namespace Pds {
         pdv_cl_reset_fv_counter(pdv_p);
 	pdv_multibuf(_base->dev(), N_RING_BUFFERS);
 	_last_timeouts = pdv_timeouts(_base->dev());
+	while(_released.tryTake())  // releases from the last run
+	  ;
+	_held.clear();
+	_nreleased = 0;
 	pdv_start_images(pdv_p, N_RING_BUFFERS);
+	_armed = N_RING_BUFFERS;
 	_task->call(this);
 	_enable->unblock();
       }
@@ -89,16 +125,62 @@ namespace Pds {
         edt_do_timeout(_base->dev());
       }
     }
+    //
+    //  Requeue ring buffers.  A buffer holding a posted frame is requeued
+    //  only when its message is deleted, after the event builder has
+    //  consumed it, so the ring is never overwritten in flight.  The driver
+    //  restarts buffers in ring order, so a buffer whose frame was dropped
+    //  (overrun, timeout) is held until every posted buffer ahead of it has
+    //  been released.  Frames are consumed in order, so each release is
+    //  that of the oldest posted buffer.
+    //
+    //  Messages are deleted in the event builder thread, which only counts
+    //  the release; the reader thread requeues the buffers, so that the
+    //  driver is called from one thread.
+    //
+    void release() { _released.give(); }
+    static void release(void* arg) { reinterpret_cast<EdtReader*>(arg)->release(); }
     void routine()
     {
       PdvDev* pdv_p = _base->dev();
 
+      if (!_running) {
+        _disable->unblock();
+        return;
+      }
+
+      while(_released.tryTake())
+        _nreleased++;
+      unsigned n = 0;
+      while(!_held.empty()) {
+        if (_held.front()==Posted) {
+          if (!_nreleased) break;
+          _nreleased--;
+        }
+        _held.pop_front();
+        n++;
+      }
+      if (n) {
+        pdv_start_images(pdv_p, n);
+        _armed += n;
+      }
+
+      //  Every buffer is held for a posted frame; wait for a release,
+      //  returning now and then so that a disable is seen
+      if (!_armed) {
+        pollfd pfd;
+        pfd.fd     = _released.fd();
+        pfd.events = POLLIN;
+        ::poll(&pfd, 1, _sleepTime.tv_nsec/1000000);
+        _task->call(this);
+        return;
+      }
+
       u_char* image_p = pdv_wait_image(pdv_p);
+      _armed--;
 
       int overrun  = edt_reg_read(pdv_p, PDV_STAT) & PDV_OVERRUN;
 
-      pdv_start_images(pdv_p, 1);
-
       int timeouts = pdv_timeouts(pdv_p);
 
       _vmon.event(edt_get_todo(pdv_p)-edt_done_count(pdv_p));
@@ -113,6 +195,7 @@ namespace Pds {
                nfv, timeouts, curdone, curtodo);
       }
 
+      BufferState state = Dropped;
       if (timeouts > _last_timeouts) {
 	pdv_timeout_restart(pdv_p, TRUE);
 	_last_timeouts = timeouts;
@@ -121,14 +204,12 @@ namespace Pds {
       else if (overrun) {
 	_base->handle_error("Frame readout error: overrun\n");
       }
-      else {
-	_base->handle(image_p);
+      else if (_base->handle(image_p)) {
+	state = Posted;
       }
+      _held.push_back(state);
 
-      if (_running)
-	_task->call(this);
-      else
-	_disable->unblock();
+      _task->call(this);
     }
   private:
     EdtPdvCL*  _base;
@@ -138,6 +219,11 @@ namespace Pds {
     int       _last_timeouts;
     bool      _recover_timeout;
     bool      _running;
+    enum BufferState { Posted, Dropped };
+    unsigned  _armed;     // buffers started and not yet waited for
+    std::deque<BufferState> _held;  // buffers waited for and not yet restarted, in ring order
+    unsigned  _nreleased; // releases not yet matched to a posted buffer
+    PollSemaphore _released;  // one count per buffer released by the event builder
     timespec  _sleepTime;
     VmonCam   _vmon;
   };
@@ -158,6 +244,7 @@ EdtPdvCL::EdtPdvCL(CameraBase& camera, int unit, int channel) :
   _fsrv    (0),
   _app     (0),
   _occPool (new GenericPool(sizeof(UserMessage),8)),
+  _msgPool (0),
   _hsignal ("CamSignal")
 {
 
@@ -379,6 +466,10 @@ int EdtPdvCL::start_acquisition(FrameServer& fsrv,  // post frames here
   _fsrv = &fsrv;
   _app  = &app;
 
+  //  One message per ring buffer; a message holds its buffer until deleted
+  delete _msgPool;
+  _msgPool = new EdtMsgPool(sizeof(FrameServerMsg),N_RING_BUFFERS);
+
   _acq->queue_enable();
 
   return 0;
@@ -389,6 +480,9 @@ int EdtPdvCL::stop_acquisition()
   _acq->queue_disable();
   _fsrv->clear();
 
+  delete _msgPool;
+  _msgPool = 0;
+
   pdv_close(_dev);
 
   _fsrv = 0;
@@ -468,7 +562,7 @@ void EdtPdvCL::dump()
 {
 }
 
-void EdtPdvCL::handle(u_char* image_p)
+bool EdtPdvCL::handle(u_char* image_p)
 {
 #ifdef DBG
   timespec ts;
@@ -480,13 +574,18 @@ void EdtPdvCL::handle(u_char* image_p)
 
   CameraBase& c = camera();
   FrameServerMsg* msg =
-    new FrameServerMsg(FrameServerMsg::NewFrame,
-		       image_p,
-		       c.camera_width(),
-		       c.camera_height(),
-		       c.camera_depth(),
-		       _nposts,
-		       0);
+    new (_msgPool) FrameServerMsg(FrameServerMsg::NewFrame,
+				  image_p,
+				  c.camera_width(),
+				  c.camera_height(),
+				  c.camera_depth(),
+				  _nposts,
+				  0,
+				  &EdtReader::release, _acq);
+  if (!msg) {  // one message per ring buffer, so this should never happen
+    printf("EdtPdvCL::handle message pool is empty\n");
+    return false;
+  }
 
   //  Test out-of-order
   if (_outOfOrder)
@@ -505,6 +604,7 @@ void EdtPdvCL::handle(u_char* image_p)
 #ifdef DBG
   _hsignal.print(_nposts);
 #endif
+  return true;
 }
 
 void EdtPdvCL::handle_error(const char* s)
@@ -35,7 +35,7 @@ namespace Pds {
                           Appliance  &,  // post occurrences here
 			  UserMessage*);
     int stop_acquisition();
-    void handle         (u_char*);
+    bool handle         (u_char*);  // false if the frame was not posted
     void handle_error   (const char*);
   public:
     int SendCommand(char* szCommand, 
@@ -59,6 +59,7 @@ namespace Pds {
     FrameServer*    _fsrv;
     Appliance*      _app;
     GenericPool*    _occPool;
+    GenericPool*    _msgPool;
     bool                 _outOfOrder;
     bool                 _latched;
     unsigned             _nposts;
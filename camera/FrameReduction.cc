@@ -0,0 +1,382 @@
+#include "pds/camera/FrameReduction.hh"
+
+#include "pds/camera/FrameType.hh"
+
+#include "pdsdata/xtc/Xtc.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <new>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace Pds;
+
+static Pds::TypeId _frameStatsType(Pds::TypeId::Any, FrameStats::Version);
+
+namespace Pds {
+  class RowStats {
+  public:
+    RowStats() : nsaturated(0), min(0xffff), max(0), sum(0), sumsq(0) {}
+  public:
+    unsigned nsaturated;
+    unsigned min;
+    unsigned max;
+    uint64_t sum;
+    uint64_t sumsq;
+  };
+};
+
+//
+//  Pedestal subtracts "n" raw pixels "p" into "d" and accumulates their
+//  statistics.  Row sums are kept in 32-bit lanes, which is safe for rows
+//  up to 64k pixels.
+//
+static void _subtract_row(const uint16_t* p, const uint16_t* q, unsigned n,
+                          unsigned saturation, uint16_t* d, RowStats& s)
+{
+  unsigned i=0;
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bias = _mm_set1_epi16(short(0x8000));
+  const __m128i vsat = _mm_set1_epi16(short(saturation > 0xffff ? 0xffff : saturation));
+  __m128i vmin = _mm_set1_epi16(short(0x7fff));  // biased 0xffff
+  __m128i vmax = _mm_set1_epi16(short(0x8000));  // biased 0
+  __m128i vnst = zero;
+  __m128i vsum = zero;
+  __m128i vsq  = zero;
+  for(; i+8<=n; i+=8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p+i));
+    //  v >= saturation  <=>  saturation -sat v == 0
+    vnst = _mm_sub_epi16(vnst, _mm_cmpeq_epi16(_mm_subs_epu16(vsat,v),zero));
+    if (q)
+      v = _mm_subs_epu16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(q+i)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+i), v);
+
+    __m128i b = _mm_xor_si128(v,bias);  // unsigned order as signed
+    vmin = _mm_min_epi16(vmin,b);
+    vmax = _mm_max_epi16(vmax,b);
+
+    vsum = _mm_add_epi32(vsum, _mm_add_epi32(_mm_unpacklo_epi16(v,zero),
+                                             _mm_unpackhi_epi16(v,zero)));
+
+    __m128i pl  = _mm_mullo_epi16(v,v);
+    __m128i ph  = _mm_mulhi_epu16(v,v);
+    __m128i sq0 = _mm_unpacklo_epi16(pl,ph);
+    __m128i sq1 = _mm_unpackhi_epi16(pl,ph);
+    vsq = _mm_add_epi64(vsq, _mm_add_epi64(_mm_unpacklo_epi32(sq0,zero),
+                                           _mm_unpackhi_epi32(sq0,zero)));
+    vsq = _mm_add_epi64(vsq, _mm_add_epi64(_mm_unpacklo_epi32(sq1,zero),
+                                           _mm_unpackhi_epi32(sq1,zero)));
+  }
+  if (i) {
+    uint16_t a16[8];
+    uint32_t a32[4];
+    uint64_t a64[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(a16), _mm_xor_si128(vmin,bias));
+    for(unsigned k=0; k<8; k++) if (a16[k] < s.min) s.min = a16[k];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(a16), _mm_xor_si128(vmax,bias));
+    for(unsigned k=0; k<8; k++) if (a16[k] > s.max) s.max = a16[k];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(a16), vnst);
+    for(unsigned k=0; k<8; k++) s.nsaturated += a16[k];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(a32), vsum);
+    s.sum += uint64_t(a32[0])+a32[1]+a32[2]+a32[3];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(a64), vsq);
+    s.sumsq += a64[0]+a64[1];
+  }
+#endif
+  for(; i<n; i++) {
+    unsigned v = p[i];
+    if (v >= saturation) s.nsaturated++;
+    if (q) v = v > q[i] ? v-q[i] : 0;
+    d[i] = v;
+    if (v < s.min) s.min = v;
+    if (v > s.max) s.max = v;
+    s.sum   += v;
+    s.sumsq += uint64_t(v*v);
+  }
+}
+
+double FrameStats::mean() const
+{
+  return npixels ? double(sum)/double(npixels) : 0;
+}
+
+double FrameStats::rms() const
+{
+  if (!npixels) return 0;
+  double m = mean();
+  double v = double(sumsq)/double(npixels) - m*m;
+  return v > 0 ? sqrt(v) : 0;
+}
+
+FrameReduction::Settings::Settings() :
+  binX      (1),
+  binY      (1),
+  roiX      (0),
+  roiY      (0),
+  roiW      (0),
+  roiH      (0),
+  saturation(0xffff)
+{
+}
+
+int FrameReduction::Settings::parse(const char* arg)
+{
+  std::string s(arg);
+  size_t p = 0;
+  while(p < s.size()) {
+    size_t e = s.find(':',p);
+    if (e == std::string::npos) e = s.size();
+    std::string f(s.substr(p,e-p));
+    p = e+1;
+
+    if (f.compare(0,4,"bin=")==0) {
+      if (sscanf(f.c_str()+4,"%ux%u",&binX,&binY)!=2 || !binX || !binY) {
+        printf("*** FrameReduction::Settings bad binning \"%s\"\n",f.c_str());
+        return -1;
+      }
+    }
+    else if (f.compare(0,4,"roi=")==0) {
+      if (sscanf(f.c_str()+4,"%u,%u,%u,%u",&roiX,&roiY,&roiW,&roiH)!=4) {
+        printf("*** FrameReduction::Settings bad roi \"%s\"\n",f.c_str());
+        return -1;
+      }
+    }
+    else if (f.compare(0,4,"ped=")==0)
+      pedestal = f.substr(4);
+    else if (f.compare(0,4,"sat=")==0)
+      saturation = strtoul(f.c_str()+4,NULL,0);
+    else if (!f.empty()) {
+      printf("*** FrameReduction::Settings unknown field \"%s\"\n",f.c_str());
+      return -1;
+    }
+  }
+  return 0;
+}
+
+bool FrameReduction::Settings::enabled() const
+{
+  return binX>1 || binY>1 || roiW || roiH || !pedestal.empty();
+}
+
+void FrameReduction::Settings::dump() const
+{
+  printf("Frame reduction: bin %ux%u  roi (%u,%u) %ux%u  saturation %u  pedestal %s\n",
+         binX, binY, roiX, roiY, roiW, roiH, saturation,
+         pedestal.empty() ? "none" : pedestal.c_str());
+}
+
+FrameReduction::FrameReduction(const Settings& settings,
+                               unsigned width,
+                               unsigned height,
+                               unsigned nsections) :
+  _settings (settings),
+  _width    (width),
+  _height   (height),
+  _nsections(nsections),
+  _ow       (0),
+  _oh       (0),
+  _pedestal (0),
+  _row      (0),
+  _valid    (false)
+{
+  _acc[0] = _acc[1] = 0;
+
+  unsigned roiW = _settings.roiW ? _settings.roiW : width;
+  unsigned roiH = _settings.roiH ? _settings.roiH : height;
+  if (_settings.roiX + roiW > width || _settings.roiY + roiH > height) {
+    printf("*** FrameReduction ROI (%u,%u) %ux%u exceeds the frame %ux%u\n",
+           _settings.roiX, _settings.roiY, roiW, roiH, width, height);
+    return;
+  }
+  _ow = roiW / _settings.binX;
+  _oh = roiH / _settings.binY;
+  if (!_ow || !_oh) {
+    printf("*** FrameReduction binning %ux%u exceeds the ROI %ux%u\n",
+           _settings.binX, _settings.binY, roiW, roiH);
+    return;
+  }
+  if (_nsections > FrameStats::MaxSections) {
+    printf("*** FrameReduction supports at most %u sections\n", FrameStats::MaxSections);
+    return;
+  }
+  if (!_settings.pedestal.empty() && _load_pedestal(_settings.pedestal.c_str()))
+    return;
+
+  _row    = new uint16_t[_ow*_settings.binX];
+  _acc[0] = new uint32_t[_ow];
+  _acc[1] = new uint32_t[_ow];
+  _valid  = true;
+}
+
+FrameReduction::~FrameReduction()
+{
+  delete[] _acc[1];
+  delete[] _acc[0];
+  delete[] _row;
+  delete[] _pedestal;
+}
+
+int FrameReduction::_load_pedestal(const char* path)
+{
+  FILE* f = fopen(path,"r");
+  if (!f) {
+    printf("*** FrameReduction failed to open pedestal %s : %s\n", path, strerror(errno));
+    return -1;
+  }
+  size_t n = size_t(_width)*_height*_nsections;
+  _pedestal = new uint16_t[n];
+  size_t r = fread(_pedestal, sizeof(uint16_t), n, f);
+  bool extra = fgetc(f)!=EOF;
+  fclose(f);
+  if (r != n || extra) {
+    printf("*** FrameReduction pedestal %s does not match the %ux%ux%u frame\n",
+           path, _width, _height, _nsections);
+    delete[] _pedestal;
+    _pedestal = 0;
+    return -1;
+  }
+  return 0;
+}
+
+//
+//  Adds a pedestal subtracted raw row into a binned row
+//
+void FrameReduction::_fold(const uint16_t* d, uint32_t* acc) const
+{
+  switch(_settings.binX) {
+  case 1:
+    for(unsigned j=0; j<_ow; j++)
+      acc[j] += d[j];
+    break;
+  case 2:
+    for(unsigned j=0; j<_ow; j++)
+      acc[j] += unsigned(d[2*j]) + d[2*j+1];
+    break;
+  default:
+    for(unsigned j=0; j<_ow; j++) {
+      uint32_t v = 0;
+      for(unsigned k=0; k<_settings.binX; k++)
+        v += *d++;
+      acc[j] += v;
+    }
+    break;
+  }
+}
+
+static inline void _write_row(const uint32_t* acc, unsigned n, uint16_t* out)
+{
+  for(unsigned j=0; j<n; j++)
+    out[j] = acc[j] > 0xffff ? 0xffff : acc[j];
+}
+
+void FrameReduction::reduce(const uint16_t* in, uint16_t* out, FrameStats& stats)
+{
+  const unsigned binX = _settings.binX;
+  const unsigned binY = _settings.binY;
+  const unsigned nraw = _ow*binX;
+  const size_t   ssize = size_t(_width)*_height;
+
+  RowStats  s;
+  uint16_t* pending = 0;
+  unsigned  g = 0;
+  for(unsigned is=0; is<_nsections; is++) {
+    const uint16_t* sin = in + is*ssize;
+    const uint16_t* ped = _pedestal ? _pedestal + is*ssize : 0;
+    for(unsigned r=0; r<_oh; r++, g++) {
+      uint32_t* acc = _acc[g&1];
+      memset(acc, 0, _ow*sizeof(uint32_t));
+      for(unsigned k=0; k<binY; k++) {
+        size_t o = size_t(_settings.roiY + r*binY + k)*_width + _settings.roiX;
+        _subtract_row(sin+o, ped ? ped+o : 0, nraw, _settings.saturation, _row, s);
+        _fold(_row, acc);
+      }
+      //  The previous row group has been consumed; its binned row is safe to write
+      if (pending)
+        _write_row(_acc[(g&1)^1], _ow, pending);
+      pending = out;
+      out    += _ow;
+    }
+  }
+  _write_row(_acc[(g-1)&1], _ow, pending);
+
+  stats.npixels    = nraw*_oh*binY*_nsections;
+  stats.nsaturated = s.nsaturated;
+  stats.min        = s.min > s.max ? 0 : s.min;
+  stats.max        = s.max;
+  stats.sum        = s.sum;
+  stats.sumsq      = s.sumsq;
+}
+
+FrameStats* FrameReduction::apply(Xtc& parent, const uint16_t* pixels, const Src& src)
+{
+  char*  p   = parent.payload();
+  Damage dmg = reinterpret_cast<const Xtc*>(p)->damage;
+
+  //  The headers overwrite raw data, so reduce before placing them
+  uint16_t* out = reinterpret_cast<uint16_t*>(p + sizeof(Xtc) + sizeof(FrameType));
+  FrameStats stats;
+  memset(&stats, 0, sizeof(stats));
+  reduce(pixels, out, stats);
+
+  Xtc* frameXtc = new (p) Xtc(_frameType, src, dmg);
+  new (frameXtc->alloc(sizeof(FrameType))) FrameType(width(), height(), 16, 0);
+  frameXtc->alloc((width()*height()*sizeof(uint16_t)+3)&~3);
+
+  Xtc* statsXtc = new ((char*)frameXtc->next()) Xtc(_frameStatsType, src, dmg);
+  FrameStats* result = new (statsXtc->alloc(sizeof(FrameStats))) FrameStats(stats);
+
+  parent.extent = sizeof(Xtc) + frameXtc->extent + statsXtc->extent;
+  return result;
+}
+
+void FrameReduction::apply(Xtc& parent, const uint16_t* pixels, const Src& src,
+                           uint32_t shotIdStart, float readoutTime,
+                           const float* temperature, bool report)
+{
+  //  The header may lie in the raw frame, so copy it before reducing
+  float temp[FrameStats::MaxSections];
+  for(unsigned i=0; i<FrameStats::MaxSections; i++)
+    temp[i] = i < _nsections ? temperature[i] : 0;
+
+  FrameStats* stats = apply(parent, pixels, src);
+  stats->shotIdStart = shotIdStart;
+  stats->readoutTime = readoutTime;
+  for(unsigned i=0; i<FrameStats::MaxSections; i++)
+    stats->temperature[i] = temp[i];
+
+  if (report)
+    printf( "Frame Avg Value = %.2lf  Std = %.2lf  Min %u  Max %u  Saturated %u  Reduced %d x %d\n",
+            stats->mean(), stats->rms(), stats->min, stats->max, stats->nsaturated,
+            width(), height() );
+}
+
+int FrameReduction::create(FrameReduction*& reduction,
+                           const Settings& settings,
+                           unsigned width,
+                           unsigned height,
+                           unsigned nsections,
+                           const char* owner)
+{
+  delete reduction;
+  reduction = 0;
+  if (!settings.enabled())
+    return 0;
+
+  settings.dump();
+  reduction = new FrameReduction(settings, width, height, nsections);
+  if (!reduction->valid()) {
+    printf("%s: Frame reduction does not fit the %u x %u x %u image\n",
+           owner, width, height, nsections);
+    delete reduction;
+    reduction = 0;
+    return -1;
+  }
+  return 0;
+}
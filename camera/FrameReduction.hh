@@ -0,0 +1,138 @@
+#ifndef Pds_FrameReduction_hh
+#define Pds_FrameReduction_hh
+
+//
+//  Software binning, ROI crop, pedestal subtraction and summary statistics
+//  for the slow CCD servers (Andor, DualAndor, Princeton, PI-MAX).
+//
+//  The raw frame is read exactly once.  Each raw row inside the ROI is
+//  pedestal subtracted (clamped at zero), accumulated into the statistics
+//  and folded into a binned row; binned rows are written out one row group
+//  behind the rows being read, so the reduced frame may overwrite the raw
+//  frame in place.  Partial bins at the ROI edges are dropped, as the
+//  cameras do for hardware binning.
+//
+//  A frame may consist of several equal sections stacked vertically (one
+//  per sensor); the ROI and binning are applied to each section and the
+//  reduced sections are stacked in the same order.
+//
+//  The servers create their reduction with FrameReduction::create at each
+//  capture initialization and reduce each L1 datagram with apply(), which
+//  also fills in and reports the statistics, so the servers skip their
+//  own statistics pass over the raw frame while a reduction is active.
+//
+
+#include <string>
+#include <stdint.h>
+
+namespace Pds {
+
+  class Src;
+  class Xtc;
+
+  //
+  //  Summary of one reduced frame.  Also carries the readout header of the
+  //  native frame type, which the reduced Camera::FrameV1 does not have.
+  //  Recorded with TypeId::Any until a pdsdata type is assigned.
+  //
+  class FrameStats {
+  public:
+    enum { Version = 1 };
+    enum { MaxSections = 2 };
+  public:
+    uint32_t shotIdStart;
+    float    readoutTime;
+    float    temperature[MaxSections];  // per sensor
+    uint32_t npixels;       // raw pixels reduced
+    uint32_t nsaturated;    // raw pixels at or above the saturation level
+    uint32_t min;           // pedestal subtracted pixel range
+    uint32_t max;
+    uint64_t sum;           // pedestal subtracted pixel sums
+    uint64_t sumsq;
+  public:
+    double   mean() const;
+    double   rms () const;
+  };
+
+  class FrameReduction {
+  public:
+    //
+    //  Parsed from "bin=<x>x<y>:roi=<x>,<y>,<w>,<h>:ped=<file>:sat=<level>",
+    //  any field may be omitted.  The ROI is in raw pixels of one section
+    //  (a zero width or height means the full section).  The pedestal file
+    //  holds one raw frame of little-endian 16-bit values.
+    //
+    class Settings {
+    public:
+      Settings();
+    public:
+      int  parse  (const char*);
+      bool enabled() const;
+      void dump   () const;
+    public:
+      unsigned    binX, binY;
+      unsigned    roiX, roiY, roiW, roiH;
+      unsigned    saturation;
+      std::string pedestal;
+    };
+  public:
+    //  Most the datagram can grow by when the reduction is applied
+    enum { Overhead = 128 };
+  public:
+    //
+    //  Replaces "reduction" with one for the given raw frame, or with none
+    //  when the settings are not enabled.  Returns -1, leaving none, if the
+    //  settings do not fit the frame; "owner" prefixes the report.
+    //
+    static int create(FrameReduction*& reduction,
+                      const Settings&,
+                      unsigned width,
+                      unsigned height,
+                      unsigned nsections,
+                      const char* owner);
+  public:
+    FrameReduction(const Settings&,
+                   unsigned width,         // raw section width
+                   unsigned height,        // raw section height
+                   unsigned nsections=1);
+    ~FrameReduction();
+  public:
+    bool     valid () const { return _valid; }
+    unsigned width () const { return _ow; }
+    unsigned height() const { return _oh*_nsections; }
+  public:
+    //
+    //  Reduces the raw frame "pixels" belonging to the native frame xtc
+    //  which is the only child of "parent".  The native xtc is replaced by
+    //  a Camera::FrameV1 xtc of the reduced frame followed by a FrameStats
+    //  xtc, both keeping its damage, and "parent" is resized to fit.
+    //  Returns the stats so the caller can fill in the readout header.
+    //
+    FrameStats* apply (Xtc& parent, const uint16_t* pixels, const Src&);
+    //
+    //  As above, also copying the native readout header (one temperature
+    //  per section) into the stats and printing them if "report"
+    //
+    void        apply (Xtc& parent, const uint16_t* pixels, const Src&,
+                       uint32_t shotIdStart, float readoutTime,
+                       const float* temperature, bool report);
+    //
+    //  Reduces "in" to "out" which may alias "in" provided it starts no
+    //  more than one raw row beyond it.
+    //
+    void        reduce(const uint16_t* in, uint16_t* out, FrameStats&);
+  private:
+    int  _load_pedestal(const char*);
+    void _fold(const uint16_t*, uint32_t*) const;
+  private:
+    const Settings _settings;
+    unsigned  _width, _height, _nsections;
+    unsigned  _ow, _oh;         // reduced section size
+    uint16_t* _pedestal;
+    uint16_t* _row;             // pedestal subtracted raw row
+    uint32_t* _acc[2];          // binned rows being summed and waiting to be written
+    bool      _valid;
+  };
+};
+
+#endif
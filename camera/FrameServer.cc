@@ -43,8 +43,10 @@ void FrameServer::clear()
 #else
   int flags = ::fcntl(_fd[0],F_GETFL) | O_NONBLOCK;
   ::fcntl(_fd[0],F_SETFL,flags);
-  while(::read(_fd[0],&msg,sizeof(msg))>0) 
+  while(::read(_fd[0],&msg,sizeof(msg))>0) {
     printf("FrameServer::clear %p\n",msg);
+    delete msg;  // releases the frame buffer
+  }
   flags ^= O_NONBLOCK;
   ::fcntl(_fd[0],F_SETFL,flags);
 #endif
@@ -2,12 +2,20 @@
 #define Pds_FrameServerMsg_hh
 
 #include "pds/service/LinkedList.hh"
+#include "pds/service/Pool.hh"
 #include "pdsdata/xtc/Damage.hh"
 
 namespace Pds {
 
+  //
+  //  Messages are allocated from the driver's pool; deleting one returns
+  //  it to the pool and calls "release" so the driver can reuse the
+  //  frame buffer it references.
+  //
   class FrameServerMsg : public LinkedList<FrameServerMsg> {
   public:
+    PoolDeclare;
+
     enum Type { NewFrame, Fragment };
     enum Intlv { None, MidTopLine };
 
@@ -39,6 +39,46 @@ static PdsLeutron::PicPortCL* signalHandlerArgs[] =
   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
+namespace PdsLeutron {
+
+  //
+  //  Messages are allocated in the signal handler and deleted by the event
+  //  builder thread.  A lock is not safe in a signal handler, so entries are
+  //  returned through a single producer, single consumer ring.  The pool is
+  //  populated into the GenericPool queue (the base class' enque while it
+  //  is constructed), which only the allocating side touches afterwards.
+  //
+  class PicPortMsgPool : public Pds::GenericPool {
+  public:
+    PicPortMsgPool(size_t sizeofObject, int numberofObjects) :
+      Pds::GenericPool(sizeofObject, numberofObjects),
+      _size (numberofObjects+1),
+      _ring (new Pds::PoolEntry*[numberofObjects+1]),
+      _head (0),
+      _tail (0) {}
+    ~PicPortMsgPool() { delete[] _ring; }
+  protected:
+    void* deque()
+    { void* p = Pds::GenericPool::deque();
+      if (p || _head==_tail) return p;
+      __sync_synchronize();  // read the slot after the index
+      Pds::PoolEntry* entry = _ring[_head];
+      __sync_synchronize();  // release the slot after it is read
+      _head = (_head+1)%_size;
+      return &entry[1]; }
+    void  enque(Pds::PoolEntry* entry)
+    { _ring[_tail] = entry;  // never full: a slot for every entry
+      __sync_synchronize();  // publish the slot before the index
+      _tail = (_tail+1)%_size; }
+  private:
+    unsigned           _size;
+    Pds::PoolEntry**   _ring;
+    volatile unsigned  _head;  // allocating side
+    volatile unsigned  _tail;  // freeing side
+  };
+
+};
+
 static void cameraSignalHandler(int arg)
 {
   PdsLeutron::PicPortCL* mgr = signalHandlerArgs[arg];
@@ -110,6 +150,7 @@ PicPortCL::PicPortCL(Pds::CameraBase& camera,
   _fsrv    (0),
   _app     (0),
   _occPool (new Pds::GenericPool(sizeof(Pds::UserMessage),4)),
+  _msgPool (new PicPortMsgPool(sizeof(Pds::FrameServerMsg),nbuffers)),
   _sig     (-1),
   _hsignal ("CamSignal"), 
   _pSeqDral(NULL),
@@ -216,16 +257,17 @@ void PicPortCL::handle()
     return;
   }
   Pds::FrameServerMsg* msg = 
-    new Pds::FrameServerMsg(Pds::FrameServerMsg::NewFrame,
-                            fhandle->data,
-                            fhandle->width,
-                            fhandle->height,
-                            fhandle->depth(),
-			    _nposts,
-			    0,
-                            &release_handle, fhandle);
+    new (_msgPool) Pds::FrameServerMsg(Pds::FrameServerMsg::NewFrame,
+                                       fhandle->data,
+                                       fhandle->width,
+                                       fhandle->height,
+                                       fhandle->depth(),
+                                       _nposts,
+                                       0,
+                                       &release_handle, fhandle);
   if (!msg) {
     printf("%s:line %d: Failed to allocate FrameServerMsg\n",__FILE__,__LINE__);
+    release_handle(fhandle);
     return;
   }
 
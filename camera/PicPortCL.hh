@@ -104,6 +104,7 @@ namespace PdsLeutron {
     Pds::FrameServer*    _fsrv;
     Pds::Appliance*      _app;
     Pds::GenericPool*    _occPool;
+    Pds::GenericPool*    _msgPool;
     bool                 _outOfOrder;
     int                  _sig;
     unsigned             _nposts;
@@ -11,6 +11,7 @@ libsrcs_camera := CameraBase.cc \
 		  FrameHandle.cc \
 		  TwoDMoments.cc \
 		  TwoDGaussian.cc \
+		  FrameReduction.cc \
 		  Frame.cc \
 	          FrameServer.cc \
 	          FexFrameServer.cc \
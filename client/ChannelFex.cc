@@ -0,0 +1,60 @@
+#include "pds/client/ChannelFex.hh"
+
+#include <stdlib.h>
+
+using namespace Pds;
+
+static int _parseList(const char* name, const char* p, char** end, double* v, unsigned n)
+{
+  unsigned i=0;
+  while(1) {
+    char* e;
+    double x = strtod(p, &e);
+    if (e==p) {
+      printf("*** ChannelFex: bad %s value at \"%s\"\n", name, p);
+      return -1;
+    }
+    if (i==n) {
+      printf("*** ChannelFex: more than %u %s values\n", n, name);
+      return -1;
+    }
+    v[i++] = x;
+    p = e;
+    if (*p!=',') break;
+    p++;
+  }
+  *end = const_cast<char*>(p);
+  if (i==1)
+    for(; i<n; i++)
+      v[i] = v[0];
+  else if (i<n) {
+    printf("*** ChannelFex: %u %s values for %u channels\n", i, name, n);
+    return -1;
+  }
+  return 0;
+}
+
+int ChannelFexBase::parse(const char* s, double* scale, double* offset, unsigned n)
+{
+  const char* p = s;
+  while(*p) {
+    char* e;
+    if (strncmp(p,"scale=",6)==0) {
+      if (_parseList("scale", p+6, &e, scale, n)) return -1;
+    }
+    else if (strncmp(p,"offset=",7)==0) {
+      if (_parseList("offset", p+7, &e, offset, n)) return -1;
+    }
+    else {
+      printf("*** ChannelFex: unknown field at \"%s\" in \"%s\"\n", p, s);
+      return -1;
+    }
+    p = e;
+    if (*p==':') p++;
+    else if (*p) {
+      printf("*** ChannelFex: unexpected \"%s\" in \"%s\"\n", p, s);
+      return -1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,167 @@
+#ifndef Pds_ChannelFex_hh
+#define Pds_ChannelFex_hh
+
+//
+//  Per-channel feature extraction of low rate devices.  The value of each
+//  channel is scale*(raw+offset).  A kernel fixes at compile time the
+//  device's types, its number of channels, how the raw values are read
+//  and how the result is recorded:
+//
+//    class Kernel {
+//    public:
+//      enum { NChannels = <n> };
+//      typedef <device data>   Data;
+//      typedef <configuration> Config;  // from the Configure datagram
+//      typedef <fex result>    Result;
+//      static TypeId   dataType   ();
+//      static TypeId   configType ();
+//      static TypeId   resultType ();
+//      //  Sets the calibration from the configuration; false if it has none
+//      static bool     calibration(const Config&, double* scale, double* offset);
+//      //  Writes NChannels raw values and returns the number that are valid
+//      static unsigned raw        (const Config&, const Data&, double* v);
+//      //  Fills the result of n values and returns its size in bytes
+//      static unsigned result     (const double* v, unsigned n, Result&);
+//    };
+//
+//  Devices whose configuration has no calibration use the kernel's
+//  settings.  ChannelFexApp runs the kernels of all the
+//  devices of a node in one pass over each event.
+//
+//  Data are matched to a configuration by the source's physical id only,
+//  since the log word carries the id of the process that recorded it.
+//
+
+#include "pdsdata/xtc/Xtc.hh"
+#include "pdsdata/xtc/TypeId.hh"
+#include "pdsdata/xtc/Src.hh"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <new>
+
+namespace Pds {
+
+  class ChannelFexBase {
+  public:
+    virtual ~ChannelFexBase() {}
+  public:
+    virtual TypeId   dataType  () const = 0;
+    virtual TypeId   configType() const = 0;
+    virtual void     clear     () = 0;
+    //  Takes a copy of a device configuration xtc
+    virtual void     configure (const Xtc&) = 0;
+    //
+    //  Writes the result xtc of the data xtc "in" at "out" (at least
+    //  maxSize() bytes) and returns its extent, or 0 for an unconfigured
+    //  source
+    //
+    virtual unsigned process   (const Xtc& in, char* out) const = 0;
+    virtual unsigned maxSize   () const = 0;
+  public:
+    //
+    //  Parses "scale=<s0>,<s1>,...:offset=<o0>,<o1>,..." into n channels;
+    //  a single value applies to every channel.  Returns 0 on success.
+    //
+    static int       parse     (const char*, double* scale, double* offset, unsigned n);
+  };
+
+  //
+  //  Up to NChannels values recorded as a TypeId::Any xtc with the
+  //  device's source, for devices without a pdsdata fex type
+  //
+  template <unsigned N>
+  class ChannelFexValues {
+  public:
+    enum { Version = 1 };
+    uint32_t nchannels;
+    uint32_t reserved;
+    double   value[N];
+  public:
+    unsigned fill(const double* v, unsigned n) {
+      nchannels = n;
+      reserved  = 0;
+      memcpy(value, v, n*sizeof(double));
+      return sizeof(*this)-(N-n)*sizeof(double);
+    }
+  };
+
+  template <class K>
+  class ChannelFex : public ChannelFexBase {
+  public:
+    enum { NChannels = K::NChannels, MaxSources = 16 };
+  public:
+    ChannelFex() : _nsources(0) {
+      for(unsigned i=0; i<NChannels; i++) {
+        _scale [i] = 1;
+        _offset[i] = 0;
+      }
+    }
+    ~ChannelFex() {}
+  public:
+    //  Sets the calibration of sources configured without one
+    int      settings  (const char* s) { return parse(s, _scale, _offset, NChannels); }
+    TypeId   dataType  () const { return K::dataType(); }
+    TypeId   configType() const { return K::configType(); }
+    void     clear     () { _nsources = 0; }
+    void     configure (const Xtc& xtc) {
+      configure(xtc.src, *reinterpret_cast<const typename K::Config*>(xtc.payload()));
+    }
+    void     configure (const Src& src, const typename K::Config& config) {
+      Source* s = _find(src);
+      if (!s) {
+        if (_nsources == MaxSources) {
+          printf("*** ChannelFex: more than %d sources of %s\n",
+                 int(MaxSources), TypeId::name(K::dataType().id()));
+          return;
+        }
+        s = &_sources[_nsources++];
+        s->phy = src.phy();
+      }
+      s->config = config;
+      if (!K::calibration(s->config, s->scale, s->offset)) {
+        memcpy(s->scale , _scale , sizeof(_scale));
+        memcpy(s->offset, _offset, sizeof(_offset));
+      }
+    }
+    unsigned process   (const Xtc& in, char* out) const {
+      const Source* s = _find(in.src);
+      if (!s) return 0;
+
+      double v[NChannels];
+      unsigned n = K::raw(s->config, *reinterpret_cast<const typename K::Data*>(in.payload()), v);
+      for(unsigned i=0; i<NChannels; i++)
+        v[i] = s->scale[i]*(v[i]+s->offset[i]);
+
+      Xtc* xtc = new (out) Xtc(K::resultType(), in.src);
+      xtc->extent += K::result(v, n, *reinterpret_cast<typename K::Result*>(xtc->payload()));
+      return xtc->extent;
+    }
+    unsigned maxSize   () const { return sizeof(Xtc)+sizeof(typename K::Result); }
+  private:
+    class Source {
+    public:
+      uint32_t phy;
+      typename K::Config config;
+      double   scale [NChannels];
+      double   offset[NChannels];
+    };
+    const Source* _find(const Src& src) const {
+      for(unsigned i=0; i<_nsources; i++)
+        if (_sources[i].phy==src.phy())
+          return &_sources[i];
+      return 0;
+    }
+    Source*       _find(const Src& src) {
+      return const_cast<Source*>(static_cast<const ChannelFex*>(this)->_find(src));
+    }
+  private:
+    double   _scale [NChannels];
+    double   _offset[NChannels];
+    unsigned _nsources;
+    Source   _sources[MaxSources];
+  };
+};
+
+#endif
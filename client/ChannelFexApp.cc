@@ -0,0 +1,105 @@
+#include "pds/client/ChannelFexApp.hh"
+#include "pds/client/ChannelFex.hh"
+
+#include "pds/xtc/InDatagram.hh"
+
+#include <stdio.h>
+
+using namespace Pds;
+
+ChannelFexApp::ChannelFexApp() :
+  _nkernels  (0),
+  _buffer    (0),
+  _bufferSize(0),
+  _in        (0),
+  _configure (false)
+{
+}
+
+ChannelFexApp::~ChannelFexApp()
+{
+  for(unsigned i=0; i<_nkernels; i++)
+    delete _kernel[i];
+  delete[] _buffer;
+}
+
+int ChannelFexApp::add(ChannelFexBase* k)
+{
+  if (_nkernels == MaxKernels) {
+    printf("*** ChannelFexApp: more than %d kernels\n", int(MaxKernels));
+    delete k;
+    return -1;
+  }
+  for(unsigned i=0; i<_nkernels; i++)
+    if (_dataType[i] == k->dataType().value()) {
+      printf("*** ChannelFexApp: second kernel for %s\n", TypeId::name(k->dataType().id()));
+      delete k;
+      return -1;
+    }
+
+  _kernel    [_nkernels] = k;
+  _dataType  [_nkernels] = k->dataType  ().value();
+  _configType[_nkernels] = k->configType().value();
+  _nkernels++;
+
+  if (k->maxSize() > _bufferSize) {
+    delete[] _buffer;
+    _bufferSize = k->maxSize();
+    _buffer     = new char[_bufferSize];
+  }
+  return 0;
+}
+
+Transition* ChannelFexApp::transitions(Transition* tr)
+{
+  return tr;
+}
+
+InDatagram* ChannelFexApp::events(InDatagram* in)
+{
+  Datagram& dg = in->datagram();
+  switch(dg.seq.service()) {
+  case TransitionId::Configure:
+    for(unsigned i=0; i<_nkernels; i++)
+      _kernel[i]->clear();
+    _configure = true;
+    break;
+  case TransitionId::L1Accept:
+    _configure = false;
+    break;
+  default:
+    return in;
+  }
+  //  Results are appended at the end of the datagram, beyond the
+  //  extent being iterated
+  _in = in;
+  iterate(&dg.xtc);
+  return in;
+}
+
+int ChannelFexApp::process(Xtc* xtc)
+{
+  if (xtc->contains.id()==TypeId::Id_Xtc) {
+    iterate(xtc);
+    return 1;
+  }
+
+  uint32_t type = xtc->contains.value();
+  for(unsigned i=0; i<_nkernels; i++) {
+    if (_configure) {
+      if (type == _configType[i])
+        _kernel[i]->configure(*xtc);
+    }
+    else if (type == _dataType[i]) {
+      if (xtc->sizeofPayload()) {
+        unsigned extent = _kernel[i]->process(*xtc, _buffer);
+        if (extent) {
+          const Xtc& tc = *reinterpret_cast<const Xtc*>(_buffer);
+          _in->insert(tc, tc.payload());
+        }
+      }
+      break;
+    }
+  }
+  return 1;
+}
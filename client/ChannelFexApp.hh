@@ -0,0 +1,48 @@
+#ifndef Pds_ChannelFexApp_hh
+#define Pds_ChannelFexApp_hh
+
+//
+//  Segment level appliance that runs the ChannelFex kernels of a node's
+//  devices.  Each kernel takes the configurations of its devices from the
+//  Configure datagram, so the appliance must follow the device managers'
+//  appliances.  Each event is iterated once; every contribution whose type
+//  has a kernel gets its result appended to the datagram.  The results are
+//  built in one preallocated buffer, so there is no allocation per event.
+//
+
+#include "pds/utility/Appliance.hh"
+#include "pdsdata/xtc/XtcIterator.hh"
+
+#include <stdint.h>
+
+namespace Pds {
+
+  class ChannelFexBase;
+
+  class ChannelFexApp : public Appliance,
+                        private XtcIterator {
+  public:
+    ChannelFexApp();
+    ~ChannelFexApp();
+  public:
+    //  Takes ownership of the kernel; returns 0 on success
+    int         add        (ChannelFexBase*);
+  public:
+    Transition* transitions(Transition*);
+    InDatagram* events     (InDatagram*);
+  private:
+    int         process    (Xtc*);
+  private:
+    enum { MaxKernels = 8 };
+    unsigned        _nkernels;
+    ChannelFexBase* _kernel    [MaxKernels];
+    uint32_t        _dataType  [MaxKernels];
+    uint32_t        _configType[MaxKernels];
+    char*           _buffer;
+    unsigned        _bufferSize;
+    InDatagram*     _in;
+    bool            _configure;
+  };
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include "pds/xtc/InDatagram.hh"
 #include "pds/xtc/CDatagramIterator.hh"
 #include "pds/client/XtcIterator.hh"
+#include "pds/client/XtcIndex.hh"
 #include "pds/service/GenericPool.hh"
 
 namespace Pds {
@@ -56,6 +57,38 @@ DamageBrowser::DamageBrowser(const InDatagram& dg)
   iter.iterate();
 }
 
+//
+//  A container's damage not carried by any of its children is attributed
+//  to the container's source.  The children of node i are the following
+//  nodes one level deeper, up to the next node at its level or above.
+//
+DamageBrowser::DamageBrowser(const XtcIndex& index, unsigned dgram)
+{
+  const XtcIndex::Node* nodes = index.nodes(dgram);
+  unsigned nnodes = index.dgram(dgram).nnodes;
+  for(unsigned i=0; i<nnodes; i++) {
+    const XtcIndex::Node& node = nodes[i];
+    if (TypeId::Type(node.contains&0xffff) != TypeId::Id_Xtc)
+      continue;
+    unsigned children = 0;
+    for(unsigned j=i+1; j<nnodes && nodes[j].depth > node.depth; j++)
+      if (nodes[j].depth == node.depth+1)
+        children |= nodes[j].damage;
+    unsigned damage = node.damage & ~children;
+    if (damage) {
+      bool lFound=false;
+      for(std::list<Xtc>::iterator it=_damaged.begin(); it!=_damaged.end(); it++)
+        if (it->src == node.src()) {
+          lFound = true;
+          break;
+        }
+      if (!lFound)
+        _damaged.push_back(Xtc(TypeId(TypeId::Id_Xtc,(node.contains>>16)&0x7fff),
+                               node.src(),damage));
+    }
+  }
+}
+
 DamageBrowser::~DamageBrowser()
 {
 }
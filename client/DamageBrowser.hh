@@ -7,9 +7,12 @@
 
 namespace Pds {
   class InDatagram;
+  class XtcIndex;
   class DamageBrowser {
   public:
     DamageBrowser(const InDatagram& dg);
+    //  The same summary from a browse index entry, without the data
+    DamageBrowser(const XtcIndex& index, unsigned dgram);
     ~DamageBrowser();
   public:
     const std::list<Xtc>& damaged() const;
@@ -28,7 +28,7 @@
 #include "pds/vmon/VmonServerManager.hh"
 #include "pds/mon/MonCds.hh"
 #include "pds/mon/MonGroup.hh"
-#include "pds/mon/MonEntryTH1F.hh"
+#include "pds/mon/MonShardedTH1F.hh"
 #include "pds/mon/MonDescTH1F.hh"
 
 #include <time.h>
@@ -220,10 +220,10 @@ static const double ms_per_bin = 64./64.;
 static const double rat_per_bin = 1.28/64.;
 static const double evt_per_bin = 1.;
 
-static MonEntryTH1F* _mon_entry_th1f( const char* name )
+static MonShardedTH1F* _mon_entry_th1f( const char* name )
 {
   MonDescTH1F desc(name,"[events]","", 32, 0., double(32)*evt_per_bin);
-  return new MonEntryTH1F(desc);
+  return new MonShardedTH1F(desc);
 }
 
 FrameCompApp::FrameCompApp(size_t max_size, unsigned nthreads) :
@@ -235,13 +235,13 @@ FrameCompApp::FrameCompApp(size_t max_size, unsigned nthreads) :
   VmonServerManager::instance()->cds().add(group);
 
   MonDescTH1F start_to_complete("Start to Complete","[ms]", "", nbins, 0., double(nbins)*ms_per_bin);
-  _start_to_complete = new MonEntryTH1F(start_to_complete);
+  _start_to_complete = new MonShardedTH1F(start_to_complete);
 
   MonDescTH1F start_to_post("Start to Post","[ms]", "", nbins, 0., double(nbins)*ms_per_bin);
-  _start_to_post = new MonEntryTH1F(start_to_post);
+  _start_to_post = new MonShardedTH1F(start_to_post);
 
   MonDescTH1F compress_ratio("Compr Ratio","[fraction]", "", nbins, 0., double(nbins)*rat_per_bin);
-  _compress_ratio = new MonEntryTH1F(compress_ratio);
+  _compress_ratio = new MonShardedTH1F(compress_ratio);
 
   _queued   =_mon_entry_th1f("Queued");
   _assigned =_mon_entry_th1f("Assigned");
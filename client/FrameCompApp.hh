@@ -13,7 +13,7 @@
 #include <vector>
 
 namespace Pds {
-  class MonEntryTH1F;
+  class MonShardedTH1F;
   class Task;
 
   namespace FCA { class Entry; class Task; class Timer; }
@@ -43,12 +43,12 @@ namespace Pds {
     std::list<FCA::Entry*>  _list;
     std::vector<FCA::Task*> _tasks;
     FCA::Timer*             _timer;
-    MonEntryTH1F* _start_to_complete;
-    MonEntryTH1F* _start_to_post;
-    MonEntryTH1F* _compress_ratio;
-    MonEntryTH1F* _queued;
-    MonEntryTH1F* _assigned;
-    MonEntryTH1F* _completed;
+    MonShardedTH1F* _start_to_complete;
+    MonShardedTH1F* _start_to_post;
+    MonShardedTH1F* _compress_ratio;
+    MonShardedTH1F* _queued;
+    MonShardedTH1F* _assigned;
+    MonShardedTH1F* _completed;
   };
 };
 
@@ -0,0 +1,56 @@
+#ifndef Pds_RunSummary_hh
+#define Pds_RunSummary_hh
+
+//
+//  Per-run totals of the event builder output, broken down by
+//  contribution (Src, TypeId).  Recorded as a TypeId::Any xtc in the
+//  EndRun datagram by RunSummaryApp.  The per-source values are stored as
+//  columns of "nsources" entries following the header:
+//
+//    uint64_t bytes  [n]               xtc extents
+//    uint32_t log    [n]               Src
+//    uint32_t phy    [n]
+//    uint32_t type   [n]               TypeId value
+//    uint32_t count  [n]               contributions
+//    uint32_t damaged[n]               contributions with any damage
+//    uint32_t damage [DamageBits][n]   contributions with each damage bit
+//
+
+#include <stdint.h>
+
+namespace Pds {
+
+  class RunSummary {
+  public:
+    enum { Version = 1 };
+    enum { DamageBits = 32, IntervalBins = 32 };
+  public:
+    uint32_t nsources;
+    uint32_t nunlisted;      // contributions from sources beyond the table
+    uint64_t events;
+    uint64_t damagedEvents;
+    uint64_t bytes;
+    uint64_t intervalMin;    // ns between consecutive events
+    uint64_t intervalMax;
+    uint64_t intervalSum;
+    uint32_t intervals[IntervalBins];  // bin i counts [2^i,2^(i+1)) us; bin 0 includes < 1 us
+  public:
+    const uint64_t* srcBytes  () const { return reinterpret_cast<const uint64_t*>(this+1); }
+    const uint32_t* srcLog    () const { return reinterpret_cast<const uint32_t*>(srcBytes()+nsources); }
+    const uint32_t* srcPhy    () const { return srcLog    ()+nsources; }
+    const uint32_t* srcType   () const { return srcPhy    ()+nsources; }
+    const uint32_t* srcCount  () const { return srcType   ()+nsources; }
+    const uint32_t* srcDamaged() const { return srcCount  ()+nsources; }
+    const uint32_t* srcDamage (unsigned bit) const { return srcDamaged()+nsources*(1+bit); }
+    uint64_t*       srcBytes  () { return reinterpret_cast<uint64_t*>(this+1); }
+    uint32_t*       srcLog    () { return reinterpret_cast<uint32_t*>(srcBytes()+nsources); }
+    uint32_t*       srcPhy    () { return srcLog    ()+nsources; }
+    uint32_t*       srcType   () { return srcPhy    ()+nsources; }
+    uint32_t*       srcCount  () { return srcType   ()+nsources; }
+    uint32_t*       srcDamaged() { return srcCount  ()+nsources; }
+    uint32_t*       srcDamage (unsigned bit) { return srcDamaged()+nsources*(1+bit); }
+    unsigned        _sizeof   () const { return sizeof(*this)+nsources*(sizeof(uint64_t)+(5+DamageBits)*sizeof(uint32_t)); }
+  };
+};
+
+#endif
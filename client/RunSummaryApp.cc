@@ -0,0 +1,197 @@
+#include "pds/client/RunSummaryApp.hh"
+
+#include "pds/xtc/InDatagram.hh"
+#include "pdsdata/xtc/TypeId.hh"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace Pds;
+
+static Pds::TypeId _runSummaryType(Pds::TypeId::Any, RunSummary::Version);
+
+static inline unsigned _hashOf(uint32_t log, uint32_t phy, uint32_t type)
+{
+  uint32_t h = log*0x9e3779b1U ^ phy*0x85ebca6bU ^ type*0xc2b2ae35U;
+  return h ^ (h>>16);
+}
+
+RunSummaryApp::RunSummaryApp(const Src& src) :
+  _src(src)
+{
+  _reset();
+}
+
+RunSummaryApp::~RunSummaryApp()
+{
+}
+
+Transition* RunSummaryApp::transitions(Transition* tr)
+{
+  return tr;
+}
+
+InDatagram* RunSummaryApp::events(InDatagram* in)
+{
+  Datagram& dg = in->datagram();
+  switch(dg.seq.service()) {
+  case TransitionId::L1Accept:
+    { _events++;
+      _bytes += dg.xtc.extent;
+      if (dg.xtc.damage.value())
+        _damagedEvents++;
+
+      const ClockTime& clk = dg.seq.clock();
+      if (!_last.isZero()) {
+        int64_t dt = (int64_t(clk.seconds())-int64_t(_last.seconds()))*1000000000LL +
+          int64_t(clk.nanoseconds())-int64_t(_last.nanoseconds());
+        if (dt >= 0) {
+          uint64_t udt = dt;
+          if (udt < _intervalMin) _intervalMin = udt;
+          if (udt > _intervalMax) _intervalMax = udt;
+          _intervalSum += udt;
+          uint64_t us = udt/1000;
+          unsigned b = us ? 63-__builtin_clzll(us) : 0;
+          _intervals[b < RunSummary::IntervalBins ? b : RunSummary::IntervalBins-1]++;
+        }
+      }
+      _last = clk;
+      iterate(&dg.xtc);
+    } break;
+  case TransitionId::BeginRun:
+    _reset();
+    break;
+  case TransitionId::EndRun:
+    _flush(in);
+    _dump();
+    break;
+  default:
+    break;
+  }
+  return in;
+}
+
+int RunSummaryApp::process(Xtc* xtc)
+{
+  if (xtc->contains.id()!=TypeId::Id_Xtc)
+    _add(*xtc);
+  else if (xtc->sizeofPayload()==0)
+    _add(*xtc);
+  else
+    iterate(xtc);
+  return 1;
+}
+
+void RunSummaryApp::_add(const Xtc& xtc)
+{
+  uint32_t log  = xtc.src.log();
+  uint32_t phy  = xtc.src.phy();
+  uint32_t type = xtc.contains.value();
+
+  unsigned h = _hashOf(log,phy,type);
+  unsigned row;
+  while(1) {
+    h &= HashSize-1;
+    row = _hash[h];
+    if (row==0) {
+      if (_nsources==MaxSources) {
+        _nunlisted++;
+        return;
+      }
+      row = _nsources++;
+      _hash[h]    = row+1;
+      _srcLog [row] = log;
+      _srcPhy [row] = phy;
+      _srcType[row] = type;
+      break;
+    }
+    row--;
+    if (_srcLog[row]==log && _srcPhy[row]==phy && _srcType[row]==type)
+      break;
+    h++;
+  }
+
+  _srcCount[row]++;
+  _srcBytes[row] += xtc.extent;
+
+  uint32_t damage = xtc.damage.value();
+  if (damage) {
+    _srcDamaged[row]++;
+    while(damage) {
+      unsigned b = __builtin_ctz(damage);
+      _srcDamage[b][row]++;
+      damage &= damage-1;
+    }
+  }
+}
+
+void RunSummaryApp::_reset()
+{
+  _nsources      = 0;
+  _nunlisted     = 0;
+  _events        = 0;
+  _damagedEvents = 0;
+  _bytes         = 0;
+  _intervalMin   = -1ULL;
+  _intervalMax   = 0;
+  _intervalSum   = 0;
+  _last          = ClockTime();
+  memset(_intervals , 0, sizeof(_intervals));
+  memset(_hash      , 0, sizeof(_hash));
+  memset(_srcBytes  , 0, sizeof(_srcBytes));
+  memset(_srcCount  , 0, sizeof(_srcCount));
+  memset(_srcDamaged, 0, sizeof(_srcDamaged));
+  memset(_srcDamage , 0, sizeof(_srcDamage));
+}
+
+void RunSummaryApp::_flush(InDatagram* in)
+{
+  RunSummary h;
+  h.nsources = _nsources;
+
+  char* buff = new char[h._sizeof()];
+  RunSummary& s = *reinterpret_cast<RunSummary*>(buff);
+  s.nsources      = _nsources;
+  s.nunlisted     = _nunlisted;
+  s.events        = _events;
+  s.damagedEvents = _damagedEvents;
+  s.bytes         = _bytes;
+  s.intervalMin   = _events > 1 ? _intervalMin : 0;
+  s.intervalMax   = _intervalMax;
+  s.intervalSum   = _intervalSum;
+  memcpy(s.intervals   , _intervals , sizeof(_intervals));
+  memcpy(s.srcBytes  (), _srcBytes  , _nsources*sizeof(uint64_t));
+  memcpy(s.srcLog    (), _srcLog    , _nsources*sizeof(uint32_t));
+  memcpy(s.srcPhy    (), _srcPhy    , _nsources*sizeof(uint32_t));
+  memcpy(s.srcType   (), _srcType   , _nsources*sizeof(uint32_t));
+  memcpy(s.srcCount  (), _srcCount  , _nsources*sizeof(uint32_t));
+  memcpy(s.srcDamaged(), _srcDamaged, _nsources*sizeof(uint32_t));
+  for(unsigned i=0; i<RunSummary::DamageBits; i++)
+    memcpy(s.srcDamage(i), _srcDamage[i], _nsources*sizeof(uint32_t));
+
+  Xtc xtc(_runSummaryType, _src);
+  xtc.extent = sizeof(Xtc)+s._sizeof();
+  in->insert(xtc, buff);
+  delete[] buff;
+}
+
+void RunSummaryApp::_dump() const
+{
+  printf("RunSummaryApp: %llu events, %llu damaged, %.3f GB",
+         (unsigned long long)_events, (unsigned long long)_damagedEvents,
+         double(_bytes)*1.e-9);
+  if (_events > 1)
+    printf("; interval %.3f/%.3f/%.3f ms min/mean/max",
+           double(_intervalMin)*1.e-6,
+           double(_intervalSum)*1.e-6/double(_events-1),
+           double(_intervalMax)*1.e-6);
+  printf("\n");
+  for(unsigned i=0; i<_nsources; i++)
+    if (_srcDamaged[i])
+      printf("  %08x.%08x %s_v%u : %u of %u damaged\n",
+             _srcLog[i], _srcPhy[i],
+             TypeId::name(TypeId::Type(_srcType[i]&0xffff)), (_srcType[i]>>16)&0x7fff,
+             _srcDamaged[i], _srcCount[i]);
+  if (_nunlisted)
+    printf("  %u contributions beyond %u sources\n", _nunlisted, unsigned(MaxSources));
+}
@@ -0,0 +1,62 @@
+#ifndef Pds_RunSummaryApp_hh
+#define Pds_RunSummaryApp_hh
+
+//
+//  Event level appliance that accumulates the RunSummary of each run:
+//  per-(Src, TypeId) contribution counts, bytes and damage bits, and the
+//  event arrival intervals.  The tables are fixed size and the per-event
+//  cost is one hash probe per contribution.  The totals are reset at
+//  BeginRun and recorded in the EndRun datagram.  The offline side,
+//  OfflineClient::reportSourceTotals, is not yet fed from it.
+//
+//  An empty segment container, as the event builder inserts for a
+//  missing contribution, is counted as a contribution of the segment.
+//
+
+#include "pds/utility/Appliance.hh"
+#include "pds/client/RunSummary.hh"
+#include "pdsdata/xtc/XtcIterator.hh"
+#include "pdsdata/xtc/ClockTime.hh"
+#include "pdsdata/xtc/Src.hh"
+
+namespace Pds {
+
+  class RunSummaryApp : public Appliance,
+                        private XtcIterator {
+  public:
+    RunSummaryApp(const Src&);
+    ~RunSummaryApp();
+  public:
+    Transition* transitions(Transition*);
+    InDatagram* events     (InDatagram*);
+  private:
+    int         process    (Xtc*);
+    void        _add       (const Xtc&);
+    void        _reset     ();
+    void        _flush     (InDatagram*);
+    void        _dump      () const;
+  private:
+    enum { MaxSources = 256, HashSize = 1024 };
+    Src       _src;
+    unsigned  _nsources;
+    unsigned  _nunlisted;
+    uint64_t  _events;
+    uint64_t  _damagedEvents;
+    uint64_t  _bytes;
+    uint64_t  _intervalMin;
+    uint64_t  _intervalMax;
+    uint64_t  _intervalSum;
+    uint32_t  _intervals[RunSummary::IntervalBins];
+    ClockTime _last;
+    uint16_t  _hash     [HashSize];  // row+1
+    uint64_t  _srcBytes [MaxSources];
+    uint32_t  _srcLog   [MaxSources];
+    uint32_t  _srcPhy   [MaxSources];
+    uint32_t  _srcType  [MaxSources];
+    uint32_t  _srcCount [MaxSources];
+    uint32_t  _srcDamaged[MaxSources];
+    uint32_t  _srcDamage[RunSummary::DamageBits][MaxSources];
+  };
+};
+
+#endif
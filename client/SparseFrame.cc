@@ -0,0 +1,157 @@
+#include "pds/client/SparseFrame.hh"
+
+#include "pdsdata/xtc/Xtc.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace Pds;
+
+static Pds::TypeId _sparseFrameType(Pds::TypeId::Any, SparseFrameHeader::Version);
+
+static inline unsigned _pad(unsigned sz) { return (sz+3)&~3; }
+
+SparseFrame::SparseFrame() :
+  _npixels (0),
+  _adcMask (0xffff),
+  _pedestal(0),
+  _gain    (0),
+  _level   (0),
+  _hits    (0)
+{
+}
+
+SparseFrame::~SparseFrame()
+{
+  delete[] _pedestal;
+  delete[] _gain;
+  delete[] _level;
+  delete[] _hits;
+}
+
+int SparseFrame::configure(const SparseMaps& maps, unsigned npixels)
+{
+  if (maps.npixels != npixels) {
+    printf("*** SparseFrame maps are for %u pixels, frame has %u\n", maps.npixels, npixels);
+    return -1;
+  }
+
+  if (npixels != _npixels) {
+    delete[] _pedestal;
+    delete[] _gain;
+    delete[] _level;
+    delete[] _hits;
+    _npixels  = npixels;
+    _pedestal = new float   [npixels];
+    _gain     = new float   [npixels];
+    _level    = new uint16_t[npixels];
+    _hits     = new uint32_t[npixels];
+  }
+  _adcMask = maps.adcMask;
+
+  memcpy(_pedestal, maps.pedestal(), npixels*sizeof(float));
+  memcpy(_gain    , maps.gain    (), npixels*sizeof(float));
+
+  //  The ADC value must exceed the level; masked pixels never do
+  const uint16_t* thr = maps.threshold();
+  unsigned nmasked = 0;
+  for(unsigned i=0; i<npixels; i++) {
+    double l = ceil(_pedestal[i]) + thr[i];
+    if (_gain[i]==0 || !(l < _adcMask)) {
+      _level[i] = 0xffff;
+      nmasked++;
+    }
+    else
+      _level[i] = l < 0 ? 0 : uint16_t(l);
+  }
+  printf("SparseFrame configured %u pixels, %u masked, adc mask 0x%x, dense prescale %u\n",
+         npixels, nmasked, _adcMask, maps.densePrescale);
+  return 0;
+}
+
+unsigned SparseFrame::scan(const uint16_t* frame, const uint16_t* level, unsigned n,
+                           uint16_t adcMask, uint32_t* hits, unsigned maxhits)
+{
+  unsigned nhits = 0;
+  unsigned i = 0;
+#ifdef __SSE2__
+  const __m128i zero  = _mm_setzero_si128();
+  const __m128i vadc  = _mm_set1_epi16(short(adcMask));
+  const __m128i vgain = _mm_set1_epi16(short(~adcMask));
+  for(; i+8<=n; i+=8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame+i));
+    __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(level+i));
+    //  adc > level  <=>  adc -sat level != 0
+    __m128i k = _mm_or_si128(_mm_subs_epu16(_mm_and_si128(v,vadc),l),
+                             _mm_and_si128(v,vgain));
+    unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi16(k,zero)) ^ 0xffff;
+    while(m) {
+      unsigned b = __builtin_ctz(m);
+      if (nhits == maxhits)
+        return maxhits+1;
+      hits[nhits++] = i + (b>>1);
+      m &= ~(3U<<b);
+    }
+  }
+#endif
+  for(; i<n; i++)
+    if ((frame[i]&adcMask) > level[i] || (frame[i]&~adcMask)) {
+      if (nhits == maxhits)
+        return maxhits+1;
+      hits[nhits++] = i;
+    }
+  return nhits;
+}
+
+unsigned SparseFrame::process(const Xtc& in, const uint16_t* frame, char* out, unsigned maxsize)
+{
+  const char* p   = in.payload();
+  const char* f   = reinterpret_cast<const char*>(frame);
+  unsigned    fsz = _npixels*sizeof(uint16_t);
+  if (f < p || f+fsz > p+in.sizeofPayload())
+    return 0;
+  unsigned hsz = f - p;
+  unsigned tsz = in.sizeofPayload() - hsz - fsz;
+
+  unsigned fixed = sizeof(Xtc) + sizeof(SparseFrameHeader) + _pad(hsz) + _pad(tsz);
+  if (fixed >= maxsize)
+    return 0;
+  unsigned maxhits = (maxsize - fixed)/sizeof(SparsePixel);
+  unsigned nhits   = scan(frame, _level, _npixels, _adcMask, _hits, maxhits);
+  if (nhits > maxhits)
+    return 0;
+
+  Xtc* xtc = new (out) Xtc(_sparseFrameType, in.src, in.damage);
+  SparseFrameHeader* h = reinterpret_cast<SparseFrameHeader*>(xtc->alloc(sizeof(SparseFrameHeader)));
+  h->npixels     = _npixels;
+  h->nhits       = nhits;
+  h->headerSize  = hsz;
+  h->trailerSize = tsz;
+
+  char* b = reinterpret_cast<char*>(xtc->alloc(_pad(hsz)));
+  memcpy(b, p, hsz);
+  memset(b+hsz, 0, _pad(hsz)-hsz);
+  b = reinterpret_cast<char*>(xtc->alloc(_pad(tsz)));
+  memcpy(b, f+fsz, tsz);
+  memset(b+tsz, 0, _pad(tsz)-tsz);
+
+  SparsePixel* px = reinterpret_cast<SparsePixel*>(xtc->alloc(nhits*sizeof(SparsePixel)));
+  for(unsigned i=0; i<nhits; i++) {
+    unsigned j = _hits[i];
+    uint16_t v = frame[j];
+    if (v & ~_adcMask) {
+      px[i].index = j | SparsePixel::SwitchedGain;
+      px[i].value = v;
+    }
+    else {
+      px[i].index = j;
+      px[i].value = (float(v)-_pedestal[j])*_gain[j];
+    }
+  }
+  return xtc->extent;
+}
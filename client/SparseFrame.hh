@@ -0,0 +1,93 @@
+#ifndef Pds_SparseFrame_hh
+#define Pds_SparseFrame_hh
+
+//
+//  Zero suppression of dense 16-bit detector frames.
+//
+//  A pixel is kept when its ADC bits exceed its pedestal plus threshold,
+//  or when any of the bits outside the ADC mask are set (a switched gain
+//  stage).  The frame is compared eight pixels at a time against a
+//  precomputed per-pixel level; only kept pixels are calibrated.
+//
+//  The sparse xtc (TypeId::Any until a pdsdata type is assigned) keeps
+//  the dense element's header and trailer verbatim:
+//
+//    [ SparseFrameHeader | header (padded) | trailer (padded) | SparsePixel x nhits ]
+//
+
+#include <stdint.h>
+
+namespace Pds {
+
+  class Xtc;
+
+  //
+  //  Per-pixel maps, fetched with the configuration
+  //
+  class SparseMaps {
+  public:
+    enum { Version = 1 };
+  public:
+    uint32_t npixels;
+    uint32_t adcMask;        // bits of the ADC value
+    uint32_t densePrescale;  // record the dense frame of one event in N; 0 never
+    uint32_t reserved;
+    //  float    pedestal [npixels];   ADC counts
+    //  float    gain     [npixels];   calibrated units per ADC count; 0 masks the pixel
+    //  uint16_t threshold[npixels];   ADC counts above the pedestal
+  public:
+    const float*    pedestal () const { return reinterpret_cast<const float*>(this+1); }
+    const float*    gain     () const { return pedestal()+npixels; }
+    const uint16_t* threshold() const { return reinterpret_cast<const uint16_t*>(gain()+npixels); }
+    unsigned        _sizeof  () const { return sizeof(*this)+npixels*(2*sizeof(float)+sizeof(uint16_t))+(npixels&1)*sizeof(uint16_t); }
+  };
+
+  class SparsePixel {
+  public:
+    enum { SwitchedGain = 1U<<31 };  // index flag: value is the raw pixel
+  public:
+    uint32_t index;
+    float    value;
+  };
+
+  class SparseFrameHeader {
+  public:
+    enum { Version = 1 };
+  public:
+    uint32_t npixels;      // of the dense frame
+    uint32_t nhits;
+    uint32_t headerSize;   // bytes of the dense element before the frame
+    uint32_t trailerSize;  // bytes after it
+  };
+
+  class SparseFrame {
+  public:
+    SparseFrame();
+    ~SparseFrame();
+  public:
+    //  Returns 0 if the maps match a frame of "npixels"
+    int      configure(const SparseMaps&, unsigned npixels);
+    //
+    //  Writes the sparse form of the dense element xtc "in", whose frame
+    //  is at "frame", as an xtc at "out" and returns its extent.  Returns
+    //  0 if it would exceed "maxsize" bytes.
+    //
+    unsigned process  (const Xtc& in, const uint16_t* frame, char* out, unsigned maxsize);
+  public:
+    //
+    //  Writes the indices of the kept pixels to "hits".  Returns the
+    //  number kept, or maxhits+1 once there are more than "maxhits".
+    //
+    static unsigned scan(const uint16_t* frame, const uint16_t* level, unsigned n,
+                         uint16_t adcMask, uint32_t* hits, unsigned maxhits);
+  private:
+    unsigned  _npixels;
+    uint16_t  _adcMask;
+    float*    _pedestal;
+    float*    _gain;
+    uint16_t* _level;
+    uint32_t* _hits;
+  };
+};
+
+#endif
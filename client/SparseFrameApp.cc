@@ -0,0 +1,167 @@
+#include "pds/client/SparseFrameApp.hh"
+
+#include "pds/config/CfgCache.hh"
+#include "pds/utility/Transition.hh"
+#include "pds/xtc/InDatagram.hh"
+#include "pdsdata/xtc/XtcIterator.hh"
+
+#include <stdio.h>
+
+using namespace Pds;
+
+static Pds::TypeId _sparseMapsType(Pds::TypeId::Any, SparseMaps::Version);
+
+namespace Pds {
+  class SparseMapCache : public CfgCache {
+  public:
+    SparseMapCache(const Src& src, unsigned maxPixels) :
+      CfgCache(src, _sparseMapsType, __size(maxPixels)) {}
+  private:
+    int _size(void* p) const { return reinterpret_cast<const SparseMaps*>(p)->_sizeof(); }
+    static int __size(unsigned n) {
+      SparseMaps m;
+      m.npixels = n;
+      return m._sizeof();
+    }
+  };
+
+  //
+  //  Finds the first undamaged xtc of a type
+  //
+  class SparseFrameFinder : public XtcIterator {
+  public:
+    SparseFrameFinder(Xtc* root, const TypeId& type) :
+      XtcIterator(root), _type(type), _found(0) {}
+  public:
+    Xtc* find() { iterate(); return _found; }
+    int  process(Xtc* xtc) {
+      if (xtc->contains.id()==TypeId::Id_Xtc)
+        iterate(xtc);
+      else if (xtc->contains.value()==_type.value() && xtc->damage.value()==0)
+        _found = xtc;
+      return _found==0;
+    }
+  private:
+    TypeId _type;
+    Xtc*   _found;
+  };
+};
+
+SparseFrameApp::SparseFrameApp(const Src& src, Layout* layout, unsigned maxPixels) :
+  _layout     (layout),
+  _maps       (new SparseMapCache(src, maxPixels)),
+  _maxPixels  (maxPixels),
+  _mapsValid  (false),
+  _transform  (maxPixels*sizeof(uint16_t)+0x10000),
+  _configured (false),
+  _prescale   (0),
+  _nevents    (0),
+  _ndense     (0),
+  _nsparse    (0),
+  _densebytes (0),
+  _sparsebytes(0)
+{
+  _transform.add(_layout->dataType().id(), XtcTransform::Compress, this);
+}
+
+SparseFrameApp::~SparseFrameApp()
+{
+  delete _maps;
+  delete _layout;
+}
+
+Transition* SparseFrameApp::transitions(Transition* tr)
+{
+  switch(tr->id()) {
+  case TransitionId::Map:
+    _maps->init(reinterpret_cast<const Allocate&>(*tr).allocation());
+    break;
+  case TransitionId::Configure:
+    { _mapsValid = false;
+      int len = _maps->fetch(tr);
+      const SparseMaps* maps = reinterpret_cast<const SparseMaps*>(_maps->current());
+      if (len <= 0)
+        printf("SparseFrameApp found no pixel maps; frames will be recorded dense\n");
+      else if (unsigned(len) < sizeof(SparseMaps))
+        printf("*** SparseFrameApp pixel maps are %d bytes; frames will be recorded dense\n", len);
+      else if (maps->npixels > _maxPixels)
+        printf("*** SparseFrameApp pixel maps are for %u pixels, more than %u; frames will be recorded dense\n",
+               maps->npixels, _maxPixels);
+      else if (unsigned(len) < maps->_sizeof())
+        printf("*** SparseFrameApp pixel maps are %d bytes, %u pixels need %u; frames will be recorded dense\n",
+               len, maps->npixels, maps->_sizeof());
+      else
+        _mapsValid = true;
+    } break;
+  default:
+    break;
+  }
+  return tr;
+}
+
+InDatagram* SparseFrameApp::events(InDatagram* in)
+{
+  Datagram& dg = in->datagram();
+  switch(dg.seq.service()) {
+  case TransitionId::Configure:
+    _configured = false;
+    if (_mapsValid) {
+      Xtc* xtc = SparseFrameFinder(&dg.xtc, _layout->configType()).find();
+      if (!xtc) {
+        printf("SparseFrameApp found no detector configuration\n");
+        break;
+      }
+      const SparseMaps& maps = *reinterpret_cast<const SparseMaps*>(_maps->current());
+      if (_sparse.configure(maps, _layout->configure(xtc->payload())))
+        break;
+      _prescale   = maps.densePrescale;
+      _configured = true;
+      _nevents = _ndense = _nsparse = 0;
+      _densebytes = _sparsebytes = 0;
+    }
+    break;
+  case TransitionId::Unconfigure:
+    if (_configured)
+      _dump();
+    _configured = false;
+    break;
+  case TransitionId::L1Accept:
+    if (_configured) {
+      if (_prescale && (_nevents++ % _prescale)==0)
+        _ndense++;
+      else
+        _transform.apply(dg.xtc);
+    }
+    break;
+  default:
+    break;
+  }
+  return in;
+}
+
+//
+//  Called by the transform for each frame; the result is only used when
+//  it is smaller than the dense frame.
+//
+unsigned SparseFrameApp::replace(const Xtc& in, Xtc* out, unsigned maxsize)
+{
+  if (in.contains.value()!=_layout->dataType().value() || in.damage.value())
+    return 0;
+  unsigned extent = _sparse.process(in, _layout->frame(in), reinterpret_cast<char*>(out), maxsize);
+  _densebytes += in.extent;
+  if (extent && extent < in.extent) {
+    _sparsebytes += extent;
+    _nsparse++;
+  }
+  else {
+    _sparsebytes += in.extent;
+    _ndense++;
+  }
+  return extent;
+}
+
+void SparseFrameApp::_dump() const
+{
+  printf("SparseFrameApp: %u frames sparse, %u dense; %.3f -> %.3f MB\n",
+         _nsparse, _ndense, double(_densebytes)*1.e-6, double(_sparsebytes)*1.e-6);
+}
@@ -0,0 +1,66 @@
+#ifndef Pds_SparseFrameApp_hh
+#define Pds_SparseFrameApp_hh
+
+//
+//  Segment level appliance that replaces a detector's dense 16-bit frames
+//  with their zero-suppressed form (see SparseFrame).  The per-pixel maps
+//  are fetched from the configuration database with the device's source
+//  as a TypeId::Any blob at Configure, like the device configuration; they
+//  are not recorded.  The dense frame is kept on one event in
+//  "densePrescale", and whenever the sparse form would not be smaller.
+//
+//  The detector specific parts are supplied by a Layout, which must
+//  follow the device manager's appliance so that the device configuration
+//  is in the Configure datagram.
+//
+
+#include "pds/utility/Appliance.hh"
+#include "pds/client/SparseFrame.hh"
+#include "pds/client/XtcTransform.hh"
+#include "pdsdata/xtc/TypeId.hh"
+#include "pdsdata/xtc/Src.hh"
+
+namespace Pds {
+
+  class SparseMapCache;
+
+  class SparseFrameApp : public Appliance,
+                         private XtcTransform::Callback {
+  public:
+    class Layout {
+    public:
+      virtual ~Layout() {}
+    public:
+      virtual TypeId          configType() const = 0;
+      virtual TypeId          dataType  () const = 0;
+      //  Takes a copy of the device configuration and returns the pixels per frame
+      virtual unsigned        configure (const void*) = 0;
+      virtual const uint16_t* frame     (const Xtc&) const = 0;
+    };
+  public:
+    SparseFrameApp(const Src&, Layout*, unsigned maxPixels);
+    ~SparseFrameApp();
+  public:
+    Transition* transitions(Transition*);
+    InDatagram* events     (InDatagram*);
+  private:
+    unsigned    replace    (const Xtc&, Xtc*, unsigned);
+    void        _dump      () const;
+  private:
+    Layout*         _layout;
+    SparseMapCache* _maps;
+    unsigned        _maxPixels;
+    bool            _mapsValid;
+    SparseFrame     _sparse;
+    XtcTransform    _transform;
+    bool            _configured;
+    unsigned        _prescale;
+    unsigned        _nevents;
+    unsigned        _ndense;
+    unsigned        _nsparse;
+    uint64_t        _densebytes;
+    uint64_t        _sparsebytes;
+  };
+};
+
+#endif
@@ -11,7 +11,7 @@
 #include "pds/vmon/VmonServerManager.hh"
 #include "pds/mon/MonCds.hh"
 #include "pds/mon/MonGroup.hh"
-#include "pds/mon/MonEntryTH1F.hh"
+#include "pds/mon/MonShardedTH1F.hh"
 #include "pds/mon/MonDescTH1F.hh"
 
 #include <math.h>
@@ -137,23 +137,23 @@ namespace Pds {
         VmonServerManager::instance()->cds().add(group);
         
         MonDescTH1F start_to_complete("Start to Complete","[ms]", "", nbins, 0., double(nbins)*ms_per_bin);
-        _start_to_complete = new MonEntryTH1F(start_to_complete);
+        _start_to_complete = new MonShardedTH1F(start_to_complete);
         group->add(_start_to_complete);
 
         MonDescTH1F queued("Queued"      ,"[events]","", 32, -0.5, 31.5);
-        _queued    = new MonEntryTH1F(queued);
+        _queued    = new MonShardedTH1F(queued);
         group->add(_queued);
 
         MonDescTH1F assigned("Assigned"  ,"[events]","", 32, -0.5, 31.5);
-        _assigned  = new MonEntryTH1F(assigned);
+        _assigned  = new MonShardedTH1F(assigned);
         group->add(_assigned);
 
         MonDescTH1F completed("Completed","[events]","", 32, -0.5, 31.5);
-        _completed = new MonEntryTH1F(completed);
+        _completed = new MonShardedTH1F(completed);
         group->add(_completed);
 
         MonDescTH1F worker("Worker","[thread]","", 16, -1.5, 14.5);
-        _worker = new MonEntryTH1F(worker);
+        _worker = new MonShardedTH1F(worker);
         group->add(_worker);
       }
       ~Manager() {
@@ -318,11 +318,11 @@ namespace Pds {
       Semaphore                 _sem;
       bool                      _handled;
       std::list  <Work::Entry*> _list;
-      MonEntryTH1F*             _start_to_complete;
-      MonEntryTH1F*             _queued;
-      MonEntryTH1F*             _assigned;
-      MonEntryTH1F*             _completed;
-      MonEntryTH1F*             _worker;
+      MonShardedTH1F*             _start_to_complete;
+      MonShardedTH1F*             _queued;
+      MonShardedTH1F*             _assigned;
+      MonShardedTH1F*             _completed;
+      MonShardedTH1F*             _worker;
     };
   };
 };
@@ -0,0 +1,239 @@
+#include "pds/client/XtcIndex.hh"
+
+#include "pdsdata/xtc/Dgram.hh"
+#include "pdsdata/xtc/Xtc.hh"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+using namespace Pds;
+
+static const unsigned MaxDgramSize = 0x10000000;
+
+namespace Pds {
+  //
+  //  Records every xtc beneath a datagram, depth first
+  //
+  class XtcIndexScanner {
+  public:
+    XtcIndexScanner(FILE* f) : _f(f), _nnodes(0), _corrupt(0) {}
+  public:
+    void scan(const Xtc& root, unsigned depth) {
+      int remaining = root.sizeofPayload();
+      const Xtc* xtc = reinterpret_cast<const Xtc*>(root.payload());
+      while(remaining > 0) {
+        if (xtc->extent < sizeof(Xtc) || int(xtc->extent) > remaining) {
+          _corrupt++;
+          break;
+        }
+        XtcIndex::Node node;
+        node.log      = xtc->src.log();
+        node.phy      = xtc->src.phy();
+        node.contains = xtc->contains.value();
+        node.extent   = xtc->extent;
+        node.damage   = xtc->damage.value();
+        node.depth    = depth;
+        fwrite(&node, sizeof(node), 1, _f);
+        _nnodes++;
+
+        if (xtc->contains.id()==TypeId::Id_Xtc &&
+            !(xtc->damage.value() & (1<<Damage::IncompleteContribution)))
+          scan(*xtc, depth+1);
+
+        remaining -= xtc->extent;
+        xtc = reinterpret_cast<const Xtc*>(reinterpret_cast<const char*>(xtc)+xtc->extent);
+      }
+    }
+  public:
+    unsigned nnodes () const { return _nnodes; }
+    unsigned corrupt() const { return _corrupt; }
+  private:
+    FILE*    _f;
+    unsigned _nnodes;
+    unsigned _corrupt;
+  };
+};
+
+XtcIndex::XtcIndex() :
+  _header(0),
+  _dgrams(0),
+  _nodes (0),
+  _map   (0),
+  _size  (0)
+{
+}
+
+XtcIndex::~XtcIndex()
+{
+  close();
+}
+
+int XtcIndex::build(const char* path, const char* ipath)
+{
+  FILE* in = fopen(path, "r");
+  if (!in) {
+    printf("*** XtcIndex::build failed to open %s : %s\n", path, strerror(errno));
+    return -1;
+  }
+  FILE* out = fopen(ipath, "w");
+  if (!out) {
+    printf("*** XtcIndex::build failed to open %s : %s\n", ipath, strerror(errno));
+    fclose(in);
+    return -1;
+  }
+
+  Header header;
+  header.magic    = Magic;
+  header.version  = Version;
+  header.ndgrams  = 0;
+  header.nnodes   = 0;
+  header.filesize = 0;
+  fwrite(&header, sizeof(header), 1, out);
+
+  std::vector<Dgram> dgrams;
+  XtcIndexScanner scanner(out);
+  unsigned bufsize = 0x100000;
+  char*    buffer  = new char[bufsize];
+  uint64_t offset  = 0;
+  int      result  = 0;
+
+  while(1) {
+    Pds::Dgram* dg = reinterpret_cast<Pds::Dgram*>(buffer);
+    if (fread(dg, sizeof(Pds::Dgram), 1, in) != 1)
+      break;
+
+    unsigned payloadSize = dg->xtc.sizeofPayload();
+    if (dg->xtc.extent < sizeof(Xtc) || payloadSize > MaxDgramSize) {
+      printf("*** XtcIndex::build corrupt datagram at offset 0x%llx (extent 0x%x)\n",
+             (unsigned long long)offset, dg->xtc.extent);
+      result = -1;
+      break;
+    }
+    if (sizeof(Pds::Dgram)+payloadSize > bufsize) {
+      bufsize = sizeof(Pds::Dgram)+payloadSize;
+      char* b = new char[bufsize];
+      memcpy(b, buffer, sizeof(Pds::Dgram));
+      delete[] buffer;
+      buffer = b;
+      dg = reinterpret_cast<Pds::Dgram*>(buffer);
+    }
+    if (payloadSize && fread(dg->xtc.payload(), payloadSize, 1, in) != 1) {
+      printf("XtcIndex::build truncated datagram at offset 0x%llx\n",
+             (unsigned long long)offset);
+      break;
+    }
+
+    Dgram d;
+    d.offset      = offset;
+    d.service     = dg->seq.service();
+    d.fiducials   = dg->seq.stamp().fiducials();
+    d.seconds     = dg->seq.clock().seconds();
+    d.nanoseconds = dg->seq.clock().nanoseconds();
+    d.damage      = dg->xtc.damage.value();
+    d.extent      = dg->xtc.extent;
+    d.first       = scanner.nnodes();
+    scanner.scan(dg->xtc, 1);  // contributions are intact when the event is incomplete
+    d.nnodes      = scanner.nnodes() - d.first;
+    dgrams.push_back(d);
+
+    offset += sizeof(Pds::Dgram)+payloadSize;
+  }
+
+  if (!dgrams.empty())
+    fwrite(&dgrams[0], sizeof(Dgram), dgrams.size(), out);
+
+  header.ndgrams  = dgrams.size();
+  header.nnodes   = scanner.nnodes();
+  header.filesize = offset;
+  fseek(out, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, out);
+
+  if (ferror(out)) {
+    printf("*** XtcIndex::build error writing %s\n", ipath);
+    result = -1;
+  }
+  if (scanner.corrupt())
+    printf("XtcIndex::build %u corrupt xtc extents in %s\n", scanner.corrupt(), path);
+
+  delete[] buffer;
+  fclose(out);
+  fclose(in);
+  return result;
+}
+
+int XtcIndex::open(const char* ipath)
+{
+  close();
+
+  int fd = ::open(ipath, O_RDONLY);
+  if (fd < 0) {
+    printf("*** XtcIndex::open failed to open %s : %s\n", ipath, strerror(errno));
+    return -1;
+  }
+
+  struct stat s;
+  if (fstat(fd, &s) < 0 || size_t(s.st_size) < sizeof(Header)) {
+    printf("*** XtcIndex::open %s is too small\n", ipath);
+    ::close(fd);
+    return -1;
+  }
+
+  void* p = mmap(0, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) {
+    printf("*** XtcIndex::open failed to map %s : %s\n", ipath, strerror(errno));
+    return -1;
+  }
+
+  const Header* h = reinterpret_cast<const Header*>(p);
+  size_t size = sizeof(Header) + h->nnodes*sizeof(Node) + h->ndgrams*sizeof(Dgram);
+  if (h->magic != Magic || h->version != Version || size_t(s.st_size) != size) {
+    printf("*** XtcIndex::open %s is not a valid index\n", ipath);
+    munmap(p, s.st_size);
+    return -1;
+  }
+
+  _map    = p;
+  _size   = s.st_size;
+  _header = h;
+  _nodes  = reinterpret_cast<const Node *>(h+1);
+  _dgrams = reinterpret_cast<const Dgram*>(_nodes+h->nnodes);
+  return 0;
+}
+
+void XtcIndex::close()
+{
+  if (_map) {
+    munmap(_map, _size);
+    _map    = 0;
+    _header = 0;
+    _dgrams = 0;
+    _nodes  = 0;
+  }
+}
+
+void XtcIndex::find(const Src& src, uint32_t mask, std::vector<unsigned>& result) const
+{
+  bool anySrc = (src.log()==0 && src.phy()==0);
+  for(unsigned i=0; i<ndgrams(); i++) {
+    const Dgram& d = _dgrams[i];
+    if (anySrc && (d.damage & mask)) {
+      result.push_back(i);
+      continue;
+    }
+    const Node* n   = nodes(i);
+    const Node* end = n + d.nnodes;
+    for(; n<end; n++)
+      if ((n->damage & mask) &&
+          (anySrc || ((n->log>>24)==(src.log()>>24) && n->phy==src.phy()))) {
+        result.push_back(i);
+        break;
+      }
+  }
+}
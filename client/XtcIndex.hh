@@ -0,0 +1,93 @@
+#ifndef Pds_XtcIndex_hh
+#define Pds_XtcIndex_hh
+
+//
+//  Browse index of a recorded XTC file.
+//
+//  The index is a sidecar file (by convention <file>.idx) holding, for each
+//  datagram, its file offset, transition, timestamp and damage, and the
+//  (Src, TypeId, extent, damage) of every xtc beneath it in depth-first
+//  order.  All records are fixed size and laid out as
+//
+//    [ Header | Node x nnodes | Dgram x ndgrams ]
+//
+//  so the reader simply maps the file.  Nodes are streamed to the index as
+//  the file is scanned; only the datagram records are held until the end.
+//  Containers damaged with IncompleteContribution are recorded but not
+//  descended.
+//
+
+#include "pdsdata/xtc/Src.hh"
+
+#include <stdint.h>
+#include <vector>
+
+namespace Pds {
+
+  class Xtc;
+
+  class XtcIndex {
+  public:
+    enum { Magic = 0x58494458 };  // 'XIDX'
+    enum { Version = 1 };
+    class Header {
+    public:
+      uint32_t magic;
+      uint32_t version;
+      uint32_t ndgrams;
+      uint32_t nnodes;
+      uint64_t filesize;   // size of the indexed file
+    };
+    class Dgram {
+    public:
+      uint64_t offset;     // file offset of the datagram
+      uint32_t service;    // TransitionId::Value
+      uint32_t fiducials;
+      uint32_t seconds;
+      uint32_t nanoseconds;
+      uint32_t damage;
+      uint32_t extent;
+      uint32_t first;      // index of its first node
+      uint32_t nnodes;
+    };
+    class Node {
+    public:
+      uint32_t log;        // Src
+      uint32_t phy;
+      uint32_t contains;   // TypeId value
+      uint32_t extent;
+      uint32_t damage;
+      uint32_t depth;      // 1 = child of the datagram xtc
+    public:
+      Src      src() const { return Src(log,phy); }
+    };
+  public:
+    XtcIndex();
+    ~XtcIndex();
+  public:
+    //  Scans the xtc file "path" and writes its index to "ipath"
+    static int build(const char* path, const char* ipath);
+  public:
+    //  Maps an index; returns 0 on success
+    int  open (const char* ipath);
+    void close();
+  public:
+    unsigned     ndgrams() const { return _header ? _header->ndgrams : 0; }
+    const Dgram& dgram  (unsigned i) const { return _dgrams[i]; }
+    const Node*  nodes  (unsigned i) const { return _nodes + _dgrams[i].first; }
+  public:
+    //  Datagrams in which some xtc from "src" carries any of the damage bits
+    //  in "mask" (all datagrams with damage in "mask" if src is zero).
+    //  Sources are matched by level and physical id; the process id is
+    //  ignored.
+    void find(const Src& src, uint32_t mask, std::vector<unsigned>& result) const;
+  private:
+    const Header* _header;
+    const Dgram*  _dgrams;
+    const Node*   _nodes;
+    void*         _map;
+    size_t        _size;
+  };
+};
+
+#endif
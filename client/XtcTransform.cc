@@ -0,0 +1,155 @@
+#include "pds/client/XtcTransform.hh"
+
+#include "pdsdata/xtc/Xtc.hh"
+
+#include <string.h>
+
+using namespace Pds;
+
+XtcTransform::XtcTransform(unsigned maxsize) :
+  _maxsize (maxsize),
+  _scratch (maxsize ? new char[maxsize] : 0),
+  _pwrite  (0),
+  _pread   (0),
+  _plen    (0),
+  _dropped (0),
+  _replaced(0),
+  _corrupt (0)
+{
+}
+
+XtcTransform::~XtcTransform()
+{
+  if (_scratch) delete[] _scratch;
+}
+
+void XtcTransform::add(TypeId::Type type, Action action, Callback* cb)
+{
+  _rules.push_back(Rule(0, int(type), action, cb));
+}
+
+void XtcTransform::add(const Src& src, TypeId::Type type, Action action, Callback* cb)
+{
+  _rules.push_back(Rule(&src, int(type), action, cb));
+}
+
+void XtcTransform::add(const Src& src, Action action, Callback* cb)
+{
+  _rules.push_back(Rule(&src, -1, action, cb));
+}
+
+void XtcTransform::clear()
+{
+  _rules.clear();
+}
+
+unsigned XtcTransform::apply(Xtc& root)
+{
+  if (root.damage.value() & (1<<Damage::IncompleteContribution))
+    return root.extent;
+
+  _pwrite = reinterpret_cast<char*>(&root);
+  _pread  = _pwrite;
+  _plen   = 0;
+  _iterate(&root);
+  _flush();
+  return root.extent;
+}
+
+const XtcTransform::Rule* XtcTransform::_match(const Xtc& xtc) const
+{
+  for(std::vector<Rule>::const_iterator it=_rules.begin(); it!=_rules.end(); it++)
+    if ((it->type < 0 || it->type == int(xtc.contains.id())) &&
+        (it->anySrc   || it->src  == xtc.src))
+      return &(*it);
+  return 0;
+}
+
+//
+//  The container's header is appended to the pending run and its
+//  children are processed.  The new extent is written where the header
+//  now lives: at its destination if the run has since been moved, or
+//  still in place within the pending run otherwise.
+//
+void XtcTransform::_iterate(Xtc* root)
+{
+  char* hdr = _position();
+  _keep(reinterpret_cast<const char*>(root), sizeof(Xtc));
+
+  int  remaining = root->sizeofPayload();
+  Xtc* xtc       = reinterpret_cast<Xtc*>(root->payload());
+
+  while(remaining > 0) {
+    unsigned extent = xtc->extent;
+    if (extent < sizeof(Xtc) || int(extent) > remaining) {
+      _corrupt++;  // keep the remainder untouched
+      _keep(reinterpret_cast<const char*>(xtc), remaining);
+      break;
+    }
+
+    const Rule* rule = _match(*xtc);
+    if (!rule) {
+      if (xtc->contains.id()==TypeId::Id_Xtc &&
+          !(xtc->damage.value() & (1<<Damage::IncompleteContribution)))
+        _iterate(xtc);
+      else
+        _keep(reinterpret_cast<const char*>(xtc), extent);
+    }
+    else {
+      switch(rule->action) {
+      case Drop:
+        _dropped++;
+        break;
+      case Replace:
+      case Compress:
+        { unsigned n = 0;
+          if (rule->callback && _scratch)
+            n = rule->callback->replace(*xtc, reinterpret_cast<Xtc*>(_scratch),
+                                        extent < _maxsize ? extent : _maxsize);
+          if (n==0 || n>extent || (rule->action==Compress && n==extent))
+            _keep(reinterpret_cast<const char*>(xtc), extent);
+          else {
+            _flush();
+            memcpy(_pwrite, _scratch, n);
+            _pwrite += n;
+            _replaced++;
+          }
+          break; }
+      case Keep:
+      default:
+        _keep(reinterpret_cast<const char*>(xtc), extent);
+        break;
+      }
+    }
+
+    remaining -= extent;
+    xtc        = reinterpret_cast<Xtc*>(reinterpret_cast<char*>(xtc)+extent);
+  }
+
+  unsigned newExtent = _position() - hdr;
+  if (hdr < _pwrite)
+    reinterpret_cast<Xtc*>(hdr)->extent = newExtent;
+  else
+    reinterpret_cast<Xtc*>(const_cast<char*>(_pread) + (hdr - _pwrite))->extent = newExtent;
+}
+
+void XtcTransform::_keep(const char* p, unsigned len)
+{
+  if (_plen && _pread + _plen == p)
+    _plen += len;
+  else {
+    _flush();
+    _pread = p;
+    _plen  = len;
+  }
+}
+
+void XtcTransform::_flush()
+{
+  if (_plen) {
+    if (_pwrite != _pread)
+      memmove(_pwrite, _pread, _plen);
+    _pwrite += _plen;
+    _plen    = 0;
+  }
+}
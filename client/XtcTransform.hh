@@ -0,0 +1,86 @@
+#ifndef Pds_XtcTransform_hh
+#define Pds_XtcTransform_hh
+
+//
+//  Single-pass, in-place rewrite of an XTC tree.
+//
+//  A list of actions is registered per TypeId and (optionally) Src.  The
+//  tree is traversed once; contiguous runs of kept xtcs are compacted with
+//  a single memmove and each container's extent is fixed up once, on the
+//  way back out.  The output never grows, so the rewrite is always done
+//  in place (write pointer <= read pointer).
+//
+//  Containers (Id_Xtc) are descended unless an action matches them.
+//  Containers damaged with IncompleteContribution are kept whole, as in
+//  FrameTrim and XtcStripper.
+//
+
+#include "pdsdata/xtc/TypeId.hh"
+#include "pdsdata/xtc/Src.hh"
+
+#include <stdint.h>
+#include <vector>
+
+namespace Pds {
+  class Xtc;
+
+  class XtcTransform {
+  public:
+    enum Action { Keep, Drop, Replace, Compress };
+    //
+    //  Writes the replacement for "in" at "out" (at most "maxsize" bytes)
+    //  and returns its extent, or returns 0 to keep the original.
+    //  A Replace result must not be larger than the original; a Compress
+    //  result is only used when it is strictly smaller.
+    //
+    class Callback {
+    public:
+      virtual ~Callback() {}
+      virtual unsigned replace(const Xtc& in, Xtc* out, unsigned maxsize) = 0;
+    };
+  public:
+    XtcTransform(unsigned maxsize=0);
+    ~XtcTransform();
+  public:
+    void add  (TypeId::Type, Action, Callback* =0);
+    void add  (const Src&, TypeId::Type, Action, Callback* =0);
+    void add  (const Src&, Action, Callback* =0);
+    void clear();
+  public:
+    //  Rewrites the tree beneath (and including) root; returns the new extent
+    unsigned apply(Xtc& root);
+  public:
+    unsigned dropped () const { return _dropped; }
+    unsigned replaced() const { return _replaced; }
+    unsigned corrupt () const { return _corrupt; }
+  private:
+    class Rule {
+    public:
+      Rule(const Src* s, int t, Action a, Callback* c) :
+        src(s ? *s : Src()), anySrc(s==0), type(t), action(a), callback(c) {}
+    public:
+      Src       src;
+      bool      anySrc;
+      int       type;     // -1 matches any type
+      Action    action;
+      Callback* callback;
+    };
+    const Rule* _match  (const Xtc&) const;
+    void        _iterate(Xtc*);
+    void        _keep   (const char*, unsigned);
+    void        _flush  ();
+    char*       _position() const { return _pwrite + _plen; }
+  private:
+    std::vector<Rule> _rules;
+    unsigned  _maxsize;
+    char*     _scratch;
+    char*     _pwrite;    // compacted output end
+    const char* _pread;   // start of pending (not yet moved) run
+    unsigned  _plen;      // length of pending run
+    unsigned  _dropped;
+    unsigned  _replaced;
+    unsigned  _corrupt;
+  };
+};
+
+#endif
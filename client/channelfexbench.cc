@@ -0,0 +1,200 @@
+//
+//  channelfexbench - single thread throughput of the ChannelFex kernels,
+//  and a check that the UsdUsb kernel reproduces the former UsdUsb::Fex
+//  arithmetic bit for bit.
+//
+//    channelfexbench [-d <devices>] [-n <events>] [-t <seconds>]
+//
+//  Each event has one contribution from each of <devices> USDUSB4,
+//  PCI-3E and 16AI32SSC devices, with random configurations and data.
+//
+#include "pds/client/ChannelFex.hh"
+#include "pds/usdusb/FexKernel.hh"
+#include "pds/encoder/EncoderFexKernel.hh"
+#include "pds/gsc16ai/Gsc16aiFexKernel.hh"
+
+#include "pdsdata/xtc/DetInfo.hh"
+
+#include <vector>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+using namespace Pds;
+
+static double now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return double(ts.tv_sec)+1.e-9*double(ts.tv_nsec);
+}
+
+static void randomize(void* p, unsigned size)
+{
+  unsigned char* b = reinterpret_cast<unsigned char*>(p);
+  for(unsigned i=0; i<size; i++)
+    b[i] = lrand48();
+}
+
+static DetInfo _src(DetInfo::Device dev, unsigned i)
+{
+  return DetInfo(0, DetInfo::XppEndstation, 0, dev, i);
+}
+
+//
+//  Appends an xtc of "type" from "src" with "size" random bytes
+//
+static Xtc* _contribution(std::vector<char>& buf, const TypeId& type, const Src& src, unsigned size)
+{
+  unsigned off = buf.size();
+  buf.resize(off+sizeof(Xtc)+size);
+  Xtc* xtc = new (&buf[off]) Xtc(type, src);
+  xtc->extent += size;
+  randomize(xtc->payload(), size);
+  return xtc;
+}
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [-d <devices>] [-n <events>] [-t <seconds>]\n"
+         "Options:\n"
+         "\t-d <n>         devices of each type [2]\n"
+         "\t-n <events>    events [10000]\n"
+         "\t-t <seconds>   minimum run time [2]\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned ndev    = 2;
+  unsigned nevents = 10000;
+  double   tmin    = 2;
+
+  int c;
+  while ((c = getopt(argc, argv, "d:n:t:h")) != -1) {
+    switch(c) {
+    case 'd': ndev    = strtoul(optarg,NULL,0); break;
+    case 'n': nevents = strtoul(optarg,NULL,0); break;
+    case 't': tmin    = strtod (optarg,NULL); break;
+    case 'h':
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  ChannelFex<UsdUsb::FexKernel>* usdusb  = new ChannelFex<UsdUsb::FexKernel>;
+  ChannelFex<EncoderFexKernel>*  encoder = new ChannelFex<EncoderFexKernel>;
+  ChannelFex<Gsc16aiFexKernel>*  gsc16ai = new ChannelFex<Gsc16aiFexKernel>;
+  if (encoder->settings("scale=1.e-4:offset=0,100,-100") ||
+      gsc16ai->settings("scale=2:offset=0.5"))
+    return 1;
+
+  ChannelFexBase* kernels[] = { usdusb, encoder, gsc16ai };
+  const unsigned nkernels = sizeof(kernels)/sizeof(kernels[0]);
+
+  srand48(1);
+
+  //  Configure
+  std::vector<UsdUsbFexConfigType> usdusbConfig(ndev);
+  for(unsigned d=0; d<ndev; d++) {
+    randomize(&usdusbConfig[d], sizeof(UsdUsbFexConfigType));
+    { int32_t* offset = const_cast<int32_t*>(usdusbConfig[d].offset().data());
+      for(unsigned i=0; i<UsdUsb::FexConfigV1::NCHANNELS; i++)
+        offset[i] >>= 1; }
+    usdusb->configure(_src(DetInfo::USDUSB, d), usdusbConfig[d]);
+
+    EncoderConfigType ecfg;
+    randomize(&ecfg, sizeof(ecfg));
+    encoder->configure(_src(DetInfo::Encoder, d), ecfg);
+
+    Gsc16aiConfigType gcfg;
+    randomize(&gcfg, sizeof(gcfg));
+    gsc16ai->configure(_src(DetInfo::Gsc16ai, d), gcfg);
+  }
+
+  //  Events
+  std::vector<char> buf;
+  std::vector<unsigned> offsets;
+  for(unsigned e=0; e<nevents; e++)
+    for(unsigned d=0; d<ndev; d++) {
+      offsets.push_back(buf.size());
+      { Xtc* xtc = _contribution(buf, _usdusbDataType , _src(DetInfo::USDUSB , d), sizeof(UsdUsbDataType));
+        //  Counts within 31 bits, so that adding the offset cannot overflow
+        int32_t* count = const_cast<int32_t*>(reinterpret_cast<const UsdUsbDataType*>(xtc->payload())->encoder_count().data());
+        for(unsigned i=0; i<UsdUsb::FexConfigV1::NCHANNELS; i++)
+          count[i] >>= 1; }
+      offsets.push_back(buf.size());
+      _contribution(buf, _encoderDataType, _src(DetInfo::Encoder, d), sizeof(EncoderDataType));
+      offsets.push_back(buf.size());
+      _contribution(buf, _gsc16aiDataType, _src(DetInfo::Gsc16ai, d), sizeof(Gsc16aiDataType)+
+                    Gsc16aiFexKernel::NChannels*sizeof(uint16_t));
+    }
+
+  uint32_t dataType[nkernels];
+  unsigned maxSize = 0;
+  for(unsigned k=0; k<nkernels; k++) {
+    dataType[k] = kernels[k]->dataType().value();
+    if (kernels[k]->maxSize() > maxSize)
+      maxSize = kernels[k]->maxSize();
+  }
+  char* out = new char[maxSize];
+
+  //  Compare with the former UsdUsb::Fex arithmetic
+  unsigned nbad = 0;
+  for(unsigned i=0; i<offsets.size(); i++) {
+    const Xtc* xtc = reinterpret_cast<const Xtc*>(&buf[offsets[i]]);
+    if (xtc->contains.value() != _usdusbDataType.value())
+      continue;
+    if (!usdusb->process(*xtc, out)) {
+      printf("*** no result for contribution %u\n", i);
+      nbad++;
+      continue;
+    }
+    const UsdUsbFexConfigType& cfg = usdusbConfig[static_cast<const DetInfo&>(xtc->src).devId()];
+    const UsdUsbDataType* data = reinterpret_cast<const UsdUsbDataType*>(xtc->payload());
+    const ndarray<const int32_t, 1> encoder_count = data->encoder_count();
+    const ndarray<const int32_t, 1> offset = cfg.offset();
+    const ndarray<const double, 1> scale   = cfg.scale();
+    double fex_values[UsdUsb::FexConfigV1::NCHANNELS];
+    for(int j=0; j<UsdUsb::FexConfigV1::NCHANNELS; j++)
+      fex_values[j] = scale[j] * (encoder_count[j] + offset[j]);
+    UsdUsbFexDataType usdusb_fex(fex_values);
+    if (memcmp(&usdusb_fex, reinterpret_cast<const Xtc*>(out)->payload(), sizeof(usdusb_fex))) {
+      if (nbad < 10)
+        printf("*** UsdUsb result differs for contribution %u\n", i);
+      nbad++;
+    }
+  }
+
+  //  Throughput, dispatching by type as ChannelFexApp does
+  double   t0, t1;
+  unsigned passes = 0;
+  uint64_t nbytes = 0;
+  t0 = now();
+  do {
+    for(unsigned i=0; i<offsets.size(); i++) {
+      const Xtc* xtc = reinterpret_cast<const Xtc*>(&buf[offsets[i]]);
+      uint32_t type = xtc->contains.value();
+      for(unsigned k=0; k<nkernels; k++)
+        if (type == dataType[k]) {
+          nbytes += kernels[k]->process(*xtc, out);
+          break;
+        }
+    }
+    passes++;
+  } while((t1=now())-t0 < tmin);
+
+  double dt = t1-t0;
+  uint64_t ncontrib = uint64_t(passes)*offsets.size();
+  printf("%u passes, %llu contributions, %.3f MB of results in %.3f s : %.1f ns/contribution\n",
+         passes, (unsigned long long)ncontrib, double(nbytes)*1.e-6, dt,
+         dt/double(ncontrib)*1.e9);
+  printf("%u UsdUsb results differ\n", nbad);
+
+  delete[] out;
+  for(unsigned k=0; k<nkernels; k++)
+    delete kernels[k];
+  return nbad ? 1 : 0;
+}
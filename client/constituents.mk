@@ -1,5 +1,5 @@
 libnames := client
-libsrcs_client := $(filter-out FrameCompApp.cc l3ftest.cc,$(wildcard *.cc))
+libsrcs_client := $(filter-out FrameCompApp.cc l3ftest.cc xtctransformtest.cc xtcindex.cc channelfexbench.cc runsummarytest.cc sparseframetest.cc,$(wildcard *.cc))
 libincs_client := pdsdata/include ndarray/include boost/include 
 
 libnames += clientcompress
@@ -11,4 +11,37 @@ tgtsrcs_l3ftest := l3ftest.cc
 tgtlibs_l3ftest := pdsdata/xtcdata pdsdata/appdata pdsdata/psddl_pdsdata
 tgtlibs_l3ftest += pds/client pds/utility pds/service pds/collection pds/vmon pds/mon pds/xtc
 tgtslib_l3ftest := $(USRLIBDIR)/rt $(USRLIBDIR)/dl
-tgtincs_l3ftest := pdsdata/include
\ No newline at end of file
+tgtincs_l3ftest := pdsdata/include
+
+tgtnames += xtctransformtest
+tgtsrcs_xtctransformtest := xtctransformtest.cc
+tgtlibs_xtctransformtest := pdsdata/xtcdata
+tgtlibs_xtctransformtest += pds/client pds/utility pds/service pds/xtc
+tgtslib_xtctransformtest := $(USRLIBDIR)/rt
+tgtincs_xtctransformtest := pdsdata/include
+
+tgtnames += xtcindex
+tgtsrcs_xtcindex := xtcindex.cc
+tgtlibs_xtcindex := pdsdata/xtcdata
+tgtlibs_xtcindex += pds/client pds/utility pds/service pds/xtc
+tgtincs_xtcindex := pdsdata/include
+
+tgtnames += channelfexbench
+tgtsrcs_channelfexbench := channelfexbench.cc ChannelFex.cc
+tgtlibs_channelfexbench := pdsdata/xtcdata pdsdata/psddl_pdsdata
+tgtslib_channelfexbench := $(USRLIBDIR)/rt
+tgtincs_channelfexbench := pdsdata/include ndarray/include boost/include
+
+tgtnames += runsummarytest
+tgtsrcs_runsummarytest := runsummarytest.cc
+tgtlibs_runsummarytest := pdsdata/xtcdata
+tgtlibs_runsummarytest += pds/client pds/utility pds/service pds/xtc
+tgtslib_runsummarytest := $(USRLIBDIR)/rt
+tgtincs_runsummarytest := pdsdata/include
+
+tgtnames += sparseframetest
+tgtsrcs_sparseframetest := sparseframetest.cc
+tgtlibs_sparseframetest := pdsdata/xtcdata
+tgtlibs_sparseframetest += pds/client
+tgtslib_sparseframetest := $(USRLIBDIR)/rt
+tgtincs_sparseframetest := pdsdata/include
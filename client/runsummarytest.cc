@@ -0,0 +1,290 @@
+//
+//  runsummarytest - feeds RunSummaryApp a run of built events and checks
+//  the EndRun RunSummary against totals kept here.  Each event holds more
+//  (Src, TypeId) contributions than the table has rows, in two segment
+//  containers whose order alternates, so that
+//    - the rows are found through the hash probe whatever the order in
+//      which the sources arrive, and pairs of contributions from the same
+//      Src with different types get separate rows,
+//    - the sources beyond the table are counted in nunlisted,
+//    - an empty segment container counts as a contribution of the segment,
+//  and that the columns sit where RunSummary.hh lays them out.  A second
+//  run checks that BeginRun resets the totals.
+//
+//    runsummarytest [-e <events>]
+//
+#include "pds/client/RunSummaryApp.hh"
+#include "pds/client/RunSummary.hh"
+#include "pds/xtc/CDatagram.hh"
+#include "pds/service/GenericPool.hh"
+
+#include "pdsdata/xtc/DetInfo.hh"
+#include "pdsdata/xtc/ProcInfo.hh"
+#include "pdsdata/xtc/TypeId.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <map>
+#include <vector>
+
+using namespace Pds;
+
+static const unsigned MaxSources = 256;   // as RunSummaryApp
+static const unsigned NSources   = 300;   // leaf sources per event
+
+//
+//  The totals expected of each (Src, TypeId), in order of arrival
+//
+class Reference {
+public:
+  Reference() : nunlisted(0) {}
+public:
+  void add(const Xtc& xtc) {
+    Key k(xtc.src.log(), xtc.src.phy(), xtc.contains.value());
+    std::map<Key,unsigned>::iterator it = _rows.find(k);
+    unsigned row;
+    if (it == _rows.end()) {
+      if (_rows.size()==MaxSources) { nunlisted++; return; }
+      row = _rows.size();
+      _rows[k] = row;
+      rows.push_back(Row(k));
+    }
+    else
+      row = it->second;
+    Row& r = rows[row];
+    r.count++;
+    r.bytes += xtc.extent;
+    uint32_t damage = xtc.damage.value();
+    if (damage) {
+      r.damaged++;
+      for(unsigned b=0; b<RunSummary::DamageBits; b++)
+        if (damage & (1U<<b)) r.damage[b]++;
+    }
+  }
+public:
+  class Key {
+  public:
+    Key(uint32_t l, uint32_t p, uint32_t t) : log(l), phy(p), type(t) {}
+    bool operator<(const Key& o) const {
+      if (log !=o.log ) return log <o.log;
+      if (phy !=o.phy ) return phy <o.phy;
+      return type<o.type;
+    }
+    uint32_t log, phy, type;
+  };
+  class Row {
+  public:
+    Row(const Key& k) : key(k), count(0), damaged(0), bytes(0)
+    { memset(damage, 0, sizeof(damage)); }
+    Key      key;
+    uint32_t count;
+    uint32_t damaged;
+    uint64_t bytes;
+    uint32_t damage[RunSummary::DamageBits];
+  };
+  std::vector<Row> rows;
+  unsigned         nunlisted;
+private:
+  std::map<Key,unsigned> _rows;
+};
+
+static unsigned _failed = 0;
+
+static void check(bool ok, const char* what)
+{
+  printf("%-64s %s\n", what, ok ? "ok" : "FAILED");
+  if (!ok) _failed++;
+}
+
+static CDatagram* _datagram(GenericPool& pool, TransitionId::Value id,
+                            const ClockTime& clk)
+{
+  CDatagram* dg = new(&pool) CDatagram(TypeId(TypeId::Id_Xtc,0),
+                                       ProcInfo(Level::Event,0,0));
+  dg->seq = Sequence(Sequence::Event, id, clk, TimeStamp(0,0,0));
+  return dg;
+}
+
+//
+//  Leaf sources "first" up to "last" in a segment container.  Sources come
+//  in pairs sharing a Src, one of each type.  Some are damaged in the
+//  events where "damaged" is set.
+//
+static void _segment(Datagram& dg, unsigned seg, unsigned first, unsigned last,
+                     bool damaged, Reference& ref)
+{
+  Xtc* s = new(&dg.xtc) Xtc(TypeId(TypeId::Id_Xtc,1), ProcInfo(Level::Segment,seg,0x0a000001));
+  for(unsigned i=first; i<last; i++) {
+    unsigned d = i/2;
+    TypeId type = (i&1) ? TypeId(TypeId::Id_IpmFex,1) : TypeId(TypeId::Id_IpimbData,1);
+    Damage damage(0);
+    //  Any bit but IncompleteContribution, which the iterator does not enter
+    if (damaged && (i%7)==3)
+      damage.increase(Damage::Value((i%24)==Damage::IncompleteContribution ? 0 : i%24));
+    Xtc* x = new(s) Xtc(type, DetInfo(0, DetInfo::XppEndstation, d>>8, DetInfo::Ipimb, d&0xff), damage);
+    unsigned sz = 4*(i%5);
+    memset(x->alloc(sz), 0, sz);
+    s->alloc(sz);
+    s->damage.increase(damage.value());
+    ref.add(*x);
+  }
+  dg.xtc.alloc(s->sizeofPayload());
+  dg.xtc.damage.increase(s->damage.value());
+}
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [-e <events>]\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned nevents = 10;
+
+  int c;
+  while ((c = getopt(argc, argv, "e:h")) != -1) {
+    switch (c) {
+    case 'e': nevents = strtoul(optarg, NULL, 0); break;
+    default : usage(argv[0]); return 1;
+    }
+  }
+  if (nevents < 2) {
+    printf("*** needs at least 2 events\n");
+    return 1;
+  }
+
+  GenericPool pool(sizeof(CDatagram)+0x10000, 2);
+  RunSummaryApp app(ProcInfo(Level::Event,0,0));
+  Reference ref;
+
+  delete app.events(_datagram(pool, TransitionId::BeginRun, ClockTime(1,0)));
+
+  uint64_t events=0, damagedEvents=0, bytes=0;
+  uint64_t intervalMin=-1ULL, intervalMax=0, intervalSum=0;
+  uint32_t intervals[RunSummary::IntervalBins];
+  memset(intervals, 0, sizeof(intervals));
+
+  unsigned s = 10, ns = 0;
+  for(unsigned e=0; e<nevents; e++) {
+    if (e) {
+      unsigned us = 1000U<<(e%4);   // 1, 2, 4 and 8 ms
+      ns += us*1000;
+      s  += ns/1000000000; ns %= 1000000000;
+      uint64_t dt = uint64_t(us)*1000;
+      if (dt < intervalMin) intervalMin = dt;
+      if (dt > intervalMax) intervalMax = dt;
+      intervalSum += dt;
+      intervals[9+(e%4)]++;
+    }
+    CDatagram* dg = _datagram(pool, TransitionId::L1Accept, ClockTime(s,ns));
+    //  A missing segment in the even events
+    if ((e&1)==0) {
+      Xtc* x = new(&dg->xtc) Xtc(TypeId(TypeId::Id_Xtc,1), ProcInfo(Level::Segment,9,0x0a000009));
+      x->damage.increase(Damage::DroppedContribution);
+      dg->xtc.damage.increase(x->damage.value());
+      ref.add(*x);
+    }
+    bool damaged = (e%3)==1;
+    if (e&1) {
+      _segment(*dg, 2, NSources/2, NSources  , damaged, ref);
+      _segment(*dg, 1, 0         , NSources/2, damaged, ref);
+    }
+    else {
+      _segment(*dg, 1, 0         , NSources/2, damaged, ref);
+      _segment(*dg, 2, NSources/2, NSources  , damaged, ref);
+    }
+    events++;
+    bytes += dg->xtc.extent;
+    if (dg->xtc.damage.value()) damagedEvents++;
+    delete app.events(dg);
+  }
+
+  CDatagram* dg = _datagram(pool, TransitionId::EndRun, ClockTime(s+1,0));
+  app.events(dg);
+
+  const Xtc* xtc = reinterpret_cast<const Xtc*>(dg->xtc.payload());
+  bool found = dg->xtc.sizeofPayload() > 0 &&
+    xtc->contains.value()==TypeId(TypeId::Any,RunSummary::Version).value();
+  check(found, "EndRun holds the RunSummary");
+  if (!found) {
+    printf("*** %u failures\n", _failed);
+    return 1;
+  }
+
+  const RunSummary& sum = *reinterpret_cast<const RunSummary*>(xtc->payload());
+  unsigned n = sum.nsources;
+  check(n==MaxSources && ref.rows.size()==MaxSources, "table fills to MaxSources");
+  check(sum.nunlisted==ref.nunlisted && ref.nunlisted!=0,
+        "contributions beyond the table counted in nunlisted");
+  check(unsigned(xtc->sizeofPayload())==sum._sizeof(), "xtc extent matches the RunSummary size");
+
+  //  The columns, as laid out in RunSummary.hh
+  const char* base = reinterpret_cast<const char*>(&sum);
+  unsigned off = sizeof(RunSummary);
+  bool layout = (sizeof(RunSummary)%sizeof(uint64_t))==0;
+  layout &= reinterpret_cast<const char*>(sum.srcBytes  ())==base+off; off += n*sizeof(uint64_t);
+  layout &= reinterpret_cast<const char*>(sum.srcLog    ())==base+off; off += n*sizeof(uint32_t);
+  layout &= reinterpret_cast<const char*>(sum.srcPhy    ())==base+off; off += n*sizeof(uint32_t);
+  layout &= reinterpret_cast<const char*>(sum.srcType   ())==base+off; off += n*sizeof(uint32_t);
+  layout &= reinterpret_cast<const char*>(sum.srcCount  ())==base+off; off += n*sizeof(uint32_t);
+  layout &= reinterpret_cast<const char*>(sum.srcDamaged())==base+off; off += n*sizeof(uint32_t);
+  for(unsigned b=0; b<RunSummary::DamageBits; b++) {
+    layout &= reinterpret_cast<const char*>(sum.srcDamage(b))==base+off;
+    off += n*sizeof(uint32_t);
+  }
+  layout &= off==sum._sizeof();
+  check(layout, "columns laid out in order, uint64 aligned");
+
+  //  Each row, in order of arrival
+  unsigned bad = 0;
+  for(unsigned i=0; i<n && i<ref.rows.size(); i++) {
+    const Reference::Row& r = ref.rows[i];
+    bool ok = (sum.srcLog()[i]==r.key.log && sum.srcPhy()[i]==r.key.phy &&
+               sum.srcType()[i]==r.key.type && sum.srcCount()[i]==r.count &&
+               sum.srcBytes()[i]==r.bytes && sum.srcDamaged()[i]==r.damaged);
+    for(unsigned b=0; b<RunSummary::DamageBits; b++)
+      ok &= sum.srcDamage(b)[i]==r.damage[b];
+    if (!ok) {
+      if (bad++ < 8)
+        printf("  row %u: %08x.%08x %08x count %u/%u bytes %llu/%llu damaged %u/%u\n",
+               i, sum.srcLog()[i], sum.srcPhy()[i], sum.srcType()[i],
+               sum.srcCount()[i], r.count,
+               (unsigned long long)sum.srcBytes()[i], (unsigned long long)r.bytes,
+               sum.srcDamaged()[i], r.damaged);
+    }
+  }
+  check(bad==0, "per-source counts, bytes and damage bits");
+  check(ref.rows[0].key.log==ProcInfo(Level::Segment,9,0x0a000009).log() &&
+        sum.srcCount()[0]==(nevents+1)/2 && sum.srcDamage(Damage::DroppedContribution)[0]==(nevents+1)/2,
+        "an empty segment container counts as a contribution");
+
+  check(sum.events==events && sum.damagedEvents==damagedEvents && sum.bytes==bytes,
+        "event, damaged event and byte totals");
+  bool iv = sum.intervalMin==intervalMin && sum.intervalMax==intervalMax &&
+    sum.intervalSum==intervalSum;
+  for(unsigned b=0; b<RunSummary::IntervalBins; b++)
+    iv &= sum.intervals[b]==intervals[b];
+  check(iv, "event intervals and their histogram");
+  delete dg;
+
+  //  A second run starts from zero
+  delete app.events(_datagram(pool, TransitionId::BeginRun, ClockTime(s+2,0)));
+  Reference ref2;
+  dg = _datagram(pool, TransitionId::L1Accept, ClockTime(s+3,0));
+  _segment(*dg, 1, 0, 4, false, ref2);
+  delete app.events(dg);
+  dg = _datagram(pool, TransitionId::EndRun, ClockTime(s+4,0));
+  app.events(dg);
+  xtc = reinterpret_cast<const Xtc*>(dg->xtc.payload());
+  const RunSummary& sum2 = *reinterpret_cast<const RunSummary*>(xtc->payload());
+  check(sum2.nsources==4 && sum2.nunlisted==0 && sum2.events==1 &&
+        sum2.intervalMin==0 && sum2.intervalSum==0 && sum2.srcCount()[0]==1,
+        "BeginRun resets the totals");
+  delete dg;
+
+  if (_failed)
+    printf("*** %u failures\n", _failed);
+  return _failed ? 1 : 0;
+}
@@ -0,0 +1,255 @@
+//
+//  sparseframetest - checks the zero suppression of SparseFrame against a
+//  dense reference, a plain loop over every pixel of the frame, for the
+//  frames of the Epix10k and Jungfrau layouts.  For each layout:
+//    - the pixels kept by scan, over the whole frame and over lengths and
+//      offsets which leave a tail of fewer than 8 pixels,
+//    - that scan stops once there are more than "maxhits" pixels,
+//    - the sparse xtc written by process: its header and trailer, and the
+//      index and value of each kept pixel.
+//  The frames have pixels near their level, switched gain stages, masked
+//  pixels and pixels whose level is beyond the ADC range.  The layouts'
+//  geometry and ADC masks are taken from their headers, since the layouts
+//  themselves need a detector configuration.
+//
+//    sparseframetest [-s <seed>]
+//
+#include "pds/client/SparseFrame.hh"
+
+#include "pdsdata/xtc/Xtc.hh"
+#include "pdsdata/xtc/DetInfo.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <vector>
+
+using namespace Pds;
+
+class TestLayout {
+public:
+  const char*     name;
+  DetInfo::Device device;
+  unsigned        npixels;
+  uint16_t        adcMask;
+  uint16_t        gainBits;     // the pixel word's gain stage
+  unsigned        headerSize;   // of the dense element, around the frame
+  unsigned        trailerSize;
+};
+
+static const TestLayout _layouts[] = {
+  //  Epix10kSparseLayout: rows*columns, one gain bit above the ADC
+  { "Epix10k" , DetInfo::Epix10k , 352*384     , 0x3fff, 0x4000, 48, 4 },
+  //  Jungfrau::SparseLayout: modules*rows*columns, two gain bits
+  { "Jungfrau", DetInfo::Jungfrau, 2*512*1024  , 0x3fff, 0xc000, 24, 0 },
+};
+
+static unsigned _failed = 0;
+
+static void check(bool ok, const char* what)
+{
+  printf("%-64s %s\n", what, ok ? "ok" : "FAILED");
+  if (!ok) _failed++;
+}
+
+static unsigned _random(unsigned& seed, unsigned n)
+{
+  return n ? unsigned(rand_r(&seed)) % n : 0;
+}
+
+//
+//  The maps, the frame and the reference for one layout
+//
+class TestFrame {
+public:
+  TestFrame(const TestLayout& l, unsigned& seed) :
+    layout(l),
+    _maps (l.npixels*(2*sizeof(float)+sizeof(uint16_t))/sizeof(uint32_t)+8),
+    level (l.npixels),
+    _elem (l.headerSize + l.npixels*sizeof(uint16_t) + l.trailerSize)
+  {
+    SparseMaps& m = maps();
+    m.npixels       = l.npixels;
+    m.adcMask       = l.adcMask;
+    m.densePrescale = 0;
+    m.reserved      = 0;
+    float*    ped = const_cast<float*   >(m.pedestal ());
+    float*    gn  = const_cast<float*   >(m.gain     ());
+    uint16_t* thr = const_cast<uint16_t*>(m.threshold());
+
+    for(unsigned i=0; i<l.npixels; i++) {
+      ped[i] = 1000 + _random(seed, 2000) + 0.01*_random(seed, 100);
+      gn [i] = _random(seed, 100) ? 0.5 + 0.01*_random(seed, 100) : 0;
+      thr[i] = _random(seed, 200);
+      if (_random(seed, 500)==0)     // beyond the ADC range: never kept by its ADC value
+        ped[i] = l.adcMask - _random(seed, 100);
+      //  As SparseFrame sets the level
+      double lv = ceil(ped[i]) + thr[i];
+      level[i] = (gn[i]==0 || !(lv < l.adcMask)) ? 0xffff : uint16_t(lv);
+    }
+
+    for(unsigned i=0; i<l.headerSize; i++)
+      _elem[i] = i;
+    for(unsigned i=0; i<l.trailerSize; i++)
+      _elem[l.headerSize+l.npixels*sizeof(uint16_t)+i] = ~i;
+
+    uint16_t* f = frame();
+    for(unsigned i=0; i<l.npixels; i++) {
+      unsigned v;
+      switch(_random(seed, 64)) {
+      case 0 : v = level[i] + 1 + _random(seed, 500); break;  // above its level
+      case 1 : v = level[i]; break;                          // at its level
+      case 2 : v = level[i] + 1; break;                      // just above
+      case 3 : v = _random(seed, 0x10000); break;            // anything, gain bits too
+      default: v = unsigned(ped[i]) + _random(seed, thr[i]+1) - _random(seed, 20); break;
+      }
+      f[i] = (v & l.adcMask) | (_random(seed, 200)==0 ? l.gainBits : 0);
+    }
+  }
+public:
+  SparseMaps&     maps ()       { return *reinterpret_cast<SparseMaps*>(&_maps[0]); }
+  char*           elem ()       { return &_elem[0]; }
+  unsigned        elemSize() const { return _elem.size(); }
+  uint16_t*       frame()       { return reinterpret_cast<uint16_t*>(&_elem[layout.headerSize]); }
+  //  The dense reference: every pixel in turn
+  std::vector<uint32_t> reference(unsigned first, unsigned n) {
+    const SparseMaps& m = maps();
+    const uint16_t* f = frame();
+    std::vector<uint32_t> hits;
+    for(unsigned i=first; i<first+n; i++) {
+      uint16_t adc  = f[i] & layout.adcMask;
+      bool     gain = f[i] & ~layout.adcMask;
+      double   lv   = ceil(m.pedestal()[i]) + m.threshold()[i];
+      if (gain || (m.gain()[i]!=0 && lv < layout.adcMask && adc > lv))
+        hits.push_back(i-first);
+    }
+    return hits;
+  }
+public:
+  const TestLayout&     layout;
+private:
+  std::vector<uint32_t> _maps;
+public:
+  std::vector<uint16_t> level;
+private:
+  std::vector<char>     _elem;
+};
+
+static bool _same(const std::vector<uint32_t>& ref, const uint32_t* hits, unsigned nhits)
+{
+  if (nhits != ref.size()) {
+    printf("  %u pixels kept, %zu in the reference\n", nhits, ref.size());
+    return false;
+  }
+  for(unsigned i=0; i<nhits; i++)
+    if (hits[i] != ref[i]) {
+      printf("  hit %u is pixel %u, %u in the reference\n", i, hits[i], ref[i]);
+      return false;
+    }
+  return true;
+}
+
+static void _run(const TestLayout& l, unsigned& seed)
+{
+  TestFrame t(l, seed);
+  char what[128];
+  std::vector<uint32_t> hits(l.npixels);
+
+  //  The whole frame
+  std::vector<uint32_t> ref = t.reference(0, l.npixels);
+  unsigned nhits = SparseFrame::scan(t.frame(), &t.level[0], l.npixels, l.adcMask,
+                                     &hits[0], l.npixels);
+  printf("%s: %u pixels, %zu kept\n", l.name, l.npixels, ref.size());
+  snprintf(what, sizeof(what), "%s: scan matches the dense reference", l.name);
+  check(_same(ref, &hits[0], nhits), what);
+
+  //  Lengths and offsets which leave a tail
+  bool ok = true;
+  for(unsigned first=0; ok && first<8; first++)
+    for(unsigned n=l.npixels-first-15; ok && n<=l.npixels-first; n++) {
+      std::vector<uint32_t> r = t.reference(first, n);
+      ok = _same(r, &hits[0], SparseFrame::scan(t.frame()+first, &t.level[first], n, l.adcMask,
+                                                &hits[0], l.npixels));
+    }
+  snprintf(what, sizeof(what), "%s: scan of a tail matches", l.name);
+  check(ok, what);
+
+  //  More than "maxhits"
+  ok = (SparseFrame::scan(t.frame(), &t.level[0], l.npixels, l.adcMask,
+                          &hits[0], ref.size()-1) == ref.size()) &&
+       (SparseFrame::scan(t.frame(), &t.level[0], l.npixels, l.adcMask,
+                          &hits[0], ref.size()) == ref.size());
+  snprintf(what, sizeof(what), "%s: scan stops beyond maxhits", l.name);
+  check(ok, what);
+
+  //  The sparse xtc
+  SparseFrame sparse;
+  ok = sparse.configure(t.maps(), l.npixels)==0;
+
+  std::vector<uint32_t> inbuf((sizeof(Xtc)+t.elemSize())/sizeof(uint32_t)+1);
+  Xtc* in = new (&inbuf[0]) Xtc(TypeId(TypeId::Any,0), DetInfo(0, DetInfo::XppEndstation, 0, l.device, 0));
+  memcpy(in->alloc(t.elemSize()), t.elem(), t.elemSize());
+  const uint16_t* frame = reinterpret_cast<const uint16_t*>(in->payload()+l.headerSize);
+
+  //  Exactly room for the kept pixels, then one short
+  unsigned maxsize = sizeof(Xtc)+sizeof(SparseFrameHeader)+((l.headerSize+3)&~3)+((l.trailerSize+3)&~3)+
+    ref.size()*sizeof(SparsePixel);
+  std::vector<uint32_t> outbuf(maxsize/sizeof(uint32_t)+1);
+  char* out = reinterpret_cast<char*>(&outbuf[0]);
+  ok &= sparse.process(*in, frame, out, maxsize-sizeof(SparsePixel))==0;
+
+  unsigned extent = sparse.process(*in, frame, out, maxsize);
+  const Xtc& x = *reinterpret_cast<const Xtc*>(out);
+  const SparseFrameHeader& h = *reinterpret_cast<const SparseFrameHeader*>(x.payload());
+  ok &= extent!=0 && extent==x.extent &&
+    h.npixels==l.npixels && h.nhits==ref.size() &&
+    h.headerSize==l.headerSize && h.trailerSize==l.trailerSize;
+  if (ok) {
+    const char* b = reinterpret_cast<const char*>(&h+1);
+    ok &= memcmp(b, t.elem(), l.headerSize)==0;
+    b += (l.headerSize+3)&~3;
+    ok &= memcmp(b, t.elem()+l.headerSize+l.npixels*sizeof(uint16_t), l.trailerSize)==0;
+    b += (l.trailerSize+3)&~3;
+    const SparsePixel* px = reinterpret_cast<const SparsePixel*>(b);
+    const SparseMaps& m = t.maps();
+    for(unsigned i=0; ok && i<ref.size(); i++) {
+      unsigned j = ref[i];
+      uint16_t v = frame[j];
+      if (v & ~l.adcMask)
+        ok = px[i].index==(j|SparsePixel::SwitchedGain) && px[i].value==v;
+      else
+        ok = px[i].index==j && px[i].value==(float(v)-m.pedestal()[j])*m.gain()[j];
+      if (!ok)
+        printf("  hit %u: pixel 0x%x value %f\n", i, px[i].index, px[i].value);
+    }
+  }
+  snprintf(what, sizeof(what), "%s: process writes the kept pixels", l.name);
+  check(ok, what);
+}
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [-s <seed>]\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned seed = 1;
+
+  int c;
+  while ((c = getopt(argc, argv, "s:h")) != -1) {
+    switch (c) {
+    case 's': seed = strtoul(optarg, NULL, 0); break;
+    default : usage(argv[0]); return 1;
+    }
+  }
+
+  for(unsigned i=0; i<sizeof(_layouts)/sizeof(_layouts[0]); i++)
+    _run(_layouts[i], seed);
+
+  if (_failed)
+    printf("*** %u failures\n", _failed);
+  return _failed ? 1 : 0;
+}
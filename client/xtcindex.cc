@@ -0,0 +1,95 @@
+//
+//  xtcindex - build and query the browse index of a recorded xtc file.
+//
+//    xtcindex -f <file.xtc> [-o <index>]                  builds the index
+//    xtcindex -i <index> [-s <log>,<phy>] [-d <mask>] [-v] lists damaged datagrams
+//
+#include "pds/client/XtcIndex.hh"
+#include "pds/client/DamageBrowser.hh"
+
+#include "pdsdata/xtc/TransitionId.hh"
+#include "pdsdata/xtc/Damage.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+
+using namespace Pds;
+
+static void usage(const char* p)
+{
+  printf("Usage: %s -f <xtc file> [-o <index file>]\n"
+         "       %s -i <index file> [-s <log>,<phy>] [-d <damage mask>] [-v]\n"
+         "Options:\n"
+         "\t-f <file>       build the index of an xtc file [<file>.idx]\n"
+         "\t-i <file>       query an index\n"
+         "\t-s <log>,<phy>  select xtcs from this source\n"
+         "\t-d <mask>       select damage bits [0x%x]\n"
+         "\t-v              list the damaged sources of each datagram\n",
+         p, p, 1<<Damage::IncompleteContribution);
+}
+
+int main(int argc, char** argv)
+{
+  const char* xtcfile = 0;
+  const char* idxfile = 0;
+  unsigned    log     = 0;
+  unsigned    phy     = 0;
+  unsigned    mask    = 1<<Damage::IncompleteContribution;
+  bool        verbose = false;
+
+  int c;
+  while ((c = getopt(argc, argv, "f:o:i:s:d:vh")) != -1) {
+    char* endPtr;
+    switch(c) {
+    case 'f': xtcfile = optarg; break;
+    case 'o':
+    case 'i': idxfile = optarg; break;
+    case 's':
+      log = strtoul(optarg,&endPtr,0);
+      if (*endPtr==',')
+        phy = strtoul(endPtr+1,NULL,0);
+      break;
+    case 'd': mask    = strtoul(optarg,NULL,0); break;
+    case 'v': verbose = true; break;
+    case 'h':
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  if (xtcfile) {
+    std::string ipath = idxfile ? std::string(idxfile) : std::string(xtcfile)+".idx";
+    return XtcIndex::build(xtcfile, ipath.c_str()) ? 1 : 0;
+  }
+
+  if (!idxfile) {
+    usage(argv[0]);
+    exit(1);
+  }
+
+  XtcIndex index;
+  if (index.open(idxfile))
+    return 1;
+
+  std::vector<unsigned> result;
+  index.find(Src(log,phy), mask, result);
+
+  for(unsigned i=0; i<result.size(); i++) {
+    const XtcIndex::Dgram& d = index.dgram(result[i]);
+    printf("%s @ 0x%llx : time %08x/%08x  fid %05x  dmg %08x  extent 0x%x\n",
+           TransitionId::name(TransitionId::Value(d.service)),
+           (unsigned long long)d.offset,
+           d.seconds, d.nanoseconds, d.fiducials, d.damage, d.extent);
+    if (verbose) {
+      DamageBrowser browser(index, result[i]);
+      const std::list<Xtc>& damaged = browser.damaged();
+      for(std::list<Xtc>::const_iterator it=damaged.begin(); it!=damaged.end(); it++)
+        printf("\t%08x.%08x  dmg %08x\n", it->src.log(), it->src.phy(), it->damage.value());
+    }
+  }
+  printf("%zu of %u datagrams selected\n", result.size(), index.ndgrams());
+  return 0;
+}
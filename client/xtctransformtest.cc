@@ -0,0 +1,234 @@
+//
+//  Randomized equivalence test of XtcTransform against FrameTrim and
+//  XtcStripper.  Random XTC trees (nested containers, damaged
+//  contributions, leaves of random type/source/size) are rewritten by
+//  both implementations and the results compared byte for byte.
+//
+#include "pds/client/XtcTransform.hh"
+#include "pds/client/FrameTrim.hh"
+#include "pds/client/XtcStripper.hh"
+
+#include "pdsdata/xtc/Xtc.hh"
+#include "pdsdata/xtc/DetInfo.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+using namespace Pds;
+
+static const unsigned MaxSize = 0x400000;
+static const unsigned NSrcs   = 4;
+static const TypeId::Type Types[] = { TypeId::Id_Frame, TypeId::Id_AcqWaveform, TypeId::Id_Epics };
+static const unsigned NTypes  = sizeof(Types)/sizeof(Types[0]);
+
+static unsigned _seed;
+
+static unsigned _rand(unsigned n) { return rand_r(&_seed)%n; }
+
+static DetInfo _src(unsigned i)
+{
+  return DetInfo(0, DetInfo::XppEndstation, 0, DetInfo::Opal1000, i);
+}
+
+//
+//  Write a random xtc at p; return its extent
+//
+static unsigned _generate(char* p, unsigned depth)
+{
+  Xtc* xtc = reinterpret_cast<Xtc*>(p);
+  unsigned extent = sizeof(Xtc);
+  if (depth < 3 && _rand(3)==0) {
+    Damage dmg(_rand(10)==0 ? (1<<Damage::IncompleteContribution) : 0);
+    Xtc hdr(TypeId(TypeId::Id_Xtc,0), _src(_rand(NSrcs)), dmg);
+    memcpy(xtc, &hdr, sizeof(Xtc));
+    unsigned n = _rand(6);
+    for(unsigned i=0; i<n; i++)
+      extent += _generate(p+extent, depth+1);
+  }
+  else {
+    Xtc hdr(TypeId(Types[_rand(NTypes)],1), _src(_rand(NSrcs)));
+    memcpy(xtc, &hdr, sizeof(Xtc));
+    unsigned n = _rand(64);
+    uint32_t* q = reinterpret_cast<uint32_t*>(p+extent);
+    for(unsigned i=0; i<n; i++)
+      q[i] = rand_r(&_seed);
+    extent += n*sizeof(uint32_t);
+  }
+  xtc->extent = extent;
+  return extent;
+}
+
+namespace Pds {
+  //  Reference implementation: strip every xtc of one type
+  class TypeStripper : public XtcStripper {
+  public:
+    TypeStripper(Xtc* root, uint32_t*& pwrite, TypeId::Type type) :
+      XtcStripper(root, pwrite), _type(type) {}
+  protected:
+    void process(Xtc* xtc) {
+      if (xtc->contains.id()==_type)
+        return;
+      if (xtc->contains.id()==TypeId::Id_Xtc)
+        iterate(xtc);
+      else
+        XtcStripper::process(xtc);
+    }
+  private:
+    TypeId::Type _type;
+  };
+
+  //  Reference implementation: truncate the payload of one type by half
+  class TypeTruncater : public XtcStripper {
+  public:
+    TypeTruncater(Xtc* root, uint32_t*& pwrite, TypeId::Type type) :
+      XtcStripper(root, pwrite), _type(type) {}
+  protected:
+    void process(Xtc* xtc) {
+      if (xtc->contains.id()==_type) {
+        unsigned n = (xtc->sizeofPayload()>>3)<<2;
+        if (n) {
+          Xtc* o = reinterpret_cast<Xtc*>(_write(xtc, sizeof(Xtc)+n));
+          o->extent = sizeof(Xtc)+n;
+          return;
+        }
+      }
+      if (xtc->contains.id()==TypeId::Id_Xtc)
+        iterate(xtc);
+      else
+        XtcStripper::process(xtc);
+    }
+  private:
+    TypeId::Type _type;
+  };
+
+  class Truncate : public XtcTransform::Callback {
+  public:
+    unsigned replace(const Xtc& in, Xtc* out, unsigned maxsize) {
+      unsigned n = (in.sizeofPayload()>>3)<<2;
+      if (!n || sizeof(Xtc)+n > maxsize) return 0;
+      memcpy(out, &in, sizeof(Xtc)+n);
+      out->extent = sizeof(Xtc)+n;
+      return out->extent;
+    }
+  };
+};
+
+static double _since(const timespec& t0)
+{
+  timespec t1;
+  clock_gettime(CLOCK_REALTIME, &t1);
+  return double(t1.tv_sec-t0.tv_sec)*1.e9+double(t1.tv_nsec-t0.tv_nsec);
+}
+
+static bool _compare(const char* test, unsigned iter, const Xtc* a, const Xtc* b)
+{
+  if (a->extent != b->extent || memcmp(a, b, a->extent)) {
+    printf("%s: mismatch on iteration %u extents %u/%u\n",
+           test, iter, a->extent, b->extent);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  unsigned niter = 10000;
+  unsigned seed  = time(0);
+  int c;
+  while ((c = getopt(argc, argv, "n:s:h")) != -1) {
+    switch(c) {
+    case 'n': niter = strtoul(optarg,NULL,0); break;
+    case 's': seed  = strtoul(optarg,NULL,0); break;
+    default:
+      printf("Usage: %s [-n <iterations>] [-s <seed>]\n",argv[0]);
+      exit(1);
+    }
+  }
+  printf("Seed %u\n",seed);
+  _seed = seed;
+
+  char* orig = new char[MaxSize];
+  char* bufa = new char[MaxSize];
+  char* bufb = new char[MaxSize];
+
+  Truncate truncate;
+  XtcTransform replacer(MaxSize);
+  unsigned failures = 0;
+  double tref[3] = {0,0,0};
+  double tnew[3] = {0,0,0};
+
+  for(unsigned iter=0; iter<niter; iter++) {
+    //  Build a random event
+    Xtc* root = reinterpret_cast<Xtc*>(orig);
+    { Xtc hdr(TypeId(TypeId::Id_Xtc,0), _src(0));
+      memcpy(root, &hdr, sizeof(Xtc));
+      unsigned n = _rand(16);
+      for(unsigned i=0; i<n && root->extent < MaxSize/2; i++)
+        root->extent += _generate(orig+root->extent, 0); }
+
+    Xtc* a = reinterpret_cast<Xtc*>(bufa);
+    Xtc* b = reinterpret_cast<Xtc*>(bufb);
+    timespec t0;
+
+    //  FrameTrim
+    DetInfo src = _src(_rand(NSrcs));
+    memcpy(bufa, orig, root->extent);
+    memcpy(bufb, orig, root->extent);
+    clock_gettime(CLOCK_REALTIME, &t0);
+    { uint32_t* pwrite = reinterpret_cast<uint32_t*>(a);
+      FrameTrim trim(pwrite, src);
+      trim.iterate(a); }
+    tref[0] += _since(t0);
+    clock_gettime(CLOCK_REALTIME, &t0);
+    { XtcTransform t;
+      t.add(src, TypeId::Id_Frame, XtcTransform::Drop);
+      t.apply(*b); }
+    tnew[0] += _since(t0);
+    if (!_compare("FrameTrim",iter,a,b)) failures++;
+
+    //  XtcStripper type strip
+    TypeId::Type type = Types[_rand(NTypes)];
+    memcpy(bufa, orig, root->extent);
+    memcpy(bufb, orig, root->extent);
+    clock_gettime(CLOCK_REALTIME, &t0);
+    { uint32_t* pwrite = reinterpret_cast<uint32_t*>(a);
+      TypeStripper s(a, pwrite, type);
+      s.iterate(); }
+    tref[1] += _since(t0);
+    clock_gettime(CLOCK_REALTIME, &t0);
+    { XtcTransform t;
+      t.add(type, XtcTransform::Drop);
+      t.apply(*b); }
+    tnew[1] += _since(t0);
+    if (!_compare("XtcStripper",iter,a,b)) failures++;
+
+    //  XtcStripper replacement
+    memcpy(bufa, orig, root->extent);
+    memcpy(bufb, orig, root->extent);
+    clock_gettime(CLOCK_REALTIME, &t0);
+    { uint32_t* pwrite = reinterpret_cast<uint32_t*>(a);
+      TypeTruncater s(a, pwrite, type);
+      s.iterate(); }
+    tref[2] += _since(t0);
+    clock_gettime(CLOCK_REALTIME, &t0);
+    replacer.clear();
+    replacer.add(type, XtcTransform::Replace, &truncate);
+    replacer.apply(*b);
+    tnew[2] += _since(t0);
+    if (!_compare("Replace",iter,a,b)) failures++;
+  }
+
+  const char* names[] = { "FrameTrim", "XtcStripper", "Replace" };
+  for(unsigned i=0; i<3; i++)
+    printf("%12s : reference %8.1f ns  transform %8.1f ns  per event\n",
+           names[i], tref[i]/double(niter), tnew[i]/double(niter));
+  printf("%u iterations, %u failures\n", niter, failures);
+
+  delete[] orig;
+  delete[] bufa;
+  delete[] bufb;
+  return failures ? 1 : 0;
+}
@@ -82,6 +82,16 @@ int CfgClientNfs::fetch(const Transition& tr,
   //  Could consider caching "name" of data returned to
   //  supply back to XtcClient as shortcut.
   //
+  //  The same key may have been rewritten since the last Configure,
+  //  so each Configure reads the database again.
+  //
+  if (!(tr.sequence().clock() == _clock)) {
+    _clock = tr.sequence().clock();
+    db->flush();
+    if (tr.id() == TransitionId::Configure)
+      clear_map(_cache);
+  }
+
   if (_key != tr.env().value())
     clear_map(_cache);
 
@@ -2,6 +2,7 @@
 #define Pds_CfgClientNfs_hh
 
 #include "pdsdata/xtc/Src.hh"
+#include "pdsdata/xtc/ClockTime.hh"
 
 #include <string>
 #include <map>
@@ -33,6 +34,7 @@ namespace Pds {
     Pds_ConfigDb::XtcClient* _db;
     std::string              _path;
     unsigned                 _key;
+    ClockTime                _clock;   // of the last transition fetched for
   public:
     class CacheEntry {
     public:
@@ -1,5 +1,6 @@
 #include "pds/confignfs/XtcClient.hh"
 #include "pds/configsql/XtcClient.hh"
+#include "pds/configsql/FileClient.hh"
 
 #include <stdio.h>
 #include <errno.h>
@@ -18,6 +19,9 @@ XtcClient* XtcClient::open(const char* path)
   if (S_ISDIR(s.st_mode))
     return Nfs::XtcClient::open(path);
 
+  else if (Sql::FileClient::matches(path))
+    return Sql::FileClient::open(path);
+
   else
     return Sql::XtcClient::open(path);
 }
@@ -15,6 +15,9 @@ namespace Pds_ConfigDb {
                               const Pds::TypeId& type_id,
                               void*              dst,
                               unsigned           maxSize) = 0;
+    /// Discards anything kept from earlier requests; called at each new
+    /// transition so that a key rewritten in place is read again
+    virtual void      flush () {}
   };
 };
 
@@ -1,5 +1,7 @@
 #include "pds/configsql/DbClient.hh"
 #include "pds/configsql/QueryProcessor.hh"
+#include "pds/configsql/XtcBatch.hh"
+#include "pds/config/DeviceEntry.hh"
 #include "pds/config/PdsDefs.hh"
 
 using Pds_ConfigDb::XtcEntry;
@@ -15,6 +17,7 @@ using Pds_ConfigDb::ExptAlias;
 #include <mysql/mysql.h>
 
 #include <stdlib.h>
+#include <string.h>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -1303,6 +1306,73 @@ int                  DbClient::getXTC(const XtcEntryT& x,
   return len;
 }
 
+//
+//  A single statement reads a consistent snapshot without table locks.
+//  The result is streamed rather than stored, so each payload is copied
+//  once, from the connection buffer into the batch.  As in
+//  getXTC(XtcEntry), each (typeid,xtcname) gets its newest xtc row, not
+//  the one at runkeys.xtctime, since the two TIMESTAMPs can differ.
+//
+int                  DbClient::getXTC(unsigned key,
+                                      const std::list<Pds::Src>& sources,
+                                      XtcBatch& batch)
+{
+  std::ostringstream sql;
+  sql << "SELECT runkeys.source,runkeys.typeid,runkeys.xtcname,xtc.payload"
+      << " FROM runkeys JOIN xtc"
+      << " ON xtc.typeid=runkeys.typeid"
+      << " AND xtc.xtcname=runkeys.xtcname"
+      << " AND xtc.xtctime=(SELECT MAX(latest.xtctime) FROM xtc AS latest"
+      << " WHERE latest.typeid=runkeys.typeid"
+      << " AND latest.xtcname=runkeys.xtcname)"
+      << " WHERE runkeys.runkey=" << key;
+  if (!sources.empty()) {
+    const char* sep = " AND (";
+    for(std::list<Pds::Src>::const_iterator it=sources.begin();
+        it!=sources.end(); it++) {
+      DeviceEntry d(*it);
+      sql << sep << "(runkeys.source>>56)=" << unsigned(d.level());
+      if (d.level()==Pds::Level::Source)
+        sql << " AND (runkeys.source&0xffffffff)=" << d.phy();
+      sep = ") OR (";
+    }
+    sql << ")";
+  }
+  sql << " ORDER BY runkeys.source,runkeys.typeid;";
+
+#ifdef DBUG
+  printf("Query [%s]\n",sql.str().c_str());
+#endif
+
+  simpleQuery(_mysql,sql.str());
+
+  MYSQL_RES* result = mysql_use_result(_mysql);
+  if (!result)
+    throw DatabaseError( std::string( "error in mysql_use_result(): " ) + mysql_error(_mysql));
+
+  int n = 0;
+  MYSQL_ROW row;
+  while((row = mysql_fetch_row(result))) {
+    unsigned long* lengths = mysql_fetch_lengths(result);
+    if (!row[0] || !row[1] || !row[3])
+      continue;
+    uint64_t source  = strtoull(row[0],NULL,10);
+    unsigned type_id = strtoul (row[1],NULL,10);
+    std::string name(row[2] ? row[2] : "", row[2] ? lengths[2] : 0);
+    memcpy(batch.alloc(source,type_id,name,lengths[3]), row[3], lengths[3]);
+    n++;
+  }
+
+  if (mysql_errno(_mysql)) {
+    std::string err(mysql_error(_mysql));
+    mysql_free_result(result);
+    throw DatabaseError( std::string( "error in mysql_fetch_row(): " ) + err);
+  }
+  mysql_free_result(result);
+
+  return n;
+}
+
 DbClient*  DbClient::open  (const char* path)
 {
   return new DbClient(path);
@@ -7,6 +7,7 @@
 
 namespace Pds_ConfigDb {
   namespace Sql {
+    class XtcBatch;
     class DbClient : public Pds_ConfigDb::DbClient {
     private:
       DbClient(const char*);
@@ -76,6 +77,14 @@ namespace Pds_ConfigDb {
       int                  getXTC(const XtcEntryT&,
 				  void*    payload,
 				  unsigned payload_size);
+
+      /// -- Run Interface --
+      /// Get the payloads of all XTCs used by a run key for a set of
+      /// sources (all sources if empty) in one query.
+      /// Returns the number of XTCs added to the batch.
+      int                  getXTC(unsigned key,
+                                  const std::list<Pds::Src>& sources,
+                                  XtcBatch& batch);
     private:
       void _updateKey(const std::string& alias,
                       std::list<ExptAlias>&  alist,
@@ -0,0 +1,137 @@
+#include "pds/configsql/FileClient.hh"
+#include "pdsdata/xtc/Src.hh"
+#include "pdsdata/xtc/TypeId.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+using namespace Pds_ConfigDb::Sql;
+
+static const char _magic[] = "PDSCFGDB";
+
+static inline unsigned _pad(unsigned sz) { return (sz+7)&~7; }
+
+FileClient::FileClient(const char* path) :
+  _path  (path),
+  _loaded(false)
+{
+  printf("Sql::FileClient %s\n",path);
+}
+
+FileClient::~FileClient()
+{
+}
+
+FileClient* FileClient::open  ( const char* path )
+{
+  return new FileClient(path);
+}
+
+bool FileClient::matches( const char* path )
+{
+  FILE* f = fopen(path,"r");
+  if (!f)
+    return false;
+
+  FileHeader h;
+  bool result = fread(&h, sizeof(h), 1, f)==1 &&
+    memcmp(h.magic, _magic, sizeof(h.magic))==0;
+  fclose(f);
+  return result;
+}
+
+int FileClient::read( const char* path, unsigned key, XtcBatch& batch )
+{
+  FILE* f = fopen(path,"r");
+  if (!f) {
+    printf("*** FileClient error opening %s : %s\n", path, strerror(errno));
+    return -1;
+  }
+
+  FileHeader h;
+  if (fread(&h, sizeof(h), 1, f)!=1 ||
+      memcmp(h.magic, _magic, sizeof(h.magic)) ||
+      h.version != Version) {
+    printf("*** FileClient %s is not a version %u configuration file\n", path, Version);
+    fclose(f);
+    return -1;
+  }
+
+  int n = 0;
+  Record r;
+  while(fread(&r, sizeof(r), 1, f)==1) {
+    if (r.runkey != key) {
+      if (fseek(f, _pad(r.size), SEEK_CUR))
+        break;
+      continue;
+    }
+    std::string name(r.xtcname, strnlen(r.xtcname, sizeof(r.xtcname)));
+    char* p = batch.alloc(r.source, r.type_id, name, r.size);
+    if (fread(p, 1, r.size, f)!=r.size ||
+        fseek(f, _pad(r.size)-r.size, SEEK_CUR)) {
+      printf("*** FileClient %s truncated\n", path);
+      fclose(f);
+      return -1;
+    }
+    n++;
+  }
+  fclose(f);
+  return n;
+}
+
+int FileClient::write( const char* path, const XtcBatch& batch )
+{
+  FILE* f = fopen(path,"a");
+  if (!f) {
+    printf("*** FileClient error opening %s : %s\n", path, strerror(errno));
+    return -1;
+  }
+
+  if (ftell(f)==0) {
+    FileHeader h;
+    memcpy(h.magic, _magic, sizeof(h.magic));
+    h.version  = Version;
+    h.reserved = 0;
+    fwrite(&h, sizeof(h), 1, f);
+  }
+
+  static const char zeros[8] = {0,0,0,0,0,0,0,0};
+
+  int n = 0;
+  const std::vector<XtcBatch::Entry>& entries = batch.entries();
+  for(std::vector<XtcBatch::Entry>::const_iterator it=entries.begin();
+      it!=entries.end(); it++, n++) {
+    Record r;
+    memset(&r, 0, sizeof(r));
+    r.runkey  = batch.key();
+    r.type_id = it->type_id;
+    r.source  = it->source;
+    strncpy(r.xtcname, it->name.c_str(), sizeof(r.xtcname));
+    r.size    = it->size;
+    fwrite(&r, sizeof(r), 1, f);
+    fwrite(batch.payload(*it), 1, it->size, f);
+    fwrite(zeros, 1, _pad(it->size)-it->size, f);
+  }
+
+  if (fclose(f)) {
+    printf("*** FileClient error writing %s : %s\n", path, strerror(errno));
+    return -1;
+  }
+  return n;
+}
+
+int       FileClient::getXTC( unsigned           key,
+                              const Pds::Src&    src,
+                              const Pds::TypeId& type_id,
+                              void*              dst,
+                              unsigned           maxSize)
+{
+  if (!_loaded || _batch.key()!=key) {
+    _batch.reset(key);
+    _loaded = read(_path.c_str(), key, _batch) >= 0;
+  }
+
+  int len = _batch.find(src, type_id, dst, maxSize);
+  return len < 0 ? 0 : len;
+}
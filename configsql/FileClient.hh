@@ -0,0 +1,67 @@
+#ifndef Pds_FileClientSql_hh
+#define Pds_FileClientSql_hh
+
+//
+//  A configuration database embedded in a single file, holding the rows
+//  of the runkeys table joined with their xtc payloads.  It serves the
+//  same XtcClient requests as the MySQL database without a server, for
+//  benchmarks and offline tests.  Files are written from a XtcBatch
+//  fetched from the database (see xtcdbbench).
+//
+//    [ FileHeader | ( Record | payload padded to 8 bytes ) ... ]
+//
+
+#include "pds/config/XtcClient.hh"
+#include "pds/configsql/XtcBatch.hh"
+
+#include <stdint.h>
+#include <string>
+
+namespace Pds_ConfigDb {
+  namespace Sql {
+    class FileClient : public Pds_ConfigDb::XtcClient {
+    public:
+      enum { Version = 1 };
+      class FileHeader {
+      public:
+        char     magic[8];
+        uint32_t version;
+        uint32_t reserved;
+      };
+      class Record {
+      public:
+        uint32_t runkey;
+        uint32_t type_id;
+        uint64_t source;
+        char     xtcname[32];
+        uint32_t size;
+        uint32_t reserved;
+      };
+    private:
+      FileClient(const char*);
+    public:
+      ~FileClient();
+    public:
+      static FileClient* open   ( const char* path );
+      /// True if "path" is a configuration database file
+      static bool        matches( const char* path );
+      /// Adds all blobs of "key" to the batch; returns the number added or -1
+      static int         read   ( const char* path, unsigned key, XtcBatch& );
+      /// Appends the batch's blobs to the file; returns the number written or -1
+      static int         write  ( const char* path, const XtcBatch& );
+    public:
+      int       getXTC( unsigned           key,
+                        const Pds::Src&    src,
+                        const Pds::TypeId& type_id,
+                        void*              dst,
+                        unsigned           maxSize);
+      void      flush () { _loaded = false; }
+    private:
+      std::string _path;
+      XtcBatch    _batch;
+      bool        _loaded;
+    };
+  };
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "pds/configsql/XtcBatch.hh"
+#include "pds/config/DeviceEntry.hh"
+#include "pdsdata/xtc/TypeId.hh"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Pds_ConfigDb::Sql;
+
+XtcBatch::XtcBatch(unsigned size) :
+  _key  (0),
+  _arena(new char[size]),
+  _size (size),
+  _used (0)
+{
+}
+
+XtcBatch::~XtcBatch()
+{
+  delete[] _arena;
+}
+
+void XtcBatch::reset(unsigned key)
+{
+  _key  = key;
+  _used = 0;
+  _entries  .clear();
+  _index_map.clear();
+}
+
+char* XtcBatch::alloc(uint64_t source, unsigned type_id, const std::string& name, unsigned size)
+{
+  unsigned asize = (size+7)&~7;
+  if (_used+asize > _size) {
+    //  Only grows while the largest keys are first seen
+    unsigned nsize = _size;
+    while(_used+asize > nsize)
+      nsize <<= 1;
+    char* arena = new char[nsize];
+    memcpy(arena, _arena, _used);
+    delete[] _arena;
+    _arena = arena;
+    _size  = nsize;
+  }
+
+  Entry e;
+  e.source  = source;
+  e.type_id = type_id;
+  e.name    = name;
+  e.offset  = _used;
+  e.size    = size;
+  _index_map.insert(std::make_pair(_index(source,type_id),unsigned(_entries.size())));
+  _entries.push_back(e);
+  _used += asize;
+  return _arena+e.offset;
+}
+
+int XtcBatch::find(const Pds::Src&    src,
+                   const Pds::TypeId& type_id,
+                   void*              dst,
+                   unsigned           maxSize) const
+{
+  std::map<Index,unsigned>::const_iterator it =
+    _index_map.find(_index(DeviceEntry(src).value(),type_id.value()));
+  if (it == _index_map.end())
+    return -1;
+
+  const Entry& e = _entries[it->second];
+  unsigned len = e.size < maxSize ? e.size : maxSize;
+  memcpy(dst, _arena+e.offset, len);
+  return len;
+}
+
+XtcBatch::Index XtcBatch::_index(uint64_t source, unsigned type_id)
+{
+  uint64_t level = source>>56;
+  uint64_t v     = level<<32;
+  if (level == Pds::Level::Source)
+    v |= source&0xffffffff;
+  return Index(v,type_id);
+}
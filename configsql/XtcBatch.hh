@@ -0,0 +1,60 @@
+#ifndef Pds_ConfigDbSql_XtcBatch_hh
+#define Pds_ConfigDbSql_XtcBatch_hh
+
+//
+//  The configuration blobs of one run key, fetched together and kept in a
+//  single arena indexed by (source, type).  Sources are matched as the
+//  configuration database does: by level and physical id for Source level
+//  devices, by level alone for the others.  The first blob stored for an
+//  index is the one returned.
+//
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace Pds { class Src; class TypeId; };
+
+namespace Pds_ConfigDb {
+  namespace Sql {
+    class XtcBatch {
+    public:
+      class Entry {
+      public:
+        uint64_t    source;
+        unsigned    type_id;
+        std::string name;
+        unsigned    offset;
+        unsigned    size;
+      };
+    public:
+      XtcBatch(unsigned size=0x100000);
+      ~XtcBatch();
+    public:
+      /// Drop all blobs and start a batch for "key"
+      void     reset  (unsigned key);
+      unsigned key    () const { return _key; }
+      /// Space for a blob of "size" bytes; filled by the caller
+      char*    alloc  (uint64_t source, unsigned type_id, const std::string& name, unsigned size);
+    public:
+      /// Copies the blob to "dst" and returns its size, or -1 if there is none
+      int      find   (const Pds::Src&, const Pds::TypeId&, void* dst, unsigned maxSize) const;
+      const std::vector<Entry>& entries() const { return _entries; }
+      const char* payload(const Entry& e) const { return _arena+e.offset; }
+      unsigned    used   () const { return _used; }
+    private:
+      typedef std::pair<uint64_t,unsigned> Index;
+      static Index _index(uint64_t source, unsigned type_id);
+    private:
+      unsigned             _key;
+      char*                _arena;
+      unsigned             _size;
+      unsigned             _used;
+      std::vector<Entry>   _entries;
+      std::map<Index,unsigned> _index_map;
+    };
+  };
+};
+
+#endif
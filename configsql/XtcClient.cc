@@ -1,6 +1,5 @@
 #include "pds/configsql/XtcClient.hh"
 #include "pds/configsql/DbClient.hh"
-#include "pds/config/DeviceEntry.hh"
 #include "pdsdata/xtc/Src.hh"
 #include "pdsdata/xtc/TypeId.hh"
 
@@ -10,6 +9,12 @@
 
 using namespace Pds_ConfigDb::Sql;
 
+static bool _match(const Pds::Src& a, const Pds::Src& b)
+{
+  return a.level()==b.level() &&
+    (a.phy()==b.phy() || a.level()!=Pds::Level::Source);
+}
+
 XtcClient::XtcClient(const char* path) : _db(DbClient::open(path))
 {
   printf("Sql::XtcClient %s\n",path);
@@ -31,16 +36,34 @@ int       XtcClient::getXTC( unsigned           key,
                              void*              dst,
                              unsigned           maxSize)
 {
-  std::list<KeyEntry> klist = _db->getKey(key);
-  for(std::list<KeyEntry>::iterator it=klist.begin();
-      it!=klist.end(); it++) {
-    DeviceEntry d(it->source);
-    if (d.level() == src.level() &&
-        (d.phy  () == src.phy() ||
-         d.level() != Pds::Level::Source) &&
-        it->xtc.type_id.value() == type_id.value())
-      return _db->getXTC(it->xtc, dst, maxSize);
+  if (_loaded.empty() || _batch.key()!=key) {
+    _batch.reset(key);
+    _loaded.clear();
   }
 
-  return 0;
+  bool loaded=false;
+  for(std::list<Pds::Src>::const_iterator it=_loaded.begin();
+      it!=_loaded.end(); it++)
+    if (_match(*it,src)) {
+      loaded=true;
+      break;
+    }
+
+  if (!loaded) {
+    std::list<Pds::Src> sources(1,src);
+    _db->getXTC(key, sources, _batch);
+    _loaded.push_back(src);
+  }
+
+  int len = _batch.find(src, type_id, dst, maxSize);
+  return len < 0 ? 0 : len;
+}
+
+//
+//  The batch only serves the requests of one transition; a key may be
+//  rewritten under the same number between Configures
+//
+void      XtcClient::flush()
+{
+  _loaded.clear();
 }
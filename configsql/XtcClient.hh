@@ -2,8 +2,11 @@
 #define Pds_XtcClientSql_hh
 
 #include "pds/config/XtcClient.hh"
+#include "pds/configsql/XtcBatch.hh"
+#include "pdsdata/xtc/Src.hh"
 
 #include <string>
+#include <list>
 
 namespace Pds_ConfigDb {
   namespace Sql {
@@ -21,8 +24,13 @@ namespace Pds_ConfigDb {
                         const Pds::TypeId& type_id,
                         void*              dst,
                         unsigned           maxSize);
+      void      flush ();
     private:
-      DbClient* _db;
+      //  All of a source's blobs for the key are fetched by its first
+      //  request and kept until the next transition
+      DbClient*            _db;
+      XtcBatch             _batch;
+      std::list<Pds::Src>  _loaded;
     };
   };
 };
@@ -4,4 +4,12 @@ libsrcs_configsql := DatabaseError.cc ValueTypeMismatch.cc WrongParams.cc
 libsrcs_configsql += QueryProcessor.cc
 libsrcs_configsql += DbClient.cc
 libsrcs_configsql += XtcClient.cc
+libsrcs_configsql += XtcBatch.cc FileClient.cc
 libincs_configsql := pdsdata/include
+
+tgtnames := xtcdbbench
+tgtsrcs_xtcdbbench := xtcdbbench.cc
+tgtlibs_xtcdbbench := pds/configsql pds/configdbc
+tgtlibs_xtcdbbench += pdsdata/xtcdata offlinedb/mysqlclient
+tgtslib_xtcdbbench := $(USRLIBDIR)/rt
+tgtincs_xtcdbbench := pdsdata/include
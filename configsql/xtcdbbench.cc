@@ -0,0 +1,118 @@
+//
+//  xtcdbbench - time to fetch all configuration blobs of a run key.
+//
+//    xtcdbbench -p <db config> -k <key> [-n <passes>] [-o <file>]
+//      compares the batched query with a query pair per blob, and
+//      optionally appends the key's blobs to an embedded database file
+//    xtcdbbench -p <file> -k <key> [-n <passes>]
+//      times the same fetch from an embedded database file
+//
+#include "pds/configsql/DbClient.hh"
+#include "pds/configsql/FileClient.hh"
+#include "pds/configsql/XtcBatch.hh"
+
+#include <vector>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+
+using namespace Pds_ConfigDb;
+
+static double now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return double(ts.tv_sec)+1.e-9*double(ts.tv_nsec);
+}
+
+static void usage(const char* p)
+{
+  printf("Usage: %s -p <path> -k <key> [-n <passes>] [-o <file>]\n"
+         "Options:\n"
+         "\t-p <path>    database configuration or embedded database file\n"
+         "\t-k <key>     run key\n"
+         "\t-n <passes>  fetches of the key [20]\n"
+         "\t-o <file>    append the key to an embedded database file\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  const char* path    = 0;
+  const char* outfile = 0;
+  unsigned    key     = 0;
+  unsigned    passes  = 20;
+  bool        lkey    = false;
+
+  int c;
+  while ((c = getopt(argc, argv, "p:k:n:o:h")) != -1) {
+    switch(c) {
+    case 'p': path    = optarg; break;
+    case 'k': key     = strtoul(optarg,NULL,0); lkey = true; break;
+    case 'n': passes  = strtoul(optarg,NULL,0); break;
+    case 'o': outfile = optarg; break;
+    case 'h':
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+  if (!path || !lkey || !passes) {
+    usage(argv[0]);
+    exit(1);
+  }
+
+  Sql::XtcBatch batch;
+  double t0, t1;
+
+  if (Sql::FileClient::matches(path)) {
+    t0 = now();
+    for(unsigned i=0; i<passes; i++) {
+      batch.reset(key);
+      if (Sql::FileClient::read(path, key, batch) < 0)
+        return 1;
+    }
+    t1 = now();
+    printf("%zu blobs, %u bytes : file %.3f ms/key\n",
+           batch.entries().size(), batch.used(), (t1-t0)*1.e3/double(passes));
+    return 0;
+  }
+
+  Sql::DbClient* db = Sql::DbClient::open(path);
+  std::list<Pds::Src> all;
+
+  t0 = now();
+  for(unsigned i=0; i<passes; i++) {
+    batch.reset(key);
+    db->getXTC(key, all, batch);
+  }
+  t1 = now();
+  double tbatch = (t1-t0)/double(passes);
+
+  //  One key lookup and one payload query per blob
+  std::vector<char> buff(0x1000000);
+  t0 = now();
+  for(unsigned i=0; i<passes; i++) {
+    std::list<KeyEntry> klist = db->getKey(key);
+    for(std::list<KeyEntry>::iterator it=klist.begin(); it!=klist.end(); it++) {
+      if (it!=klist.begin())
+        db->getKey(key);
+      db->getXTC(it->xtc, &buff[0], buff.size());
+    }
+  }
+  t1 = now();
+  double tsingle = (t1-t0)/double(passes);
+
+  printf("%zu blobs, %u bytes : batched %.3f ms/key, per blob %.3f ms/key\n",
+         batch.entries().size(), batch.used(), tbatch*1.e3, tsingle*1.e3);
+
+  if (outfile) {
+    int n = Sql::FileClient::write(outfile, batch);
+    if (n < 0)
+      return 1;
+    printf("Wrote %d blobs of key %u to %s\n", n, key, outfile);
+  }
+
+  delete db;
+  return 0;
+}
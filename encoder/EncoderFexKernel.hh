@@ -0,0 +1,36 @@
+#ifndef Pds_EncoderFexKernel_hh
+#define Pds_EncoderFexKernel_hh
+
+//
+//  ChannelFex kernel for the PCI-3E encoder counts.  The 24-bit counters
+//  are sign extended before calibration.  The configuration has no
+//  calibration, so it comes from the kernel's settings.
+//
+
+#include "pds/client/ChannelFex.hh"
+#include "pds/config/EncoderConfigType.hh"
+#include "pds/config/EncoderDataType.hh"
+
+namespace Pds {
+  class EncoderFexKernel {
+  public:
+    enum { NChannels = 3 };
+    typedef EncoderDataType                Data;
+    typedef EncoderConfigType              Config;
+    typedef ChannelFexValues<NChannels>    Result;
+  public:
+    static TypeId   dataType   () { return _encoderDataType; }
+    static TypeId   configType () { return _encoderConfigType; }
+    static TypeId   resultType () { return TypeId(TypeId::Any, Result::Version); }
+    static bool     calibration(const Config&, double*, double*) { return false; }
+    static unsigned raw        (const Config&, const Data& d, double* v) {
+      const ndarray<const uint32_t,1> count = d.encoder_count();
+      for(unsigned i=0; i<NChannels; i++)
+        v[i] = int32_t(count[i]<<8)>>8;
+      return NChannels;
+    }
+    static unsigned result     (const double* v, unsigned n, Result& r) { return r.fill(v,n); }
+  };
+};
+
+#endif
@@ -11,6 +11,8 @@
 #include "pds/xtc/CDatagram.hh"
 #include "pds/client/Fsm.hh"
 #include "pds/client/Action.hh"
+#include "pds/client/ChannelFexApp.hh"
+#include "pds/encoder/EncoderFexKernel.hh"
 #include "pds/config/EncoderConfigType.hh"
 #include "pci3e_dev.hh"
 #include "EncoderManager.hh"
@@ -342,8 +344,9 @@ class EncoderUnconfigAction : public EncoderAction {
 
 
 EncoderManager::EncoderManager( EncoderServer* server,
-                                CfgClientNfs* cfg )
-   : _fsm(*new Fsm)
+                                CfgClientNfs* cfg,
+                                const char* fex )
+   : _fsm(*new Fsm), _fex(0)
 {
    int ret;
 
@@ -372,4 +375,25 @@ EncoderManager::EncoderManager( EncoderServer* server,
    _fsm.callback( TransitionId::Map,
                   new EncoderAllocAction( *cfg ) );
    _fsm.callback( TransitionId::L1Accept, &encoderl1 );
+
+   if (fex) {
+      ChannelFex<EncoderFexKernel>* kernel = new ChannelFex<EncoderFexKernel>;
+      if (kernel->settings(fex)) {
+         printf("*** EncoderManager: bad fex settings \"%s\"\n", fex);
+         delete kernel;
+      }
+      else {
+         _fex = new ChannelFexApp;
+         _fex->add(kernel);
+      }
+   }
+}
+
+std::list<Appliance*> EncoderManager::appliances( void )
+{
+   std::list<Appliance*> apps;
+   if (_fex)
+      apps.push_back(_fex);
+   apps.push_back(&_fsm);
+   return apps;
 }
@@ -5,21 +5,31 @@
 #include "pds/client/Fsm.hh"
 #include "EncoderOccurrence.hh"
 
+#include <list>
+
 namespace Pds {
    class EncoderServer;
    class EncoderManager;
    class EncoderOccurrence;
    class CfgClientNfs;
+   class ChannelFexApp;
 }
 
 class Pds::EncoderManager {
  public:
+   //  "fex" is the ChannelFex settings of the encoder counts (see
+   //  ChannelFex::parse); without them no fex is recorded
    EncoderManager( EncoderServer* server,
-                   CfgClientNfs* cfg );
+                   CfgClientNfs* cfg,
+                   const char* fex=0 );
    Appliance& appliance( void ) { return _fsm; }
+   //  The manager's appliances, in the order EventAppCallback connects them
+   //  (the fex follows the manager's appliance)
+   std::list<Appliance*> appliances( void );
 
  private:
    Fsm& _fsm;
+   ChannelFexApp* _fex;
    static const char* _calibPath;
    EncoderOccurrence* _occSend;
 };
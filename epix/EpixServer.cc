@@ -23,6 +23,7 @@
 #include <string.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <omp.h>
 
 using namespace Pds;
@@ -54,6 +55,9 @@ EpixServer::EpixServer( const Pds::Src& client, unsigned configMask )
      _debug(0),
      _offset(0),
      _unconfiguredErrors(0),
+     _pgpFd(-1),
+     _dmaDriver(0),
+     _dma(0),
      _processorBuffer(0),
      _configured(false),
      _firstFetch(true),
@@ -70,16 +74,21 @@ unsigned EpixServer::configure(EpixConfigType* config, bool forceConfig) {
   unsigned firstConfig = _resetOnEveryConfig || forceConfig;
   if (_cnfgrtr == 0) {
     firstConfig = 1;
-    _cnfgrtr = new Pds::Epix::EpixConfigurator(fd(), _debug);
+    _cnfgrtr = new Pds::Epix::EpixConfigurator(_pgpFd, _debug);
     _cnfgrtr->runTimeConfigName(_runTimeConfigName);
     printf("EpixServer::configure making new configurator %p, firstConfig %u\n", _cnfgrtr, firstConfig);
   }
   _payloadSize = EpixDataType::_sizeof(*config);
-  if (_processorBuffer) free(_processorBuffer);
-  _processorBuffer = (char*) calloc(1, _payloadSize);
-  printf("EpixServer::configure allocated processorBuffer size %u, firstConfig %u\n", _payloadSize, firstConfig);
-  if (!_processorBuffer) {
-    printf("EpixServer::configure FAILED to allocated processor buffer!!!\n");
+  if (_dma == 0) {
+    _dma = new Pds::Pgp::DmaBuffers(new Pds::Pgp::ReadDmaDriver(_pgpFd, ReadBuffers, _payloadSize));
+  } else if (!_dmaDriver && _dma->bufferSize() < _payloadSize) {
+    delete _dma;
+    _dma = new Pds::Pgp::DmaBuffers(new Pds::Pgp::ReadDmaDriver(_pgpFd, ReadBuffers, _payloadSize));
+  }
+  printf("EpixServer::configure receive buffers size %u, payload size %u, firstConfig %u\n",
+      _dma->bufferSize(), _payloadSize, firstConfig);
+  if (_dma->bufferSize() < _payloadSize) {
+    printf("EpixServer::configure FAILED, receive buffers are too small!!!\n");
     return 0xdeadbeef;
   }
   unsigned c = flushInputQueue(fd());
@@ -184,7 +193,7 @@ unsigned Pds::EpixServer::unconfigure(void) {
 
 int Pds::EpixServer::fetch( char* payload, int flags ) {
    int ret = 0;
-   PgpCardRx       pgpCardRx;
+   Pds::Pgp::DmaRx rx;
    unsigned        offset = 0;
    enum {Ignore=-1};
 
@@ -237,12 +246,9 @@ int Pds::EpixServer::fetch( char* payload, int flags ) {
      }
    }
 
-   pgpCardRx.model   = sizeof(&pgpCardRx);
-   pgpCardRx.maxSize = _payloadSize / sizeof(__u32);
-//   pgpCardRx.data    = (__u32*)(payload + offset);
-   pgpCardRx.data   = (__u32*)_processorBuffer;
-
-   if ((ret = read(fd(), &pgpCardRx, sizeof(PgpCardRx))) < 0) {
+   //  The receive buffer is held until its contents are copied into the
+   //  contribution and is then handed back to the card.
+   if ((ret = _dma->receive(rx)) < 0) {
      if (errno == ERESTART) {
        disable();
        char message[400];
@@ -257,17 +263,23 @@ int Pds::EpixServer::fetch( char* payload, int flags ) {
        exit(-ERESTART);
      }
      perror ("EpixServer::fetch pgpCard read error");
-     ret =  Ignore;
+     return Ignore;
+   } else if (ret == 0) {
+     return Ignore;
    } else ret *= sizeof(__u32);
 
-   if (_ignoreFetch) return Ignore;
+   if (_ignoreFetch) {
+     _dma->release(rx.index);
+     return Ignore;
+   }
 
+   _processorBuffer = (char*)_dma->buffer(rx.index);
    Pds::Pgp::DataImportFrame* data = (Pds::Pgp::DataImportFrame*)(_processorBuffer);
 
    if ((ret > 0) && (ret < (int)_payloadSize)) {
      printf("EpixServer::fetch() returning Ignore, ret was %d, looking for %u\n", ret, _payloadSize);
      if ((_debug & 4) || ret < 0) printf("\telementId(%u) frameType(0x%x) acqcount(0x%x) raw_count(%u) _elementsThisCount(%u) lane(%u) vc(%u)\n",
-         data->elementId(), data->_frameType, data->acqCount(), data->frameNumber(), _elementsThisCount, pgpCardRx.pgpLane, pgpCardRx.pgpVc);
+         data->elementId(), data->_frameType, data->acqCount(), data->frameNumber(), _elementsThisCount, rx.lane, rx.vc);
      uint32_t* u = (uint32_t*)data;
      printf("\tDataHeader: "); for (int i=0; i<16; i++) printf("0x%x ", u[i]); printf("\n");
      ret = Ignore;
@@ -276,28 +288,29 @@ int Pds::EpixServer::fetch( char* payload, int flags ) {
    if (ret > (int) _payloadSize) printf("EpixServer::fetch pgp read returned too much _payloadSize(%u) ret(%d)\n", _payloadSize, ret);
 
    unsigned damageMask = 0;
-   if (pgpCardRx.eofe)      damageMask |= 1;
-   if (pgpCardRx.fifoErr)   damageMask |= 2;
-   if (pgpCardRx.lengthErr) damageMask |= 4;
+   if (rx.eofe)      damageMask |= 1;
+   if (rx.fifoErr)   damageMask |= 2;
+   if (rx.lengthErr) damageMask |= 4;
    if (damageMask) {
      damageMask |= 0xe0;
      _xtc.damage.increase(Pds::Damage::UserDefined);
      _xtc.damage.userBits(damageMask);
      printf("EpixServer::fetch setting user damage 0x%x", damageMask);
-     if (pgpCardRx.lengthErr) printf(", rxSize(%zu), maxSize(%u) ret(%d) offset(%u) (bytes)",
-         (unsigned)pgpCardRx.rxSize*sizeof(uint32_t), _payloadSize, ret, offset);
+     if (rx.lengthErr) printf(", rxSize(%zu), maxSize(%u) ret(%d) offset(%u) (bytes)",
+         (unsigned)rx.size*sizeof(uint32_t), _payloadSize, ret, offset);
      printf("\n");
    } else {
      unsigned oldCount = _count;
      _count = data->frameNumber() - 1;  // epix starts counting at 1, not zero
      if ((_debug & 4) || ret < 0) {
        printf("\telementId(%u) frameType(0x%x) acqcount(0x%x) _oldCount(%u) _count(%u) _elementsThisCount(%u) lane(%u) vc(%u)\n",
-           data->elementId(), data->_frameType, data->acqCount(),  oldCount, _count, _elementsThisCount, pgpCardRx.pgpLane, pgpCardRx.pgpVc);
+           data->elementId(), data->_frameType, data->acqCount(),  oldCount, _count, _elementsThisCount, rx.lane, rx.vc);
        uint32_t* u = (uint32_t*)data;
        printf("\tDataHeader: "); for (int i=0; i<16; i++) printf("0x%x ", u[i]); printf("\n");
      }
    }
    process(payload + offset);
+   _dma->release(rx.index);
    if (ret > 0) {
      _elementsThisCount += 1;
      ret += offset;
@@ -323,7 +336,23 @@ unsigned EpixServer::count() const {
   return _count + _offset;
 }
 
+//
+//  Buffers received through the active driver are handed straight back
+//
 unsigned EpixServer::flushInputQueue(int f) {
+  if (_dma && f == _dma->fd()) {
+    unsigned count = 0;
+    Pds::Pgp::DmaRx rx;
+    pollfd pfd;
+    pfd.fd     = f;
+    pfd.events = POLLIN;
+    while(::poll(&pfd, 1, 2) > 0 && _dma->receive(rx) > 0) {
+      _dma->release(rx.index);
+      count += 1;
+    }
+    return count;
+  }
+
   fd_set          fds;
   struct timeval  timeout;
   timeout.tv_sec  = 0;
@@ -348,7 +377,8 @@ unsigned EpixServer::flushInputQueue(int f) {
 }
 
 void EpixServer::setEpix( int f ) {
-  fd( f );
+  _pgpFd = f;
+  if (!_dmaDriver) fd( f );
   Pds::Pgp::RegisterSlaveExportFrame::FileDescr(f);
   if (unsigned c = this->flushInputQueue(f)) {
     printf("EpixServer::setEpix read %u time%s after opening pgpcard driver\n", c, c==1 ? "" : "s");
@@ -358,6 +388,18 @@ void EpixServer::setEpix( int f ) {
 //  }
 }
 
+//
+//  The event builder polls the installed driver's descriptor, so the
+//  driver must be installed before the server is added to the event
+//  builder.  The driver remains the caller's.
+//
+void EpixServer::dmaDriver(Pds::Pgp::DmaDriver* d) {
+  if (_dma) delete _dma;
+  _dmaDriver = d;
+  _dma = new Pds::Pgp::DmaBuffers(d, false);
+  fd( d->fd() );
+}
+
 void EpixServer::clearHisto() {
   for (unsigned i=0; i<sizeOfHisto; i++) {
     _histo[i] = 0;
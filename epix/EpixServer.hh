@@ -19,6 +19,7 @@
 #include "pds/utility/Occurrence.hh"
 #include "pdsdata/xtc/Xtc.hh"
 #include "pds/service/GenericPool.hh"
+#include "pds/pgp/DmaBuffers.hh"
 #include <fcntl.h>
 #include <time.h>
 
@@ -34,7 +35,7 @@ class Pds::EpixServer
 {
  public:
    EpixServer( const Src& client, unsigned configMask=0 );
-   virtual ~EpixServer() {}
+   virtual ~EpixServer() { if (_dma) delete _dma; }
     
    //  Eb interface
    void       dump ( int detail ) const {}
@@ -82,6 +83,8 @@ class Pds::EpixServer
    bool     resetOnEveryConfig() { return _resetOnEveryConfig; }
    void     runTimeConfigName(char*);
    void     resetOnEveryConfig(bool r) { _resetOnEveryConfig = r; }
+   //  Receive through a driver with mapped buffers instead of read()
+   void     dmaDriver(Pds::Pgp::DmaDriver*);
 
  public:
    static EpixServer* instance() { return _instance; }
@@ -92,7 +95,7 @@ class Pds::EpixServer
    static void instance(EpixServer* s) { _instance = s; }
 
  private:
-   enum     {sizeOfHisto=1000, ElementsPerSegmentLevel=1};
+   enum     {sizeOfHisto=1000, ElementsPerSegmentLevel=1, ReadBuffers=2};
    Xtc                            _xtc;
    Pds::Epix::EpixConfigurator* _cnfgrtr;
    unsigned                       _elements;
@@ -112,7 +115,10 @@ class Pds::EpixServer
    EpixManager*                   _mgr;
    GenericPool*                   _occPool;
    unsigned                       _unconfiguredErrors;
-   char*                          _processorBuffer;
+   int                            _pgpFd;     // register access and read()
+   Pds::Pgp::DmaDriver*           _dmaDriver;
+   Pds::Pgp::DmaBuffers*          _dma;
+   char*                          _processorBuffer;  // buffer being processed
    bool                           _configured;
    bool                           _firstFetch;
    bool                           _ignoreFetch;
@@ -21,6 +21,7 @@
 #include "pds/service/Routine.hh"
 #include "pds/service/Task.hh"
 #include "pds/service/TaskObject.hh"
+#include "pds/service/BinaryLog.hh"
 #include "pds/epix100a/Epix100aDestination.hh"
 #include "pdsdata/xtc/DetInfo.hh"
 #include "pgpcard/PgpCardMod.h"
@@ -382,7 +383,7 @@ int Pds::Epix100aServer::fetch( char* payload, int flags ) {
          _scopeHasArrived = true;
        }
      } else {
-       printf("Epix100aServer::fetch ignoring scope buffer %u when not enabled!\n", ++_neScopeCount);
+       PDS_LOG("Epix100aServer::fetch ignoring scope buffer %u when not enabled!", ++_neScopeCount);
      }
      return Ignore;
    }
@@ -393,7 +394,7 @@ int Pds::Epix100aServer::fetch( char* payload, int flags ) {
      Pds::Pgp::DataImportFrame* data = (Pds::Pgp::DataImportFrame*)(_processorBuffer);
 
      if ((ret > 0) && (ret < (int)_payloadSize)) {
-       printf("Epix100aServer::fetch() returning Ignore, ret was %d, looking for %u\n", ret, _payloadSize);
+       PDS_LOG("Epix100aServer::fetch() returning Ignore, ret was %d, looking for %u", ret, _payloadSize);
        if ((_debug & 4) || ret < 0) printf("\telementId(%u) frameType(0x%x) acqcount(0x%x) raw_count(%u) _elementsThisCount(%u) lane(%u) vc(%u)\n",
            data->elementId(), data->_frameType, data->acqCount(), data->frameNumber(), _elementsThisCount, pgpCardRx.pgpLane, pgpCardRx.pgpVc);
        uint32_t* u = (uint32_t*)data;
@@ -401,16 +402,17 @@ int Pds::Epix100aServer::fetch( char* payload, int flags ) {
        ret = Ignore;
      }
 
-     if (ret > (int) _payloadSize) printf("Epix100aServer::fetch pgp read returned too much _payloadSize(%u) ret(%d)\n", _payloadSize, ret);
+     if (ret > (int) _payloadSize) PDS_LOG("Epix100aServer::fetch pgp read returned too much _payloadSize(%u) ret(%d)", _payloadSize, ret);
 
      if (damageMask) {
        damageMask |= 0xe0;
        _xtcEpix.damage.increase(Pds::Damage::UserDefined);
        _xtcEpix.damage.userBits(damageMask);
-       printf("Epix100aServer::fetch setting user damage 0x%x", damageMask);
-       if (pgpCardRx.lengthErr) printf(", rxSize(%zu), payloadSize(%u) ret(%d) offset(%u) (bytes)",
-           (unsigned)pgpCardRx.rxSize*sizeof(uint32_t), _payloadSize, ret, offset);
-       printf("\n");
+       if (pgpCardRx.lengthErr)
+         PDS_LOG("Epix100aServer::fetch setting user damage 0x%x, rxSize(%zu), payloadSize(%u) ret(%d) offset(%u) (bytes)",
+                 damageMask, (unsigned)pgpCardRx.rxSize*sizeof(uint32_t), _payloadSize, ret, offset);
+       else
+         PDS_LOG("Epix100aServer::fetch setting user damage 0x%x", damageMask);
      } else {
        unsigned oldCount = _count;
        _count = data->frameNumber() - 1;  // epix100a starts counting at 1, not zero
@@ -451,14 +453,14 @@ int Pds::Epix100aServer::fetch( char* payload, int flags ) {
              _timeSinceLastException /= 1000000.0;
 //             printf("Epix100aServer::fetch exceptional period %3lld, not %3u, frame %5u, frames since last %5u, ms since last %7.3f, ms/f %6.3f\n",
 //             diff, peak, _count, _fetchesSinceLastException, _timeSinceLastException, (1.0*_timeSinceLastException)/_fetchesSinceLastException);
-             printf("Epix100aServer::fetch exceptional period %3lld, not %3u, frame %5u, frames since last %5u\n",
-                 diff, peak, _count, _fetchesSinceLastException);
+             PDS_LOG("Epix100aServer::fetch exceptional period %3lld, not %3u, frame %5u, frames since last %5u",
+                     diff, peak, _count, _fetchesSinceLastException);
              _timeSinceLastException = 0;
              _fetchesSinceLastException = 0;
            }
          }
        } else {
-         printf("Epix100aServer::fetch Clock backtrack %f ms\n", diff / 1000000.0);
+         PDS_LOG("Epix100aServer::fetch Clock backtrack %f ms", diff / 1000000.0);
        }
 //       if (g3sync() && (data->opCode() != (_lastOpCode + 1)%256)) {
 //         printf("Epix100aServer::fetch opCode mismatch last(%u) this(%u) on frame(0x%x)\n",
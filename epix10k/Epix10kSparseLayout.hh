@@ -0,0 +1,40 @@
+#ifndef Pds_Epix10kSparseLayout_hh
+#define Pds_Epix10kSparseLayout_hh
+
+//
+//  Epix10k frames for the SparseFrameApp.  The pixel maps' ADC mask
+//  should exclude the gain bit(s) of the pixel word.
+//
+
+#include "pds/client/SparseFrameApp.hh"
+#include "pds/config/EpixConfigType.hh"
+#include "pds/config/EpixDataType.hh"
+#include "pdsdata/xtc/Xtc.hh"
+
+#include <string.h>
+
+namespace Pds {
+  class Epix10kSparseLayout : public SparseFrameApp::Layout {
+  public:
+    Epix10kSparseLayout() : _config(0) {}
+    ~Epix10kSparseLayout() { delete[] _config; }
+  public:
+    TypeId   configType() const { return _epix10kConfigType; }
+    TypeId   dataType  () const { return _epixDataType; }
+    unsigned configure (const void* p) {
+      const Epix10kConfigType& c = *reinterpret_cast<const Epix10kConfigType*>(p);
+      delete[] _config;
+      _config = new char[c._sizeof()];
+      memcpy(_config, p, c._sizeof());
+      return c.numberOfRows()*c.numberOfColumns();
+    }
+    const uint16_t* frame(const Xtc& xtc) const {
+      return reinterpret_cast<const EpixDataType*>(xtc.payload())->
+        frame(*reinterpret_cast<const Epix10kConfigType*>(_config)).data();
+    }
+  private:
+    char* _config;
+  };
+}
+
+#endif
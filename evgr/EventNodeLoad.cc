@@ -0,0 +1,145 @@
+#include "pds/evgr/EventNodeLoad.hh"
+
+#include "pds/utility/EventLoad.hh"
+#include "pds/utility/StreamPorts.hh"
+#include "pds/utility/Mtu.hh"
+#include "pds/collection/Route.hh"
+#include "pds/service/Task.hh"
+#include "pds/service/TaskObject.hh"
+
+#include <poll.h>
+#include <stdio.h>
+
+using namespace Pds;
+
+//
+//  The segment levels resolve the vector modulo the number of event nodes,
+//  so a partial set of nodes cannot be balanced.  Beyond MaxNodes the
+//  events are assigned round-robin.
+//
+EventNodeLoad::EventNodeLoad(unsigned nnodes) :
+  _nnodes(nnodes <= unsigned(MaxNodes) ? nnodes : 0)
+{
+  if (nnodes > unsigned(MaxNodes))
+    printf("*** EventNodeLoad cannot balance %u event nodes (max %u); assigning round-robin\n",
+           nnodes, unsigned(MaxNodes));
+
+  for(unsigned i=0; i<MaxNodes; i++) {
+    _inuse   [i] = 0;
+    _assigned[i] = 0;
+    _stamp   [i].tv_sec = _stamp[i].tv_nsec = 0;
+    _selected[i] = 0;
+  }
+}
+
+EventNodeLoad::~EventNodeLoad()
+{
+}
+
+void EventNodeLoad::report(unsigned node, unsigned inuse)
+{
+  if (node >= _nnodes)
+    return;
+  _inuse   [node] = inuse;
+  _assigned[node] = 0;
+  clock_gettime(CLOCK_MONOTONIC, &_stamp[node]);
+}
+
+unsigned EventNodeLoad::select(unsigned count)
+{
+  if (_nnodes < 2)
+    return 0;
+
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  unsigned first = count % _nnodes;
+  unsigned best  = first;
+  unsigned bestLoad = -1U;
+  for(unsigned i=0; i<_nnodes; i++) {
+    unsigned node = first + i;
+    if (node >= _nnodes) node -= _nnodes;
+    long age = (now.tv_sec - _stamp[node].tv_sec)*1000 +
+      (now.tv_nsec - _stamp[node].tv_nsec)/1000000;
+    unsigned load = _assigned[node] + (age < StaleTime ? _inuse[node] : 0);
+    if (load < bestLoad) {
+      bestLoad = load;
+      best     = node;
+    }
+  }
+  _assigned[best]++;
+  _selected[best]++;
+  return best;
+}
+
+unsigned EventNodeLoad::vector(unsigned count)
+{
+  return _nnodes < 2 ? count : count - count%_nnodes + select(count);
+}
+
+void EventNodeLoad::dump() const
+{
+  printf("EventNodeLoad node : inuse assigned selected\n");
+  for(unsigned i=0; i<_nnodes; i++)
+    printf("  %2u : %4u %4u %u\n", i, _inuse[i], _assigned[i], _selected[i]);
+}
+
+
+EventLoadServer::EventLoadServer(unsigned       partition,
+                                 EventNodeLoad& load) :
+  _group   (StreamPorts::eventLoad(partition)),
+  _server  ((unsigned)-1,
+            _group,
+            sizeof(EventLoad),
+            Mtu::Size),
+  _loopback(sizeof(EventLoad)),
+  _load    (load),
+  _sem     (Semaphore::EMPTY),
+  _task    (new Task(TaskObject("evtload")))
+{
+  _server.join(_group,Ins(Route::interface()));
+  _task->call(this);
+}
+
+EventLoadServer::~EventLoadServer()
+{
+  EventLoad dgram;
+  _loopback.unblock(reinterpret_cast<char*>(&dgram));
+  _sem.take();
+  _task->destroy();
+}
+
+void EventLoadServer::routine()
+{
+  const int bsiz = 256;
+  char* payload = new char[bsiz];
+
+  int nfds = 2;
+
+  pollfd* pfd = new pollfd[2];
+  pfd[0].fd = _server.socket();
+  pfd[0].events = POLLIN | POLLERR | POLLHUP;
+  pfd[0].revents = 0;
+  pfd[1].fd = _loopback.fd();
+  pfd[1].events = POLLIN | POLLERR | POLLHUP;
+  pfd[1].revents = 0;
+
+  while(::poll(pfd, nfds, -1) > 0) {
+    if (pfd[0].revents & (POLLIN | POLLERR)) {
+      int len = _server.fetch( payload, 0 );
+      if (len ==0) {
+        const EventLoad* load = reinterpret_cast<const EventLoad*>(_server.datagram());
+        _load.report(load->node(), load->inuse());
+      }
+    }
+    if (pfd[1].revents & (POLLIN | POLLERR)) {
+      _sem.give();
+      break;
+    }
+    pfd[0].revents = 0;
+    pfd[1].revents = 0;
+  }
+
+  delete[] pfd;
+  delete[] payload;
+}
@@ -0,0 +1,77 @@
+#ifndef Pds_EventNodeLoad_hh
+#define Pds_EventNodeLoad_hh
+
+//
+//  Load-aware choice of the event node for each L1Accept.
+//
+//  Event levels report their event buffer occupancy (EventLoad) to the master
+//  EVR.  The load of a node is its last reported occupancy plus the events
+//  assigned to it since that report; a report older than StaleTime is
+//  assumed to have drained.  Each event goes to the least loaded node with
+//  ties broken round-robin from the event counter.
+//
+//  The choice is encoded in the L1Accept vector as
+//
+//    vector = count - count%nnodes + node
+//
+//  so that every segment level resolves (vector % nnodes) to the same node.
+//  More than MaxNodes event nodes are not balanced: the vector is the
+//  count, as without load balancing.
+//
+
+#include "pds/service/Routine.hh"
+#include "pds/service/Ins.hh"
+#include "pds/service/NetServer.hh"
+#include "pds/service/OobPipe.hh"
+#include "pds/service/Semaphore.hh"
+
+#include <time.h>
+
+namespace Pds {
+
+  class Task;
+
+  class EventNodeLoad {
+  public:
+    enum { MaxNodes = 32 };
+    enum { StaleTime = 250 };  // msec
+  public:
+    EventNodeLoad(unsigned nnodes);
+    ~EventNodeLoad();
+  public:
+    ///  Record an occupancy report from an event node
+    void     report(unsigned node, unsigned inuse);
+    ///  Choose the node for event "count"
+    unsigned select(unsigned count);
+    ///  Choose the node and return the encoded vector
+    unsigned vector(unsigned count);
+    unsigned nnodes() const { return _nnodes; }
+    void     dump  () const;
+  private:
+    unsigned          _nnodes;
+    volatile unsigned _inuse   [MaxNodes];
+    volatile unsigned _assigned[MaxNodes];
+    timespec          _stamp   [MaxNodes];
+    unsigned          _selected[MaxNodes];
+  };
+
+  //
+  //  Receives the load reports of a partition's event nodes
+  //
+  class EventLoadServer : public Routine {
+  public:
+    EventLoadServer(unsigned partition, EventNodeLoad& load);
+    virtual ~EventLoadServer();
+  public:
+    void routine();
+  private:
+    Ins            _group;
+    NetServer      _server;
+    OobPipe        _loopback;
+    EventNodeLoad& _load;
+    Semaphore      _sem;
+    Task*          _task;
+  };
+};
+
+#endif
@@ -43,6 +43,7 @@
 using namespace Pds;
 
 static bool _randomize_nodes = false;
+static bool _load_balance    = false;
 static EvrFIFOHandler* _fifo_handler;
 
 static EvgrBoardInfo < Evr > *erInfoGlobal; // yuck
@@ -267,7 +268,7 @@ public:
           (_pWire)->add_input_nonblocking(_pSrv);
         }
 
-        _fifo_handler = new EvrMasterFIFOHandler(
+        EvrMasterFIFOHandler* master = new EvrMasterFIFOHandler(
                    _er,
                    _src,
                    _app,
@@ -279,8 +280,9 @@ public:
                    _randomize_nodes,
                    _task,
                    _vmon);
-
-
+        if (_load_balance)
+          master->load_balance(alloc.allocation().partitionid());
+        _fifo_handler = master;
       }
       else
       {
@@ -453,3 +455,5 @@ void EvrManager::sigintHandler(int sig_no)
 }
 
 void EvrManager::randomize_nodes(bool v) { _randomize_nodes=v; }
+
+void EvrManager::load_balance(bool v) { _load_balance=v; }
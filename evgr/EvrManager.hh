@@ -27,6 +27,7 @@ namespace Pds {
     // SIGINT handler
     static void sigintHandler(int);
     static void randomize_nodes(bool);
+    static void load_balance   (bool);
 
     Appliance&  appliance();
     Server&     server();
@@ -6,10 +6,12 @@
 #include <semaphore.h>
 #include <stdlib.h>
 #include <math.h>
+#include <vector>
 
 #include "EvrSimManager.hh"
 #include "EvrFifoServer.hh"
 #include "EvrTimer.hh"
+#include "EventNodeLoad.hh"
 
 #include "pds/client/Fsm.hh"
 #include "pds/client/Action.hh"
@@ -31,11 +33,13 @@
 #include "pds/service/Ins.hh"
 #include "pds/collection/Route.hh"
 #include "pds/utility/StreamPorts.hh"
+#include "pds/utility/EventLoad.hh"
 
 #include "pdsdata/xtc/DetInfo.hh"
 #include "pdsdata/xtc/TimeStamp.hh"
 
 static bool _randomize_nodes = false;
+static std::vector<double> _sim_service;  // simulated event node service times [sec]
 
 static const int      giMaxEventCodes   = 64; // max number of event code configurations
 static const int      giMaxPulses       = 10; 
@@ -116,6 +120,97 @@ namespace Pds {
 
   void Cancel::routine() { _timer._continue=false; _sem.give(); }
 
+  //
+  //  Model of the partition's event nodes.  Each node holds up to "depth"
+  //  events and completes one every "service" seconds.  An event assigned
+  //  to a full node would time out in the segment levels; it is counted as
+  //  damaged.
+  //
+  class SimEventNodes {
+  public:
+    SimEventNodes(const std::vector<double>& service, unsigned depth) :
+      _service(service),
+      _queue  (service.size(),0),
+      _next   (service.size(),0),
+      _depth  (depth),
+      _damaged(0) {}
+  public:
+    void advance(double t)
+    {
+      for(unsigned i=0; i<_queue.size(); i++)
+        while(_queue[i] && _next[i] <= t) {
+          _queue[i]--;
+          _next [i] += _service[i];
+        }
+    }
+    void assign (unsigned node, double t)
+    {
+      if (_queue[node] >= _depth) {
+        _damaged++;
+        return;
+      }
+      if (_queue[node]++ == 0)
+        _next[node] = t + _service[node];
+    }
+    void     reset  () { _damaged=0; }
+    unsigned inuse  (unsigned node) const { return _queue[node]; }
+    unsigned damaged() const { return _damaged; }
+  private:
+    std::vector<double>   _service;
+    std::vector<unsigned> _queue;
+    std::vector<double>   _next;
+    unsigned              _depth;
+    unsigned              _damaged;
+  };
+
+  //
+  //  Runs the EVR's trigger stream through two models of the event nodes:
+  //  one assigned round-robin (as the vectors are sent) and one assigned
+  //  by EventNodeLoad from periodic occupancy reports.
+  //
+  class SimNodeLoad {
+  public:
+    enum { Depth = 16, PrintPeriod = 1000 };
+  public:
+    SimNodeLoad(const std::vector<double>& service) :
+      _rr    (service, Depth),
+      _lb    (service, Depth),
+      _load  (service.size()),
+      _report(0),
+      _events(0) {}
+  public:
+    void event(unsigned count, double t)
+    {
+      unsigned nnodes = _load.nnodes();
+      _rr.advance(t);
+      _rr.assign (count%nnodes, t);
+
+      _lb.advance(t);
+      if (t - _report > 1.e-3*EventLoadReporter::MinInterval) {
+        for(unsigned i=0; i<nnodes; i++)
+          _load.report(i, _lb.inuse(i));
+        _report = t;
+      }
+      _lb.assign(_load.select(count), t);
+
+      if (++_events%PrintPeriod == 0)
+        printf("SimEvr node model [%u events] damaged : round-robin %u  load-aware %u\n",
+               _events, _rr.damaged(), _lb.damaged());
+    }
+    void reset()
+    {
+      _rr.reset();
+      _lb.reset();
+      _events = 0;
+    }
+  private:
+    SimEventNodes _rr;
+    SimEventNodes _lb;
+    EventNodeLoad _load;
+    double        _report;
+    unsigned      _events;
+  };
+
   class SimEvr : public Routine {
   public:
     SimEvr(EvrFifoServer& srv,
@@ -125,8 +220,9 @@ namespace Pds {
 				  _done    (done),
 				  _count   (0),
 				  _fiducial(0),
-				  _swtrig_out(0) {}
-    ~SimEvr() {}
+				  _swtrig_out(0),
+				  _sim     (0) {}
+    ~SimEvr() { if (_sim) delete _sim; }
   public:
     void     allocate (const Allocation& alloc) 
     {
@@ -167,8 +263,13 @@ namespace Pds {
 	}
       }
       _lmaster = lmaster;
+
+      if (_sim) delete _sim;
+      _sim = 0;
+      if (_lmaster && !_sim_service.empty())
+	_sim = new SimNodeLoad(_sim_service);
     }
-    void     reset  () { _count=0; }
+    void     reset  () { _count=0; if (_sim) _sim->reset(); }
     void     configure(unsigned prescale) { _duration=double(prescale)/119e6; }
     void     enable   (unsigned events) 
     {
@@ -193,6 +294,9 @@ namespace Pds {
       EvrDatagram datagram(seq, _count, 0);
       
       _srv.post(_count, _fiducial); 
+
+      if (_sim)
+	_sim->event(_count, double(ts.tv_sec)+1.e-9*double(ts.tv_nsec));
       
       datagram.setL1AcceptEnv((1<<_ldst.size())-1);
       datagram.evr = _count;
@@ -229,6 +333,7 @@ namespace Pds {
     unsigned       _evt_stop;
     ToNetEb*       _swtrig_out;
     Ins            _swtrig_dst;
+    SimNodeLoad*   _sim;
   };
 
   class EvrSimEnableAction:public Action
@@ -538,3 +643,26 @@ EvrSimManager::~EvrSimManager()
 
 void EvrSimManager::randomize_nodes(bool v) { _randomize_nodes=v; }
 
+void EvrSimManager::simulate_nodes(const char* arg)
+{
+  _sim_service.clear();
+  if (!arg) return;
+
+  const char* p = arg;
+  char* endPtr;
+  while(*p) {
+    double ms = strtod(p, &endPtr);
+    if (endPtr == p) {
+      printf("*** EvrSimManager::simulate_nodes bad service time list \"%s\"\n", arg);
+      _sim_service.clear();
+      return;
+    }
+    _sim_service.push_back(1.e-3*ms);
+    p = (*endPtr==',') ? endPtr+1 : endPtr;
+  }
+  if (_sim_service.size() < 2 || _sim_service.size() > unsigned(EventNodeLoad::MaxNodes)) {
+    printf("*** EvrSimManager::simulate_nodes needs 2-%u event nodes\n", unsigned(EventNodeLoad::MaxNodes));
+    _sim_service.clear();
+  }
+}
+
@@ -21,6 +21,9 @@ namespace Pds {
     // SIGINT handler
     static void sigintHandler(int);
     static void randomize_nodes(bool);
+    //  Model the event nodes with these service times [ms], e.g. "2,2,2,8",
+    //  and report the damage under round-robin and load-aware assignment
+    static void simulate_nodes (const char*);
     
     Appliance&  appliance();
     Server&     server();
@@ -1,6 +1,7 @@
 #include "pds/evgr/MasterFIFOHandler.hh"
 #include "pds/evgr/EvrFifoServer.hh"
 #include "pds/evgr/EvrTimer.hh"
+#include "pds/evgr/EventNodeLoad.hh"
 
 #include "pds/utility/Mtu.hh"
 #include "pds/xtc/EvrDatagram.hh"
@@ -86,6 +87,8 @@ MasterFIFOHandler::MasterFIFOHandler(Evr&       er,
   _iMaxGroup          (iMaxGroup),
   _nnodes             (neventnodes),
   _randomize_nodes    (randomize),
+  _load               (0),
+  _load_server        (0),
   _validateFiducial   (true),
   _full               (false),
   _vmon               (vmon)
@@ -107,9 +110,23 @@ MasterFIFOHandler::MasterFIFOHandler(Evr&       er,
 
 MasterFIFOHandler::~MasterFIFOHandler()
 {
+  if (_load_server) delete _load_server;
+  if (_load)        delete _load;
   delete _done;
 }
 
+void MasterFIFOHandler::load_balance(unsigned partition)
+{
+  if (_nnodes < 2) return;
+  if (_nnodes > unsigned(EventNodeLoad::MaxNodes)) {
+    printf("*** MasterFIFOHandler cannot balance %u event nodes (max %u); assigning round-robin\n",
+           _nnodes, unsigned(EventNodeLoad::MaxNodes));
+    return;
+  }
+  _load        = new EventNodeLoad(_nnodes);
+  _load_server = new EventLoadServer(partition, *_load);
+}
+
 InDatagram* MasterFIFOHandler::l1accept(InDatagram* in)
 {
   InDatagram* out = in;
@@ -302,7 +319,10 @@ void MasterFIFOHandler::startL1Accept(const FIFOEvent& fe, bool bEvrDataIncomple
     }
 
   unsigned vector;
-  if (_randomize_nodes) {
+  if (_load) {
+    vector = _load->vector(_evtCounter);
+  }
+  else if (_randomize_nodes) {
     //
     //  Schedule the event node destinations for the next batch of events
     //
@@ -35,6 +35,8 @@ namespace Pds {
   class EvrFifoServer;
   class EvrTimer;
   class VmonEvr;
+  class EventNodeLoad;
+  class EventLoadServer;
 
   class MasterFIFOHandler : public EvrFIFOHandler {
   public:
@@ -50,6 +52,9 @@ namespace Pds {
                       Task*    task,
                       VmonEvr& vmon);
     virtual ~MasterFIFOHandler();
+  public:
+    ///  Assign events to the least loaded event node
+    void                load_balance(unsigned partition);
   public:
     ///  EvrFIFOHandler interface
     virtual void        fifo_full   ();
@@ -122,6 +127,9 @@ namespace Pds {
     unsigned              _nnodes;
     bool                  _randomize_nodes;
     int                   _vector[MAX_NODES];
+    /// Load-aware assignment
+    EventNodeLoad*        _load;
+    EventLoadServer*      _load_server;
     // 
     bool                  _validateFiducial;
     bool                  _full;
@@ -0,0 +1,53 @@
+#ifndef Pds_Gsc16aiFexKernel_hh
+#define Pds_Gsc16aiFexKernel_hh
+
+//
+//  ChannelFex kernel for the 16AI32SSC ADC.  The codes of the configured
+//  channels are converted to volts with the configured range and data
+//  format; the calibration from the kernel's settings is applied to the
+//  volts.
+//
+
+#include "pds/client/ChannelFex.hh"
+#include "pds/config/Gsc16aiConfigType.hh"
+#include "pds/config/Gsc16aiDataType.hh"
+
+namespace Pds {
+  class Gsc16aiFexKernel {
+  public:
+    enum { NChannels = 32 };
+    typedef Gsc16aiDataType                Data;
+    typedef Gsc16aiConfigType              Config;
+    typedef ChannelFexValues<NChannels>    Result;
+  public:
+    static TypeId   dataType   () { return _gsc16aiDataType; }
+    static TypeId   configType () { return _gsc16aiConfigType; }
+    static TypeId   resultType () { return TypeId(TypeId::Any, Result::Version); }
+    static bool     calibration(const Config&, double*, double*) { return false; }
+    static unsigned raw        (const Config& c, const Data& d, double* v) {
+      unsigned n = c.lastChan() >= c.firstChan() ? c.lastChan()-c.firstChan()+1 : 0;
+      if (n > NChannels) n = NChannels;
+
+      double range;
+      switch(c.voltageRange()) {
+      case Gsc16aiConfigType::VoltageRange_5V  : range = 5  ; break;
+      case Gsc16aiConfigType::VoltageRange_2_5V: range = 2.5; break;
+      default                                  : range = 10 ; break;
+      }
+      const double lsb = range/32768.;
+      const ndarray<const uint16_t,1> code = d.channelValue(c);
+      if (c.dataFormat()==Gsc16aiConfigType::DataFormat_OffsetBinary)
+        for(unsigned i=0; i<n; i++)
+          v[i] = (int(code[i])-32768)*lsb;
+      else
+        for(unsigned i=0; i<n; i++)
+          v[i] = int16_t(code[i])*lsb;
+      for(unsigned i=n; i<NChannels; i++)
+        v[i] = 0;
+      return n;
+    }
+    static unsigned result     (const double* v, unsigned n, Result& r) { return r.fill(v,n); }
+  };
+};
+
+#endif
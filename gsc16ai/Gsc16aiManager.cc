@@ -11,6 +11,8 @@
 #include "pds/xtc/CDatagram.hh"
 #include "pds/client/Fsm.hh"
 #include "pds/client/Action.hh"
+#include "pds/client/ChannelFexApp.hh"
+#include "pds/gsc16ai/Gsc16aiFexKernel.hh"
 #include "pds/config/Gsc16aiConfigType.hh"
 #include "Gsc16aiManager.hh"
 #include "Gsc16aiServer.hh"
@@ -204,10 +206,20 @@ Appliance& Gsc16aiManager::appliance()
   return _fsm;
 }
 
+std::list<Appliance*> Gsc16aiManager::appliances()
+{
+  std::list<Appliance*> apps;
+  if (_fex)
+    apps.push_back(_fex);
+  apps.push_back(&_fsm);
+  return apps;
+}
+
 
 Gsc16aiManager::Gsc16aiManager( Gsc16aiServer* server,
-                                CfgClientNfs* cfg )
-   : _fsm(*new Fsm)
+                                CfgClientNfs* cfg,
+                                const char* fex )
+   : _fsm(*new Fsm), _fex(0)
 {
   printf("%s being initialized...\n", __FUNCTION__);
 
@@ -237,4 +249,16 @@ Gsc16aiManager::Gsc16aiManager( Gsc16aiServer* server,
  _fsm.callback( TransitionId::L1Accept, &gsc16aiL1 );
  _fsm.callback( TransitionId::BeginCalibCycle,
                 new Gsc16aiBeginCalibCycleAction( cfg, server ) );
+
+  if (fex) {
+    ChannelFex<Gsc16aiFexKernel>* kernel = new ChannelFex<Gsc16aiFexKernel>;
+    if (kernel->settings(fex)) {
+      printf("*** %s: bad fex settings \"%s\"\n", __FUNCTION__, fex);
+      delete kernel;
+    }
+    else {
+      _fex = new ChannelFexApp;
+      _fex->add(kernel);
+    }
+  }
 }
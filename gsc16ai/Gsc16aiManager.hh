@@ -5,21 +5,31 @@
 #include "pds/client/Fsm.hh"
 #include "Gsc16aiOccurrence.hh"
 
+#include <list>
+
 namespace Pds {
   class Gsc16aiServer;
   class Gsc16aiManager;
   class Gsc16aiOccurrence;
   class CfgClientNfs;
+  class ChannelFexApp;
 }
 
 class Pds::Gsc16aiManager {
   public:
+    //  "fex" is the ChannelFex settings of the channels in volts (see
+    //  ChannelFex::parse); without them no fex is recorded
     Gsc16aiManager(Gsc16aiServer* server,
-                   CfgClientNfs* cfg);
+                   CfgClientNfs* cfg,
+                   const char* fex=0);
     Appliance& appliance(void);
+    //  The manager's appliances, in the order EventAppCallback connects them
+    //  (the fex follows the manager's appliance)
+    std::list<Appliance*> appliances(void);
 
   private:
     Fsm&                _fsm;
+    ChannelFexApp*      _fex;
     static const char*  _calibPath;
     Gsc16aiOccurrence*  _occSend;
 };
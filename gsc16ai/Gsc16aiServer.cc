@@ -10,169 +10,99 @@
 using namespace Pds;
 
 Pds::Gsc16aiServer::Gsc16aiServer( const Src& client )
-   : _xtc( _gsc16aiDataType, client ),
+   : AsyncReadout<Gsc16aiReadout>( client, _gsc16aiDataType, BufferDepth, "Gsc16ai" ),
      _adc(NULL),
-     _occSend(NULL),
-     _outOfOrder(0),
-     _buffer(new vector<BufferElement>(BufferDepth)),
-     _shutdownFlag(false),
-     _task(new Task(TaskObject("waitevent")))
+     _occSend(NULL)
 {
-  // create pipe
-  int err = ::pipe(_pfd);
-  if (err) {
-    fprintf(stderr, "%s pipe error: %s\n", __FUNCTION__, strerror(errno));
-  } else {
-    // setup to read from pipe
-    fd(_pfd[0]);
-    // call routine() in separate task
-    _task->call(this);
-  }
 }
 
-// consider calling _task->destroy() in destructor
-
-int Pds::Gsc16aiServer::payloadComplete(vector<BufferElement>::iterator buf_iter)
+bool Pds::Gsc16aiServer::_ready()
 {
-  int rv;
-  command_t sendCommand;
-
-  sendCommand.cmd = Payload;
-  sendCommand.buf_iter = buf_iter;
-
-  rv = ::write(_pfd[1],&sendCommand,sizeof(sendCommand));
-  if (rv == -1) {
-    fprintf(stderr, "%s write error: %s\n", __FUNCTION__, strerror(errno));
-  }
-  return (rv);
+  return _adc && _adc->get_isOpen();
 }
 
-void Pds::Gsc16aiServer::routine()
+int Pds::Gsc16aiServer::read(Gsc16aiReadout& buf)
 {
-  timespec sleepTime = {0, 100000000u};  // 0.1 sec
-  int waitResult;
-  vector<BufferElement>::iterator buf_iter;
+  // Wait for data
+  int waitResult = _adc->waitEventInBufThrL2H(500);     // half second timeout
 
-  while (1) {
-    // Wait for ADC to be opened
-    if (_adc && _adc->get_isOpen()) {
-      break;
-    }
-    nanosleep(&sleepTime, NULL);
+  if (waitResult == gsc16ai_dev::waitEventTimeout) {
+    return (0);
+  } else if (waitResult != gsc16ai_dev::waitEventReady) {
+    fprintf(stderr, "Error: waitEventInBufThrL2H() returned %d\n", waitResult);
+    return (-1);
   }
 
-  while (1) {
-    for (buf_iter = _buffer->begin(); buf_iter != _buffer->end(); ) {
-      // Wait for data
-      waitResult = _adc->waitEventInBufThrL2H(500);     // half second timeout
-
-      if (_shutdownFlag) {
-        // exit the task
-        goto routine_shutdown;
-      }
-
-      if (waitResult == gsc16ai_dev::waitEventReady) {
-        // detected event...
+  // ...read the data from ADC
+  int fifoDataSize = sizeof(buf._channelValue);
+  int fdadc = _adc->get_fd();
 
-        if (buf_iter->_full) {
-          // buffer is full: error
-          fprintf(stderr, "Error: buffer overrun in %s\n", __PRETTY_FUNCTION__);
-          if (_occSend) {
-            // send occurrence
-            _occSend->outOfOrder();
-            _occSend->userMessage("Gsc16ai: Buffer overrun\n");
-          }
-          // exit the task
-          goto routine_shutdown;
-
-        } else {
-          // buffer is empty: mark it as full
-          buf_iter->_full = true;
-        }
-
-        // ...read the data from ADC
-        int fifoDataSize = sizeof(buf_iter->_channelValue);
-        int fdadc = _adc->get_fd();
-
-        int rv = read(fdadc, (void *)(buf_iter->_channelValue), fifoDataSize);
-        if (rv == -1) {
-          perror ("read");
-          // exit the task
-          goto routine_shutdown;
-        }
+  int rv = ::read(fdadc, (void *)(buf._channelValue), fifoDataSize);
+  if (rv == -1) {
+    perror ("read");
+    return (-1);
+  }
 
-        if (rv != fifoDataSize) {
-          fprintf(stderr, "Error: %s requested %d bytes, read() returned %d\n",
-                  __FUNCTION__, fifoDataSize, rv);
-          // exit the task
-          goto routine_shutdown;
-        }
+  if (rv != fifoDataSize) {
+    fprintf(stderr, "Error: %s requested %d bytes, read() returned %d\n",
+            __FUNCTION__, fifoDataSize, rv);
+    return (-1);
+  }
 
-        // verify that first channel flag is set
-        if ((buf_iter->_channelValue[1] & 0x8000) != 0x8000) {
-          if (!_outOfOrder) {
-            // latch error
-            _outOfOrder = 1;
-            fprintf(stderr, "Error: first channel flag not set; data could be out-of-order\n");
-            if (_occSend) {
-              // send occurrence
-              _occSend->outOfOrder();
-              _occSend->userMessage("Gsc16ai: First channel flag not set\n");
-            }
-          }
-          // exit the task
-          goto routine_shutdown;
-        }
+  // verify that first channel flag is set
+  if ((buf._channelValue[1] & 0x8000) != 0x8000) {
+    fprintf(stderr, "Error: first channel flag not set; data could be out-of-order\n");
+    if (_occSend) {
+      // send occurrence
+      _occSend->outOfOrder();
+      _occSend->userMessage("Gsc16ai: First channel flag not set\n");
+    }
+    return (-1);
+  }
 
-        // verify that FIFO is empty
-        int bufLevel = _adc->get_bufLevel();
-        if (bufLevel > 0) {
-          if (!_outOfOrder) {
-            // latch error
-            _outOfOrder = 1;
-            if (_occSend) {
-              // send occurrence
-              _occSend->outOfOrder();
-              _occSend->userMessage("Gsc16ai: FIFO not empty after read\n");
-            }
-            fprintf(stderr, "Error: FIFO level nonzero (%d) after read; data could be out-of-order\n",
-                    bufLevel);
-          }
-          // exit the task
-          goto routine_shutdown;
-        }
+  // verify that FIFO is empty
+  int bufLevel = _adc->get_bufLevel();
+  if (bufLevel > 0) {
+    if (_occSend) {
+      // send occurrence
+      _occSend->outOfOrder();
+      _occSend->userMessage("Gsc16ai: FIFO not empty after read\n");
+    }
+    fprintf(stderr, "Error: FIFO level nonzero (%d) after read; data could be out-of-order\n",
+            bufLevel);
+    return (-1);
+  }
 
-        // timestamp support
-        if (!_timeTagEnable) {
-          // when hw timestamp feature is not configured, use sw clock for timestamp
-          timespec ts;
-          clock_gettime(CLOCK_REALTIME, &ts);
-          buf_iter->_timestamp[0] = (uint16_t) (ts.tv_sec % 3600);  // sec modulo 1hr
-          buf_iter->_timestamp[1] = (uint16_t) (ts.tv_nsec >> 16);  // nsec upper half
-          buf_iter->_timestamp[2] = (uint16_t) ts.tv_nsec;          // nsec lower half
-        }
+  // timestamp support
+  if (!_timeTagEnable) {
+    // when hw timestamp feature is not configured, use sw clock for timestamp
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    buf._timestamp[0] = (uint16_t) (ts.tv_sec % 3600);  // sec modulo 1hr
+    buf._timestamp[1] = (uint16_t) (ts.tv_nsec >> 16);  // nsec upper half
+    buf._timestamp[2] = (uint16_t) ts.tv_nsec;          // nsec lower half
+  }
 
-        // ...send notification
-        payloadComplete(buf_iter);
+  return (rv);
+}
 
-        // ...advance to next buffer, then wait again
-        buf_iter++;
-        continue;
+int Pds::Gsc16aiServer::decode(Gsc16aiReadout& buf, char* payload, Damage& damage)
+{
+  int nChans = _lastChan - _firstChan + 1;
 
-      } else if (waitResult == gsc16ai_dev::waitEventTimeout) {
-        // ...wait again
-        continue;
+  Gsc16aiDataType *frame = (Gsc16aiDataType *)payload;
 
-      } else {
-        fprintf(stderr, "Error: waitEventInBufThrL2H() returned %d\n", waitResult);
-      }
-      // an error occured.  delay to avoid spinning too fast.
-      nanosleep(&sleepTime, NULL);
-    }   // end of for(...)
-  }   // end of while(1)
+  // copy the configured channels
+  { uint16_t* ts = reinterpret_cast<uint16_t*>(frame);
+    for(int i=0; i<3; i++)
+      ts[i] = buf._timestamp[i];
+  }
+  { uint16_t* cv = reinterpret_cast<uint16_t*>(frame+1);
+    for (int ii = 0; ii < nChans; ii++)
+      cv[ii] = buf._channelValue[(_firstChan + ii) * 2];
+  }
 
-routine_shutdown:
-  printf("\n ** %s shutdown **\n", __PRETTY_FUNCTION__);
+  return (Gsc16aiDataType::_sizeof(_config));
 }
 
 unsigned Pds::Gsc16aiServer::configure(const Gsc16aiConfigType& config)
@@ -180,7 +110,6 @@ unsigned Pds::Gsc16aiServer::configure(const Gsc16aiConfigType& config)
   unsigned numErrs = 0;
 
   _config     = config; 
-  _count      = 0;
   _firstChan  = config.firstChan();
   _lastChan   = config.lastChan();
   _timeTagEnable = config.timeTagEnable();
@@ -209,75 +138,10 @@ unsigned Pds::Gsc16aiServer::configure(const Gsc16aiConfigType& config)
 
 unsigned Pds::Gsc16aiServer::unconfigure(void)
 {
-  _count = 0;
+  stop();
   return ((unsigned) _adc->unconfigure());
 }
 
-int Pds::Gsc16aiServer::fetch( char* payload, int flags )
-{
-  command_t receiveCommand;
-  int extraChans = _lastChan - _firstChan;
-
-  if (_outOfOrder) {
-    // error condition is latched
-    return (-1);
-  }
-
-  Gsc16aiDataType *frame = (Gsc16aiDataType *)(payload + sizeof(Xtc));
-
-  // calculate extent maintaining longword alignment
-  _xtc.extent = (sizeof(Xtc) + Gsc16aiDataType::_sizeof(_config) + 3) & ~0x3;
-
-  memcpy(payload, &_xtc, sizeof(Xtc));  // copy after adjusting extent
-
-  // read from pipe
-  int length = ::read(_pfd[0], &receiveCommand, sizeof(receiveCommand));
-
-  if (length != sizeof(receiveCommand)) {
-    fprintf(stderr, "Error: read() returned %d in %s\n", length, __FUNCTION__);
-    return (-1);
-  } else if (receiveCommand.cmd == Payload) {
-    vector<BufferElement>::iterator buf_iter = receiveCommand.buf_iter;
-
-    // if first channel is not 0, relocate it
-    if (_firstChan) {
-      buf_iter->_channelValue[0] = buf_iter->_channelValue[_firstChan * 2];
-    }
-
-    // if multiple channels are configured, relocate them
-    if (extraChans > 0) {
-      for (int ii = 1; ii <= extraChans; ii++) {
-        buf_iter->_channelValue[ii] = buf_iter->_channelValue[(_firstChan + ii) * 2];
-      }
-    }
-
-    // copy the received data
-    { uint16_t* cv = reinterpret_cast<uint16_t*>(frame+1);
-      for (int ii = 0; ii < extraChans + 1; ii++)
-        cv[ii] = buf_iter->_channelValue[ii];
-    }      
-    { uint16_t* ts = reinterpret_cast<uint16_t*>(frame);
-      for(int i=0; i<3; i++)
-        ts[i] = buf_iter->_timestamp[i];
-    }
-
-    // mark buffer as empty
-    buf_iter->_full = false;
-
-    // success
-    ++_count;
-    return (_xtc.extent);
-  } else {
-    printf("Unknown command (0x%x) in %s\n", receiveCommand.cmd, __FUNCTION__);
-    return (-1);
-  }
-}
-
-unsigned Gsc16aiServer::count() const
-{
-  return (_count-1);
-}
-
 void Gsc16aiServer::setAdc(gsc16ai_dev* adc)
 {
   _adc = adc;
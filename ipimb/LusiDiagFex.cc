@@ -11,28 +11,13 @@
 #include "pdsdata/xtc/DetInfo.hh"
 
 #include <new>
-
-namespace Pds {
-  class IpimbCapSetting {
-  public:
-    int ndiodes;
-    int cap[4];
-  };
-};
+#include <stdio.h>
 
 using namespace Pds;
 
 static const int OutSize = 0x800;
 static const int OutEntries = 32;
-static const int max_configs=32;
-
-#define IS_IPM(det) (_cap_config[det].ndiodes >1)
-#define IS_PIM(det) (_cap_config[det].ndiodes==1)
-#define SET_IPM(det) (_cap_config[det].ndiodes=4)
-#define SET_PIM(det) (_cap_config[det].ndiodes=1)
-
-static inline unsigned ipmIndex(unsigned det) { return det; }
-static inline unsigned pimIndex(unsigned det) { return det; }
+static const int max_configs=LusiDiagFexEngine::MaxDetectors;
 
 typedef Pds::Lusi::IpmFexV1 IpmFexType;
 static  Pds::TypeId _ipmFexType(Pds::TypeId::Id_IpmFex, IpmFexType::Version);
@@ -43,22 +28,20 @@ static  Pds::TypeId _diodeFexType(Pds::TypeId::Id_DiodeFex, DiodeFexType::Versio
 typedef Pds::Ipimb::DataV2 IpimbDataType;
 
 LusiDiagFex::LusiDiagFex(int baselineMode, const std::map<uint32_t,int>& polarity) : 
-  _baselineMode(baselineMode),
   _polarity    (polarity),
   _pool(OutSize,OutEntries), 
   _ipm_config(new IpmFexConfigType  [max_configs]),
   _pim_config(new DiodeFexConfigType[max_configs]),
-  _cap_config(new IpimbCapSetting   [max_configs]),
-  _odg(0) {}
+  _engine    (baselineMode),
+  _odg       (0) {}
 
 LusiDiagFex::~LusiDiagFex() 
 {
   delete[] _pim_config;
   delete[] _ipm_config;
-  delete[] _cap_config;
 }
 
-void LusiDiagFex::reset() { _map.clear(); }
+void LusiDiagFex::reset() { _engine.reset(); }
 
 InDatagram* LusiDiagFex::process(InDatagram* in)
 {
@@ -70,64 +53,37 @@ InDatagram* LusiDiagFex::process(InDatagram* in)
 
 int LusiDiagFex::process(Xtc* xtc)
 {
-  if (static_cast<const DetInfo&>(xtc->src).device()!=DetInfo::Ipimb) {
-    _odg->insert(*xtc, xtc->payload());
-	return 1; }
-
-  unsigned det=0;
-  while(_map[det] != xtc->src.phy()) det++;
-  
-  if (IS_IPM(det)) {
-    // keep a copy of the raw data
-    _odg->insert(*xtc, xtc->payload());
-
-    Xtc& tc = *new (&_odg->xtc) Xtc(_ipmFexType, xtc->src);
-    tc.extent += sizeof(IpmFexType);
-
-    const IpmFexConfigType& cfg  = _ipm_config[det];
-    const IpimbDataType& data = *reinterpret_cast<const IpimbDataType*>(xtc->payload());
-    float fex_channel[4];
-    double base = _polarity[xtc->src.phy()]==1 ? 0 : IpimbDataType::ipimbAdcRange;
-#define CALC_FEX(ch) {                                                  \
-      int s=_cap_config[det].cap[ch];                                   \
-      if (_baselineMode)                                                \
-        fex_channel[ch] = (cfg.diode()[ch].base()[s] -                  \
-                           base -                                       \
-                           data.channel##ch##Volts() +                  \
-                           data.channel##ch##psVolts() )                \
-          *cfg.diode()[ch].scale()[s];                                  \
-      else                                                              \
-        fex_channel[ch] = (cfg.diode()[ch].base()[s] -                  \
-                           data.channel##ch##Volts() )                  \
-          *cfg.diode()[ch].scale()[s];                                  \
-    }
-    CALC_FEX(0);
-    CALC_FEX(1);
-    CALC_FEX(2);
-    CALC_FEX(3);
-#undef CALC_FEX
-
-    float fex_sum = fex_channel[0] + fex_channel[1] + fex_channel[2] + fex_channel[3];
-    float fex_xpos = cfg.xscale()*(fex_channel[1] - fex_channel[3])/(fex_channel[1] + fex_channel[3]);
-    float fex_ypos = cfg.yscale()*(fex_channel[0] - fex_channel[2])/(fex_channel[0] + fex_channel[2]);
-    *new (_odg->xtc.alloc(sizeof(IpmFexType))) IpmFexType(fex_channel, fex_sum, fex_xpos, fex_ypos);
-  }
-  else if (IS_PIM(det)) {
-    // keep a copy of the raw data
-    _odg->insert(*xtc, xtc->payload());
-
-    Xtc& tc = *new (&_odg->xtc) Xtc(_diodeFexType, xtc->src);
-    tc.extent += sizeof(DiodeFexType);
-
-    const DiodeFexConfigType& cfg  = _pim_config[det];
-    const IpimbDataType& data = *reinterpret_cast<const IpimbDataType*>(xtc->payload());
-    int s=_cap_config[det].cap[0]; // need to fetch the cap selection from the IPIMB configuration for each channel
-    float fex_value = (cfg.base()[s] - data.channel0Volts())*cfg.scale()[s];
-    *new (_odg->xtc.alloc(sizeof(DiodeFexType))) DiodeFexType(fex_value);
-  }
-  else {
-    // keep a copy of the raw data
-    _odg->insert(*xtc, xtc->payload());
+  // keep a copy of the raw data
+  _odg->insert(*xtc, xtc->payload());
+
+  if (static_cast<const DetInfo&>(xtc->src).device()!=DetInfo::Ipimb)
+    return 1;
+
+  int det = _engine.index(xtc->src.phy());
+  if (det < 0)
+    return 1;
+
+  switch(_engine.kind(det)) {
+  case LusiDiagFexEngine::Ipm:
+    { _engine.compute(det, *reinterpret_cast<const IpimbDataType*>(xtc->payload()));
+      Xtc& tc = *new (&_odg->xtc) Xtc(_ipmFexType, xtc->src);
+      tc.extent += sizeof(IpmFexType);
+      float fex_channel[4];
+      for(unsigned ch=0; ch<4; ch++)
+        fex_channel[ch] = _engine.channel(det,ch);
+      new (_odg->xtc.alloc(sizeof(IpmFexType))) IpmFexType(fex_channel,
+                                                           _engine.sum (det),
+                                                           _engine.xpos(det),
+                                                           _engine.ypos(det));
+    } break;
+  case LusiDiagFexEngine::Pim:
+    { _engine.compute(det, *reinterpret_cast<const IpimbDataType*>(xtc->payload()));
+      Xtc& tc = *new (&_odg->xtc) Xtc(_diodeFexType, xtc->src);
+      tc.extent += sizeof(DiodeFexType);
+      new (_odg->xtc.alloc(sizeof(DiodeFexType))) DiodeFexType(_engine.value(det));
+    } break;
+  default:
+    break;
   }
   return 1;
 }
@@ -136,38 +92,44 @@ bool LusiDiagFex::configure(CfgClientNfs& cfg,
 			    Transition& tr,
 			    const IpimbConfigType& ipimb_config)
 {
-  unsigned det = _map.size();
-  _map.push_back(cfg.src().phy());
+  unsigned det = _engine.detectors();
+  if (det == LusiDiagFexEngine::MaxDetectors) {
+    printf("*** LusiDiagFex: too many detectors to configure %08x\n", cfg.src().phy());
+    return false;
+  }
+
+  uint32_t phy = cfg.src().phy();
+  std::map<uint32_t,int>::const_iterator it = _polarity.find(phy);
+  int polarity = it==_polarity.end() ? 0 : it->second;
 
   if ( cfg.fetch(tr, _ipmFexConfigType, 
-		 &_ipm_config[ipmIndex(det)], sizeof(IpmFexConfigType)) > 0 ) {
-    SET_IPM(det);
-    _cap_config[det].cap[0] = (ipimb_config.chargeAmpRange()>> 0)&0xf;
-    _cap_config[det].cap[1] = (ipimb_config.chargeAmpRange()>> 4)&0xf;
-    _cap_config[det].cap[2] = (ipimb_config.chargeAmpRange()>> 8)&0xf;
-    _cap_config[det].cap[3] = (ipimb_config.chargeAmpRange()>>12)&0xf;
-  }
+		 &_ipm_config[det], sizeof(IpmFexConfigType)) > 0 )
+    _engine.addIpm(phy, _ipm_config[det], ipimb_config, polarity);
   else if ( cfg.fetch(tr, _diodeFexConfigType, 
-		      &_pim_config[pimIndex(det)], sizeof(DiodeFexConfigType)) > 0 ) {
-    SET_PIM(det);
-    _cap_config[det].cap[0] = (ipimb_config.chargeAmpRange()>>0)&0xf;
-  }
+		      &_pim_config[det], sizeof(DiodeFexConfigType)) > 0 )
+    _engine.addPim(phy, _pim_config[det], ipimb_config);
+  else
+    _engine.addNone(phy);
   return true;
 }
 
 void LusiDiagFex::recordConfigure(InDatagram* dg, const Src& src)
 {
-  unsigned det=0;
-  while(_map[det] != src.phy()) det++;
-
-  if (IS_IPM(det)) {
-    Xtc tc = Xtc(_ipmFexConfigType, src);
-    tc.extent += sizeof(IpmFexConfigType);
-    dg->insert(tc, &_ipm_config[det]);
-  }
-  else if (IS_PIM(det)) {
-    Xtc tc = Xtc(_diodeFexConfigType, src);
-    tc.extent += sizeof(DiodeFexConfigType);
-    dg->insert(tc, &_pim_config[det]);
+  int det = _engine.index(src.phy());
+  if (det < 0) return;
+
+  switch(_engine.kind(det)) {
+  case LusiDiagFexEngine::Ipm:
+    { Xtc tc = Xtc(_ipmFexConfigType, src);
+      tc.extent += sizeof(IpmFexConfigType);
+      dg->insert(tc, &_ipm_config[det]);
+    } break;
+  case LusiDiagFexEngine::Pim:
+    { Xtc tc = Xtc(_diodeFexConfigType, src);
+      tc.extent += sizeof(DiodeFexConfigType);
+      dg->insert(tc, &_pim_config[det]);
+    } break;
+  default:
+    break;
   }
 }
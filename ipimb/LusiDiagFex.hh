@@ -2,6 +2,7 @@
 #define LusiDiagFex_hh
 
 #include "pds/ipimb/IpimbFex.hh"
+#include "pds/ipimb/LusiDiagFexEngine.hh"
 
 #include "pdsdata/xtc/XtcIterator.hh"
 #include "pds/service/GenericPoolW.hh"
@@ -18,7 +19,6 @@ namespace Pds {
   class Src;
   class CfgClientNfs;
   class Transition;
-  class IpimbCapSetting;
 
   class LusiDiagFex : public IpimbFex, XtcIterator {
   public:
@@ -32,14 +32,12 @@ namespace Pds {
   public:
     int process(Xtc*);
   private:
-    int                    _baselineMode;
     std::map<uint32_t,int> _polarity;
     GenericPoolW           _pool;
     IpmFexConfigType*      _ipm_config;
     DiodeFexConfigType*    _pim_config;
-    IpimbCapSetting*       _cap_config;
+    LusiDiagFexEngine      _engine;
     InDatagram*            _odg;
-    std::vector<unsigned>  _map;
   };
 };
 
@@ -0,0 +1,140 @@
+#include "pds/ipimb/LusiDiagFexEngine.hh"
+
+#include "pdsdata/psddl/lusi.ddl.h"
+#include "pdsdata/psddl/ipimb.ddl.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace Pds;
+
+typedef Pds::Ipimb::DataV2 IpimbDataType;
+
+static inline unsigned _capSetting(const IpimbConfigType& c, unsigned ch)
+{
+  return (c.chargeAmpRange()>>(4*ch))&0xf;
+}
+
+LusiDiagFexEngine::LusiDiagFexEngine(int baselineMode) :
+  _baselineMode(baselineMode),
+  _ndet        (0)
+{
+  memset(_phy   , 0, sizeof(_phy));
+  memset(_kind  , 0, sizeof(_kind));
+  memset(_base  , 0, sizeof(_base));
+  memset(_scale , 0, sizeof(_scale));
+  memset(_offset, 0, sizeof(_offset));
+  memset(_xscale, 0, sizeof(_xscale));
+  memset(_yscale, 0, sizeof(_yscale));
+  memset(_fex   , 0, sizeof(_fex));
+  memset(_sum   , 0, sizeof(_sum));
+  memset(_xpos  , 0, sizeof(_xpos));
+  memset(_ypos  , 0, sizeof(_ypos));
+  memset(_pfex  , 0, sizeof(_pfex));
+}
+
+LusiDiagFexEngine::~LusiDiagFexEngine()
+{
+}
+
+void LusiDiagFexEngine::reset() { _ndet = 0; }
+
+int LusiDiagFexEngine::_add(uint32_t phy, Kind kind)
+{
+  if (_ndet == MaxDetectors) {
+    printf("*** LusiDiagFexEngine: more than %d detectors\n", int(MaxDetectors));
+    return -1;
+  }
+  unsigned det = _ndet++;
+  _phy [det] = phy;
+  _kind[det] = kind;
+  for(unsigned ch=0; ch<NChannels; ch++) {
+    _base  [ch][det] = 0;
+    _scale [ch][det] = 0;
+    _offset[ch][det] = 0;
+  }
+  _xscale[det] = 0;
+  _yscale[det] = 0;
+  return det;
+}
+
+int LusiDiagFexEngine::addIpm(uint32_t phy,
+                              const IpmFexConfigType& cfg,
+                              const IpimbConfigType&  ipimb,
+                              int polarity)
+{
+  int det = _add(phy, Ipm);
+  if (det < 0) return det;
+
+  double base = polarity==1 ? 0 : IpimbDataType::ipimbAdcRange;
+  for(unsigned ch=0; ch<NChannels; ch++) {
+    unsigned s = _capSetting(ipimb, ch);
+    _base  [ch][det] = cfg.diode()[ch].base ()[s];
+    _scale [ch][det] = cfg.diode()[ch].scale()[s];
+    _offset[ch][det] = _base[ch][det] - base;
+  }
+  _xscale[det] = cfg.xscale();
+  _yscale[det] = cfg.yscale();
+  return det;
+}
+
+int LusiDiagFexEngine::addPim(uint32_t phy,
+                              const DiodeFexConfigType& cfg,
+                              const IpimbConfigType&    ipimb)
+{
+  int det = _add(phy, Pim);
+  if (det < 0) return det;
+
+  unsigned s = _capSetting(ipimb, 0);
+  _base  [0][det] = cfg.base ()[s];
+  _scale [0][det] = cfg.scale()[s];
+  return det;
+}
+
+int LusiDiagFexEngine::addNone(uint32_t phy) { return _add(phy, None); }
+
+int LusiDiagFexEngine::index(uint32_t phy) const
+{
+  for(unsigned det=0; det<_ndet; det++)
+    if (_phy[det]==phy)
+      return det;
+  return -1;
+}
+
+//
+//  The expressions keep the evaluation order and precision of the former
+//  code: with the baseline correction the difference is taken in double
+//  precision (float less the double baseline) and rounded to float once at
+//  the end; without it everything is float.
+//
+void LusiDiagFexEngine::compute(unsigned det, const IpimbDataType& data)
+{
+  float v[NChannels];
+  v[0] = data.channel0Volts();
+  v[1] = data.channel1Volts();
+  v[2] = data.channel2Volts();
+  v[3] = data.channel3Volts();
+
+  if (_kind[det]==Pim) {
+    _pfex[det] = (_base[0][det] - v[0])*_scale[0][det];
+    return;
+  }
+
+  if (_baselineMode) {
+    float ps[NChannels];
+    ps[0] = data.channel0psVolts();
+    ps[1] = data.channel1psVolts();
+    ps[2] = data.channel2psVolts();
+    ps[3] = data.channel3psVolts();
+    for(unsigned ch=0; ch<NChannels; ch++)
+      _fex[ch][det] = (_offset[ch][det] - v[ch] + ps[ch])*_scale[ch][det];
+  }
+  else
+    for(unsigned ch=0; ch<NChannels; ch++)
+      _fex[ch][det] = (_base[ch][det] - v[ch])*_scale[ch][det];
+
+  float f0 = _fex[0][det], f1 = _fex[1][det], f2 = _fex[2][det], f3 = _fex[3][det];
+  _sum [det] = f0 + f1 + f2 + f3;
+  _xpos[det] = _xscale[det]*(f1 - f3)/(f1 + f3);
+  _ypos[det] = _yscale[det]*(f0 - f2)/(f0 + f2);
+}
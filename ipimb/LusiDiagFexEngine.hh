@@ -0,0 +1,69 @@
+#ifndef LusiDiagFexEngine_hh
+#define LusiDiagFexEngine_hh
+
+//
+//  IPM and PIM feature extraction, one detector at a time.
+//
+//  At configure the calibration constants for each detector's selected
+//  charge amplifier range (and the polarity baseline) are looked up once,
+//  so each contribution costs the arithmetic alone.  The arithmetic matches
+//  LusiDiagFex's former code operation for operation, so the results are
+//  bit identical (see lusidiagfextest).
+//
+
+#include "pds/config/IpimbConfigType.hh"
+#include "pds/config/IpmFexConfigType.hh"
+#include "pds/config/DiodeFexConfigType.hh"
+
+#include <stdint.h>
+
+namespace Pds {
+
+  class LusiDiagFexEngine {
+  public:
+    enum { MaxDetectors = 32, NChannels = 4 };
+    enum Kind { None, Ipm, Pim };
+  public:
+    LusiDiagFexEngine(int baselineMode);
+    ~LusiDiagFexEngine();
+  public:
+    void     reset    ();
+    //  Each returns the detector index, or -1 if there are too many
+    int      addIpm   (uint32_t phy, const IpmFexConfigType&,   const IpimbConfigType&, int polarity);
+    int      addPim   (uint32_t phy, const DiodeFexConfigType&, const IpimbConfigType&);
+    int      addNone  (uint32_t phy);
+    //  Returns -1 for an unknown detector
+    int      index    (uint32_t phy) const;
+    unsigned detectors() const { return _ndet; }
+    Kind     kind     (unsigned det) const { return Kind(_kind[det]); }
+  public:
+    //  Per contribution: compute the detector's features
+    void     compute  (unsigned det, const Ipimb::DataV2&);
+    float    channel  (unsigned det, unsigned ch) const { return _fex[ch][det]; }
+    float    sum      (unsigned det) const { return _sum [det]; }
+    float    xpos     (unsigned det) const { return _xpos[det]; }
+    float    ypos     (unsigned det) const { return _ypos[det]; }
+    float    value    (unsigned det) const { return _pfex[det]; }
+  private:
+    int      _add     (uint32_t phy, Kind);
+  private:
+    int       _baselineMode;
+    unsigned  _ndet;
+    uint32_t  _phy   [MaxDetectors];
+    uint8_t   _kind  [MaxDetectors];
+    //  Constants for the selected ranges
+    float     _base  [NChannels][MaxDetectors];
+    float     _scale [NChannels][MaxDetectors];
+    double    _offset[NChannels][MaxDetectors];  // base less the polarity baseline
+    float     _xscale[MaxDetectors];
+    float     _yscale[MaxDetectors];
+    //  Results
+    float     _fex   [NChannels][MaxDetectors];
+    float     _sum   [MaxDetectors];
+    float     _xpos  [MaxDetectors];
+    float     _ypos  [MaxDetectors];
+    float     _pfex  [MaxDetectors];
+  };
+};
+
+#endif
@@ -1,6 +1,10 @@
 libnames := ipimb
 
-libsrcs_ipimb := $(wildcard *.cc)
+libsrcs_ipimb := $(filter-out lusidiagfextest.cc,$(wildcard *.cc))
 libincs_ipimb := pdsdata/include ndarray/include boost/include 
 
-
+tgtnames := lusidiagfextest
+tgtsrcs_lusidiagfextest := lusidiagfextest.cc LusiDiagFexEngine.cc
+tgtlibs_lusidiagfextest := pdsdata/xtcdata pdsdata/psddl_pdsdata
+tgtslib_lusidiagfextest := $(USRLIBDIR)/rt
+tgtincs_lusidiagfextest := pdsdata/include ndarray/include boost/include
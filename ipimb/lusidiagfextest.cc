@@ -0,0 +1,369 @@
+//
+//  lusidiagfextest - checks that LusiDiagFexEngine reproduces the former
+//  LusiDiagFex arithmetic bit for bit, and reports the throughput of both
+//  (the former code with its constants already looked up, against the
+//  engine's detector lookup and computation).
+//
+//    lusidiagfextest -f <file.xtc> [-n <events>] [-t <seconds>]
+//      uses the IPIMB configurations and data of a recorded run; detectors
+//      without a recorded IPM or PIM configuration get synthetic constants
+//    lusidiagfextest [-d <detectors>] [-n <events>] [-t <seconds>]
+//      uses synthetic configurations and data
+//
+//  Each event is computed in both baseline modes and with both polarities.
+//  Exits with 1 on any difference.
+//
+#include "pds/ipimb/LusiDiagFexEngine.hh"
+
+#include "pds/config/IpimbDataType.hh"
+
+#include "pdsdata/xtc/XtcFileIterator.hh"
+#include "pdsdata/xtc/XtcIterator.hh"
+#include "pdsdata/xtc/DetInfo.hh"
+#include "pdsdata/xtc/Dgram.hh"
+
+#include <vector>
+#include <map>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+using namespace Pds;
+
+static double now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return double(ts.tv_sec)+1.e-9*double(ts.tv_nsec);
+}
+
+//
+//  The former LusiDiagFex::process arithmetic, verbatim
+//
+struct IpmResult { float fex_channel[4]; float fex_sum, fex_xpos, fex_ypos; };
+
+static void referenceIpm(int _baselineMode, int polarity,
+                         const IpmFexConfigType& cfg, const int* cap,
+                         const IpimbDataType& data, IpmResult& r)
+{
+  float* fex_channel = r.fex_channel;
+  double base = polarity==1 ? 0 : IpimbDataType::ipimbAdcRange;
+#define CALC_FEX(ch) {                                                  \
+    int s=cap[ch];                                                      \
+    if (_baselineMode)                                                  \
+      fex_channel[ch] = (cfg.diode()[ch].base()[s] -                    \
+                         base -                                         \
+                         data.channel##ch##Volts() +                    \
+                         data.channel##ch##psVolts() )                  \
+        *cfg.diode()[ch].scale()[s];                                    \
+    else                                                                \
+      fex_channel[ch] = (cfg.diode()[ch].base()[s] -                    \
+                         data.channel##ch##Volts() )                    \
+        *cfg.diode()[ch].scale()[s];                                    \
+  }
+  CALC_FEX(0);
+  CALC_FEX(1);
+  CALC_FEX(2);
+  CALC_FEX(3);
+#undef CALC_FEX
+
+  r.fex_sum = fex_channel[0] + fex_channel[1] + fex_channel[2] + fex_channel[3];
+  r.fex_xpos = cfg.xscale()*(fex_channel[1] - fex_channel[3])/(fex_channel[1] + fex_channel[3]);
+  r.fex_ypos = cfg.yscale()*(fex_channel[0] - fex_channel[2])/(fex_channel[0] + fex_channel[2]);
+}
+
+static float referencePim(const DiodeFexConfigType& cfg, const int* cap,
+                          const IpimbDataType& data)
+{
+  int s=cap[0];
+  return (cfg.base()[s] - data.channel0Volts())*cfg.scale()[s];
+}
+
+static inline bool same(float a, float b) { return memcmp(&a,&b,sizeof(float))==0; }
+
+namespace Pds {
+  class LusiDetector {
+  public:
+    LusiDetector() : ipm(false), pim(false) {}
+  public:
+    IpimbConfigType    ipimb;
+    IpmFexConfigType   ipmcfg;
+    DiodeFexConfigType pimcfg;
+    bool               ipm;
+    bool               pim;
+    int                cap[4];
+  };
+
+  class LusiTestLoader : public XtcIterator {
+  public:
+    LusiTestLoader(std::map<uint32_t,LusiDetector>& dets,
+                   std::vector< std::vector<std::pair<uint32_t,IpimbDataType> > >& events) :
+      _dets(dets), _events(events) {}
+  public:
+    int process(Xtc* xtc) {
+      if (xtc->contains.id()==TypeId::Id_Xtc)
+        iterate(xtc);
+      else if (xtc->damage.value()==0 &&
+               static_cast<const DetInfo&>(xtc->src).device()==DetInfo::Ipimb) {
+        uint32_t phy = xtc->src.phy();
+        if (xtc->contains.value()==_ipimbConfigType.value())
+          _dets[phy].ipimb = *reinterpret_cast<const IpimbConfigType*>(xtc->payload());
+        else if (xtc->contains.value()==_ipmFexConfigType.value()) {
+          _dets[phy].ipmcfg = *reinterpret_cast<const IpmFexConfigType*>(xtc->payload());
+          _dets[phy].ipm    = true;
+        }
+        else if (xtc->contains.value()==_diodeFexConfigType.value()) {
+          _dets[phy].pimcfg = *reinterpret_cast<const DiodeFexConfigType*>(xtc->payload());
+          _dets[phy].pim    = true;
+        }
+        else if (xtc->contains.value()==_ipimbDataType.value() && _dets.count(phy))
+          _events.back().push_back(std::make_pair(phy, *reinterpret_cast<const IpimbDataType*>(xtc->payload())));
+      }
+      return 1;
+    }
+  private:
+    std::map<uint32_t,LusiDetector>& _dets;
+    std::vector< std::vector<std::pair<uint32_t,IpimbDataType> > >& _events;
+  };
+};
+
+static void randomize(void* p, unsigned size)
+{
+  unsigned char* b = reinterpret_cast<unsigned char*>(p);
+  for(unsigned i=0; i<size; i++)
+    b[i] = lrand48();
+}
+
+static DiodeFexConfigType randomDiode()
+{
+  float base [DiodeFexConfigType::NRANGES];
+  float scale[DiodeFexConfigType::NRANGES];
+  for(unsigned i=0; i<DiodeFexConfigType::NRANGES; i++) {
+    base [i] = 5*drand48()-0.5;
+    scale[i] = 1.e-3 + 10*drand48();
+  }
+  return DiodeFexConfigType(base, scale);
+}
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [-f <xtc file>] [-d <detectors>] [-n <events>] [-t <seconds>]\n"
+         "Options:\n"
+         "\t-f <file>      use the IPIMB data of a recorded run\n"
+         "\t-d <n>         synthetic detectors [8]\n"
+         "\t-n <events>    maximum events to load [10000]\n"
+         "\t-t <seconds>   minimum run time of each throughput measurement [1]\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  const char* fname   = 0;
+  unsigned    ndets   = 8;
+  unsigned    nevents = 10000;
+  double      tmin    = 1;
+
+  int c;
+  while ((c = getopt(argc, argv, "f:d:n:t:h")) != -1) {
+    switch(c) {
+    case 'f': fname   = optarg; break;
+    case 'd': ndets   = strtoul(optarg,NULL,0); break;
+    case 'n': nevents = strtoul(optarg,NULL,0); break;
+    case 't': tmin    = strtod (optarg,NULL); break;
+    case 'h':
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  std::map<uint32_t,LusiDetector> dets;
+  std::vector< std::vector<std::pair<uint32_t,IpimbDataType> > > events;
+  srand48(1);
+
+  if (fname) {
+    int fd = ::open(fname, O_RDONLY | O_LARGEFILE);
+    if (fd < 0) {
+      perror(fname);
+      return 1;
+    }
+    XtcFileIterator iter(fd, 0x2000000);
+    Dgram* dg;
+    while(events.size() < nevents && (dg = iter.next())) {
+      if (dg->seq.service()==TransitionId::Configure ||
+          dg->seq.service()==TransitionId::L1Accept) {
+        events.push_back(std::vector<std::pair<uint32_t,IpimbDataType> >());
+        LusiTestLoader(dets, events).iterate(&dg->xtc);
+        if (events.back().empty())
+          events.pop_back();
+      }
+    }
+    ::close(fd);
+
+    if (events.empty()) {
+      printf("No IPIMB data found in %s\n", fname);
+      return 1;
+    }
+    //  Alternate synthetic IPM and PIM constants for the rest
+    unsigned n = 0;
+    for(std::map<uint32_t,LusiDetector>::iterator it=dets.begin(); it!=dets.end(); it++, n++)
+      if (!it->second.ipm && !it->second.pim) {
+        if (n&1) {
+          it->second.pimcfg = randomDiode();
+          it->second.pim    = true;
+        }
+        else {
+          DiodeFexConfigType d[4] = { randomDiode(), randomDiode(), randomDiode(), randomDiode() };
+          it->second.ipmcfg = IpmFexConfigType(d, 1+drand48(), 1+drand48());
+          it->second.ipm    = true;
+        }
+      }
+  }
+  else {
+    //  Three IPMs to each PIM, and one detector without a fex configuration
+    for(unsigned n=0; n<ndets; n++) {
+      LusiDetector& det = dets[0x1000+n];
+      randomize(&det.ipimb, sizeof(det.ipimb));
+      if (n==3)
+        ;
+      else if ((n&3)==1) {
+        det.pimcfg = randomDiode();
+        det.pim    = true;
+      }
+      else {
+        DiodeFexConfigType d[4] = { randomDiode(), randomDiode(), randomDiode(), randomDiode() };
+        det.ipmcfg = IpmFexConfigType(d, 1+drand48(), 1+drand48());
+        det.ipm    = true;
+      }
+    }
+    for(unsigned e=0; e<nevents; e++) {
+      events.push_back(std::vector<std::pair<uint32_t,IpimbDataType> >());
+      for(unsigned n=0; n<ndets; n++) {
+        IpimbDataType data;
+        randomize(&data, sizeof(data));
+        events.back().push_back(std::make_pair(0x1000+n, data));
+      }
+    }
+  }
+
+  if (dets.size() > LusiDiagFexEngine::MaxDetectors) {
+    printf("%zu detectors exceeds the maximum of %u\n", dets.size(), unsigned(LusiDiagFexEngine::MaxDetectors));
+    return 1;
+  }
+
+  for(std::map<uint32_t,LusiDetector>::iterator it=dets.begin(); it!=dets.end(); it++)
+    for(unsigned ch=0; ch<4; ch++)
+      it->second.cap[ch] = (it->second.ipimb.chargeAmpRange()>>(4*ch))&0xf;
+
+  unsigned long long ncompared = 0;
+  unsigned long long nbad      = 0;
+
+  for(int baselineMode=0; baselineMode<2; baselineMode++) {
+    for(int polarity=0; polarity<2; polarity++) {
+      LusiDiagFexEngine engine(baselineMode);
+      for(std::map<uint32_t,LusiDetector>::iterator it=dets.begin(); it!=dets.end(); it++) {
+        const LusiDetector& d = it->second;
+        if (d.ipm)
+          engine.addIpm(it->first, d.ipmcfg, d.ipimb, polarity);
+        else if (d.pim)
+          engine.addPim(it->first, d.pimcfg, d.ipimb);
+        else
+          engine.addNone(it->first);
+      }
+
+      //  Compare
+      for(unsigned e=0; e<events.size(); e++) {
+        const std::vector<std::pair<uint32_t,IpimbDataType> >& ev = events[e];
+        for(unsigned i=0; i<ev.size(); i++) {
+          const LusiDetector& d = dets[ev[i].first];
+          int det = engine.index(ev[i].first);
+          if (engine.kind(det)!=LusiDiagFexEngine::None)
+            engine.compute(det, ev[i].second);
+          bool ok = true;
+          if (d.ipm) {
+            IpmResult r;
+            referenceIpm(baselineMode, polarity, d.ipmcfg, d.cap, ev[i].second, r);
+            for(unsigned ch=0; ch<4; ch++)
+              ok &= same(r.fex_channel[ch], engine.channel(det,ch));
+            ok &= same(r.fex_sum , engine.sum (det));
+            ok &= same(r.fex_xpos, engine.xpos(det));
+            ok &= same(r.fex_ypos, engine.ypos(det));
+            if (!ok && nbad < 10)
+              printf("*** event %u detector %08x baseline %d polarity %d: "
+                     "%g %g %g %g %g %g %g != %g %g %g %g %g %g %g\n",
+                     e, ev[i].first, baselineMode, polarity,
+                     r.fex_channel[0], r.fex_channel[1], r.fex_channel[2], r.fex_channel[3],
+                     r.fex_sum, r.fex_xpos, r.fex_ypos,
+                     engine.channel(det,0), engine.channel(det,1),
+                     engine.channel(det,2), engine.channel(det,3),
+                     engine.sum(det), engine.xpos(det), engine.ypos(det));
+          }
+          else if (d.pim) {
+            float r = referencePim(d.pimcfg, d.cap, ev[i].second);
+            ok = same(r, engine.value(det));
+            if (!ok && nbad < 10)
+              printf("*** event %u detector %08x: %g != %g\n",
+                     e, ev[i].first, r, engine.value(det));
+          }
+          else
+            continue;
+          ncompared++;
+          if (!ok) nbad++;
+        }
+      }
+
+      //  Throughput
+      double t0, t1, tref, teng;
+      unsigned passes = 0;
+      unsigned long long ncontrib = 0;
+      float    sink = 0;
+      t0 = now();
+      do {
+        for(unsigned e=0; e<events.size(); e++) {
+          const std::vector<std::pair<uint32_t,IpimbDataType> >& ev = events[e];
+          for(unsigned i=0; i<ev.size(); i++) {
+            const LusiDetector& d = dets[ev[i].first];
+            if (d.ipm) {
+              IpmResult r;
+              referenceIpm(baselineMode, polarity, d.ipmcfg, d.cap, ev[i].second, r);
+              sink += r.fex_sum;
+            }
+            else if (d.pim)
+              sink += referencePim(d.pimcfg, d.cap, ev[i].second);
+          }
+          ncontrib += ev.size();
+        }
+        passes++;
+      } while((t1=now())-t0 < tmin);
+      tref = (t1-t0)/double(ncontrib);
+
+      passes = 0;
+      ncontrib = 0;
+      t0 = now();
+      do {
+        for(unsigned e=0; e<events.size(); e++) {
+          const std::vector<std::pair<uint32_t,IpimbDataType> >& ev = events[e];
+          for(unsigned i=0; i<ev.size(); i++) {
+            int det = engine.index(ev[i].first);
+            if (engine.kind(det)!=LusiDiagFexEngine::None) {
+              engine.compute(det, ev[i].second);
+              sink += engine.sum(det);
+            }
+          }
+          ncontrib += ev.size();
+        }
+        passes++;
+      } while((t1=now())-t0 < tmin);
+      teng = (t1-t0)/double(ncontrib);
+
+      printf("baseline %d polarity %d: %.1f ns/contribution former, %.1f ns engine%s\n",
+             baselineMode, polarity, tref*1.e9, teng*1.e9, sink==0.5f ? " " : "");
+    }
+  }
+
+  printf("%zu events, %zu detectors, %llu results compared, %llu differ\n",
+         events.size(), dets.size(), ncompared, nbad);
+  return nbad ? 1 : 0;
+}
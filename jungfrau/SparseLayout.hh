@@ -0,0 +1,42 @@
+#ifndef Pds_Jungfrau_SparseLayout_hh
+#define Pds_Jungfrau_SparseLayout_hh
+
+//
+//  Jungfrau frames for the SparseFrameApp.  The two upper bits of a pixel
+//  are the gain stage, so the pixel maps should have an ADC mask of 0x3fff.
+//
+
+#include "pds/client/SparseFrameApp.hh"
+#include "pds/config/JungfrauConfigType.hh"
+#include "pds/config/JungfrauDataType.hh"
+#include "pdsdata/xtc/Xtc.hh"
+
+#include <string.h>
+
+namespace Pds {
+  namespace Jungfrau {
+    class SparseLayout : public SparseFrameApp::Layout {
+    public:
+      SparseLayout() : _config(new char[sizeof(JungfrauConfigType)]) {}
+      ~SparseLayout() { delete[] _config; }
+    public:
+      TypeId   configType() const { return _jungfrauConfigType; }
+      TypeId   dataType  () const { return _jungfrauDataType; }
+      unsigned configure (const void* p) {
+        const JungfrauConfigType& c = *reinterpret_cast<const JungfrauConfigType*>(p);
+        delete[] _config;
+        _config = new char[c._sizeof()];
+        memcpy(_config, p, c._sizeof());
+        return c.numberOfModules()*c.numberOfRowsPerModule()*c.numberOfColumnsPerModule();
+      }
+      const uint16_t* frame(const Xtc& xtc) const {
+        return reinterpret_cast<const JungfrauDataType*>(xtc.payload())->
+          frame(*reinterpret_cast<const JungfrauConfigType*>(_config)).data();
+      }
+    private:
+      char* _config;
+    };
+  }
+}
+
+#endif
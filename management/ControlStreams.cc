@@ -9,6 +9,7 @@
 #include "pds/management/PartitionMember.hh"
 #include "EventBuilder.hh"
 #include "pds/xtc/XtcType.hh"
+#include "pds/management/VmonServerAppliance.hh"
 
 using namespace Pds;
 
@@ -39,6 +40,8 @@ ControlStreams::ControlStreams(PartitionMember& cmgr) :
     eb->no_build(Sequence::Event,1<<TransitionId::L1Accept);
 
     _inlet_wires[s] = eb;
+
+    (new VmonServerAppliance(cmgr.header().procInfo()))->connect(stream(s)->inlet());
   }
 }
 
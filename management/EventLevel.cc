@@ -15,6 +15,7 @@
 #include "pds/utility/InletWireIns.hh"
 #include "pds/utility/NetDgServer.hh"
 #include "pds/utility/EbSGroup.hh"
+#include "pds/utility/EventLoad.hh"
 
 using namespace Pds;
 
@@ -159,6 +160,15 @@ void    EventLevel::allocated(const Allocation& alloc,
   for (int iGroup = 0; iGroup < (int) lGroupSegMask.size(); ++iGroup)
     printf("Group %d Segment Mask 0x%04x%04x\n", iGroup, lGroupSegMask[iGroup].value(1), lGroupSegMask[iGroup].value(0) );
   ((EbSGroup*) inlet)-> setClientMask(lGroupSegMask);
+  ((EbSGroup*) inlet)-> report_load(new EventLoadReporter(partition,
+                                                          index,
+                                                          _max_buffers,
+                                                          header().ip()));
+  //  Credits for the segment levels; one buffer is kept for recopy
+  ((EbSGroup*) inlet)-> credits(StreamPorts::ebCredit(partition),
+                                index,
+                                _max_buffers > 1 ? _max_buffers-1 : 1,
+                                header().ip());
 
   OutletWire* owire = _streams->stream(StreamParams::FrameWork)->outlet()->wire();
   owire->bind(OutletWire::Bcast, StreamPorts::bcast(partition,
@@ -0,0 +1,211 @@
+#include "pds/management/ParallelConfigure.hh"
+
+#include "pds/service/Task.hh"
+#include "pds/service/Routine.hh"
+#include "pds/utility/Occurrence.hh"
+#include "pdsdata/xtc/DetInfo.hh"
+#include "pdsdata/xtc/Xtc.hh"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace Pds {
+  class ParallelConfigureJob : public Routine {
+  public:
+    ParallelConfigureJob(ParallelConfigure& group, unsigned member) :
+      _group(group), _member(member) {}
+  public:
+    void routine() { _group.configure(_member); }
+  private:
+    ParallelConfigure& _group;
+    unsigned           _member;
+  };
+};
+
+using namespace Pds;
+
+static double time_since(const timespec& start)
+{
+  timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  return double(now.tv_sec-start.tv_sec)*1.e3 +
+    double(now.tv_nsec-start.tv_nsec)*1.e-6;
+}
+
+ParallelConfigure::ParallelConfigure(unsigned nmembers,
+                                     unsigned nthreads) :
+  _nmembers(nmembers),
+  _result  (nmembers),
+  _tr      (0),
+  _sem     (Semaphore::EMPTY),
+  _occPool (sizeof(UserMessage),4)
+{
+  if (nthreads > nmembers) nthreads = nmembers;
+  if (nthreads == 0)       nthreads = 1;
+
+  for(unsigned i=0; i<nthreads; i++) {
+    char name[16];
+    snprintf(name, sizeof(name), "CfgPar%u", i);
+    _tasks.push_back(new Task(TaskObject(name)));
+  }
+  for(unsigned i=0; i<nmembers; i++)
+    _jobs.push_back(new ParallelConfigureJob(*this, i));
+}
+
+ParallelConfigure::~ParallelConfigure()
+{
+  for(unsigned i=0; i<_tasks.size(); i++)
+    _tasks[i]->destroy();
+  for(unsigned i=0; i<_jobs.size(); i++)
+    delete _jobs[i];
+}
+
+bool ParallelConfigure::_parallel(TransitionId::Value id) const
+{
+  return (id==TransitionId::Configure ||
+          id==TransitionId::BeginCalibCycle);
+}
+
+//
+//  The members are the appliances which follow the group on the stream
+//
+void ParallelConfigure::_members()
+{
+  _member.clear();
+  Appliance* app = this;
+  for(unsigned i=0; i<_nmembers; i++)
+    _member.push_back(app = app->forward());
+}
+
+void ParallelConfigure::configure(unsigned i)
+{
+  timespec start;
+  clock_gettime(CLOCK_REALTIME, &start);
+  _result[i].output = _member[i]->transitions(_tr);
+  _result[i].time   = time_since(start);
+  _sem.give();
+}
+
+Transition* ParallelConfigure::transitions(Transition* tr)
+{
+  if (!_parallel(tr->id()) || _nmembers < 2)
+    return tr;
+
+  _members();
+  _tr = tr;
+  clock_gettime(CLOCK_REALTIME, &_start);
+  for(unsigned i=0; i<_nmembers; i++) {
+    _result[i] = Result();
+    _tasks[i%_tasks.size()]->call(_jobs[i]);
+  }
+  for(unsigned i=0; i<_nmembers; i++)
+    _sem.take();
+
+  printf("ParallelConfigure %s : %u members on %zu tasks in %.1f ms [",
+         TransitionId::name(tr->id()), _nmembers, _tasks.size(), time_since(_start));
+  for(unsigned i=0; i<_nmembers; i++)
+    printf(" %.1f", _result[i].time);
+  printf(" ]\n");
+
+  //
+  //  Every member has handled the transition once.  The first member
+  //  result which would have stopped or replaced the transition, had the
+  //  members been called in turn, is applied; the members are not run
+  //  again, so a replacement resumes after the last member.
+  //
+  Transition* output = tr;
+  for(unsigned i=0; i<_nmembers; i++) {
+    Transition* r = _result[i].output;
+    if (r == tr)
+      continue;
+    if (output == tr) {
+      if (r == 0)
+        printf("ParallelConfigure member %u stopped %s\n", i, TransitionId::name(tr->id()));
+      else if (r == (Transition*)DontDelete)
+        printf("*** ParallelConfigure member %u kept %s\n", i, TransitionId::name(tr->id()));
+      output = r;
+    }
+    else if (r && r != (Transition*)DontDelete)
+      delete r;             // superseded by the earlier member's result
+  }
+
+  if (output == 0 || output == (Transition*)DontDelete)
+    return output;
+
+  _member.back()->post(output);
+  return output == tr ? (Transition*)DontDelete : 0;  // 0 releases the input
+}
+
+InDatagram* ParallelConfigure::events(InDatagram* in)
+{
+  if (!_parallel(in->datagram().seq.service()) || _nmembers < 2)
+    return in;
+
+  if (_member.size() != _nmembers)
+    _members();
+
+  for(unsigned i=0; i<_nmembers; i++) {
+    Result& r = _result[i];
+    Xtc& root = in->datagram().xtc;
+    unsigned extent = root.extent;
+    uint32_t damage = root.damage.value();
+
+    InDatagram* out = _member[i]->events(in);
+    if (out == 0) {
+      delete in;
+      return (InDatagram*)DontDelete;
+    }
+    if (out == (InDatagram*)DontDelete)
+      return out;
+    if (out != in) {
+      delete in;
+      in = out;
+      continue;
+    }
+
+    //  Attribute the damage and the detector to this member
+    r.damage = root.damage.value() & ~damage;
+    if (root.extent > extent) {
+      const Xtc* xtc = reinterpret_cast<const Xtc*>(reinterpret_cast<const char*>(&root)+extent);
+      r.src    = xtc->src;
+      r.named  = true;
+      r.damage |= xtc->damage.value();
+    }
+  }
+
+  _report(in->datagram().seq.service());
+
+  _member.back()->post(in);
+  return (InDatagram*)DontDelete;
+}
+
+void ParallelConfigure::_report(TransitionId::Value id)
+{
+  unsigned nfail = 0;
+  for(unsigned i=0; i<_nmembers; i++)
+    if (_result[i].damage)
+      nfail++;
+
+  if (!nfail)
+    return;
+
+  UserMessage* msg = new(&_occPool) UserMessage;
+  char buff[128];
+  snprintf(buff, sizeof(buff), "%s failed for %u of %u detectors\n",
+           TransitionId::name(id), nfail, _nmembers);
+  msg->append(buff);
+  for(unsigned i=0; i<_nmembers; i++) {
+    const Result& r = _result[i];
+    if (r.named && r.src.level()==Level::Source)
+      snprintf(buff, sizeof(buff), "%s : %.1f ms%s\n",
+               DetInfo::name(static_cast<const DetInfo&>(r.src)),
+               r.time, r.damage ? " FAILED":"");
+    else
+      snprintf(buff, sizeof(buff), "member %u : %.1f ms%s\n",
+               i, r.time, r.damage ? " FAILED":"");
+    if (msg->remaining() > int(strlen(buff)))
+      msg->append(buff);
+    printf("ParallelConfigure %s",buff);
+  }
+  _member.back()->post(msg);  // members drop occurrences they do not handle
+}
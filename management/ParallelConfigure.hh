@@ -0,0 +1,82 @@
+#ifndef Pds_ParallelConfigure_hh
+#define Pds_ParallelConfigure_hh
+
+//
+//  Runs the configuration of several detector appliances hosted by one
+//  segment level concurrently.
+//
+//  The group is connected immediately ahead of its members on the stream.
+//  Configure and BeginCalibCycle transitions are handed to every member
+//  at once on a bounded pool of tasks; the group waits for all of them
+//  before forwarding the transition beyond the last member, so the
+//  transition latency is that of the slowest device rather than the sum.
+//  All other traffic passes through the members in order, as usual.
+//
+//  The corresponding datagram is passed through the members in order and
+//  any damage each adds is attributed to the detector it recorded.  A
+//  UserMessage listing the per-detector configuration times and failures
+//  is posted when any member fails.
+//
+//  Members must handle these transitions synchronously (return the input
+//  transition), which is the case for Fsm based managers.  Since every
+//  member has already run when the results are examined, a member which
+//  stops the transition (returns 0) stops it for the group, and one which
+//  replaces it has the replacement forwarded beyond the last member
+//  rather than through the later members again.
+//
+//  SegmentLevel groups the appliances its EventCallback attaches when
+//  SegWireSettings::configure_threads() is non-zero.
+//
+
+#include "pds/utility/Appliance.hh"
+#include "pds/service/GenericPool.hh"
+#include "pds/service/Semaphore.hh"
+#include "pdsdata/xtc/Src.hh"
+
+#include <time.h>
+#include <vector>
+
+namespace Pds {
+
+  class Task;
+  class Routine;
+
+  class ParallelConfigure : public Appliance {
+  public:
+    ParallelConfigure(unsigned nmembers,
+                      unsigned nthreads);
+    ~ParallelConfigure();
+  public:
+    Transition* transitions(Transition*);
+    InDatagram* events     (InDatagram*);
+  public:
+    void        configure  (unsigned member);
+  private:
+    bool        _parallel  (TransitionId::Value) const;
+    void        _members   ();
+    void        _report    (TransitionId::Value);
+  private:
+    class Result {
+    public:
+      Result() : time(0), output(0), damage(0), named(false) {}
+    public:
+      double      time;     // [ms]
+      Transition* output;
+      uint32_t    damage;
+      Src         src;
+      bool        named;
+    };
+    unsigned                _nmembers;
+    std::vector<Appliance*> _member;
+    std::vector<Result>     _result;
+    std::vector<Routine*>   _jobs;
+    std::vector<Task*>      _tasks;
+    Transition*             _tr;
+    Semaphore               _sem;
+    GenericPool             _occPool;
+    timespec                _start;
+  };
+
+}
+
+#endif
@@ -20,6 +20,11 @@
 #include "pds/service/Routine.hh"
 #include "pds/service/GenericPool.hh"
 #include "pds/config/AliasConfigType.hh"
+#include "pds/vmon/VmonServerManager.hh"
+#include "pds/mon/MonCds.hh"
+#include "pds/mon/MonGroup.hh"
+#include "pds/mon/MonEntryTH1F.hh"
+#include "pds/mon/MonDescTH1F.hh"
 
 #include "pdsdata/xtc/Sequence.hh"
 #include "pdsdata/xtc/DetInfo.hh"
@@ -32,6 +37,7 @@
 #include <errno.h>
 #include <vector>
 #include <list>
+#include <math.h>
 
 #define RECOVER_TMO
 #define USE_L1A
@@ -399,9 +405,19 @@ PartitionControl::PartitionControl(unsigned platform,
   _sequencer      (0),
   _experiment     (0),
   _use_run_info   (true),
+  _fast_scan      (false),
+  _cycling        (false),
+  _cycle_begin    (false),
   _reportTask     (new Task(TaskObject("controlRep"))),
   _tmo            (tmo)
 {
+  //  Calib cycle turnaround, from next_cycle() to the target state
+  MonGroup* group = new MonGroup("Control");
+  VmonServerManager::instance()->cds().add(group);
+  MonDescTH1F cycle_time("Log Cycle Time", "log10 [ms]", "", 40, 0., 4.);
+  _cycle_time = new MonEntryTH1F(cycle_time);
+  group->add(_cycle_time);
+
   memset(_transition_env,0,TransitionId::NumberOf*sizeof(unsigned));
   memset(_transition_xtc,0,TransitionId::NumberOf*sizeof(Xtc*));
   _partition_xtc = 0;
@@ -410,6 +426,7 @@ PartitionControl::PartitionControl(unsigned platform,
 
   pthread_mutex_init(&_target_mutex, NULL);
   pthread_cond_init (&_target_cond , NULL);
+  pthread_mutex_init(&_cycle_mutex , NULL);
 }
 
 PartitionControl::~PartitionControl()
@@ -495,7 +512,17 @@ bool PartitionControl::set_partition(const Allocation& alloc,
 const Allocation& PartitionControl::partition() const
 { return _partition; }
 
+//
+//  A target set from outside (or by pause/reconfigure) ends any calib cycle
+//  in progress; the cycle's own target changes use _set_target.
+//
 void PartitionControl::set_target_state(State state)
+{
+  _abort_cycle();
+  _set_target(state);
+}
+
+void PartitionControl::_set_target(State state)
 {
   if (state != _target_state || state != _target_state)
     printf("PartitionControl::set_target_state curr %s  prevtgt %s  tgt %s\n",
@@ -525,8 +552,9 @@ PartitionControl::State PartitionControl::current_state() const { return _curren
 void PartitionControl::reconfigure(bool wait)
 {
   printf("PartitionControl::reconfigure %c\n",wait?'t':'f');
-  if (_target_state > Mapped) {
-    _queued_target = _target_state;
+  State target = _abort_cycle();
+  if (target > Mapped) {
+    _queued_target = target;
     set_target_state(Mapped);
     if (wait) {
       pthread_mutex_lock(&_target_mutex);
@@ -539,10 +567,13 @@ void PartitionControl::reconfigure(bool wait)
 
 void PartitionControl::pause()
 {
-  if (_target_state > Disabled) {
-    _queued_target = _target_state;
+  State target = _abort_cycle();
+  if (target > Disabled) {
+    _queued_target = target;
     set_target_state(Disabled);
   }
+  else if (target != _target_state)  // a cycle from Disabled
+    set_target_state(target);
 }
 
 void  PartitionControl::set_runAllocator (RunAllocator* ra) {
@@ -561,6 +592,60 @@ void  PartitionControl::use_run_info(bool r) {
   _use_run_info=r;
 }
 
+void  PartitionControl::set_fast_scan(bool v) {
+  _fast_scan=v;
+}
+
+void  PartitionControl::next_cycle()
+{
+  if (_target_state < Disabled || _cycling) {
+    printf("PartitionControl::next_cycle ignored in state %s/%s%s\n",
+           name(_current_state), name(_target_state), _cycling ? " (cycling)":"");
+    return;
+  }
+  clock_gettime(CLOCK_REALTIME, &_cycle_start);
+  pthread_mutex_lock(&_cycle_mutex);
+  _cycling       = true;
+  _queued_target = _target_state;
+  _set_target(Running);
+  pthread_mutex_unlock(&_cycle_mutex);
+}
+
+//
+//  Ends the calib cycle in progress, if any, and returns the target the
+//  cycle would have returned to (the current target otherwise).  The
+//  target itself is left for the caller to set.
+//
+PartitionControl::State PartitionControl::_abort_cycle()
+{
+  pthread_mutex_lock(&_cycle_mutex);
+  State target = _target_state;
+  if (_cycling) {
+    printf("PartitionControl::next_cycle aborted in state %s/%s\n",
+           name(_current_state), name(_target_state));
+    target         = _queued_target;
+    _queued_target = Mapped;
+    _cycling       = false;
+  }
+  pthread_mutex_unlock(&_cycle_mutex);
+  return target;
+}
+
+void  PartitionControl::_cycle_done()
+{
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  double ms = 1.e3*double(ts.tv_sec - _cycle_start.tv_sec) +
+    1.e-6*double(ts.tv_nsec - _cycle_start.tv_nsec);
+  unsigned bin = ms > 1 ? unsigned(10.*log10(ms)) : 0;
+  if (bin < _cycle_time->desc().nbins())
+    _cycle_time->addcontent(1, bin);
+  else
+    _cycle_time->addinfo(1, MonEntryTH1F::Overflow);
+  _cycle_time->time(ClockTime(ts.tv_sec, ts.tv_nsec));
+  _cycling = false;
+}
+
 unsigned PartitionControl::get_transition_env(TransitionId::Value tr) const
 { return _transition_env[tr]; }
 
@@ -658,6 +743,8 @@ void PartitionControl::_next()
    name(_current_state), name(_target_state));
 #endif
   if      (_current_state==_target_state) {
+    if (_cycling)
+      _cycle_done();
     pthread_cond_signal(&_target_cond);
   }
   else if (_target_state > _current_state)
@@ -719,9 +806,32 @@ void PartitionControl::_complete(TransitionId::Value id)
     break;
   case TransitionId::Configure      :
   case TransitionId::EndRun         : _current_state = Configured; break;
-  case TransitionId::BeginRun       :
-  case TransitionId::EndCalibCycle  : _current_state = Running   ; break;
+  case TransitionId::BeginRun       : _current_state = Running   ; break;
+  case TransitionId::EndCalibCycle  :
+    pthread_mutex_lock(&_cycle_mutex);
+    _current_state = Running   ;
+    //  Return to the target the cycle was started from, unless the cycle
+    //  was aborted by a new target
+    if (_cycling && _target_state==Running) {
+      State target   = _queued_target;
+      _queued_target = Mapped;
+      if (_cycle_begin)
+        _target_state = target;
+      else
+        _set_target(target);
+      pthread_mutex_unlock(&_cycle_mutex);
+      return;
+    }
+    //  In fast-scan mode the BeginCalibCycle is already on its way; its
+    //  completion takes us on to the target
+    if (_cycle_begin) {
+      pthread_mutex_unlock(&_cycle_mutex);
+      return;
+    }
+    pthread_mutex_unlock(&_cycle_mutex);
+    break;
   case TransitionId::BeginCalibCycle:
+    _cycle_begin = false;
   case TransitionId::Disable        :
     _current_state = Disabled;
     if (_target_state==Disabled && _queued_target>Disabled) {
@@ -761,6 +871,26 @@ void PartitionControl::_execute(Transition& tr) {
   mcast(tr);
 
   _sem.take();  // block until transition is complete
+
+  _accepted(tr.id());
+}
+
+//
+//  Every level has accepted the transition.  In fast-scan mode an
+//  EndCalibCycle of a cycle still in progress is followed by the next
+//  BeginCalibCycle without waiting for it to complete.
+//
+void PartitionControl::_accepted(TransitionId::Value id)
+{
+  if (!_fast_scan || id!=TransitionId::EndCalibCycle)
+    return;
+
+  pthread_mutex_lock(&_cycle_mutex);
+  if (_cycling && _target_state==Running && _current_state==Disabled) {
+    _cycle_begin = true;
+    _queue(TransitionId::BeginCalibCycle);
+  }
+  pthread_mutex_unlock(&_cycle_mutex);
 }
 
 const ControlEb& PartitionControl::eb() const { return _eb; }
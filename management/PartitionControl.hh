@@ -11,6 +11,7 @@
 #include "pdsdata/psddl/alias.ddl.h"
 
 #include <pthread.h>
+#include <time.h>
 // #include <set>
 #include <vector>
 
@@ -25,6 +26,7 @@ namespace Pds {
   class Task;
   class RunAllocator;
   class Sequencer;
+  class MonEntryTH1F;
 
   class PartitionControl : public ControlLevel {
   public:
@@ -83,14 +85,31 @@ namespace Pds {
     void  set_experiment   (unsigned experiment);
     void  set_sequencer    (Sequencer* seq);
     void  use_run_info(bool);
+    //
+    //  Ends the current calib cycle and begins the next, then returns to
+    //  the target state.  In fast-scan mode the next BeginCalibCycle is
+    //  issued as soon as every level has accepted the EndCalibCycle,
+    //  without waiting for the EndCalibCycle to complete.  The segment
+    //  levels have their next scan step staged by CfgCache, so only
+    //  devices that take their step configuration from it should be run
+    //  this way.  A new target (set_target_state, pause, reconfigure)
+    //  aborts the cycle: its target is kept rather than the cycle's.
+    //
+    void  next_cycle       ();
+    void  set_fast_scan    (bool);
   public: // Implements ControlLevel
     void  message          (const Node& hdr,
           const Message& msg);
   private:
     void  _next            ();
+    void  _set_target      (State);
+    State _abort_cycle     ();
+    void  _cycle_done      ();
+  protected:  // sequencing, replaced by partitioncontroltest
     void  _queue           (TransitionId::Value id);
-    void  _queue           (const Transition&   tr);
+    virtual void _queue    (const Transition&   tr);
     void  _complete        (TransitionId::Value id);
+    void  _accepted        (TransitionId::Value id);
   public:
     void  _execute         (Transition& tr);
   public:
@@ -117,6 +136,11 @@ namespace Pds {
     unsigned   _experiment;
     bool       _use_run_info;
     unsigned   _pulse_id;
+    bool       _fast_scan;
+    volatile bool _cycling;
+    volatile bool _cycle_begin;   // fast-scan BeginCalibCycle queued
+    timespec   _cycle_start;
+    MonEntryTH1F* _cycle_time;
     Task*      _reportTask;
     friend class ControlAction;
 
@@ -126,6 +150,7 @@ namespace Pds {
 
     pthread_mutex_t _target_mutex;
     pthread_cond_t  _target_cond;
+    pthread_mutex_t _cycle_mutex;
   };
 
 };
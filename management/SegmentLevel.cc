@@ -18,6 +18,8 @@
 #include "pds/config/EvrConfigType.hh"
 #include "pds/management/EventBuilder.hh"
 #include "pds/management/EventCallback.hh"
+#include "pds/management/ParallelConfigure.hh"
+#include "pds/utility/Stream.hh"
 #include "pdsdata/xtc/DetInfo.hh"
 
 #include <unistd.h>
@@ -44,6 +46,7 @@ SegmentLevel::SegmentLevel(unsigned platform,
   _callback      (callback),
   _streams       (0),
   _evr           (0),
+  _configGroup   (0),
   _reply         (settings.sources())
 {
   if (settings.pAliases()) {
@@ -57,6 +60,29 @@ SegmentLevel::SegmentLevel(unsigned platform,
 SegmentLevel::~SegmentLevel()
 {
   if (_streams)  delete _streams;
+  if (_configGroup) delete _configGroup;
+}
+
+//
+//  The appliances the callback attached lie between the inlet and the
+//  level's own appliances ("end"); with configure_threads() they are
+//  configured concurrently by a group connected ahead of them.
+//
+void SegmentLevel::_groupConfigure(Inlet* inlet, Appliance* end)
+{
+  unsigned nthreads = _settings.configure_threads();
+  if (!nthreads)
+    return;
+
+  unsigned napps = 0;
+  for(Appliance* app = inlet->forward(); app != end; app = app->forward())
+    napps++;
+  if (napps < 2)
+    return;
+
+  _configGroup = new ParallelConfigure(napps, nthreads);
+  _configGroup->connect(inlet);
+  printf("SegmentLevel configures %u appliances on %u threads\n", napps, nthreads);
 }
 
 bool SegmentLevel::attach()
@@ -76,7 +102,8 @@ bool SegmentLevel::attach()
         _streams = new TaggedStreams(*this,
                                      _settings.max_event_size (),
                                      _settings.max_event_depth(),
-                                     vname);
+                                     vname,
+                                     _settings.match_tolerance());
       }
       else {
         _streams = new SegStreams(*this,
@@ -86,7 +113,10 @@ bool SegmentLevel::attach()
       }
       _streams->connect();
 
+      Inlet* inlet = _streams->stream(StreamParams::FrameWork)->inlet();
+      Appliance* levelApps = inlet->forward();
       _callback.attached(*_streams);
+      _groupConfigure(inlet, levelApps);
 
       //  Add the L1 Data servers
       _settings.connect(*_streams->wire(StreamParams::FrameWork),
@@ -192,6 +222,7 @@ void    SegmentLevel::allocated(const Allocation& alloc,
   owire->bind(OutletWire::Bcast, StreamPorts::bcast(partition,
                                                     Level::Event,
                                                     index));
+  owire->bind(OutletWire::Credits, StreamPorts::ebCredit(partition));
 
   //
   //  Assign traffic shaping phase
@@ -248,6 +279,10 @@ void SegmentLevel::detach()
     _streams->disconnect();
     delete _streams;
     _streams = 0;
+    if (_configGroup) {
+      delete _configGroup;
+      _configGroup = 0;
+    }
     _callback.dissolved(header());
   }
   cancel();
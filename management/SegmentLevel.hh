@@ -12,6 +12,9 @@ namespace Pds {
   class Arp;
   class EventCallback;
   class Server;
+  class Inlet;
+  class Appliance;
+  class ParallelConfigure;
 
   class SegmentLevel: public PartitionMember {
   public:
@@ -36,12 +39,14 @@ namespace Pds {
     void     post      (const Transition&);
     void     post      (const Occurrence&);
     void     post      (const InDatagram&);
+    void     _groupConfigure(Inlet*, Appliance*);
 
   protected:
     SegWireSettings& _settings;
     EventCallback& _callback;
     WiredStreams*  _streams;
     Server*        _evr;
+    ParallelConfigure* _configGroup;
     PingReply      _reply;
     AliasReply     _aliasReply;
   };
@@ -0,0 +1,193 @@
+#include "SimSegment.hh"
+
+#include "pds/utility/ChunkIterator.hh"
+#include "pds/utility/OutletWireHeader.hh"
+#include "pds/utility/Mtu.hh"
+#include "pds/service/Client.hh"
+#include "pds/service/GenericPool.hh"
+#include "pds/service/Task.hh"
+#include "pds/xtc/CDatagram.hh"
+#include "pdsdata/xtc/TypeId.hh"
+#include "pdsdata/xtc/TransitionId.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace Pds;
+
+static const unsigned MaxFiducials = 0x1ffff;
+
+namespace Pds {
+  class SimChunk {
+  public:
+    SimChunk(const OutletWireHeader* h, const char* p, unsigned s) :
+      header(*h), payload(p), size(s) {}
+  public:
+    OutletWireHeader header;
+    const char*      payload;
+    unsigned         size;
+  };
+};
+
+SimSegment::Params::Params() :
+  minSize     (1024),
+  maxSize     (1024),
+  rate        (120.),
+  jitter      (0),
+  reorder     (0),
+  dropFragment(0),
+  missing     (0),
+  nevents     (1000)
+{
+}
+
+SimSegment::SimSegment(unsigned        id,
+                       const Src&      src,
+                       const Ins&      dst,
+                       const Params&   params,
+                       const timespec& start) :
+  _id       (id),
+  _src      (src),
+  _dst      (dst),
+  _params   (params),
+  _start    (start),
+  _client   (new Client(sizeof(OutletWireHeader), Mtu::Size, Ins(dst.address()))),
+  _pool     (new GenericPool(sizeof(CDatagram)+params.maxSize+sizeof(Xtc), 1)),
+  _task     (0),
+  _seed     (0x5eed+id),
+  _done     (false),
+  _sent     (0),
+  _missed   (0),
+  _reordered(0),
+  _dropped  (0),
+  _bytes    (0)
+{
+  if (_client->error())
+    printf("*** SimSegment %u client error: %s\n", id, strerror(_client->error()));
+}
+
+SimSegment::~SimSegment()
+{
+  if (_task) _task->destroy();
+  delete _pool;
+  delete _client;
+}
+
+void SimSegment::start()
+{
+  char name[32];
+  sprintf(name,"SimSeg%u",_id);
+  _task = new Task(TaskObject(name));
+  _task->call(this);
+}
+
+//
+//  Every simulated segment derives the same sequence for a given event
+//  so that their contributions coincide at the event level.  The clock
+//  carries the nominal generation time, from which the sink measures
+//  the post latency.
+//
+void SimSegment::stamp(unsigned event, double rate, const timespec& start,
+                       timespec& clock, unsigned& fiducials)
+{
+  unsigned long long ns = (unsigned long long)(double(event)*1.e9/rate);
+  clock.tv_sec  = start.tv_sec  + ns / 1000000000ULL;
+  clock.tv_nsec = start.tv_nsec + ns % 1000000000ULL;
+  if (clock.tv_nsec >= 1000000000) {
+    clock.tv_nsec -= 1000000000;
+    clock.tv_sec++;
+  }
+  fiducials = event & MaxFiducials;
+}
+
+void SimSegment::routine()
+{
+  for(unsigned event=0; event<_params.nevents; event++) {
+    timespec when;
+    unsigned fiducials;
+    stamp(event, _params.rate, _start, when, fiducials);
+    if (_params.jitter) {
+      when.tv_nsec += unsigned(_uniform()*double(_params.jitter));
+      if (when.tv_nsec >= 1000000000) {
+        when.tv_nsec -= 1000000000;
+        when.tv_sec++;
+      }
+    }
+    clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &when, 0);
+
+    if (_uniform() < _params.missing)
+      _missed++;
+    else
+      _send(event);
+  }
+  _done = true;
+}
+
+void SimSegment::_send(unsigned event)
+{
+  timespec clock;
+  unsigned fiducials;
+  stamp(event, _params.rate, _start, clock, fiducials);
+
+  CDatagram* cdg = new(_pool) CDatagram(TypeId(TypeId::Id_Xtc,0), _src);
+  Datagram& dg = cdg->dg();
+  dg.seq = Sequence(Sequence::Event, TransitionId::L1Accept,
+                    ClockTime(clock.tv_sec, clock.tv_nsec),
+                    TimeStamp(0, fiducials, 0));
+
+  unsigned size = _params.minSize;
+  if (_params.maxSize > _params.minSize)
+    size += unsigned(_uniform()*double(_params.maxSize-_params.minSize));
+  size &= ~3;
+
+  //  new(Xtc*) appends the child to dg.xtc; the payload is allocated in
+  //  the child and the parent grows by the same amount
+  Xtc& tc = *new(&dg.xtc) Xtc(TypeId(TypeId::Any,0), _src);
+  unsigned* p = reinterpret_cast<unsigned*>(tc.alloc(size));
+  dg.xtc.extent += tc.sizeofPayload();
+  for(unsigned i=0; i<(size>>2); i++)
+    p[i] = event+i;
+
+  unsigned extent = dg.xtc.extent;
+  if (extent <= Mtu::Size)
+    _client->send((char*)&dg, (char*)&dg.xtc, extent, _dst);
+  else {
+    std::vector<SimChunk> chunks;
+    DgChunkIterator chkIter(&dg);
+    do {
+      chunks.push_back(SimChunk(chkIter.header(),
+                                chkIter.payload(),
+                                chkIter.payloadSize()));
+    } while(chkIter.next());
+
+    if (_uniform() < _params.reorder) {
+      unsigned i = unsigned(_uniform()*double(chunks.size()-1));
+      SimChunk c = chunks[i];
+      chunks[i]   = chunks[i+1];
+      chunks[i+1] = c;
+      _reordered++;
+    }
+
+    if (_uniform() < _params.dropFragment) {
+      chunks.erase(chunks.begin()+unsigned(_uniform()*double(chunks.size())));
+      _dropped++;
+    }
+
+    for(unsigned i=0; i<chunks.size(); i++)
+      _client->send((char*)&chunks[i].header,
+                    (char*)chunks[i].payload,
+                    chunks[i].size,
+                    _dst);
+  }
+
+  _sent++;
+  _bytes += double(extent);
+  delete cdg;
+}
+
+double SimSegment::_uniform()
+{
+  return double(rand_r(&_seed))/(double(RAND_MAX)+1.);
+}
@@ -0,0 +1,83 @@
+#ifndef Pds_SimSegment_hh
+#define Pds_SimSegment_hh
+
+//
+//  A simulated segment level for benchmarking the event level builder.
+//  Generates L1Accept contributions of configurable size at a fixed rate
+//  and sends them over the production chunking path (OutletWireHeader +
+//  DgChunkIterator) to a loopback event level.  Faults (jitter, fragment
+//  reordering, dropped fragments, missing contributions) may be injected.
+//
+
+#include "pds/service/Routine.hh"
+#include "pds/service/Ins.hh"
+#include "pdsdata/xtc/Src.hh"
+
+#include <time.h>
+
+namespace Pds {
+
+  class Client;
+  class Task;
+  class GenericPool;
+
+  class SimSegment : public Routine {
+  public:
+    class Params {
+    public:
+      Params();
+    public:
+      unsigned minSize;         // contribution payload size range [bytes]
+      unsigned maxSize;
+      double   rate;            // events per second
+      unsigned jitter;          // max send time jitter [ns]
+      double   reorder;         // probability a chunked contribution is reordered
+      double   dropFragment;    // probability a chunked contribution loses one fragment
+      double   missing;         // probability a contribution is not sent at all
+      unsigned nevents;         // number of events to generate
+    };
+  public:
+    SimSegment(unsigned        id,
+               const Src&      src,
+               const Ins&      dst,
+               const Params&   params,
+               const timespec& start);
+    ~SimSegment();
+  public:
+    void start  ();
+    void routine();
+    bool done   () const { return _done; }
+  public:
+    unsigned     id       () const { return _id; }
+    const Src&   src      () const { return _src; }
+    unsigned     sent     () const { return _sent; }
+    unsigned     missed   () const { return _missed; }
+    unsigned     reordered() const { return _reordered; }
+    unsigned     dropped  () const { return _dropped; }
+    double       bytes    () const { return _bytes; }
+  public:
+    static void  stamp(unsigned event, double rate, const timespec& start,
+                       timespec& clock, unsigned& fiducials);
+  private:
+    void     _send   (unsigned event);
+    double   _uniform();
+  private:
+    unsigned     _id;
+    Src          _src;
+    Ins          _dst;
+    Params       _params;
+    timespec     _start;
+    Client*      _client;
+    GenericPool* _pool;
+    Task*        _task;
+    unsigned     _seed;
+    volatile bool _done;
+    unsigned     _sent;
+    unsigned     _missed;
+    unsigned     _reordered;
+    unsigned     _dropped;
+    double       _bytes;
+  };
+};
+
+#endif
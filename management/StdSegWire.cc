@@ -18,7 +18,9 @@ StdSegWire::StdSegWire(EbServer&   server,
   _istriggered  (is_triggered),
   _evrmodule    (evr_module),
   _evrchannel   (evr_channel),
-  _hasfiducial  (has_fiducial)
+  _hasfiducial  (has_fiducial),
+  _configthreads(0),
+  _matchtolerance(0)
 {
   _sources.push_back(server.client()); 
 
@@ -44,7 +46,9 @@ StdSegWire::StdSegWire(std::list<EbServer*> servers,
   _istriggered  (is_triggered),
   _evrmodule    (evr_module),
   _evrchannel   (evr_channel),
-  _hasfiducial  (has_fiducial)
+  _hasfiducial  (has_fiducial),
+  _configthreads(0),
+  _matchtolerance(0)
 {
   for(std::list<EbServer*>::iterator it=servers.begin(); it!=servers.end(); it++)
     _sources.push_back((*it)->client()); 
@@ -107,3 +111,23 @@ bool StdSegWire::has_fiducial() const
 {
   return _hasfiducial;
 }
+
+unsigned StdSegWire::configure_threads() const
+{
+  return _configthreads;
+}
+
+void StdSegWire::configure_threads(unsigned n)
+{
+  _configthreads = n;
+}
+
+unsigned StdSegWire::match_tolerance() const
+{
+  return _matchtolerance;
+}
+
+void StdSegWire::match_tolerance(unsigned ns)
+{
+  _matchtolerance = ns;
+}
@@ -39,6 +39,11 @@ namespace Pds {
     unsigned max_event_size () const;
     unsigned max_event_depth() const;
     bool     has_fiducial   () const;
+    unsigned configure_threads() const;
+    unsigned match_tolerance  () const;
+  public:
+    void     configure_threads(unsigned);
+    void     match_tolerance  (unsigned);
   private:
     std::list<EbServer*> _server;
     std::list<Src>       _sources;
@@ -49,6 +54,8 @@ namespace Pds {
     unsigned             _evrmodule;
     unsigned             _evrchannel;
     bool                 _hasfiducial;
+    unsigned             _configthreads;
+    unsigned             _matchtolerance;
   };
 };
 
@@ -4,6 +4,7 @@
 #include "pds/management/VmonServerAppliance.hh"
 #include "pds/utility/ToEventWireScheduler.hh"
 #include "pds/utility/InletWire.hh"
+#include "pds/utility/EbT.hh"
 #include "pds/service/VmonSourceId.hh"
 #include "pds/vmon/VmonEb.hh"
 #include "pds/xtc/XtcType.hh"
@@ -15,7 +16,8 @@ static const unsigned MaxSize = 16*1024*1024;
 TaggedStreams::TaggedStreams(PartitionMember& cmgr,
                              unsigned max_event_size,
                              unsigned max_event_depth,
-                             const char* name) :
+                             const char* name,
+                             unsigned match_tolerance) :
   WiredStreams(VmonSourceId(cmgr.header().level(), cmgr.header().ip()))
 {
   if (!max_event_size)
@@ -33,18 +35,33 @@ TaggedStreams::TaggedStreams(PartitionMember& cmgr,
                                            max_event_size*max_event_depth,
                                            cmgr.occurrences());
 
-    EbS* ebs = new EbS(src,
-                       _xtcType,
-                       level,
-                       *stream(s)->inlet(),
-                       *_outlets[s],
-                       s,
-                       ipaddress,
-                       max_event_size, max_event_depth, 0,
-                       new VmonEb(src,32,max_event_depth,(1<<23),max_event_size));
-    ebs->require_in_order(false);
-    ebs->printSinks(false); // these are routine
-    _inlet_wires[s] = ebs;
+    //  Contributions are matched by clock time within "match_tolerance" ns
+    //  if one is given, otherwise by fiducial
+    Eb* eb;
+    if (match_tolerance)
+      eb = new EbT(src,
+                   _xtcType,
+                   level,
+                   *stream(s)->inlet(),
+                   *_outlets[s],
+                   s,
+                   ipaddress,
+                   max_event_size, max_event_depth, 0,
+                   match_tolerance,
+                   new VmonEb(src,32,max_event_depth,(1<<23),max_event_size));
+    else
+      eb = new EbS(src,
+                   _xtcType,
+                   level,
+                   *stream(s)->inlet(),
+                   *_outlets[s],
+                   s,
+                   ipaddress,
+                   max_event_size, max_event_depth, 0,
+                   new VmonEb(src,32,max_event_depth,(1<<23),max_event_size));
+    eb->require_in_order(false);
+    eb->printSinks(false); // these are routine
+    _inlet_wires[s] = eb;
 
     (new VmonServerAppliance(src,name))->connect(stream(s)->inlet());
   }
@@ -7,6 +7,7 @@
 #include "pds/service/Ins.hh"
 #include "pds/mon/MonServer.hh"
 #include "pds/vmon/VmonServerSocket.hh"
+#include "pds/vmon/VmonTasks.hh"
 
 #include "pdsdata/xtc/DetInfo.hh"
 
@@ -18,7 +19,8 @@ using namespace Pds;
 VmonServerAppliance::VmonServerAppliance(const Src& src,
                                          const char* name) :
   _src      (src),
-  _partition(-1)
+  _partition(-1),
+  _tasks    (0)
 {
   if (name)
     _name = std::string(name);
@@ -49,6 +51,7 @@ VmonServerAppliance::VmonServerAppliance(const Src& src,
 
 VmonServerAppliance::~VmonServerAppliance()
 {
+  delete _tasks;
 }
 
 
@@ -61,6 +64,10 @@ Transition* VmonServerAppliance::transitions(Transition* tr)
     Ins vmon(StreamPorts::vmon(_partition));
 
     VmonServerManager::instance(_name.c_str())->listen(_src, vmon);
+
+    //  The node's tasks exist by the first Map
+    if (!_tasks)
+      _tasks = new VmonTasks;
   }
   else if (tr->id()==TransitionId::Unmap) {
     VmonServerManager::instance()->listen();
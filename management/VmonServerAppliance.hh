@@ -12,6 +12,7 @@
 namespace Pds {
 
   class MonServer;
+  class VmonTasks;
 
   class VmonServerAppliance : public Appliance {
   public:
@@ -25,6 +26,7 @@ namespace Pds {
     Src         _src;
     std::string _name;
     int         _partition;
+    VmonTasks*  _tasks;
   };
 
 };
@@ -1,8 +1,27 @@
 libnames := management
 
-libsrcs_management := $(wildcard *.cc)
+libsrcs_management := $(filter-out ebbench.cc SimSegment.cc parallelconfiguretest.cc partitioncontroltest.cc,$(wildcard *.cc))
 libincs_management := pdsdata/include ndarray/include boost/include 
 
+tgtnames := ebbench parallelconfiguretest partitioncontroltest
+tgtsrcs_ebbench := ebbench.cc SimSegment.cc
+tgtlibs_ebbench := pdsdata/xtcdata pdsdata/appdata
+tgtlibs_ebbench += pds/management pds/utility pds/service pds/collection pds/vmon pds/mon pds/xtc
+tgtslib_ebbench := $(USRLIBDIR)/rt
+tgtincs_ebbench := pdsdata/include
+
+tgtsrcs_parallelconfiguretest := parallelconfiguretest.cc
+tgtlibs_parallelconfiguretest := pdsdata/xtcdata
+tgtlibs_parallelconfiguretest += pds/management pds/utility pds/service pds/collection pds/xtc
+tgtslib_parallelconfiguretest := $(USRLIBDIR)/rt
+tgtincs_parallelconfiguretest := pdsdata/include
+
+tgtsrcs_partitioncontroltest := partitioncontroltest.cc
+tgtlibs_partitioncontroltest := pdsdata/xtcdata pdsdata/appdata pdsdata/psddl_pdsdata
+tgtlibs_partitioncontroltest += pds/management pds/utility pds/service pds/collection pds/vmon pds/mon pds/xtc
+tgtslib_partitioncontroltest := $(USRLIBDIR)/rt
+tgtincs_partitioncontroltest := pdsdata/include
+
 #DEFINES += -DBUILD_SLOW_DISABLE -DBUILD_LARGE_STREAM_BUFFER # for princeton camera
 #DEFINES += -DBUILD_SLOW_DISABLE        # for long exposure. No need if princeton runs with "delay shots"
 
@@ -0,0 +1,252 @@
+//
+//  ebbench - end-to-end event builder benchmark.
+//
+//  Runs a set of simulated segment levels (SimSegment) on loopback which
+//  send L1Accept contributions to a real event level builder (EbS) through
+//  the production NetDgServer inputs.  Built events pass through an
+//  appliance which measures them and are then sunk by an Outlet.
+//
+#include "pds/management/SimSegment.hh"
+#include "pds/management/EventStreams.hh"
+#include "pds/management/EventBuilder.hh"
+#include "pds/utility/Inlet.hh"
+#include "pds/utility/Outlet.hh"
+#include "pds/utility/OpenOutlet.hh"
+#include "pds/utility/NetDgServer.hh"
+#include "pds/utility/StreamPorts.hh"
+#include "pds/utility/StreamParams.hh"
+#include "pds/xtc/XtcType.hh"
+#include "pdsdata/xtc/ProcInfo.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <vector>
+
+namespace Pds {
+  //
+  //  Accumulates built events, bytes, damage and post latency.  Latency is
+  //  binned logarithmically (8 bins per octave of nanoseconds).
+  //
+  class EbBenchSink : public Appliance {
+  public:
+    enum { BinsPerOctave=8, NBins=40*BinsPerOctave };
+    EbBenchSink() { reset(); }
+  public:
+    Transition* transitions(Transition* tr) { return tr; }
+    InDatagram* events     (InDatagram* in) {
+      const Datagram& dg = in->datagram();
+      if (dg.seq.service()==TransitionId::L1Accept) {
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        double dt = double(now.tv_sec - dg.seq.clock().seconds())*1.e9 +
+          double(now.tv_nsec) - double(dg.seq.clock().nanoseconds());
+        unsigned bin = dt > 1 ? unsigned(log2(dt)*BinsPerOctave) : 0;
+        _latency[bin < NBins ? bin : NBins-1]++;
+        _events++;
+        _bytes += dg.xtc.extent;
+        if (dg.xtc.damage.value()) {
+          _damaged++;
+          if (dg.xtc.damage.value() & (1<<Damage::IncompleteContribution))
+            _incomplete++;
+          if (dg.xtc.damage.value() & (1<<Damage::DroppedContribution))
+            _dropped++;
+        }
+      }
+      return in;
+    }
+  public:
+    void reset() {
+      _events=_damaged=_incomplete=_dropped=0;
+      _bytes=0;
+      memset(_latency,0,sizeof(_latency));
+    }
+    unsigned events    () const { return _events; }
+    unsigned damaged   () const { return _damaged; }
+    unsigned incomplete() const { return _incomplete; }
+    unsigned dropped   () const { return _dropped; }
+    double   bytes     () const { return _bytes; }
+    //  Upper edge of the bin containing the fraction f of events [us]
+    double   percentile(double f) const {
+      double n=0, nt=f*double(_events);
+      for(unsigned i=0; i<NBins; i++)
+        if ((n += _latency[i]) >= nt)
+          return pow(2.,double(i+1)/double(BinsPerOctave))*1.e-3;
+      return pow(2.,double(NBins)/double(BinsPerOctave))*1.e-3;
+    }
+  private:
+    unsigned _events;
+    unsigned _damaged;
+    unsigned _incomplete;
+    unsigned _dropped;
+    double   _bytes;
+    unsigned _latency[NBins];
+  };
+};
+
+using namespace Pds;
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [options]\n"
+         "Options:\n"
+         "\t-n <segments>       number of simulated segment levels [4]\n"
+         "\t-D <segments>       number of additional dead (never contributing) segment levels [0]\n"
+         "\t-s <min>[,<max>]    contribution size range [bytes] [1024]\n"
+         "\t-r <rate>           event rate [Hz] [120]\n"
+         "\t-e <events>         number of events [1000]\n"
+         "\t-j <ns>             max send jitter [0]\n"
+         "\t-o <prob>           probability of fragment reordering [0]\n"
+         "\t-f <prob>           probability of a dropped fragment [0]\n"
+         "\t-m <prob>           probability of a missing contribution [0]\n"
+         "\t-d <depth>          event builder depth [%d]\n"
+         "\t-p <partition>      partition (selects ports) [0]\n"
+         "\t-S                  slow event builder timeouts\n",
+         p, EventStreams::EbDepth);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned nsegments = 4;
+  unsigned ndead     = 0;
+  unsigned depth     = EventStreams::EbDepth;
+  unsigned partition = 0;
+  int      slowEb    = 0;
+  SimSegment::Params params;
+
+  int c;
+  while ((c = getopt(argc, argv, "n:D:s:r:e:j:o:f:m:d:p:Sh")) != -1) {
+    char* endPtr;
+    switch(c) {
+    case 'n': nsegments = strtoul(optarg,NULL,0); break;
+    case 'D': ndead     = strtoul(optarg,NULL,0); break;
+    case 's':
+      params.minSize = params.maxSize = strtoul(optarg,&endPtr,0);
+      if (*endPtr==',')
+        params.maxSize = strtoul(endPtr+1,NULL,0);
+      break;
+    case 'r': params.rate         = strtod (optarg,NULL); break;
+    case 'e': params.nevents      = strtoul(optarg,NULL,0); break;
+    case 'j': params.jitter       = strtoul(optarg,NULL,0); break;
+    case 'o': params.reorder      = strtod (optarg,NULL); break;
+    case 'f': params.dropFragment = strtod (optarg,NULL); break;
+    case 'm': params.missing      = strtod (optarg,NULL); break;
+    case 'd': depth               = strtoul(optarg,NULL,0); break;
+    case 'p': partition           = strtoul(optarg,NULL,0); break;
+    case 'S': slowEb              = 1; break;
+    case 'h':
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  if (params.maxSize < params.minSize ||
+      nsegments+ndead > EbBitMask::BitMaskBits) {
+    usage(argv[0]);
+    exit(1);
+  }
+
+  const int loopback = 0x7f000001;
+  unsigned maxSize = (nsegments+ndead)*(params.maxSize+2*sizeof(Xtc)) + sizeof(Datagram);
+
+  Inlet   inlet;
+  Outlet  outlet;
+  OpenOutlet wire(outlet);
+  outlet.connect(&inlet);
+  EbBenchSink* sink = new EbBenchSink;
+  sink->connect(&inlet);
+
+  ProcInfo id(Level::Event, getpid(), loopback);
+  EventBuilder* eb = new EventBuilder(id, _xtcType, Level::Event,
+                                      inlet, wire,
+                                      StreamParams::FrameWork, loopback,
+                                      maxSize, depth, slowEb);
+  eb->connect();
+
+  timespec start;
+  clock_gettime(CLOCK_REALTIME, &start);
+  start.tv_sec += 1;
+
+  std::vector<SimSegment*> segments;
+  std::vector<NetDgServer*> servers;
+  for(unsigned i=0; i<nsegments+ndead; i++) {
+    Ins ins = StreamPorts::event(partition, Level::Event, 0, i);
+    ProcInfo src(Level::Segment, i, loopback);
+    NetDgServer* srv = new NetDgServer(Ins(ins.portId()),
+                                       src,
+                                       EventStreams::netbufdepth*(params.maxSize+sizeof(Datagram)));
+    eb->add_input(srv);
+    servers.push_back(srv);
+    if (i < nsegments)
+      segments.push_back(new SimSegment(i, src, Ins(loopback, ins.portId()),
+                                        params, start));
+  }
+
+  for(unsigned i=0; i<segments.size(); i++)
+    segments[i]->start();
+
+  printf("%u segments (%u dead) : %u-%u bytes @ %g Hz for %u events\n",
+         nsegments, ndead, params.minSize, params.maxSize, params.rate, params.nevents);
+  printf("%8s %10s %10s %8s %8s %8s %10s %10s %10s\n",
+         "events","evt/s","MB/s","damaged","incompl","dropped",
+         "p50[us]","p99[us]","p99.9[us]");
+
+  timespec tprev = start;
+  unsigned eprev = 0;
+  double   bprev = 0;
+  bool     done  = false;
+  sleep(1);
+  while(!done) {
+    sleep(1);
+    done = true;
+    for(unsigned i=0; i<segments.size(); i++)
+      done &= segments[i]->done();
+
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    double dt = double(now.tv_sec-tprev.tv_sec)+1.e-9*double(now.tv_nsec-tprev.tv_nsec);
+    unsigned events = sink->events();
+    double   bytes  = sink->bytes();
+    printf("%8u %10.1f %10.2f %8u %8u %8u %10.1f %10.1f %10.1f\n",
+           events,
+           double(events-eprev)/dt,
+           (bytes-bprev)/dt*1.e-6,
+           sink->damaged(), sink->incomplete(), sink->dropped(),
+           sink->percentile(0.5), sink->percentile(0.99), sink->percentile(0.999));
+    tprev = now;
+    eprev = events;
+    bprev = bytes;
+  }
+
+  //  Allow the builder to time out the last events
+  sleep(2);
+
+  unsigned sent=0, missed=0, reordered=0, dropped=0;
+  for(unsigned i=0; i<segments.size(); i++) {
+    sent      += segments[i]->sent();
+    missed    += segments[i]->missed();
+    reordered += segments[i]->reordered();
+    dropped   += segments[i]->dropped();
+  }
+  unsigned fixups=0;
+  for(unsigned i=0; i<servers.size(); i++)
+    fixups += servers[i]->drops();
+
+  printf("--- Summary ---\n");
+  printf("Generated : %u contributions sent, %u missing, %u reordered, %u fragment drops\n",
+         sent, missed, reordered, dropped);
+  printf("Built     : %u events, %g MB, %u damaged (%u incomplete, %u dropped)\n",
+         sink->events(), sink->bytes()*1.e-6,
+         sink->damaged(), sink->incomplete(), sink->dropped());
+  printf("Fixups    : %u\n", fixups);
+  printf("Latency   : p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f [us]\n",
+         sink->percentile(0.5), sink->percentile(0.9),
+         sink->percentile(0.99), sink->percentile(0.999));
+
+  eb->dump(0);
+  return 0;
+}
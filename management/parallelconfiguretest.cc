@@ -0,0 +1,248 @@
+//
+//  parallelconfiguretest - runs a chain of simulated detector appliances
+//  behind a ParallelConfigure group, as SegmentLevel connects them, and
+//  checks that
+//    - Configure runs on all members at once (the transition takes about
+//      as long as the slowest member, and every member starts before the
+//      first one finishes),
+//    - the Configure datagram passes through the members in order, and the
+//      damage of a failing member reaches the datagram and is reported in
+//      a UserMessage naming the detector,
+//    - a member which stops the transition stops it for the group, and a
+//      replaced transition is forwarded once, without running the members
+//      again,
+//    - other transitions pass through the members in turn.
+//
+//    parallelconfiguretest [-m <members>] [-t <threads>] [-d <ms>]
+//
+#include "pds/management/ParallelConfigure.hh"
+#include "pds/utility/Appliance.hh"
+#include "pds/utility/Inlet.hh"
+#include "pds/utility/Transition.hh"
+#include "pds/utility/Occurrence.hh"
+#include "pds/xtc/InDatagram.hh"
+#include "pds/service/GenericPool.hh"
+
+#include "pdsdata/xtc/DetInfo.hh"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+using namespace Pds;
+
+static double now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return double(ts.tv_sec)*1.e3+1.e-6*double(ts.tv_nsec);  // ms
+}
+
+//
+//  A datagram with room for the members' contributions
+//
+class TestDatagram : public InDatagram {
+public:
+  enum { MaxPayload = 4096 };
+  TestDatagram(TransitionId::Value id) :
+    InDatagram(Datagram(TypeId(TypeId::Id_Xtc,0), DetInfo(0,DetInfo::NoDetector,0,DetInfo::NoDevice,0)))
+  { seq = Sequence(Sequence::Event, id, ClockTime(0,0), TimeStamp(0,0,0)); }
+public:
+  bool insert(const Xtc& tc, const void* payload) {
+    if (xtc.sizeofPayload() + tc.extent > MaxPayload) return false;
+    char* p = reinterpret_cast<char*>(xtc.alloc(tc.extent));
+    memcpy(p, &tc, sizeof(Xtc));
+    memcpy(p+sizeof(Xtc), payload, tc.sizeofPayload());
+    return true;
+  }
+  InDatagramIterator* iterator(Pool*) const { return 0; }
+  int  send   (ToNetEb&, const Ins&) { return 0; }
+  int  send   (ToEb&) { return 0; }
+  TrafficDst* traffic(const Ins&) { return 0; }
+private:
+  char _payload[MaxPayload];
+};
+
+//
+//  A detector appliance which takes "delay" ms to configure and may fail
+//
+class TestMember : public Appliance {
+public:
+  enum Mode { Pass, Fail, Stop, Replace };
+  TestMember(unsigned id, unsigned delay, Mode mode=Pass) :
+    _src(0, DetInfo::XppEndstation, 0, DetInfo::Ipimb, id),
+    _delay(delay), _mode(mode), ncalls(0), nevents(0), start(0), end(0) {}
+public:
+  Transition* transitions(Transition* tr) {
+    __sync_fetch_and_add(&ncalls, 1);
+    if (tr->id()!=TransitionId::Configure)
+      return tr;
+    start = now();
+    usleep(_delay*1000);
+    end   = now();
+    if (_mode==Stop)    return 0;
+    if (_mode==Replace) return new Transition(TransitionId::Unconfigure, tr->env());
+    return tr;
+  }
+  InDatagram* events(InDatagram* in) {
+    nevents++;
+    if (in->datagram().seq.service()==TransitionId::Configure) {
+      Xtc tc(TypeId(TypeId::Any,0), _src);
+      uint32_t v = 0;
+      tc.extent += sizeof(v);
+      if (_mode==Fail) tc.damage.increase(Damage::UserDefined);
+      in->insert(tc, &v);
+      if (_mode==Fail) in->datagram().xtc.damage.increase(Damage::UserDefined);
+    }
+    return in;
+  }
+  void mode(Mode m) { _mode = m; }
+  const DetInfo& src() const { return _src; }
+private:
+  DetInfo  _src;
+  unsigned _delay;
+  Mode     _mode;
+public:
+  unsigned ncalls;
+  unsigned nevents;
+  double   start, end;
+};
+
+//
+//  The end of the chain (the outlet on a segment level)
+//
+class TestSink : public Appliance {
+public:
+  TestSink() : ntransitions(0), last(TransitionId::Unknown), damage(0), nevents(0) {}
+public:
+  Transition* transitions(Transition* tr) { ntransitions++; last = tr->id(); return 0; }
+  InDatagram* events     (InDatagram* in) { nevents++; damage = in->datagram().xtc.damage.value(); return 0; }
+  Occurrence* occurrences(Occurrence* occ) {
+    if (occ->id()==OccurrenceId::UserMessage)
+      messages.push_back(static_cast<UserMessage*>(occ)->msg());
+    return 0;
+  }
+public:
+  unsigned                 ntransitions;
+  TransitionId::Value      last;
+  uint32_t                 damage;
+  unsigned                 nevents;
+  std::vector<std::string> messages;
+};
+
+static unsigned _failed = 0;
+
+static void check(bool ok, const char* what)
+{
+  printf("%-64s %s\n", what, ok ? "ok" : "FAILED");
+  if (!ok) _failed++;
+}
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [-m <members>] [-t <threads>] [-d <ms>]\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned nmembers = 4;
+  unsigned nthreads = 4;
+  unsigned delay    = 100;
+
+  int c;
+  while ((c = getopt(argc, argv, "m:t:d:h")) != -1) {
+    switch (c) {
+    case 'm': nmembers = strtoul(optarg, NULL, 0); break;
+    case 't': nthreads = strtoul(optarg, NULL, 0); break;
+    case 'd': delay    = strtoul(optarg, NULL, 0); break;
+    default : usage(argv[0]); return 1;
+    }
+  }
+  if (nmembers < 2 || nthreads < nmembers) {
+    printf("*** needs at least 2 members and a thread for each\n");
+    return 1;
+  }
+
+  //  Connected as SegmentLevel does: each ahead of the last, then the group
+  Inlet    inlet;
+  TestSink sink;
+  sink.connect(&inlet);
+  std::vector<TestMember*> members;
+  for(unsigned i=0; i<nmembers; i++)
+    members.push_back(new TestMember(i, delay*(i+1)));
+  for(unsigned i=nmembers; i>0; i--)
+    members[i-1]->connect(&inlet);
+  ParallelConfigure group(nmembers, nthreads);
+  group.connect(&inlet);
+
+  GenericPool dgpool(sizeof(TestDatagram), 4);
+  Env env(0);
+
+  //  Concurrent configure
+  double t0 = now();
+  inlet.post(new Transition(TransitionId::Configure, env));
+  double dt = now() - t0;
+  double serial = 0, firstEnd = members[0]->end, lastStart = 0;
+  for(unsigned i=0; i<nmembers; i++) {
+    serial += delay*(i+1);
+    if (members[i]->end   < firstEnd ) firstEnd  = members[i]->end;
+    if (members[i]->start > lastStart) lastStart = members[i]->start;
+  }
+  printf("Configure took %.1f ms; %.1f ms in turn\n", dt, serial);
+  check(sink.ntransitions==1 && sink.last==TransitionId::Configure, "Configure forwarded once");
+  check(dt < delay*nmembers + 0.5*delay, "Configure takes about as long as the slowest member");
+  check(lastStart < firstEnd, "every member starts before the first one finishes");
+
+  //  The Configure datagram, with no failures
+  inlet.post(new(&dgpool) TestDatagram(TransitionId::Configure));
+  check(sink.nevents==1 && sink.damage==0 && sink.messages.empty(), "Configure datagram undamaged, no message");
+
+  //  A failing member
+  members[1]->mode(TestMember::Fail);
+  inlet.post(new Transition(TransitionId::Configure, env));
+  inlet.post(new(&dgpool) TestDatagram(TransitionId::Configure));
+  check(sink.nevents==2 && sink.damage!=0, "failing member damages the Configure datagram");
+  check(sink.messages.size()==1 &&
+        sink.messages[0].find(DetInfo::name(members[1]->src()))!=std::string::npos &&
+        sink.messages[0].find("FAILED")!=std::string::npos,
+        "failure reported in a UserMessage naming the detector");
+  if (!sink.messages.empty())
+    printf("%s", sink.messages[0].c_str());
+  members[1]->mode(TestMember::Pass);
+
+  //  A member which stops the transition
+  unsigned nt = sink.ntransitions;
+  members[0]->mode(TestMember::Stop);
+  inlet.post(new Transition(TransitionId::Configure, env));
+  check(sink.ntransitions==nt, "a member which stops Configure stops it for the group");
+  members[0]->mode(TestMember::Pass);
+
+  //  A member which replaces the transition
+  std::vector<unsigned> ncalls(nmembers);
+  for(unsigned i=0; i<nmembers; i++) ncalls[i] = members[i]->ncalls;
+  members[0]->mode(TestMember::Replace);
+  inlet.post(new Transition(TransitionId::Configure, env));
+  bool once = true;
+  for(unsigned i=0; i<nmembers; i++)
+    if (members[i]->ncalls != ncalls[i]+1) once = false;
+  check(sink.ntransitions==nt+1 && sink.last==TransitionId::Unconfigure && once,
+        "a replacement is forwarded once, the members run once");
+  members[0]->mode(TestMember::Pass);
+
+  //  Other transitions pass through in turn
+  for(unsigned i=0; i<nmembers; i++) ncalls[i] = members[i]->ncalls;
+  inlet.post(new Transition(TransitionId::Enable, env));
+  once = true;
+  for(unsigned i=0; i<nmembers; i++)
+    if (members[i]->ncalls != ncalls[i]+1) once = false;
+  check(sink.last==TransitionId::Enable && once, "Enable passes through the members in turn");
+
+  if (_failed)
+    printf("*** %u failures\n", _failed);
+  return _failed ? 1 : 0;
+}
@@ -0,0 +1,222 @@
+//
+//  partitioncontroltest - drives the PartitionControl state machine through
+//  calib cycles without a partition.  Transitions are queued in place of
+//  being multicast; each is then accepted (every level has the transition)
+//  and completed (its datagram has been built), and external commands are
+//  issued in between.  Checks that
+//    - a cycle returns to the state it started from, with and without
+//      fast-scan,
+//    - a stop, pause or reconfigure during the cycle aborts it and its own
+//      target is reached, with no BeginCalibCycle issued after the stop.
+//
+//    partitioncontroltest
+//
+#include "pds/management/PartitionControl.hh"
+#include "pds/management/ControlCallback.hh"
+#include "pds/utility/Transition.hh"
+
+#include <stdio.h>
+#include <list>
+#include <vector>
+
+using namespace Pds;
+
+class TestCallback : public ControlCallback {
+public:
+  void attached (SetOfStreams&) {}
+  void failed   (Reason) {}
+  void dissolved(const Node&) {}
+};
+
+class TestControl : public PartitionControl {
+public:
+  TestControl(ControlCallback& cb) : PartitionControl(0, cb, 0)
+  { use_run_info(false); }
+public:
+  //  Every level accepts the next queued transition
+  TransitionId::Value accept()
+  {
+    TransitionId::Value id = _pending.front();
+    _pending.pop_front();
+    _inflight.push_back(id);
+    _log.push_back(id);
+    _accepted(id);
+    return id;
+  }
+  //  The oldest accepted transition completes
+  void complete()
+  {
+    TransitionId::Value id = _inflight.front();
+    _inflight.pop_front();
+    _complete(id);
+  }
+  void run()
+  {
+    while(!_pending.empty() || !_inflight.empty()) {
+      if (!_pending.empty()) accept();
+      complete();
+    }
+  }
+  //  Runs until "id" has been accepted
+  void run_until(TransitionId::Value id)
+  {
+    while(!_pending.empty()) {
+      if (accept()==id) return;
+      complete();
+    }
+  }
+  std::vector<TransitionId::Value> log()
+  {
+    std::vector<TransitionId::Value> v(_log);
+    _log.clear();
+    return v;
+  }
+  bool idle() const { return _pending.empty() && _inflight.empty(); }
+protected:
+  using PartitionControl::_queue;
+  //  The control level disables by an L1Accept, which becomes a Disable
+  void _queue(const Transition& tr)
+  { _pending.push_back(tr.id()==TransitionId::L1Accept ? TransitionId::Disable : tr.id()); }
+private:
+  std::list  <TransitionId::Value> _pending;
+  std::list  <TransitionId::Value> _inflight;
+  std::vector<TransitionId::Value> _log;
+};
+
+static unsigned _failed = 0;
+
+static void check(bool ok, const char* what)
+{
+  printf("%-64s %s\n", what, ok ? "ok" : "FAILED");
+  if (!ok) _failed++;
+}
+
+static bool _sequence(const std::vector<TransitionId::Value>& log,
+                      const TransitionId::Value* expected, unsigned n)
+{
+  bool ok = (log.size()==n);
+  for(unsigned i=0; ok && i<n; i++)
+    ok = (log[i]==expected[i]);
+  if (!ok) {
+    printf("  sequence:");
+    for(unsigned i=0; i<log.size(); i++)
+      printf(" %s", TransitionId::name(log[i]));
+    printf("\n");
+  }
+  return ok;
+}
+
+#define SEQUENCE(log, ...) {                                    \
+    static const TransitionId::Value s[] = { __VA_ARGS__ };     \
+    ok = _sequence(log, s, sizeof(s)/sizeof(s[0]));             \
+  }
+
+static bool _at(TestControl& c, PartitionControl::State s)
+{
+  return c.idle() && c.current_state()==s && c.target_state()==s;
+}
+
+int main(int argc, char** argv)
+{
+  TestCallback cb;
+  TestControl  c(cb);
+  bool ok;
+
+  c.set_target_state(PartitionControl::Enabled);
+  c.run();
+  c.log();
+  check(_at(c, PartitionControl::Enabled), "Enabled");
+
+  for(unsigned fast=0; fast<2; fast++) {
+    const char* mode = fast ? " (fast-scan)" : "";
+    char what[128];
+    c.set_fast_scan(fast);
+
+    //  A cycle returns to Enabled
+    c.next_cycle();
+    c.run();
+    SEQUENCE(c.log(), TransitionId::Disable, TransitionId::EndCalibCycle,
+             TransitionId::BeginCalibCycle, TransitionId::Enable);
+    snprintf(what, sizeof(what), "cycle returns to Enabled%s", mode);
+    check(ok && _at(c, PartitionControl::Enabled), what);
+
+    //  A stop while disabling
+    c.next_cycle();
+    c.accept();
+    c.set_target_state(PartitionControl::Configured);
+    c.run();
+    SEQUENCE(c.log(), TransitionId::Disable, TransitionId::EndCalibCycle,
+             TransitionId::EndRun);
+    snprintf(what, sizeof(what), "stop while disabling ends Configured%s", mode);
+    check(ok && _at(c, PartitionControl::Configured), what);
+
+    c.set_target_state(PartitionControl::Enabled);
+    c.run();
+    c.log();
+
+    //  A stop once the EndCalibCycle is accepted
+    c.next_cycle();
+    c.run_until(TransitionId::EndCalibCycle);
+    c.set_target_state(PartitionControl::Configured);
+    c.run();
+    if (fast)   // the BeginCalibCycle was already on its way
+      SEQUENCE(c.log(), TransitionId::Disable, TransitionId::EndCalibCycle,
+               TransitionId::BeginCalibCycle, TransitionId::EndCalibCycle,
+               TransitionId::EndRun)
+    else
+      SEQUENCE(c.log(), TransitionId::Disable, TransitionId::EndCalibCycle,
+               TransitionId::EndRun)
+    snprintf(what, sizeof(what), "stop during EndCalibCycle ends Configured%s", mode);
+    check(ok && _at(c, PartitionControl::Configured), what);
+
+    c.set_target_state(PartitionControl::Enabled);
+    c.run();
+    c.log();
+
+    //  A pause during the cycle: disable, then return to Enabled without
+    //  a step
+    c.next_cycle();
+    c.accept();
+    c.pause();
+    c.run();
+    SEQUENCE(c.log(), TransitionId::Disable, TransitionId::Enable);
+    snprintf(what, sizeof(what), "pause during the cycle returns to Enabled%s", mode);
+    check(ok && _at(c, PartitionControl::Enabled), what);
+
+    //  A reconfigure during the cycle
+    c.next_cycle();
+    c.accept();
+    c.reconfigure(false);
+    c.run();
+    SEQUENCE(c.log(), TransitionId::Disable, TransitionId::EndCalibCycle,
+             TransitionId::EndRun, TransitionId::Unconfigure,
+             TransitionId::Configure, TransitionId::BeginRun,
+             TransitionId::BeginCalibCycle, TransitionId::Enable);
+    snprintf(what, sizeof(what), "reconfigure during the cycle returns to Enabled%s", mode);
+    check(ok && _at(c, PartitionControl::Enabled), what);
+
+    //  A cycle from Disabled, stopped
+    c.set_target_state(PartitionControl::Disabled);
+    c.run();
+    c.log();
+    c.next_cycle();
+    c.run_until(TransitionId::EndCalibCycle);
+    c.set_target_state(PartitionControl::Running);
+    c.run();
+    if (fast)
+      SEQUENCE(c.log(), TransitionId::EndCalibCycle,
+               TransitionId::BeginCalibCycle, TransitionId::EndCalibCycle)
+    else
+      SEQUENCE(c.log(), TransitionId::EndCalibCycle)
+    snprintf(what, sizeof(what), "stop of a cycle from Disabled ends Running%s", mode);
+    check(ok && _at(c, PartitionControl::Running), what);
+
+    c.set_target_state(PartitionControl::Enabled);
+    c.run();
+    c.log();
+  }
+
+  if (_failed)
+    printf("*** %u failures\n", _failed);
+  return _failed ? 1 : 0;
+}
@@ -20,11 +20,15 @@ namespace Pds {
     void payload(iovec& iov);
     void payload(iovec& iov) const;
 
+    //  Called before the payload is serialized.  Entries which accumulate
+    //  outside of the payload (per-thread shards) fold their contents in here.
+    virtual void merge() const {}
+
     double last() const;
     const ClockTime& time() const;
     void time(const ClockTime& t);
 
-    void reset();
+    virtual void reset();
 
   protected:
     void* allocate(unsigned size);
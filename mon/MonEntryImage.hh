@@ -45,7 +45,7 @@ namespace Pds {
   private:
     MonDescImage _desc;
 
-  private:
+  protected:
     unsigned* _y;
   };
 
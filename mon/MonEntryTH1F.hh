@@ -45,7 +45,7 @@ namespace Pds {
   private:
     MonDescTH1F _desc;
 
-  private:
+  protected:
     double* _y;
   };
 
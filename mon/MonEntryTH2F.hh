@@ -43,7 +43,7 @@ namespace Pds {
   private:
     MonDescTH2F _desc;
 
-  private:
+  protected:
     float* _y;
   };
 
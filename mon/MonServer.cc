@@ -112,8 +112,11 @@ void MonServer::payload()
   iovec* iov = _iovreply+1;
   for (unsigned short g=0; g<_cds.ngroups(); g++) {
     const MonGroup* group = _cds.group(g);
-    for (unsigned short e=0; e<group->nentries(); e++, iov++, used++)
-      group->entry(e)->payload(*iov); 
+    for (unsigned short e=0; e<group->nentries(); e++, iov++, used++) {
+      const MonEntry* entry = group->entry(e);
+      entry->merge();
+      entry->payload(*iov);
+    }
   }
 
   reply(MonMessage::Payload,used+1);
@@ -131,6 +134,7 @@ void MonServer::payload(unsigned loadsize)
   for (unsigned u=0; u<used; u++, signatures++, iov++) {
     const MonEntry* entry = _cds.entry(*signatures); 
     if (entry) {
+      entry->merge();
       entry->payload(*iov);
       _usage.use(*signatures);
     }
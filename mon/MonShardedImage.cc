@@ -0,0 +1,48 @@
+#include "pds/mon/MonShardedImage.hh"
+
+using namespace Pds;
+
+MonShardedImage::MonShardedImage(const char* name) :
+  MonEntryImage(name)
+{
+  build();
+}
+
+MonShardedImage::MonShardedImage(const MonDescImage& desc) :
+  MonEntryImage(desc)
+{
+  build();
+}
+
+MonShardedImage::~MonShardedImage() {}
+
+void MonShardedImage::params(unsigned nbinsx,
+                             unsigned nbinsy,
+                             int ppxbin,
+                             int ppybin)
+{
+  MonEntryImage::params(nbinsx, nbinsy, ppxbin, ppybin);
+  build();
+}
+
+void MonShardedImage::params(const MonDescImage& desc)
+{
+  MonEntryImage::params(desc);
+  build();
+}
+
+void MonShardedImage::build()
+{
+  _shards.size(desc().nbinsx()*desc().nbinsy()+InfoSize);
+}
+
+void MonShardedImage::merge() const
+{
+  _shards.merge(_y);
+}
+
+void MonShardedImage::reset()
+{
+  MonEntry::reset();
+  _shards.reset();
+}
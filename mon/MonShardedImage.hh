@@ -0,0 +1,55 @@
+#ifndef Pds_MonSHARDEDImage_HH
+#define Pds_MonSHARDEDImage_HH
+
+#include "pds/mon/MonEntryImage.hh"
+#include "pds/mon/MonShards.hh"
+
+namespace Pds {
+
+  //
+  //  A MonEntryImage which may be filled concurrently from several threads.
+  //
+  class MonShardedImage : public MonEntryImage {
+  public:
+    MonShardedImage(const char* name);
+    MonShardedImage(const MonDescImage& desc);
+    virtual ~MonShardedImage();
+
+    void params(unsigned nbinsx,
+                unsigned nbinsy,
+                int ppxbin,
+                int ppybin);
+    void params(const MonDescImage& desc);
+
+    void addcontent(unsigned y, unsigned binx, unsigned biny);
+    void addinfo   (unsigned y, Info);
+
+    void addcontent(unsigned y, unsigned binx, unsigned biny, unsigned shard);
+    void addinfo   (unsigned y, Info, unsigned shard);
+
+    //  The calling thread's shard, for filling whole rows, or 0 while
+    //  all shards are held by other threads (fill with addcontent then)
+    unsigned* shardContents();
+
+    // Implements MonEntry
+    virtual void merge() const;
+    virtual void reset();
+  private:
+    void build();
+  private:
+    MonShardArray<unsigned> _shards;
+  };
+
+  inline void MonShardedImage::addcontent(unsigned y, unsigned binx, unsigned biny)
+  { _shards.add(binx+biny*desc().nbinsx(), y); }
+  inline void MonShardedImage::addinfo(unsigned y, Info i)
+  { _shards.add(desc().nbinsx()*desc().nbinsy()+int(i), y); }
+  inline void MonShardedImage::addcontent(unsigned y, unsigned binx, unsigned biny, unsigned s)
+  { _shards.add(binx+biny*desc().nbinsx(), y, s); }
+  inline void MonShardedImage::addinfo(unsigned y, Info i, unsigned s)
+  { _shards.add(desc().nbinsx()*desc().nbinsy()+int(i), y, s); }
+  inline unsigned* MonShardedImage::shardContents()
+  { return _shards.shard(); }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "pds/mon/MonShardedTH1F.hh"
+
+using namespace Pds;
+
+MonShardedTH1F::MonShardedTH1F(const char* name,
+                               const char* xtitle,
+                               const char* ytitle,
+                               bool isnormalized) :
+  MonEntryTH1F(name, xtitle, ytitle, isnormalized)
+{
+  build();
+}
+
+MonShardedTH1F::MonShardedTH1F(const MonDescTH1F& desc) :
+  MonEntryTH1F(desc)
+{
+  build();
+}
+
+MonShardedTH1F::~MonShardedTH1F() {}
+
+void MonShardedTH1F::params(unsigned nbins, float xlow, float xup)
+{
+  MonEntryTH1F::params(nbins, xlow, xup);
+  build();
+}
+
+void MonShardedTH1F::params(const MonDescTH1F& desc)
+{
+  MonEntryTH1F::params(desc);
+  build();
+}
+
+void MonShardedTH1F::build()
+{
+  _shards.size(desc().nbins()+InfoSize);
+}
+
+void MonShardedTH1F::addcontent(double y, double x)
+{
+  const MonDescTH1F& d = desc();
+  if (x < d.xlow())
+    addinfo(y, Underflow);
+  else if (x >= d.xup())
+    addinfo(y, Overflow);
+  else {
+    unsigned bin = unsigned(((x-d.xlow())*double(d.nbins()) /
+                             (d.xup()-d.xlow())));
+    addcontent(y,bin);
+  }
+}
+
+void MonShardedTH1F::merge() const
+{
+  _shards.merge(_y);
+}
+
+void MonShardedTH1F::reset()
+{
+  MonEntry::reset();
+  _shards.reset();
+}
@@ -0,0 +1,51 @@
+#ifndef Pds_MonSHARDEDTH1F_HH
+#define Pds_MonSHARDEDTH1F_HH
+
+#include "pds/mon/MonEntryTH1F.hh"
+#include "pds/mon/MonShards.hh"
+
+namespace Pds {
+
+  //
+  //  A MonEntryTH1F which may be filled concurrently from several threads.
+  //  Fills go to the calling thread's shard; the payload is the sum of the
+  //  shards, formed when the entry is served (merge).
+  //
+  class MonShardedTH1F : public MonEntryTH1F {
+  public:
+    MonShardedTH1F(const char* name, const char* xtitle, const char* ytitle,
+                   bool isnormalized=false);
+    MonShardedTH1F(const MonDescTH1F& desc);
+    virtual ~MonShardedTH1F();
+
+    void params(unsigned nbins, float xlow, float xup);
+    void params(const MonDescTH1F& desc);
+
+    void addcontent(double y, unsigned bin);
+    void addcontent(double y, double x);
+    void addinfo   (double y, Info);
+
+    //  Explicit shard selection (e.g. by worker index)
+    void addcontent(double y, unsigned bin, unsigned shard);
+    void addinfo   (double y, Info, unsigned shard);
+
+    // Implements MonEntry
+    virtual void merge() const;
+    virtual void reset();
+  private:
+    void build();
+  private:
+    MonShardArray<double> _shards;
+  };
+
+  inline void MonShardedTH1F::addcontent(double y, unsigned bin)
+  { _shards.add(bin, y); }
+  inline void MonShardedTH1F::addinfo(double y, Info i)
+  { _shards.add(desc().nbins()+int(i), y); }
+  inline void MonShardedTH1F::addcontent(double y, unsigned bin, unsigned s)
+  { _shards.add(bin, y, s); }
+  inline void MonShardedTH1F::addinfo(double y, Info i, unsigned s)
+  { _shards.add(desc().nbins()+int(i), y, s); }
+};
+
+#endif
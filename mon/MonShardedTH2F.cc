@@ -0,0 +1,49 @@
+#include "pds/mon/MonShardedTH2F.hh"
+
+using namespace Pds;
+
+MonShardedTH2F::MonShardedTH2F(const char* name,
+                               const char* xtitle,
+                               const char* ytitle,
+                               bool isnormalized) :
+  MonEntryTH2F(name, xtitle, ytitle, isnormalized)
+{
+  build();
+}
+
+MonShardedTH2F::MonShardedTH2F(const MonDescTH2F& desc) :
+  MonEntryTH2F(desc)
+{
+  build();
+}
+
+MonShardedTH2F::~MonShardedTH2F() {}
+
+void MonShardedTH2F::params(unsigned nbinsx, float xlow, float xup,
+                            unsigned nbinsy, float ylow, float yup)
+{
+  MonEntryTH2F::params(nbinsx, xlow, xup, nbinsy, ylow, yup);
+  build();
+}
+
+void MonShardedTH2F::params(const MonDescTH2F& desc)
+{
+  MonEntryTH2F::params(desc);
+  build();
+}
+
+void MonShardedTH2F::build()
+{
+  _shards.size(desc().nbinsx()*desc().nbinsy()+InfoSize);
+}
+
+void MonShardedTH2F::merge() const
+{
+  _shards.merge(_y);
+}
+
+void MonShardedTH2F::reset()
+{
+  MonEntry::reset();
+  _shards.reset();
+}
@@ -0,0 +1,49 @@
+#ifndef Pds_MonSHARDEDTH2F_HH
+#define Pds_MonSHARDEDTH2F_HH
+
+#include "pds/mon/MonEntryTH2F.hh"
+#include "pds/mon/MonShards.hh"
+
+namespace Pds {
+
+  //
+  //  A MonEntryTH2F which may be filled concurrently from several threads.
+  //  Shards accumulate in double precision so that counts remain exact.
+  //
+  class MonShardedTH2F : public MonEntryTH2F {
+  public:
+    MonShardedTH2F(const char* name, const char* xtitle, const char* ytitle,
+                   bool isnormalized=false);
+    MonShardedTH2F(const MonDescTH2F& desc);
+    virtual ~MonShardedTH2F();
+
+    void params(unsigned nbinsx, float xlow, float xup,
+                unsigned nbinsy, float ylow, float yup);
+    void params(const MonDescTH2F& desc);
+
+    void addcontent(float y, unsigned binx, unsigned biny);
+    void addinfo   (float y, Info);
+
+    void addcontent(float y, unsigned binx, unsigned biny, unsigned shard);
+    void addinfo   (float y, Info, unsigned shard);
+
+    // Implements MonEntry
+    virtual void merge() const;
+    virtual void reset();
+  private:
+    void build();
+  private:
+    MonShardArray<double> _shards;
+  };
+
+  inline void MonShardedTH2F::addcontent(float y, unsigned binx, unsigned biny)
+  { _shards.add(binx+biny*desc().nbinsx(), y); }
+  inline void MonShardedTH2F::addinfo(float y, Info i)
+  { _shards.add(desc().nbinsx()*desc().nbinsy()+int(i), y); }
+  inline void MonShardedTH2F::addcontent(float y, unsigned binx, unsigned biny, unsigned s)
+  { _shards.add(binx+biny*desc().nbinsx(), y, s); }
+  inline void MonShardedTH2F::addinfo(float y, Info i, unsigned s)
+  { _shards.add(desc().nbinsx()*desc().nbinsy()+int(i), y, s); }
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "pds/mon/MonShards.hh"
+
+#include <pthread.h>
+
+using namespace Pds;
+
+static uint32_t       _held = 0;          // bit s set while index s is held
+static pthread_key_t  _key;
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+static __thread int   _threadShard = -1;
+
+//
+//  Thread exit: the index may be claimed by a new thread.  The shard's
+//  contents stay in the entries and are summed as before.
+//
+static void _release(void* arg)
+{
+  unsigned s = reinterpret_cast<uintptr_t>(arg)-1;
+  __sync_fetch_and_and(&_held, ~(1U<<s));
+}
+
+static void _createKey()
+{
+  pthread_key_create(&_key, _release);
+}
+
+unsigned MonShards::shard()
+{
+  if (_threadShard >= 0)
+    return _threadShard;
+
+  uint32_t held;
+  while((held = _held) != ~0U) {
+    unsigned s = __builtin_ctz(~held);
+    if (__sync_bool_compare_and_swap(&_held, held, held | (1U<<s))) {
+      pthread_once(&_once, _createKey);
+      pthread_setspecific(_key, reinterpret_cast<void*>(uintptr_t(s)+1));
+      _threadShard = s;
+      return s;
+    }
+  }
+  return Shared;
+}
@@ -0,0 +1,126 @@
+#ifndef Pds_MonSHARDS_HH
+#define Pds_MonSHARDS_HH
+
+//
+//  Per-writer-thread accumulation arrays for monitoring entries.
+//
+//  Each writer thread fills its own cache-line aligned copy of the bins
+//  with a plain (non-atomic) add.  The copies are summed into the entry's
+//  payload only when the payload is serialized (MonEntry::merge).  A
+//  shard is allocated by its writer on first use.
+//
+//  A writer thread claims one of MaxShards shard indices on its first
+//  fill and releases it when the thread exits, so that the index is never
+//  held by two live threads.  While all indices are held, a thread fills
+//  the Shared shard with atomic adds instead, and tries again to claim an
+//  index on its next fill.  Callers with a natural thread index (e.g. a
+//  worker id) may pass it explicitly, but must not mix explicit and
+//  automatic indices on the same entry.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+namespace Pds {
+
+  class MonShards {
+  public:
+    enum { MaxShards = 32 };
+    enum { Shared = MaxShards };
+    enum { CacheLine = 64 };
+  public:
+    //  The calling thread's shard index, or Shared if none is free
+    static unsigned shard();
+  public:
+    static void add(unsigned* p, unsigned v) { __sync_fetch_and_add(p, v); }
+    static void add(double*   p, double   v) {
+      union { double d; uint64_t u; } o, n;
+      do {
+        o.d = *(volatile double*)p;
+        n.d = o.d + v;
+      } while(!__sync_bool_compare_and_swap(reinterpret_cast<uint64_t*>(p), o.u, n.u));
+    }
+  };
+
+  template <class T>
+  class MonShardArray {
+  public:
+    MonShardArray() : _size(0) { memset(_shards,0,sizeof(_shards)); }
+    ~MonShardArray() { clear(); }
+  public:
+    //  Number of elements per shard; discards any existing shards
+    void size(unsigned n) { clear(); _size = n; }
+    unsigned size() const { return _size; }
+  public:
+    //  Adds v to element i of the calling thread's shard
+    void add(unsigned i, T v) {
+      unsigned s = MonShards::shard();
+      if (s < MonShards::MaxShards)
+        shard(s)[i] += v;
+      else
+        MonShards::add(shard(s)+i, v);
+    }
+    //  Adds v to element i of an explicitly chosen shard
+    void add(unsigned i, T v, unsigned s) { shard(s)[i] += v; }
+    //  The calling thread's own shard, or 0 if it has none
+    T*   shard() {
+      unsigned s = MonShards::shard();
+      return s < MonShards::MaxShards ? shard(s) : 0;
+    }
+    T*   shard(unsigned s) {
+      T* p = _shards[s];
+      return p ? p : _allocate(s);
+    }
+  public:
+    //  dst[i] = sum over shards of shard[i]
+    template <class U>
+    void merge(U* dst) const {
+      unsigned s=0;
+      while(s<NumShards && !_shards[s]) s++;
+      if (s==NumShards) {
+        memset(dst, 0, _size*sizeof(U));
+        return;
+      }
+      const T* p = _shards[s];
+      for(unsigned i=0; i<_size; i++)
+        dst[i] = U(p[i]);
+      while(++s<NumShards) {
+        if (!(p = _shards[s])) continue;
+        for(unsigned i=0; i<_size; i++)
+          dst[i] += U(p[i]);
+      }
+    }
+    void reset() {
+      for(unsigned s=0; s<NumShards; s++)
+        if (_shards[s])
+          memset(_shards[s], 0, _size*sizeof(T));
+    }
+    void clear() {
+      for(unsigned s=0; s<NumShards; s++)
+        if (_shards[s]) {
+          free(_shards[s]);
+          _shards[s] = 0;
+        }
+    }
+  private:
+    enum { NumShards = MonShards::MaxShards+1 };
+    T* _allocate(unsigned s) {
+      size_t sz = (_size*sizeof(T)+MonShards::CacheLine-1) & ~size_t(MonShards::CacheLine-1);
+      void* p;
+      if (posix_memalign(&p, MonShards::CacheLine, sz))
+        abort();
+      memset(p, 0, sz);
+      //  The Shared shard may be allocated by several threads at once;
+      //  the swap also publishes the zeroed shard to the merging thread
+      if (!__sync_bool_compare_and_swap(&_shards[s], (T*)0, static_cast<T*>(p)))
+        free(p);
+      return _shards[s];
+    }
+  private:
+    unsigned _size;
+    T*       _shards[NumShards];
+  };
+};
+
+#endif
@@ -6,6 +6,9 @@
 #include "pds/client/Action.hh"
 #include "pdsdata/xtc/Xtc.hh"
 #include "pdsdata/xtc/TypeId.hh"
+#include "pdsdata/xtc/DetInfo.hh"
+#include "pdsdata/xtc/BldInfo.hh"
+#include "pds/client/RunSummary.hh"
 #include "OfflineClient.hh"
 
 #include "LogBook/Connection.h"
@@ -546,6 +549,92 @@ int OfflineClient::reportTotals (int expt, int run, long events, long damaged, d
   return (returnVal);
 }
 
+namespace Pds {
+  class SummarySrc : public Src {
+  public:
+    SummarySrc(uint32_t log, uint32_t phy) { _log = log; _phy = phy; }
+  };
+};
+
+//
+// reportSourceTotals - per contribution totals of a run (see RunSummaryApp)
+//
+int OfflineClient::reportSourceTotals (int expt, int run, const RunSummary& summary) {
+  LogBook::Connection * conn = NULL;
+  int returnVal = -1;  // default return is ERROR
+
+  // sanity check
+  if (run && _instrument_name && _experiment_name) {
+    // in case of NULL database, report nothing
+    if ((_path == (char *)NULL) || (strcmp(_path, "/dev/null") == 0)) {
+      returnVal = 0;  // OK
+    } else {
+      try {
+        conn = LogBook::Connection::open(_path);
+
+        if (conn != NULL) {
+          // begin transaction
+          conn->beginTransaction();
+
+          for (unsigned i = 0; i < summary.nsources; i++) {
+            SummarySrc ssrc(summary.srcLog()[i], summary.srcPhy()[i]);
+            const Src& src = ssrc;
+            TypeId type(TypeId::Type(summary.srcType()[i]&0xffff), (summary.srcType()[i]>>16)&0x7fff);
+            char name[128];
+            switch (src.level()) {
+            case Level::Source:
+              snprintf(name, sizeof(name), "%s", DetInfo::name(static_cast<const DetInfo&>(src)));
+              break;
+            case Level::Reporter:
+              snprintf(name, sizeof(name), "%s", BldInfo::name(static_cast<const BldInfo&>(src)));
+              break;
+            default:
+              snprintf(name, sizeof(name), "%s.%08x", Level::name(src.level()), src.phy());
+              break;
+            }
+            std::string sname(name);
+            snprintf(name, sizeof(name), ":%s_v%u", TypeId::name(type.id()), type.version());
+            sname += name;
+
+            conn->createRunAttr(_instrument_name, _experiment_name, run,
+                                "DAQ Source Totals", sname+" Events", "Number of contributions", long(summary.srcCount()[i]));
+
+            conn->createRunAttr(_instrument_name, _experiment_name, run,
+                                "DAQ Source Totals", sname+" Damaged", "Number of damaged contributions", long(summary.srcDamaged()[i]));
+
+            conn->createRunAttr(_instrument_name, _experiment_name, run,
+                                "DAQ Source Totals", sname+" Size", "Amount of data recorded [GB]", double(summary.srcBytes()[i])*1.e-9);
+          }
+          returnVal = 0; // OK
+
+          // commit transaction
+          conn->commitTransaction();
+        } else {
+            printf("LogBook::Connection::connect() failed\n");
+        }
+
+      } catch (const LogBook::ValueTypeMismatch& e) {
+        printf ("Parameter type mismatch %s:\n", e.what());
+        returnVal = -1; // ERROR
+
+      } catch (const LogBook::WrongParams& e) {
+        printf ("Problem with parameters %s:\n", e.what());
+        returnVal = -1; // ERROR
+    
+      } catch (const LogBook::DatabaseError& e) {
+        printf ("Database operation failed: %s\n", e.what());
+        returnVal = -1; // ERROR
+      }
+
+      if (conn != NULL) {
+        // close connection
+        delete conn ;
+      }
+    }
+  }
+  return (returnVal);
+}
+
 //
 // GetExperimentNumber
 //
@@ -12,6 +12,8 @@
 
 namespace Pds {
 
+  class RunSummary;
+
   class PartitionDescriptor {
   public:
     PartitionDescriptor(const char *name);
@@ -36,6 +38,7 @@ namespace Pds {
     int reportOpenFile (int expt, int run, int stream, int chunk, std::string& host, std::string& dirpath, bool ffb=false);
     int reportDetectors (int expt, int run, std::vector<std::string>& names);
     int reportTotals (int expt, int run, long events, long damaged, double gigabytes);
+    int reportSourceTotals (int expt, int run, const RunSummary& summary);
 
     unsigned int GetExperimentNumber();
     const char * GetExperimentName();
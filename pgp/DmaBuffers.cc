@@ -0,0 +1,72 @@
+/*
+ * DmaBuffers.cc
+ */
+
+#include "pds/pgp/DmaBuffers.hh"
+#include <stdio.h>
+
+namespace Pds {
+  namespace Pgp {
+
+    DmaBuffers::DmaBuffers(DmaDriver* d, bool owner) :
+      _driver      (d),
+      _owner       (owner),
+      _held        (new bool[d->nbuffers()]),
+      _nheld       (0),
+      _maxHeld     (0),
+      _nreceived   (0),
+      _nerrors     (0),
+      _nbadReleases(0) {
+      for(unsigned i=0; i<d->nbuffers(); i++)
+        _held[i] = false;
+    }
+
+    DmaBuffers::~DmaBuffers() {
+      releaseAll();
+      delete[] _held;
+      if (_owner) delete _driver;
+    }
+
+    int DmaBuffers::receive(DmaRx& rx) {
+      int ret = _driver->receive(rx);
+      if (ret < 0) {
+        _nerrors++;
+        return ret;
+      }
+      if (ret > 0) {
+        if (rx.index >= nbuffers() || _held[rx.index]) {
+          printf("DmaBuffers::receive driver returned %s buffer %u\n",
+              rx.index >= nbuffers() ? "invalid" : "held", rx.index);
+          _nerrors++;
+          return -1;
+        }
+        _held[rx.index] = true;
+        if (++_nheld > _maxHeld) _maxHeld = _nheld;
+        _nreceived++;
+      }
+      return ret;
+    }
+
+    void DmaBuffers::release(unsigned index) {
+      if (index >= nbuffers() || !_held[index]) {
+        if (++_nbadReleases < 20)
+          printf("DmaBuffers::release buffer %u is not held\n", index);
+        return;
+      }
+      _held[index] = false;
+      _nheld--;
+      _driver->release(index);
+    }
+
+    void DmaBuffers::releaseAll() {
+      for(unsigned i=0; i<nbuffers(); i++)
+        if (_held[i])
+          release(i);
+    }
+
+    void DmaBuffers::dump() const {
+      printf("DmaBuffers: %u buffers of %u bytes, %u held (max %u), %u received, %u errors, %u bad releases\n",
+          nbuffers(), bufferSize(), _nheld, _maxHeld, _nreceived, _nerrors, _nbadReleases);
+    }
+  }
+}
@@ -0,0 +1,54 @@
+/*
+ * DmaBuffers.hh
+ *
+ *  Tracks ownership of the receive buffers of a DmaDriver.  A buffer is
+ *  held from receive() until release(), which the server calls once the
+ *  contribution built from it has been handed to the event builder.
+ *  Releasing a buffer that is not held is reported and ignored, so a
+ *  buffer can never be returned to the card twice.
+ *
+ *  The driver is deleted with the DmaBuffers only if it was handed over
+ *  as owned.
+ *
+ *  Not thread safe; receive and release from the fetch thread.
+ */
+
+#ifndef PGP_DMABUFFERS_HH_
+#define PGP_DMABUFFERS_HH_
+
+#include "pds/pgp/DmaDriver.hh"
+
+namespace Pds {
+  namespace Pgp {
+
+    class DmaBuffers {
+      public:
+        DmaBuffers(DmaDriver*, bool owner=true);
+        ~DmaBuffers();
+      public:
+        int       fd        () const { return _driver->fd(); }
+        unsigned  nbuffers  () const { return _driver->nbuffers(); }
+        unsigned  bufferSize() const { return _driver->bufferSize(); }
+        uint32_t* buffer    (unsigned index) const { return _driver->buffer(index); }
+      public:
+        int       receive   (DmaRx&);
+        void      release   (unsigned index);
+        //  Returns every held buffer to the card
+        void      releaseAll();
+      public:
+        unsigned  held      () const { return _nheld; }
+        void      dump      () const;
+      private:
+        DmaDriver* _driver;
+        bool       _owner;
+        bool*      _held;
+        unsigned   _nheld;
+        unsigned   _maxHeld;
+        unsigned   _nreceived;
+        unsigned   _nerrors;
+        unsigned   _nbadReleases;
+    };
+  }
+}
+
+#endif /* PGP_DMABUFFERS_HH_ */
@@ -0,0 +1,69 @@
+/*
+ * DmaDriver.cc
+ */
+
+#include "pds/pgp/DmaDriver.hh"
+#include "pgpcard/PgpCardMod.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <errno.h>
+
+namespace Pds {
+  namespace Pgp {
+
+    ReadDmaDriver::ReadDmaDriver(int f, unsigned n, unsigned size) :
+      _fd        (f),
+      _nbuffers  (n),
+      _bufferSize((size+sizeof(uint32_t)-1)&~(sizeof(uint32_t)-1)),
+      _buffers   (new uint32_t*[n]),
+      _free      (new unsigned[n]),
+      _nfree     (n) {
+      for(unsigned i=0; i<n; i++) {
+        _buffers[i] = (uint32_t*)calloc(1, _bufferSize);
+        _free[i]    = n-1-i;
+      }
+    }
+
+    ReadDmaDriver::~ReadDmaDriver() {
+      for(unsigned i=0; i<_nbuffers; i++)
+        free(_buffers[i]);
+      delete[] _buffers;
+      delete[] _free;
+    }
+
+    int ReadDmaDriver::receive(DmaRx& rx) {
+      if (_nfree == 0) {
+        errno = ENOBUFS;
+        return -1;
+      }
+      unsigned index = _free[_nfree-1];
+      PgpCardRx       pgpCardRx;
+      pgpCardRx.model   = sizeof(&pgpCardRx);
+      pgpCardRx.maxSize = _bufferSize / sizeof(__u32);
+      pgpCardRx.data    = (__u32*)_buffers[index];
+      int ret = ::read(_fd, &pgpCardRx, sizeof(PgpCardRx));
+      if (ret <= 0)
+        return ret;
+      _nfree--;
+      rx.index     = index;
+      rx.size      = ret;
+      rx.lane      = pgpCardRx.pgpLane;
+      rx.vc        = pgpCardRx.pgpVc;
+      rx.eofe      = pgpCardRx.eofe;
+      rx.fifoErr   = pgpCardRx.fifoErr;
+      rx.lengthErr = pgpCardRx.lengthErr;
+      return ret;
+    }
+
+    int ReadDmaDriver::release(unsigned index) {
+      if (index >= _nbuffers || _nfree == _nbuffers) {
+        printf("ReadDmaDriver::release bad index %u, %u of %u buffers free\n",
+            index, _nfree, _nbuffers);
+        return -1;
+      }
+      _free[_nfree++] = index;
+      return 0;
+    }
+  }
+}
@@ -0,0 +1,76 @@
+/*
+ * DmaDriver.hh
+ *
+ *  Buffer-index interface to a pgpcard receive DMA ring.
+ *
+ *  The driver owns a fixed set of receive buffers, identified by index.
+ *  receive() hands the oldest filled buffer to the caller, who owns it
+ *  until release() returns it to the card.  A driver that maps its DMA
+ *  buffers into user space gives the caller the received data without a
+ *  copy; ReadDmaDriver provides the same model over the pgpcard read()
+ *  call for drivers that do not.
+ */
+
+#ifndef PGP_DMADRIVER_HH_
+#define PGP_DMADRIVER_HH_
+
+#include <stdint.h>
+
+namespace Pds {
+  namespace Pgp {
+
+    class DmaRx {
+      public:
+        unsigned index;      // receive buffer
+        unsigned size;       // uint32_t's received
+        unsigned lane;
+        unsigned vc;
+        unsigned eofe;
+        unsigned fifoErr;
+        unsigned lengthErr;
+    };
+
+    class DmaDriver {
+      public:
+        virtual ~DmaDriver() {}
+      public:
+        //  Descriptor to poll for received buffers
+        virtual int       fd        () const = 0;
+        virtual unsigned  nbuffers  () const = 0;
+        //  Size of each receive buffer in bytes
+        virtual unsigned  bufferSize() const = 0;
+        virtual uint32_t* buffer    (unsigned index) const = 0;
+        //  Returns the uint32_t's received, 0 if no buffer is filled,
+        //  or -1 with errno set.
+        virtual int       receive   (DmaRx&) = 0;
+        //  Returns the buffer to the card; 0 on success
+        virtual int       release   (unsigned index) = 0;
+    };
+
+    //
+    //  Fallback for drivers without mapped receive buffers: each receive()
+    //  reads the next frame into one of a pool of user buffers.
+    //
+    class ReadDmaDriver : public DmaDriver {
+      public:
+        ReadDmaDriver(int fd, unsigned nbuffers, unsigned bufferSize);
+        ~ReadDmaDriver();
+      public:
+        int       fd        () const { return _fd; }
+        unsigned  nbuffers  () const { return _nbuffers; }
+        unsigned  bufferSize() const { return _bufferSize; }
+        uint32_t* buffer    (unsigned index) const { return _buffers[index]; }
+        int       receive   (DmaRx&);
+        int       release   (unsigned index);
+      private:
+        int        _fd;
+        unsigned   _nbuffers;
+        unsigned   _bufferSize;
+        uint32_t** _buffers;
+        unsigned*  _free;      // stack of free buffer indices
+        unsigned   _nfree;
+    };
+  }
+}
+
+#endif /* PGP_DMADRIVER_HH_ */
@@ -0,0 +1,114 @@
+/*
+ * MockDmaDriver.cc
+ */
+
+#include "pds/pgp/MockDmaDriver.hh"
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <stdio.h>
+
+namespace Pds {
+  namespace Pgp {
+
+    MockDmaDriver::MockDmaDriver(unsigned n, unsigned size) :
+      _nbuffers  (n),
+      _bufferSize((size+sizeof(uint32_t)-1)&~(sizeof(uint32_t)-1)),
+      _buffers   (new uint32_t*[n]),
+      _onCard    (new bool[n]),
+      _dropped   (0) {
+      for(unsigned i=0; i<n; i++) {
+        _buffers[i] = (uint32_t*)calloc(1, _bufferSize);
+        _onCard [i] = true;
+        _free.push_back(i);
+      }
+      if (::pipe(_pipe) < 0)
+        perror("MockDmaDriver pipe");
+      fcntl(_pipe[0], F_SETFL, O_NONBLOCK);
+      pthread_mutex_init(&_lock, NULL);
+    }
+
+    MockDmaDriver::~MockDmaDriver() {
+      for(unsigned i=0; i<_nbuffers; i++)
+        ::free(_buffers[i]);
+      delete[] _buffers;
+      delete[] _onCard;
+      ::close(_pipe[0]);
+      ::close(_pipe[1]);
+      pthread_mutex_destroy(&_lock);
+    }
+
+    int MockDmaDriver::inject(const uint32_t* data, unsigned words,
+                              unsigned lane, unsigned vc) {
+      pthread_mutex_lock(&_lock);
+      if (_free.empty()) {
+        _dropped++;
+        pthread_mutex_unlock(&_lock);
+        return -1;
+      }
+      DmaRx rx;
+      rx.index     = _free.front();
+      rx.lane      = lane;
+      rx.vc        = vc;
+      rx.eofe      = 0;
+      rx.fifoErr   = 0;
+      rx.lengthErr = words*sizeof(uint32_t) > _bufferSize;
+      rx.size      = rx.lengthErr ? _bufferSize/sizeof(uint32_t) : words;
+      _free.pop_front();
+      memcpy(_buffers[rx.index], data, rx.size*sizeof(uint32_t));
+      _queued.push_back(rx);
+      //  One byte per queued frame, written and read under the lock so
+      //  that the descriptor is readable exactly while frames are queued
+      char c = 0;
+      if (::write(_pipe[1], &c, 1) < 0)
+        perror("MockDmaDriver::inject");
+      pthread_mutex_unlock(&_lock);
+      return rx.index;
+    }
+
+    int MockDmaDriver::receive(DmaRx& rx) {
+      pthread_mutex_lock(&_lock);
+      if (_queued.empty()) {
+        pthread_mutex_unlock(&_lock);
+        return 0;
+      }
+      rx = _queued.front();
+      _queued.pop_front();
+      _onCard[rx.index] = false;
+      char c;
+      if (::read(_pipe[0], &c, 1) != 1)
+        perror("MockDmaDriver::receive");
+      pthread_mutex_unlock(&_lock);
+      return rx.size;
+    }
+
+    int MockDmaDriver::release(unsigned index) {
+      int ret = 0;
+      pthread_mutex_lock(&_lock);
+      if (index >= _nbuffers || _onCard[index]) {
+        printf("MockDmaDriver::release buffer %u is owned by the card\n", index);
+        ret = -1;
+      } else {
+        _onCard[index] = true;
+        _free.push_back(index);
+      }
+      pthread_mutex_unlock(&_lock);
+      return ret;
+    }
+
+    unsigned MockDmaDriver::available() const {
+      pthread_mutex_lock(&_lock);
+      unsigned n = _free.size();
+      pthread_mutex_unlock(&_lock);
+      return n;
+    }
+
+    unsigned MockDmaDriver::queued() const {
+      pthread_mutex_lock(&_lock);
+      unsigned n = _queued.size();
+      pthread_mutex_unlock(&_lock);
+      return n;
+    }
+  }
+}
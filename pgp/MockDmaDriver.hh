@@ -0,0 +1,56 @@
+/*
+ * MockDmaDriver.hh
+ *
+ *  User-space stand-in for a pgpcard with mapped receive buffers.  Frames
+ *  are injected (from any thread) into buffers owned by the "card" and
+ *  queued for receive(); a frame injected while every buffer is held by
+ *  the server or queued is dropped, as the card would.  The descriptor is
+ *  readable while frames are queued, so the driver can stand in for the
+ *  card under the event builder.
+ */
+
+#ifndef PGP_MOCKDMADRIVER_HH_
+#define PGP_MOCKDMADRIVER_HH_
+
+#include "pds/pgp/DmaDriver.hh"
+#include <pthread.h>
+#include <list>
+
+namespace Pds {
+  namespace Pgp {
+
+    class MockDmaDriver : public DmaDriver {
+      public:
+        MockDmaDriver(unsigned nbuffers, unsigned bufferSize);
+        ~MockDmaDriver();
+      public:
+        int       fd        () const { return _pipe[0]; }
+        unsigned  nbuffers  () const { return _nbuffers; }
+        unsigned  bufferSize() const { return _bufferSize; }
+        uint32_t* buffer    (unsigned index) const { return _buffers[index]; }
+        int       receive   (DmaRx&);
+        int       release   (unsigned index);
+      public:
+        //  Returns the buffer index filled, or -1 if the frame was dropped.
+        //  Frames larger than a buffer are truncated and flagged lengthErr.
+        int       inject    (const uint32_t* data, unsigned words,
+                             unsigned lane=0, unsigned vc=0);
+      public:
+        unsigned  available() const;   // buffers available to the card
+        unsigned  queued   () const;   // filled and not yet received
+        unsigned  dropped  () const { return _dropped; }
+      private:
+        unsigned           _nbuffers;
+        unsigned           _bufferSize;
+        uint32_t**         _buffers;
+        bool*              _onCard;
+        std::list<unsigned> _free;
+        std::list<DmaRx>   _queued;
+        unsigned           _dropped;
+        int                _pipe[2];
+        mutable pthread_mutex_t _lock;
+    };
+  }
+}
+
+#endif /* PGP_MOCKDMADRIVER_HH_ */
@@ -29,8 +29,14 @@ CPPFLAGS += -D_LINUX
 
 libnames := pgp
 
-libsrcs_pgp := $(wildcard *.cc)
+libsrcs_pgp := $(filter-out dmatest.cc,$(wildcard *.cc))
 #libsinc_pgp := 
 libincs_pgp := pgpcard
+
+tgtnames := dmatest
+tgtsrcs_dmatest := dmatest.cc
+tgtlibs_dmatest := pds/pgp
+tgtslib_dmatest := $(USRLIBDIR)/pthread
+tgtincs_dmatest := pgpcard
 CPPFLAGS += -fno-strict-aliasing
 
@@ -0,0 +1,127 @@
+//
+//  dmatest - exercises the receive buffer ownership and recycling of
+//  DmaBuffers against the user-space MockDmaDriver.
+//
+#include "pds/pgp/DmaBuffers.hh"
+#include "pds/pgp/MockDmaDriver.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <poll.h>
+
+using namespace Pds::Pgp;
+
+static unsigned nfail = 0;
+
+static void check(bool v, const char* what)
+{
+  printf("%s : %s\n", v ? "ok  " : "FAIL", what);
+  if (!v) nfail++;
+}
+
+static bool readable(int fd)
+{
+  pollfd pfd;
+  pfd.fd     = fd;
+  pfd.events = POLLIN;
+  return ::poll(&pfd, 1, 0) > 0;
+}
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [-n <buffers>] [-s <buffer bytes>] [-i <iterations>]\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned nbuffers = 8;
+  unsigned size     = 1024;
+  unsigned iter     = 100000;
+
+  int c;
+  while ((c = getopt(argc, argv, "n:s:i:h")) != -1) {
+    switch(c) {
+    case 'n': nbuffers = strtoul(optarg,NULL,0); break;
+    case 's': size     = strtoul(optarg,NULL,0); break;
+    case 'i': iter     = strtoul(optarg,NULL,0); break;
+    case 'h':
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+  if (nbuffers < 2 || size < 4*sizeof(uint32_t)) {
+    usage(argv[0]);
+    exit(1);
+  }
+
+  MockDmaDriver* card = new MockDmaDriver(nbuffers, size);
+  DmaBuffers     dma(card);
+  unsigned       words = size/sizeof(uint32_t);
+  uint32_t*      frame = new uint32_t[2*words];
+  DmaRx          rx;
+
+  check(dma.receive(rx)==0 && !readable(dma.fd()), "nothing received while idle");
+
+  //  Fill the card; one more frame must be dropped
+  for(unsigned i=0; i<=nbuffers; i++) {
+    frame[0] = i;
+    card->inject(frame, words);
+  }
+  check(card->dropped()==1,         "frame dropped when every buffer is queued");
+  check(readable(dma.fd()),          "descriptor readable while frames are queued");
+
+  //  Receive them all, in order, and hold them
+  unsigned index[nbuffers];
+  bool inorder = true;
+  for(unsigned i=0; i<nbuffers; i++) {
+    if (dma.receive(rx) != int(words) || dma.buffer(rx.index)[0] != i)
+      inorder = false;
+    index[i] = rx.index;
+  }
+  check(inorder,                     "frames received in order");
+  check(dma.held()==nbuffers,        "every buffer held");
+  check(!readable(dma.fd()),         "descriptor idle once drained");
+  check(card->inject(frame,words)<0, "frame dropped while every buffer is held");
+
+  //  A buffer goes back to the card only on release, and only once
+  dma.release(index[0]);
+  check(card->available()==1,        "released buffer returned to the card");
+  dma.release(index[0]);
+  check(card->available()==1 && dma.held()==nbuffers-1, "second release ignored");
+  dma.release(nbuffers);
+  check(dma.held()==nbuffers-1,      "invalid release ignored");
+
+  //  Oversize frames are truncated and flagged
+  card->inject(frame, 2*words);
+  check(dma.receive(rx)==int(words) && rx.lengthErr, "oversize frame flagged");
+  dma.release(rx.index);
+
+  dma.releaseAll();
+  check(dma.held()==0 && card->available()==nbuffers, "releaseAll returns every buffer");
+
+  //  Steady state: hold up to nbuffers-1 frames in flight, release the oldest
+  unsigned head = 0, tail = 0;
+  bool recycled = true;
+  for(unsigned i=0; i<iter; i++) {
+    frame[0] = i;
+    if (card->inject(frame, words) < 0 || dma.receive(rx) != int(words) ||
+        dma.buffer(rx.index)[0] != i) {
+      recycled = false;
+      break;
+    }
+    index[head++ % nbuffers] = rx.index;
+    if (head - tail == nbuffers-1)
+      dma.release(index[tail++ % nbuffers]);
+  }
+  while(tail != head)
+    dma.release(index[tail++ % nbuffers]);
+  check(recycled && card->dropped()==2, "buffers recycled without drops");
+  check(dma.held()==0 && card->available()==nbuffers, "no buffers leaked");
+
+  dma.dump();
+  delete[] frame;
+  printf("%s\n", nfail ? "FAILED" : "PASSED");
+  return nfail ? 1 : 0;
+}
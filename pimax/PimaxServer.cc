@@ -33,7 +33,7 @@ PimaxServer::PimaxServer(int iCamera, bool bDelayMode, bool bInitTest, const Src
  _fPrevReadoutTime(0), _bSequenceError(false), _clockPrevDatagram(0,0), _iNumExposure(0),
  _config(),
  _fReadoutTime(0),
- _poolFrameData(_iMaxFrameDataSize, _iPoolDataCount), _pDgOut(NULL),
+ _poolFrameData(_iMaxFrameDataSize, _iPoolDataCount), _pDgOut(NULL), _pReduction(NULL),
  _CaptureState(CAPTURE_STATE_IDLE), _pTaskCapture(NULL), _routineCapture(*this)
 {
   if ( initDevice() != 0 )
@@ -63,6 +63,8 @@ PimaxServer::~PimaxServer()
 
   if ( _pTaskCapture != NULL )
     _pTaskCapture->destroy(); // task object will destroy the thread and release the object memory by itself
+
+  delete _pReduction;
 }
 
 #define CHECK_PICAM_ERROR(errorCode, strScope) \
@@ -462,6 +464,9 @@ int PimaxServer::initCapture()
     return ERROR_INVALID_CONFIG;
   }
 
+  if ( FrameReduction::create(_pReduction, _reductionSettings, _iImageWidth, _iImageHeight, 1, "PimaxServer::initCapture()") != 0 )
+    return ERROR_INVALID_CONFIG;
+
   piflt fTimeReadout = 999;
   iError = Picam_GetParameterFloatingPointValue( _hCam, PicamParameter_ReadoutTimeCalculation , &fTimeReadout );
   CHECK_PICAM_ERROR(iError, "PimaxServer::initCapture(): Picam_GetParameterFloatingPointValue(PicamParameter_ReadoutTimeCalculation)");
@@ -1105,6 +1110,9 @@ int PimaxServer::getData(InDatagram* in, InDatagram*& out)
   PimaxDataType* pData = (PimaxDataType*) pFrameHeader;
   new (pFrameHeader) PimaxDataType(in->datagram().seq.stamp().fiducials(), _fReadoutTime, pData->temperature());
 
+  if ( _pReduction != NULL )
+    reduceFrame(_pDgOut);
+
   out       = _pDgOut;
 
   /*
@@ -1214,7 +1222,7 @@ int PimaxServer::processFrame()
     return ERROR_LOGICAL_FAILURE;
   }
 
-  if ( _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5 )
+  if ( _pReduction == NULL && ( _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5 ) )
   {
     unsigned char*  pFrameHeader    = (unsigned char*) _pDgOut + sizeof(CDatagram) + sizeof(Xtc);
     PimaxDataType* pFrame           = (PimaxDataType*) pFrameHeader;
@@ -1240,6 +1248,22 @@ int PimaxServer::processFrame()
   return 0;
 }
 
+/*
+ * Replace the full frame of a composed L1 datagram by its binned/ROI/pedestal
+ * subtracted reduction and the frame statistics, which keep the readout header
+ */
+int PimaxServer::reduceFrame(InDatagram* dg)
+{
+  PimaxDataType*  pData     = (PimaxDataType*) ((unsigned char*) dg + sizeof(CDatagram) + sizeof(Xtc));
+  float           fTemp     = pData->temperature();
+  const uint16_t* pImage    = (const uint16_t*) ((uint8_t*) dg + _iFrameHeaderSize);
+
+  _pReduction->apply(dg->datagram().xtc, pImage, _src,
+                     pData->shotIdStart(), pData->readoutTime(), &fTemp,
+                     _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5);
+  return 0;
+}
+
 int PimaxServer::setupFrame()
 {
   if ( _poolFrameData.numberOfFreeObjects() <= 0 )
@@ -1377,7 +1401,7 @@ const int       PimaxServer::_iMaxCoolingTime;
 const int       PimaxServer::_fTemperatureHiTol;
 const int       PimaxServer::_fTemperatureLoTol;
 const int       PimaxServer::_iFrameHeaderSize      = sizeof(CDatagram) + sizeof(Xtc) + sizeof(PimaxDataType);
-const int       PimaxServer::_iMaxFrameDataSize     = _iFrameHeaderSize + 2048*2048*2;
+const int       PimaxServer::_iMaxFrameDataSize     = _iFrameHeaderSize + 2048*2048*2 + FrameReduction::Overhead;
 const int       PimaxServer::_iPoolDataCount;
 const int       PimaxServer::_iMaxReadoutTime;
 const int       PimaxServer::_iMaxThreadEndTime;
@@ -1389,6 +1413,12 @@ const float     PimaxServer::_fEventDeltaTimeFactor = 1.01f;
  * Definition of private static data
  */
 pthread_mutex_t PimaxServer::_mutexPlFuncs = PTHREAD_MUTEX_INITIALIZER;
+FrameReduction::Settings PimaxServer::_reductionSettings;
+
+int PimaxServer::setReduction(const char* sSettings)
+{
+  return _reductionSettings.parse(sSettings);
+}
 
 
 PimaxServer::CaptureRoutine::CaptureRoutine(PimaxServer& server) : _server(server)
@@ -14,6 +14,7 @@
 #include "pds/xtc/CDatagram.hh"
 #include "pds/service/GenericPool.hh"
 #include "pds/service/Routine.hh"
+#include "pds/camera/FrameReduction.hh"
 
 namespace Pds
 {
@@ -44,6 +45,11 @@ public:
   PimaxConfigType&
         config() { return _config; }
 
+  /*
+   * Software binning/ROI/pedestal reduction of every frame; see FrameReduction::Settings
+   */
+  static int setReduction(const char* sSettings);
+
   enum  ErrorCodeEnum
   {
     ERROR_INVALID_ARGUMENTS = 1,
@@ -129,6 +135,7 @@ private:
   //int   setupFrame(InDatagram* in, InDatagram*& out); //!!delay mode
   int   waitForNewFrameAvailable();
   int   processFrame();
+  int   reduceFrame(InDatagram* dg);
   int   resetFrameData(bool bDelOutDatagram);
 
   int   setupCooling(double fCoolingTemperature);
@@ -192,6 +199,7 @@ private:
    */
   GenericPool         _poolFrameData;
   InDatagram*         _pDgOut;          // Datagram for outtputing to the Pimax Manager
+  FrameReduction*     _pReduction;      // Software frame reduction, if enabled
 
   /*
    * Capture Task Control
@@ -231,6 +239,7 @@ private:
    * private static data
    */
   static pthread_mutex_t _mutexPlFuncs;
+  static FrameReduction::Settings _reductionSettings;
 };
 
 class PimaxServerException : public std::runtime_error
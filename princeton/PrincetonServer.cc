@@ -32,7 +32,7 @@ PrincetonServer::PrincetonServer(int iCamera, bool bDelayMode, bool bInitTest, c
  _fPrevReadoutTime(0), _bSequenceError(false), _clockPrevDatagram(0,0), _iNumExposure(0),
  _config(),
  _fReadoutTime(0),
- _poolFrameData(_iMaxFrameDataSize, _iPoolDataCount), _pDgOut(NULL), _iFrameSize(0), _iBufferSize(0), _pFrameBuffer(NULL),
+ _poolFrameData(_iMaxFrameDataSize, _iPoolDataCount), _pDgOut(NULL), _iFrameSize(0), _iBufferSize(0), _pFrameBuffer(NULL), _pReduction(NULL),
  _CaptureState(CAPTURE_STATE_IDLE), _pTaskCapture(NULL), _routineCapture(*this)
 {
   if ( initDevice() != 0 )
@@ -63,6 +63,8 @@ PrincetonServer::~PrincetonServer()
 
   if ( _pTaskCapture != NULL )
     _pTaskCapture->destroy(); // task object will destroy the thread and release the object memory by itself
+
+  delete _pReduction;
 }
 
 int PrincetonServer::initDevice()
@@ -495,6 +497,11 @@ int PrincetonServer::initCapture()
     return ERROR_INVALID_CONFIG;
   }
 
+  const int iImageWidth   = _config.width()  / _config.binX();
+  const int iImageHeight  = _config.height() / _config.binY();
+  if ( FrameReduction::create(_pReduction, _reductionSettings, iImageWidth, iImageHeight, 1, "PrincetonServer::initCapture()") != 0 )
+    return ERROR_INVALID_CONFIG;
+
   _bCaptureInited = true;
 
   printf( "Capture initialized\n" );
@@ -1270,6 +1277,9 @@ int PrincetonServer::getData(InDatagram* in, InDatagram*& out)
   PrincetonDataType* pData = (PrincetonDataType*) pFrameHeader;
   new (pFrameHeader) PrincetonDataType(in->datagram().seq.stamp().fiducials(), _fReadoutTime, pData->temperature());
 
+  if ( _pReduction != NULL )
+    reduceFrame(_pDgOut);
+
   out       = _pDgOut;
 
   /*
@@ -1474,6 +1484,9 @@ int PrincetonServer::getDataInBeamRateMode(InDatagram* in, InDatagram*& out)
   //PrincetonDataType*  pData         = (PrincetonDataType*) pFrameHeader;
   new (pFrameHeader) PrincetonDataType(dgIn.seq.stamp().fiducials(), _fReadoutTime, -77 /* temperature undefined */);
 
+  if ( _pReduction != NULL )
+    reduceFrame(out);
+
   if (bFrameError)
     // set damage bit, and still keep the image data
     dgOut.xtc.damage.increase(Pds::Damage::UserDefined);
@@ -1577,7 +1590,7 @@ int PrincetonServer::processFrame()
     return ERROR_LOGICAL_FAILURE;
   }
 
-  if ( _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5 )
+  if ( _pReduction == NULL && ( _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5 ) )
   {
     unsigned char*  pFrameHeader   = (unsigned char*) _pDgOut + sizeof(CDatagram) + sizeof(Xtc);
     PrincetonDataType* pFrame      = (PrincetonDataType*) pFrameHeader;
@@ -1603,6 +1616,22 @@ int PrincetonServer::processFrame()
   return 0;
 }
 
+/*
+ * Replace the full frame of a composed L1 datagram by its binned/ROI/pedestal
+ * subtracted reduction and the frame statistics, which keep the readout header
+ */
+int PrincetonServer::reduceFrame(InDatagram* dg)
+{
+  PrincetonDataType* pData  = (PrincetonDataType*) ((unsigned char*) dg + sizeof(CDatagram) + sizeof(Xtc));
+  float           fTemp     = pData->temperature();
+  const uint16_t* pImage    = (const uint16_t*) ((uint8_t*) dg + _iFrameHeaderSize);
+
+  _pReduction->apply(dg->datagram().xtc, pImage, _src,
+                     pData->shotIdStart(), pData->readoutTime(), &fTemp,
+                     _iNumExposure <= _iMaxEventReport ||  _iDebugLevel >= 5);
+  return 0;
+}
+
 int PrincetonServer::setupFrame()
 {
   if ( _poolFrameData.numberOfFreeObjects() <= 0 )
@@ -1787,7 +1816,7 @@ const int       PrincetonServer::_iTemperatureHiTol;
 const int       PrincetonServer::_iTemperatureLoTol;
 const int       PrincetonServer::_iFrameHeaderSize      = sizeof(CDatagram) + sizeof(Xtc) + sizeof(PrincetonDataType);
 const int       PrincetonServer::_iInfoSize             = sizeof(Xtc) + sizeof(Princeton::InfoV1);
-const int       PrincetonServer::_iMaxFrameDataSize     = _iFrameHeaderSize + 2048*2048*2 + _iInfoSize;
+const int       PrincetonServer::_iMaxFrameDataSize     = _iFrameHeaderSize + 2048*2048*2 + _iInfoSize + FrameReduction::Overhead;
 const int       PrincetonServer::_iPoolDataCount;
 const int       PrincetonServer::_iMaxReadoutTime;
 const int       PrincetonServer::_iMaxThreadEndTime;
@@ -1799,6 +1828,12 @@ const float     PrincetonServer::_fEventDeltaTimeFactor = 1.01f;
  * Definition of private static data
  */
 pthread_mutex_t PrincetonServer::_mutexPlFuncs = PTHREAD_MUTEX_INITIALIZER;
+FrameReduction::Settings PrincetonServer::_reductionSettings;
+
+int PrincetonServer::setReduction(const char* sSettings)
+{
+  return _reductionSettings.parse(sSettings);
+}
 
 
 PrincetonServer::CaptureRoutine::CaptureRoutine(PrincetonServer& server) : _server(server)
@@ -11,6 +11,7 @@
 #include "pdsdata/xtc/DetInfo.hh"
 #include "pds/config/PrincetonConfigType.hh"
 #include "pds/utility/EbTimeoutConstants.hh"
+#include "pds/camera/FrameReduction.hh"
 #include "pds/xtc/InDatagram.hh"
 #include "pds/xtc/Datagram.hh"
 #include "pds/xtc/CDatagram.hh"
@@ -49,6 +50,11 @@ public:
   PrincetonConfigType&
         config() { return _config; }
 
+  /*
+   * Software binning/ROI/pedestal reduction of every frame; see FrameReduction::Settings
+   */
+  static int setReduction(const char* sSettings);
+
   enum  ErrorCodeEnum
   {
     ERROR_INVALID_ARGUMENTS = 1,
@@ -134,6 +140,7 @@ private:
   //int   setupFrame(InDatagram* in, InDatagram*& out); //!!delay mode
   int   waitForNewFrameAvailable();
   int   processFrame();
+  int   reduceFrame(InDatagram* dg);
   int   resetFrameData(bool bDelOutDatagram);
 
   int   setupCooling(float fCoolingTemperature);
@@ -196,6 +203,7 @@ private:
   int                 _iFrameSize;
   int                 _iBufferSize;
   char*               _pFrameBuffer;
+  FrameReduction*     _pReduction;      // Software frame reduction, if enabled
 
   /*
    * Capture Task Control
@@ -235,6 +243,7 @@ private:
    * private static data
    */
   static pthread_mutex_t _mutexPlFuncs;
+  static FrameReduction::Settings _reductionSettings;
 };
 
 class PrincetonServerException : public std::runtime_error
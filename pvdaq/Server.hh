@@ -47,6 +47,7 @@ namespace Pds {
       int fetch( char* payload, int flags );
 
       unsigned fiducials() const { return _seq.stamp().fiducials(); }
+      const Sequence* sequence() const { return &_seq; }
 
     protected:
       //  Subclasses call post when their data is ready
@@ -232,6 +232,7 @@ int Pds::RayonixServer::fetch( char* payload, int flags )
   int verbose = RayonixServer::verbose();
   int rv;
   int damage = 0;
+  int missingLines = 0;
   char msgBuf[80];
 
   if (verbose) {
@@ -247,7 +248,7 @@ int Pds::RayonixServer::fetch( char* payload, int flags )
   new (payload+offset) Pds::Camera::FrameV1(width, height, Pds::Rayonix_MX170HS::depth_bits, 0);
 
   offset += sizeof(Pds::Camera::FrameV1);
-  rv = _rnxdata->readFrame(frameNumber, (payload+offset), MAXFRAME, binning_f, binning_s, verbose);
+  rv = _rnxdata->readFrame(frameNumber, (payload+offset), MAXFRAME, binning_f, binning_s, missingLines, verbose);
   _count++;
 
   if (verbose) {
@@ -298,8 +299,12 @@ int Pds::RayonixServer::fetch( char* payload, int flags )
      // Calculate xtc extent (rv is number of pixels -> convert to bytes)
      _xtc.extent = rv*Pds::Rayonix_MX170HS::depth_bytes + offset;
      
-     // copy xtc header to payload
-     memcpy(payload, &_xtc, sizeof(Xtc));
+     // copy xtc header to payload; missing lines are zero filled and
+     // flagged as damage
+     Xtc* xtc = new (payload) Xtc(_xtc);
+     if (missingLines) {
+        xtc->damage.increase(Pds::Damage::UserDefined);
+     }
   }
 
   return (damage ? _xtcDamaged.extent : _xtc.extent);
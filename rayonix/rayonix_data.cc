@@ -13,11 +13,10 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <string.h>
+#include <poll.h>
 
 #include "rayonix_data.hh"
 
-#define ROUND_UP(x,y)       (((x)+(y)-1)/(y)*(y))
-
 // forward declarations
 int createUdpSocket(int port);
 int setrcvbuf(int socketFd, unsigned size);
@@ -28,6 +27,20 @@ Pds::rayonix_data::rayonix_data(bool verbose)
 {
   // allocate buffers
   _discard = new char[DiscardBufSize];
+  _msgs     = new struct mmsghdr[LineBatch];
+  _iovs     = new struct iovec[2*LineBatch];
+  _footers  = new data_footer_t[LineBatch];
+  _scratch  = new char[LineBatch * MAX_LINE_PIXELS * 2];
+  _lines    = new int[LineBatch];
+  _received = new char[MAX_LINE_PIXELS];
+
+  memset(_msgs, 0, LineBatch * sizeof(struct mmsghdr));
+  for (int ii = 0; ii < LineBatch; ii++) {
+    _iovs[2*ii+1].iov_base = &_footers[ii];
+    _iovs[2*ii+1].iov_len  = sizeof(data_footer_t);
+    _msgs[ii].msg_hdr.msg_iov    = &_iovs[2*ii];
+    _msgs[ii].msg_hdr.msg_iovlen = 2;
+  }
 
   // create notify socket
   _notifyFd = createUdpSocket(RNX_NOTIFY_PORT);
@@ -72,6 +85,12 @@ Pds::rayonix_data::~rayonix_data()
     close(_dataFdOdd);
   }
   delete[] _discard;
+  delete[] _msgs;
+  delete[] _iovs;
+  delete[] _footers;
+  delete[] _scratch;
+  delete[] _lines;
+  delete[] _received;
 }
 
 int Pds::rayonix_data::drainFd(int fd) const
@@ -104,110 +123,183 @@ int Pds::rayonix_data::reset(bool verbose) const
 /*
  * readFrame
  *
+ * Lines are fetched LineBatch at a time with recvmmsg.  Each line is
+ * received directly into the payload slot predicted for it (following the
+ * highest line received so far) with its footer split off into a separate
+ * buffer.  A line that arrives out of order is moved to the slot given by
+ * its line number; only those lines are copied.  Lines still missing when
+ * the socket stays empty for LineTimeout msec are zero filled and counted
+ * in missingLines.
+ *
  * RETURNS: -1 on ERROR, otherwise the number of 16-bit pixels read.
  */
 int Pds::rayonix_data::readFrame(uint16_t& frameNumber, char *payload, int payloadMax,
-                                 int &binning_f, int &binning_s, bool verbose) const
+                                 int &binning_f, int &binning_s, int &missingLines,
+                                 bool verbose) const
 {
+  const int linelen = MAX_LINE_PIXELS * 2;
   int     dataFd;
-  int     recvlen, recvsum, pixelsReceived, datalen, expectlen;
+  int     recvlen;
   char    mybuf[sizeof(data_footer_t)];
   data_footer_t *pNotifyMsg;
-  data_footer_t *pFooter;
   uint16_t firstValue;
-  char *tmpload = payload;
   int     rv = 0;
 
+  missingLines = 0;
+
   // fetch notification
   recvlen = recvfrom(_notifyFd, mybuf, sizeof(data_footer_t), MSG_DONTWAIT, 0, 0);
-  if (recvlen == sizeof(data_footer_t)) {
-    pNotifyMsg = (data_footer_t *)mybuf;
+  if (recvlen != sizeof(data_footer_t)) {
+    printf(" *** ERROR %s: received %d bytes from notifyFd\n\r", __PRETTY_FUNCTION__, recvlen);
+    return (-1);
+  }
+
+  pNotifyMsg = (data_footer_t *)mybuf;
+  if (verbose) {
+    printf("%s: recvd: epoch=%d frame=%d binning_f=%d binning_s=%d damage=0x%08x\n\r",
+           __FUNCTION__, pNotifyMsg->epoch, pNotifyMsg->frameNumber,
+           pNotifyMsg->binning_f, pNotifyMsg->binning_s, pNotifyMsg->damage);
+  }
+  binning_f = pNotifyMsg->binning_f;
+  binning_s = pNotifyMsg->binning_s;
+  frameNumber = pNotifyMsg->frameNumber;
+
+  // sanity check binning
+  if ((binning_f < Rayonix_MX170HS::min_binning_f) ||
+      (binning_s < Rayonix_MX170HS::min_binning_s) ||
+      (binning_f > Rayonix_MX170HS::max_binning_f) ||
+      (binning_s > Rayonix_MX170HS::max_binning_s)) {
     if (verbose) {
-      printf("%s: recvd: epoch=%d frame=%d binning_f=%d binning_s=%d damage=0x%08x\n\r",
-             __FUNCTION__, pNotifyMsg->epoch, pNotifyMsg->frameNumber,
-             pNotifyMsg->binning_f, pNotifyMsg->binning_s, pNotifyMsg->damage);
+      printf(" ** ERROR %s: invalid binning (%d:%d)\n\r",
+             __FUNCTION__, binning_f, binning_s);
     }
-    binning_f = pNotifyMsg->binning_f;
-    binning_s = pNotifyMsg->binning_s;
-    expectlen = MAX_LINE_PIXELS * 2;
-
-    // sanity check binning
-    if ((binning_f < Rayonix_MX170HS::min_binning_f) ||
-        (binning_s < Rayonix_MX170HS::min_binning_s) ||
-        (binning_f > Rayonix_MX170HS::max_binning_f) ||
-        (binning_s > Rayonix_MX170HS::max_binning_s)) {
-      if (verbose) {
-        printf(" ** ERROR %s: invalid binning (%d:%d)\n\r",
-               __FUNCTION__, binning_f, binning_s);
-      }
-      return (-1);
+    return (-1);
+  }
+
+  // lines are numbered 0, binning_f, 2*binning_f, ...
+  int nlines = (MAX_LINE_PIXELS/binning_s + binning_f - 1) / binning_f;
+  if (nlines * linelen > payloadMax) {
+    printf(" ** ERROR %s: frame of %d lines exceeds payload of %d bytes\n\r",
+           __FUNCTION__, nlines, payloadMax);
+    return (-1);
+  }
+
+  // fetch frame data
+  dataFd = (pNotifyMsg->frameNumber & 1) ? _dataFdOdd : _dataFdEven;
+  memset(_received, 0, nlines);
+  int nreceived = 0;
+  int nstray    = 0;
+  int next      = 0;    // slot predicted for the next line
+
+  while (nreceived < nlines) {
+    int nmsgs = nlines - nreceived;
+    if (nmsgs > LineBatch) {
+      nmsgs = LineBatch;
+    }
+    for (int ii = 0; ii < nmsgs; ii++) {
+      int slot = next + ii;
+      _iovs[2*ii].iov_base = (slot < nlines) ? payload + slot*linelen : _scratch + ii*linelen;
+      _iovs[2*ii].iov_len  = linelen;
     }
 
-    // fetch frame data
-    recvsum = 0;
-    dataFd = (pNotifyMsg->frameNumber & 1) ? _dataFdOdd : _dataFdEven;
-    for (int ii = 0; ii < MAX_LINE_PIXELS/binning_s; ii += binning_f) {
-      recvlen = recvfrom(dataFd, tmpload, payloadMax, MSG_DONTWAIT, 0, 0);
-      // verify len
-      if (recvlen <= 0) {
-        perror("readFrame() recvfrom");
+    int nrecv = recvmmsg(dataFd, _msgs, nmsgs, MSG_DONTWAIT, 0);
+    if (nrecv <= 0) {
+      if ((nrecv < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+        perror("readFrame() recvmmsg");
         rv = -1;
         break;
       }
-      datalen = recvlen - sizeof(data_footer_t);
-      if (datalen != expectlen) {
-        printf(" ** ERROR %s: data size mismatch -- recvd %d expected %d\n\r",
-               __FUNCTION__, datalen, expectlen);
-        rv = -1;
+      // wait briefly for late lines
+      struct pollfd pfd;
+      pfd.fd      = dataFd;
+      pfd.events  = POLLIN;
+      pfd.revents = 0;
+      if (poll(&pfd, 1, LineTimeout) <= 0) {
         break;
       }
-      // verify payload footer is correct
-      pFooter = (data_footer_t *)(tmpload + datalen);
-      if (pFooter->lineNumber != ii) {
-        printf(" ** ERROR %s: line number mismatch -- recvd %d expected %d\n\r",
-               __FUNCTION__, pFooter->lineNumber, ii);
-        rv = -1;
+      continue;
+    }
+
+    // validate each line, and save those received out of place before
+    // any line is moved
+    for (int ii = 0; ii < nrecv; ii++) {
+      data_footer_t *pFooter = &_footers[ii];
+      int slot = next + ii;
+      _lines[ii] = -1;
+      if (_msgs[ii].msg_len != linelen + sizeof(data_footer_t)) {
+        if (verbose) {
+          printf(" ** ERROR %s: data size mismatch -- recvd %d expected %d\n\r",
+                 __FUNCTION__, int(_msgs[ii].msg_len - sizeof(data_footer_t)), linelen);
+        }
+        nstray++;
+        continue;
       }
-      if (pFooter->frameNumber != pNotifyMsg->frameNumber) {
-        printf(" ** ERROR %s: frame number mismatch -- recvd %d expected %d\n\r",
-               __FUNCTION__, pFooter->frameNumber, pNotifyMsg->frameNumber);
-        rv = -1;
+      if ((pFooter->frameNumber != pNotifyMsg->frameNumber) ||
+          (pFooter->binning_f != pNotifyMsg->binning_f) ||
+          (pFooter->binning_s != pNotifyMsg->binning_s) ||
+          (pFooter->lineNumber % binning_f)) {
+        if (verbose) {
+          printf(" ** ERROR %s: stray line -- frame %d line %d binning %d:%d\n\r",
+                 __FUNCTION__, pFooter->frameNumber, pFooter->lineNumber,
+                 pFooter->binning_f, pFooter->binning_s);
+        }
+        nstray++;
+        continue;
       }
-      if (pFooter->binning_f != pNotifyMsg->binning_f) {
-        printf(" ** ERROR %s: binning_f mismatch -- recvd %d expected %d\n\r",
-               __FUNCTION__, pFooter->binning_f, pNotifyMsg->binning_f);
-        rv = -1;
+      int line = pFooter->lineNumber / binning_f;
+      if ((line >= nlines) || _received[line]) {
+        nstray++;
+        continue;
       }
-      if (pFooter->binning_s != pNotifyMsg->binning_s) {
-        printf(" ** ERROR %s: binning_s mismatch -- recvd %d expected %d\n\r",
-               __FUNCTION__, pFooter->binning_s, pNotifyMsg->binning_s);
-        rv = -1;
+      _received[line] = 1;
+      _lines[ii] = line;
+      if ((line != slot) && (slot < nlines)) {
+        memcpy(_scratch + ii*linelen, payload + slot*linelen, linelen);
+      }
+    }
+
+    // move lines received out of place
+    for (int ii = 0; ii < nrecv; ii++) {
+      int line = _lines[ii];
+      if (line < 0) {
+        continue;
+      }
+      if (line != next + ii) {
+        memcpy(payload + line*linelen, _scratch + ii*linelen, linelen);
+      }
+      nreceived++;
+    }
+
+    // predict the following lines after the highest received
+    for (int ii = 0; ii < nrecv; ii++) {
+      if (_lines[ii] >= next) {
+        next = _lines[ii] + 1;
       }
+    }
+  }
 
-      // advance payload pointer to next line
-      recvsum += datalen;
-      tmpload += datalen;
-      payloadMax -= datalen;
+  if (rv == 0) {
+    // zero fill missing lines
+    for (int ii = 0; ii < nlines; ii++) {
+      if (!_received[ii]) {
+        memset(payload + ii*linelen, 0, linelen);
+        missingLines++;
+      }
     }
-    pixelsReceived = recvsum / 2;
-    expectlen = ROUND_UP(MAX_FRAME_PIXELS/binning_s/binning_f, MAX_LINE_PIXELS);
-    if (pixelsReceived != expectlen) {
-      printf(" ** ERROR %s: received %d pixels from dataFd (expected %d)\n\r",
-             __FUNCTION__, pixelsReceived, expectlen);
-      rv = -1;
+    if (missingLines || nstray) {
+      printf(" ** %s: frame %d missing %d of %d lines (%d stray)\n\r",
+             __FUNCTION__, frameNumber, missingLines, nlines, nstray);
     }
-    frameNumber = pNotifyMsg->frameNumber;
-    // check frame number in data
-    firstValue = *((uint16_t *) payload);
 
-    if (firstValue != frameNumber) {
-      printf("%s: frame # mismatch: notify=%hu first=%hu\n\r",
-             __FUNCTION__, frameNumber, firstValue);
-      rv = -1;
+    // check frame number in data
+    if (_received[0]) {
+      firstValue = *((uint16_t *) payload);
+      if (firstValue != frameNumber) {
+        printf("%s: frame # mismatch: notify=%hu first=%hu\n\r",
+               __FUNCTION__, frameNumber, firstValue);
+        rv = -1;
+      }
     }
-  } else {
-    printf(" *** ERROR %s: received %d bytes from notifyFd\n\r", __PRETTY_FUNCTION__, recvlen);
-    rv = -1;
   }
   return (rv == 0 ? MAX_FRAME_PIXELS/binning_s/binning_f : rv);
 }
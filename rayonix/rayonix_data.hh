@@ -6,6 +6,9 @@
 
 #include "rayonix_common.hh"
 
+#include <sys/socket.h>
+#include <sys/uio.h>
+
 #define UDP_RCVBUF_SIZE     (64*1024*1024)
 
 namespace Pds
@@ -36,9 +39,12 @@ public:
   int fd() const                  { return (_notifyFd); }
   int drainFd(int fd) const;
   int reset(bool verbose) const;
-  int readFrame(uint16_t& frameNumber, char *payload, int payloadMax, int &binning_f, int &binning_s, bool verbose) const;
+  int readFrame(uint16_t& frameNumber, char *payload, int payloadMax, int &binning_f, int &binning_s,
+                int &missingLines, bool verbose) const;
 
   enum { DiscardBufSize = 10000 };
+  enum { LineBatch = 64 };      // lines fetched per recvmmsg
+  enum { LineTimeout = 5 };     // msec to wait for late lines
 
 private:
   //
@@ -49,6 +55,15 @@ private:
   int         _dataFdOdd;
   char *      _discard;
   unsigned    _bufsize;
+  //
+  // line receive buffers
+  //
+  struct mmsghdr* _msgs;
+  struct iovec*   _iovs;        // line data and footer of each message
+  data_footer_t*  _footers;
+  char *          _scratch;     // lines received out of place
+  int *           _lines;       // line index of each message
+  char *          _received;    // lines received in the current frame
 };
   
 #endif
@@ -80,6 +80,7 @@ int main(int argc, char *argv[])
   int i, rv;
   uint16_t frameNumber;
   int binning_f, binning_s;
+  int missingLines;
   bool verbose = false;
   Pds::rayonix_data *pData;
   char *buf;
@@ -107,7 +108,7 @@ int main(int argc, char *argv[])
   // init
   makeraw(0);
   buf = new char[BUFSIZE];
-  pData = new Pds::rayonix_data(10000, verbose);
+  pData = new Pds::rayonix_data(verbose);
   notifyFd = pData->fd();
   nfds = notifyFd + 1;
   pData->reset(verbose);
@@ -145,7 +146,7 @@ int main(int argc, char *argv[])
       }
       if FD_ISSET(notifyFd, &notify_set) {
         // data socket
-        rv = pData->readFrame(frameNumber, buf, BUFSIZE, binning_f, binning_s, verbose);
+        rv = pData->readFrame(frameNumber, buf, BUFSIZE, binning_f, binning_s, missingLines, verbose);
         if (!verbose) {
           dodots(frameNumber);
         }
@@ -0,0 +1,196 @@
+// $Id$
+//
+// rnxtest - loopback test of rayonix_data::readFrame
+//
+// Sends frames to the local data and notify ports in the format of the
+// rnxserv simulator (see sendFrame() in ../rnxserv/workThread.c), with lines
+// optionally reordered or dropped, and checks that readFrame places every
+// line received by its line number and reports the dropped lines.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "rayonix_data.hh"
+
+#define BUFSIZE (32 * 1024 * 1024)
+
+static uint16_t pixelValue(int line, int ii)
+{
+  return (uint16_t)(line * 7 + ii);
+}
+
+class LineSender {
+public:
+  LineSender() : _fd(socket(AF_INET, SOCK_DGRAM, 0)) {}
+  ~LineSender() { close(_fd); }
+public:
+  int send(int port, const void *buf, int len)
+  {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    return sendto(_fd, buf, len, 0, (struct sockaddr *)&addr, sizeof(addr));
+  }
+private:
+  int _fd;
+};
+
+//
+// Send one frame as rnxserv does: one datagram per line, the line followed
+// by its footer, then the footer alone on the notify port.  Every "swap"th
+// pair of lines is exchanged and every "drop"th line is skipped.
+//
+static int sendFrame(LineSender& sender, uint16_t frameNumber, int binning,
+                     int swap, int drop, bool *dropped)
+{
+  int nlines = (MAX_LINE_PIXELS/binning + binning - 1) / binning;
+  uint16_t linebuf[MAX_LINE_PIXELS + sizeof(data_footer_t)/2];
+  data_footer_t *pFooter = (data_footer_t *)(linebuf + MAX_LINE_PIXELS);
+  int writeSize = (MAX_LINE_PIXELS * 2) + sizeof(data_footer_t);
+  int ndropped = 0;
+
+  pFooter->cmd = 0;
+  pFooter->frameNumber = frameNumber;
+  pFooter->damage = 0;
+  pFooter->epoch = 1;
+  pFooter->binning_f = binning;
+  pFooter->binning_s = binning;
+  pFooter->pad = 0;
+
+  for (int kk = 0; kk < nlines; kk++) {
+    int line = kk;
+    if (swap && (kk % swap == 0) && (kk + 1 < nlines)) {
+      line = kk + 1;
+    } else if (swap && (kk % swap == 1)) {
+      line = kk - 1;
+    }
+    dropped[line] = drop && (line % drop == drop - 1);
+    if (dropped[line]) {
+      ndropped++;
+      continue;
+    }
+    for (int ii = 0; ii < MAX_LINE_PIXELS; ii++) {
+      linebuf[ii] = pixelValue(line, ii);
+    }
+    if (line == 0) {
+      linebuf[0] = frameNumber;
+    }
+    pFooter->lineNumber = line * binning;
+    if (sender.send((frameNumber & 1) ? RNX_DATA_PORT_ODD : RNX_DATA_PORT_EVEN,
+                    linebuf, writeSize) != writeSize) {
+      perror("sendto");
+      return (-1);
+    }
+    if (kk % 64 == 63) {
+      usleep(100);    // stay within the loopback socket buffer
+    }
+  }
+  pFooter->lineNumber = 0;
+  sender.send(RNX_NOTIFY_PORT, pFooter, sizeof(data_footer_t));
+  return (ndropped);
+}
+
+static int checkFrame(const char *buf, uint16_t frameNumber, int binning, const bool *dropped)
+{
+  int nlines = (MAX_LINE_PIXELS/binning + binning - 1) / binning;
+  int nerrors = 0;
+  for (int line = 0; line < nlines; line++) {
+    const uint16_t *p = (const uint16_t *)(buf + line * MAX_LINE_PIXELS * 2);
+    for (int ii = 0; ii < MAX_LINE_PIXELS; ii++) {
+      uint16_t expect = dropped[line] ? 0 : pixelValue(line, ii);
+      if ((line == 0) && (ii == 0) && !dropped[line]) {
+        expect = frameNumber;
+      }
+      if (p[ii] != expect) {
+        if (nerrors++ < 10) {
+          printf("ERROR: frame %d line %d pixel %d = %d, expected %d\n",
+                 frameNumber, line, ii, p[ii], expect);
+        }
+        break;
+      }
+    }
+  }
+  return (nerrors);
+}
+
+static void usage(const char *p)
+{
+  printf("Usage: %s [-n <frames>] [-b <binning>] [-s <swap>] [-d <drop>] [-v]\n"
+         "  -s <swap>  exchange the first two lines of every <swap> lines\n"
+         "  -d <drop>  drop every <drop>th line\n", p);
+}
+
+int main(int argc, char *argv[])
+{
+  int nframes = 10;
+  int binning = 2;
+  int swap    = 0;
+  int drop    = 0;
+  bool verbose = false;
+  int c;
+
+  while ((c = getopt(argc, argv, "n:b:s:d:vh")) != -1) {
+    switch (c) {
+      case 'n': nframes = strtoul(optarg, NULL, 0); break;
+      case 'b': binning = strtoul(optarg, NULL, 0); break;
+      case 's': swap    = strtoul(optarg, NULL, 0); break;
+      case 'd': drop    = strtoul(optarg, NULL, 0); break;
+      case 'v': verbose = true; break;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+
+  Pds::rayonix_data data(verbose);
+  data.reset(verbose);
+
+  LineSender sender;
+  char *buf = new char[BUFSIZE];
+  bool dropped[MAX_LINE_PIXELS];
+  int nfailed = 0;
+
+  for (int frame = 1; frame <= nframes; frame++) {
+    memset(dropped, 0, sizeof(dropped));
+    memset(buf, 0xff, BUFSIZE);
+    int ndropped = sendFrame(sender, (uint16_t)frame, binning, swap, drop, dropped);
+    if (ndropped < 0) {
+      return 1;
+    }
+
+    struct pollfd pfd;
+    pfd.fd      = data.fd();
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 1000) <= 0) {
+      printf("ERROR: no notification for frame %d\n", frame);
+      nfailed++;
+      continue;
+    }
+
+    uint16_t frameNumber;
+    int binning_f, binning_s, missingLines;
+    int rv = data.readFrame(frameNumber, buf, BUFSIZE, binning_f, binning_s, missingLines, verbose);
+    int expect = MAX_FRAME_PIXELS/binning/binning;
+    if ((rv != expect) || (frameNumber != frame) || (missingLines != ndropped) ||
+        checkFrame(buf, frameNumber, binning, dropped)) {
+      printf("FAILED frame %d: returned %d (expected %d), missing %d (dropped %d)\n",
+             frame, rv, expect, missingLines, ndropped);
+      nfailed++;
+    }
+  }
+
+  printf("%d of %d frames failed\n", nfailed, nframes);
+  delete[] buf;
+  return (nfailed ? 1 : 0);
+}
@@ -0,0 +1,302 @@
+#include "pds/service/BinaryLog.hh"
+#include "pds/service/Task.hh"
+#include "pds/service/TaskObject.hh"
+#include "pds/service/Routine.hh"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+using namespace Pds;
+
+namespace Pds {
+  class BinaryLogRecord {
+  public:
+    const BinaryLog::Site* site;
+    uint32_t sec;
+    uint32_t nsec;
+    uint32_t suppressed;
+    uint32_t tid;
+    uint32_t nargs;
+    uint32_t reserved;
+    uint64_t arg[BinaryLog::MaxArgs];
+  };
+
+  //
+  //  Single producer (the owning thread), single consumer (the drain)
+  //
+  class BinaryLogRing {
+  public:
+    volatile unsigned head;
+    volatile unsigned tail;
+    unsigned          dropped;
+    uint32_t          tid;
+    BinaryLogRing*    next;
+    BinaryLogRecord   rec[BinaryLog::RingSize];
+  };
+
+  class BinaryLogDrain : public Routine {
+  public:
+    void routine();
+  };
+};
+
+static const unsigned DrainPeriod = 10;  // ms
+
+static __thread BinaryLogRing* _ring = 0;
+static BinaryLogRing* volatile _rings = 0;
+
+static unsigned         _limit = 32;
+static bool             _print = true;
+static pthread_mutex_t  _lock  = PTHREAD_MUTEX_INITIALIZER;  // drain and dump
+static BinaryLogRecord* _history = 0;
+static uint64_t         _nhistory = 0;
+static Task*            _task = 0;
+
+static BinaryLogRing* _attach()
+{
+  BinaryLogRing* r = new BinaryLogRing;
+  r->head    = 0;
+  r->tail    = 0;
+  r->dropped = 0;
+  r->tid     = syscall(SYS_gettid);
+
+  pthread_mutex_lock(&_lock);
+  if (!_task) {
+    _history = new BinaryLogRecord[BinaryLog::HistorySize];
+    _task    = new Task(TaskObject("BinaryLog"));
+    _task->call(new BinaryLogDrain);
+  }
+  r->next = _rings;
+  __sync_synchronize();
+  _rings  = r;
+  pthread_mutex_unlock(&_lock);
+
+  return _ring = r;
+}
+
+void BinaryLog::_record(Site& s, const char* format, const uint64_t* arg, unsigned nargs)
+{
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+
+  //  Rate limit; the counts are approximate when threads share a site
+  if (s.window != uint32_t(ts.tv_sec)) {
+    s.window = ts.tv_sec;
+    s.count  = 0;
+  }
+  if (s.count >= _limit) {
+    s.suppressed++;
+    return;
+  }
+  s.count++;
+  s.format = format;
+
+  BinaryLogRing* r = _ring ? _ring : _attach();
+  unsigned h = r->head;
+  if (h - r->tail == RingSize) {
+    r->dropped++;
+    return;
+  }
+  BinaryLogRecord& rec = r->rec[h&(RingSize-1)];
+  rec.site       = &s;
+  rec.sec        = ts.tv_sec;
+  rec.nsec       = ts.tv_nsec;
+  rec.suppressed = s.suppressed;
+  rec.tid        = r->tid;
+  rec.nargs      = nargs;
+  for(unsigned i=0; i<nargs; i++)
+    rec.arg[i] = arg[i];
+  s.suppressed = 0;
+  __sync_synchronize();  // publish the record before the index
+  r->head = h+1;
+}
+
+//
+//  Formats one conversion of "spec" (from '%' through the conversion
+//  character) with the record's arguments starting at "*iarg"
+//
+static int _convert(char* out, unsigned size, const char* spec, unsigned len,
+                    const BinaryLogRecord& rec, unsigned* iarg)
+{
+  char fmt[32];
+  if (len > sizeof(fmt)-4) len = sizeof(fmt)-4;  // room for "ll" and the terminator
+
+  //  Drop the length modifiers; the argument is cast to the widest type
+  unsigned n=0;
+  int star[2];
+  unsigned nstar=0;
+  bool wide=false;
+  for(unsigned i=0; i<len-1; i++) {
+    char c = spec[i];
+    if (c=='h' || c=='L')
+      continue;
+    if (c=='l' || c=='q' || c=='j' || c=='z' || c=='t') {
+      wide = true;
+      continue;
+    }
+    if (c=='*' && nstar<2)
+      star[nstar++] = *iarg < rec.nargs ? int(rec.arg[(*iarg)++]) : 0;
+    fmt[n++] = c;
+  }
+  char conv = spec[len-1];
+
+  if (*iarg >= rec.nargs)
+    return snprintf(out, size, "<missing>");
+  uint64_t a = rec.arg[(*iarg)++];
+
+  switch(conv) {
+  case 'd': case 'i':
+    { //  Without a length modifier the value is an int, as printf would take it
+      long long v = wide ? (long long)a : (long long)int(a);
+      fmt[n++]='l'; fmt[n++]='l'; fmt[n++]=conv; fmt[n]=0;
+      if (nstar==2) return snprintf(out, size, fmt, star[0], star[1], v);
+      if (nstar==1) return snprintf(out, size, fmt, star[0], v);
+      return snprintf(out, size, fmt, v);
+    }
+  case 'o': case 'u': case 'x': case 'X':
+    { unsigned long long v = wide ? a : (a & 0xffffffffULL);
+      fmt[n++]='l'; fmt[n++]='l'; fmt[n++]=conv; fmt[n]=0;
+      if (nstar==2) return snprintf(out, size, fmt, star[0], star[1], v);
+      if (nstar==1) return snprintf(out, size, fmt, star[0], v);
+      return snprintf(out, size, fmt, v);
+    }
+  case 'c':
+    fmt[n++]=conv; fmt[n]=0;
+    return snprintf(out, size, fmt, int(a));
+  case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+    { union { double d; uint64_t u; } x; x.u = a;
+      fmt[n++]=conv; fmt[n]=0;
+      if (nstar==2) return snprintf(out, size, fmt, star[0], star[1], x.d);
+      if (nstar==1) return snprintf(out, size, fmt, star[0], x.d);
+      return snprintf(out, size, fmt, x.d); }
+  case 's':
+    fmt[n++]=conv; fmt[n]=0;
+    { const char* p = reinterpret_cast<const char*>(uintptr_t(a));
+      if (!p) p = "(null)";
+      if (nstar==2) return snprintf(out, size, fmt, star[0], star[1], p);
+      if (nstar==1) return snprintf(out, size, fmt, star[0], p);
+      return snprintf(out, size, fmt, p); }
+  case 'p':
+    fmt[n++]=conv; fmt[n]=0;
+    return snprintf(out, size, fmt, reinterpret_cast<void*>(uintptr_t(a)));
+  default:
+    return snprintf(out, size, "<%%%c?>", conv);
+  }
+}
+
+static void _format(FILE* f, const BinaryLogRecord& rec)
+{
+  char line[512];
+  unsigned n = 0;
+
+  time_t t = rec.sec;
+  struct tm tm;
+  localtime_r(&t, &tm);
+  n += strftime(line, sizeof(line), "%H:%M:%S", &tm);
+  n += snprintf(line+n, sizeof(line)-n, ".%03u [%u] ", rec.nsec/1000000, rec.tid);
+
+  const char* p = rec.site->format;
+  unsigned iarg = 0;
+  while(*p && n < sizeof(line)-1) {
+    if (*p != '%') {
+      line[n++] = *p++;
+      continue;
+    }
+    if (p[1]=='%') {
+      line[n++] = '%';
+      p += 2;
+      continue;
+    }
+    const char* q = p+1;
+    while(*q && !strchr("diouxXcspeEfFgGaAn", *q))
+      q++;
+    if (!*q) break;
+    if (*q != 'n') {
+      int m = _convert(line+n, sizeof(line)-n, p, q-p+1, rec, &iarg);
+      if (m > 0) n += m;
+      if (n >= sizeof(line)) n = sizeof(line)-1;
+    }
+    p = q+1;
+  }
+  //  The format's own newline ends the line
+  while(n && line[n-1]=='\n') n--;
+  line[n] = 0;
+  if (rec.suppressed)
+    fprintf(f, "%s  (%u suppressed)\n", line, rec.suppressed);
+  else
+    fprintf(f, "%s\n", line);
+}
+
+//
+//  Moves the pending records of every thread into the history, printing
+//  them if enabled.  Called with the lock held.
+//
+static void _drain()
+{
+  for(BinaryLogRing* r = _rings; r; r = r->next) {
+    unsigned t = r->tail;
+    unsigned h = r->head;
+    __sync_synchronize();  // read the records after the index
+    for(; t != h; t++) {
+      const BinaryLogRecord& rec = r->rec[t&(BinaryLog::RingSize-1)];
+      _history[_nhistory++ % BinaryLog::HistorySize] = rec;
+      if (_print)
+        _format(stdout, rec);
+    }
+    __sync_synchronize();  // release the records after they are copied
+    r->tail = t;
+  }
+  if (_print)
+    fflush(stdout);
+}
+
+void BinaryLogDrain::routine()
+{
+  timespec ts;
+  ts.tv_sec  = 0;
+  ts.tv_nsec = DrainPeriod*1000000;
+  while(1) {
+    nanosleep(&ts, 0);
+    pthread_mutex_lock(&_lock);
+    _drain();
+    pthread_mutex_unlock(&_lock);
+  }
+}
+
+void     BinaryLog::limit(unsigned n) { _limit = n; }
+unsigned BinaryLog::limit() { return _limit; }
+void     BinaryLog::print(bool v) { _print = v; }
+
+void BinaryLog::flush()
+{
+  pthread_mutex_lock(&_lock);
+  if (_task)
+    _drain();
+  pthread_mutex_unlock(&_lock);
+}
+
+void BinaryLog::dump(unsigned n, FILE* f)
+{
+  pthread_mutex_lock(&_lock);
+  if (_task) {
+    _drain();
+    if (n > HistorySize) n = HistorySize;
+    if (n > _nhistory)   n = _nhistory;
+    fprintf(f, "BinaryLog: last %u of %llu records\n", n, (unsigned long long)_nhistory);
+    for(uint64_t i=_nhistory-n; i<_nhistory; i++)
+      _format(f, _history[i % HistorySize]);
+    fflush(f);
+  }
+  pthread_mutex_unlock(&_lock);
+}
+
+uint64_t BinaryLog::dropped()
+{
+  uint64_t n = 0;
+  for(BinaryLogRing* r = _rings; r; r = r->next)
+    n += r->dropped;
+  return n;
+}
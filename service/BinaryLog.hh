@@ -0,0 +1,95 @@
+#ifndef Pds_BinaryLog_hh
+#define Pds_BinaryLog_hh
+
+//
+//  Logging for hot paths.  PDS_LOG(format, args...) records the address
+//  of the format and up to MaxArgs arguments in a ring owned by the
+//  calling thread, without locks or formatting; a background task drains
+//  the rings, formats the records and prints them.  The last HistorySize
+//  records are kept and can be printed on demand with dump().
+//
+//  Each call site is rate limited to limit() records per second; the
+//  number suppressed is reported with the site's next record.  A record
+//  is dropped when its thread's ring is full.
+//
+//  The format must be a string literal.  "%s" arguments are recorded by
+//  address, so they must remain valid until the record is printed (string
+//  literals, static names).  Integer, floating point and pointer
+//  conversions and "*" widths are supported.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define PDS_LOG(...) do {                                       \
+    static Pds::BinaryLog::Site _pds_log_site;                  \
+    Pds::BinaryLog::record(_pds_log_site, __VA_ARGS__);         \
+  } while(0)
+
+namespace Pds {
+
+  class BinaryLog {
+  public:
+    enum { MaxArgs = 6, RingSize = 1024, HistorySize = 4096 };
+    //  Zero-initialized as a static, so no guard is needed at the call site
+    class Site {
+    public:
+      const char* format;
+      uint32_t    window;      // second of the current rate window
+      uint32_t    count;       // records in the window
+      uint32_t    suppressed;  // since the last record
+    };
+  public:
+    static void record(Site& s, const char* f)
+    { _record(s, f, 0, 0); }
+    template <class A0>
+    static void record(Site& s, const char* f, A0 a0)
+    { uint64_t a[] = { _pack(a0) };
+      _record(s, f, a, 1); }
+    template <class A0, class A1>
+    static void record(Site& s, const char* f, A0 a0, A1 a1)
+    { uint64_t a[] = { _pack(a0), _pack(a1) };
+      _record(s, f, a, 2); }
+    template <class A0, class A1, class A2>
+    static void record(Site& s, const char* f, A0 a0, A1 a1, A2 a2)
+    { uint64_t a[] = { _pack(a0), _pack(a1), _pack(a2) };
+      _record(s, f, a, 3); }
+    template <class A0, class A1, class A2, class A3>
+    static void record(Site& s, const char* f, A0 a0, A1 a1, A2 a2, A3 a3)
+    { uint64_t a[] = { _pack(a0), _pack(a1), _pack(a2), _pack(a3) };
+      _record(s, f, a, 4); }
+    template <class A0, class A1, class A2, class A3, class A4>
+    static void record(Site& s, const char* f, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4)
+    { uint64_t a[] = { _pack(a0), _pack(a1), _pack(a2), _pack(a3), _pack(a4) };
+      _record(s, f, a, 5); }
+    template <class A0, class A1, class A2, class A3, class A4, class A5>
+    static void record(Site& s, const char* f, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
+    { uint64_t a[] = { _pack(a0), _pack(a1), _pack(a2), _pack(a3), _pack(a4), _pack(a5) };
+      _record(s, f, a, 6); }
+  public:
+    //  Records per call site per second; 0 disables logging
+    static void     limit (unsigned);
+    static unsigned limit ();
+    //  Records are still kept for dump() when not printed
+    static void     print (bool);
+    //  Formats and prints the pending records of all threads now
+    static void     flush ();
+    //  Prints the last n records
+    static void     dump  (unsigned n, FILE* f=stdout);
+    //  Records lost to full rings
+    static uint64_t dropped();
+  private:
+    static void     _record(Site&, const char*, const uint64_t*, unsigned);
+  private:
+    static uint64_t _pack(int v)                { return int64_t(v); }
+    static uint64_t _pack(unsigned v)           { return v; }
+    static uint64_t _pack(long v)               { return int64_t(v); }
+    static uint64_t _pack(unsigned long v)      { return v; }
+    static uint64_t _pack(long long v)          { return v; }
+    static uint64_t _pack(unsigned long long v) { return v; }
+    static uint64_t _pack(double v)             { union { double d; uint64_t u; } x; x.d = v; return x.u; }
+    static uint64_t _pack(const void* v)        { return uintptr_t(v); }
+  };
+};
+
+#endif
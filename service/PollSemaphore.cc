@@ -0,0 +1,58 @@
+#include "PollSemaphore.hh"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+using namespace Pds;
+
+PollSemaphore::PollSemaphore(Semaphore::semState initial, unsigned id)
+{
+  unsigned int count=0;
+
+  if(initial == Semaphore::FULL) count = 1;
+
+  Server::id(id);
+  int efd = ::eventfd(count, EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC);
+  if (efd < 0)
+    printf("*** PollSemaphore eventfd error: %s\n", strerror(errno));
+  fd(efd);
+}
+
+PollSemaphore::~PollSemaphore()
+{
+  if (fd() >= 0)
+    ::close(fd());
+}
+
+void PollSemaphore::give()
+{
+  uint64_t one = 1;
+  if (::write(fd(), &one, sizeof(one)) != sizeof(one))
+    printf("*** PollSemaphore write error: %s\n", strerror(errno));
+}
+
+bool PollSemaphore::tryTake()
+{
+  uint64_t v;
+  return ::read(fd(), &v, sizeof(v)) == sizeof(v);
+}
+
+void PollSemaphore::take()
+{
+  pollfd pfd;
+  pfd.fd     = fd();
+  pfd.events = POLLIN;
+  //  Another thread may take the count between poll and read
+  while(!tryTake())
+    ::poll(&pfd, 1, -1);
+}
+
+int PollSemaphore::pend(int flag)
+{
+  return tryTake() ? 1 : 0;
+}
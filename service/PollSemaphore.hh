@@ -0,0 +1,28 @@
+#ifndef PDS_POLLSEMAPHORE_HH
+#define PDS_POLLSEMAPHORE_HH
+
+//
+//  A counting semaphore on an eventfd, which can be managed as a Server
+//  alongside sockets (SelectManager, ServerManager::poll) instead of
+//  bridging a Semaphore to a select loop with a helper thread and pipe.
+//  The fd is readable while the count is non-zero; pend() takes one.
+//
+
+#include "Semaphore.hh"
+#include "Server.hh"
+
+namespace Pds {
+class PollSemaphore : public Server {
+ public:
+  PollSemaphore(Semaphore::semState initial, unsigned id=0);
+  ~PollSemaphore();
+  void give();
+  void take();
+  // Returns false without waiting if the count is zero
+  bool tryTake();
+
+  // Implements Server; returns 1 if a count was taken, else 0
+  int  pend(int flag = 0);
+};
+}
+#endif
@@ -0,0 +1,74 @@
+#include "PollTimer.hh"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+using namespace Pds;
+
+PollTimer::PollTimer(unsigned id) : _armed(false)
+{
+  Server::id(id);
+  int tfd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (tfd < 0)
+    printf("*** PollTimer timerfd_create error: %s\n", strerror(errno));
+  fd(tfd);
+}
+
+PollTimer::~PollTimer()
+{
+  if (fd() >= 0)
+    ::close(fd());
+}
+
+unsigned PollTimer::start()
+{
+  if (_armed)
+    return 1;
+
+  enum {MilliSeconds = 1000, Nsperms = 1000000};
+  unsigned delay = duration();
+  itimerspec its;
+  its.it_value.tv_sec  =  delay / MilliSeconds;
+  its.it_value.tv_nsec = (delay % MilliSeconds) * Nsperms;
+  //  A zero value would disarm the timerfd
+  if (delay == 0) its.it_value.tv_nsec = 1;
+  if (repetitive())
+    its.it_interval = its.it_value;
+  else
+    memset(&its.it_interval, 0, sizeof(its.it_interval));
+
+  if (::timerfd_settime(fd(), 0, &its, 0) < 0) {
+    printf("*** PollTimer timerfd_settime error: %s\n", strerror(errno));
+    return 1;
+  }
+  _armed = true;
+  return 0;
+}
+
+unsigned PollTimer::cancel()
+{
+  if (!_armed)
+    return 1;
+
+  itimerspec its;
+  memset(&its, 0, sizeof(its));
+  ::timerfd_settime(fd(), 0, &its, 0);
+  _armed = false;
+  return 0;
+}
+
+int PollTimer::pend(int flag)
+{
+  uint64_t expirations;
+  if (::read(fd(), &expirations, sizeof(expirations)) != sizeof(expirations))
+    return 0;
+  // Disarm before expired so that user can call start from expired
+  if (!repetitive())
+    _armed = false;
+  expired();
+  return int(expirations);
+}
@@ -0,0 +1,44 @@
+#ifndef PDS_POLLTIMER_HH
+#define PDS_POLLTIMER_HH
+
+//
+//  A timer on a timerfd, which can be managed as a Server alongside
+//  sockets (SelectManager, ServerManager::poll).  Unlike Timer it has no
+//  task: the fd becomes readable when the timer expires, and pend(),
+//  called by the select loop, calls expired().  start(), cancel() and
+//  pend() are called from the thread that polls the fd, so no call to
+//  expired() follows cancel().
+//
+
+#include "Server.hh"
+
+namespace Pds {
+class PollTimer : public Server {
+public:
+  PollTimer(unsigned id=0);
+  virtual ~PollTimer();
+
+  // Start timer; returns 1 if it was already started
+  unsigned start();
+
+  // Stop timer; returns 1 if it was not started
+  unsigned cancel();
+
+  // User's code executed in the polling thread
+  virtual void     expired()          = 0;
+
+  // Value in milliseconds of the duration of the timer
+  virtual unsigned duration()   const = 0;
+
+  // Return 0 if one-shot, != 0 if repetitive
+  virtual unsigned repetitive() const = 0;
+
+  // Implements Server; returns the number of expirations since the last
+  // call, for which expired() was called once
+  int pend(int flag = 0);
+
+private:
+  bool _armed;
+};
+}
+#endif
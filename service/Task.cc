@@ -2,6 +2,7 @@
 #include "Semaphore.hh"
 
 #include "Task.hh"
+#include "TaskPolicy.hh"
 
 using namespace Pds;
 
@@ -135,6 +136,8 @@ void* Pds::TaskMainLoop(void* task)
   Task* t = (Task*) task;
   Routine *aJob;
 
+  TaskPolicy::apply(*t->_taskObj);
+
   for(;;) {
     while( (aJob=t->_jobs->remove()) != t->_jobs->empty() ) {
       aJob->routine();
@@ -0,0 +1,383 @@
+#include "pds/service/TaskPolicy.hh"
+#include "pds/service/TaskObject.hh"
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+using namespace Pds;
+
+namespace Pds {
+  class TaskPolicyRule {
+  public:
+    enum { PatternSize = 64, ListSize = 64 };
+    char      pattern[PatternSize];
+    char      cpulist[ListSize];
+    cpu_set_t cpus;
+    bool      hasCpus;
+    int       policy;    // -1 to inherit
+    int       priority;  // -1 for the TaskObject priority
+    bool      hasNice;
+    int       nice;
+  };
+};
+
+static const unsigned MaxRules = 64;
+
+static pthread_once_t  _once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+static TaskPolicyRule  _rules[MaxRules];
+static unsigned        _nrules = 0;
+
+class TaskThread {
+public:
+  char name[TaskPolicy::NameSize];
+  int  tid;    // 0 for a free slot
+  int  rule;
+};
+static TaskThread _threads[TaskPolicy::MaxThreads];
+
+static int _gettid() { return syscall(SYS_gettid); }
+
+static const struct { const char* name; int policy; } _policies[] = {
+  { "other", SCHED_OTHER },
+  { "batch", SCHED_BATCH },
+  { "idle" , SCHED_IDLE  },
+  { "fifo" , SCHED_FIFO  },
+  { "rr"   , SCHED_RR    } };
+static const unsigned _npolicies = sizeof(_policies)/sizeof(_policies[0]);
+
+static const char* _policyName(int policy)
+{
+  for(unsigned i=0; i<_npolicies; i++)
+    if (_policies[i].policy == policy)
+      return _policies[i].name;
+  return "?";
+}
+
+static bool _realtime(int policy) { return policy==SCHED_FIFO || policy==SCHED_RR; }
+
+//
+//  Parses a cpu list "0-3,6" into "set"; returns 0 on success
+//
+static int _parseCpus(const char* s, cpu_set_t& set)
+{
+  CPU_ZERO(&set);
+  const char* p = s;
+  while(*p) {
+    char* e;
+    unsigned lo = strtoul(p, &e, 10);
+    if (e==p) return -1;
+    unsigned hi = lo;
+    p = e;
+    if (*p=='-') {
+      hi = strtoul(++p, &e, 10);
+      if (e==p || hi < lo) return -1;
+      p = e;
+    }
+    if (hi >= CPU_SETSIZE) return -1;
+    for(unsigned i=lo; i<=hi; i++)
+      CPU_SET(i, &set);
+    if (*p==',') p++;
+    else if (*p) return -1;
+  }
+  return CPU_COUNT(&set) ? 0 : -1;
+}
+
+//
+//  Parses one rule into "r"; returns 1 for a rule, 0 for an empty line
+//  and -1 on error
+//
+static int _parseRule(char* line, TaskPolicyRule& r)
+{
+  char* c = strchr(line, '#');
+  if (c) *c = 0;
+
+  char* save;
+  char* tok = strtok_r(line, " \t\r\n", &save);
+  if (!tok)
+    return 0;
+
+  if (strlen(tok) >= TaskPolicyRule::PatternSize) {
+    printf("*** TaskPolicy: pattern \"%s\" too long\n", tok);
+    return -1;
+  }
+  strcpy(r.pattern, tok);
+  r.cpulist[0] = 0;
+  r.hasCpus    = false;
+  r.policy     = -1;
+  r.priority   = -1;
+  r.hasNice    = false;
+  r.nice       = 0;
+
+  while((tok = strtok_r(0, " \t\r\n", &save))) {
+    char* v = strchr(tok, '=');
+    if (!v) {
+      printf("*** TaskPolicy: %s: expected <key>=<value> at \"%s\"\n", r.pattern, tok);
+      return -1;
+    }
+    *v++ = 0;
+    char* e;
+    if (strcmp(tok,"cpus")==0) {
+      if (strlen(v) >= TaskPolicyRule::ListSize || _parseCpus(v, r.cpus)) {
+        printf("*** TaskPolicy: %s: bad cpu list \"%s\"\n", r.pattern, v);
+        return -1;
+      }
+      strcpy(r.cpulist, v);
+      r.hasCpus = true;
+    }
+    else if (strcmp(tok,"sched")==0) {
+      for(unsigned i=0; i<_npolicies; i++)
+        if (strcmp(v,_policies[i].name)==0)
+          r.policy = _policies[i].policy;
+      if (r.policy < 0) {
+        printf("*** TaskPolicy: %s: unknown sched \"%s\"\n", r.pattern, v);
+        return -1;
+      }
+    }
+    else if (strcmp(tok,"prio")==0) {
+      r.priority = strtol(v, &e, 0);
+      if (*e || r.priority < 1 || r.priority > 99) {
+        printf("*** TaskPolicy: %s: bad prio \"%s\"\n", r.pattern, v);
+        return -1;
+      }
+    }
+    else if (strcmp(tok,"nice")==0) {
+      r.nice = strtol(v, &e, 0);
+      if (*e || r.nice < -20 || r.nice > 19) {
+        printf("*** TaskPolicy: %s: bad nice \"%s\"\n", r.pattern, v);
+        return -1;
+      }
+      r.hasNice = true;
+    }
+    else {
+      printf("*** TaskPolicy: %s: unknown key \"%s\"\n", r.pattern, tok);
+      return -1;
+    }
+  }
+
+  if (r.priority >= 0 && !_realtime(r.policy)) {
+    printf("*** TaskPolicy: %s: prio requires sched=fifo or rr\n", r.pattern);
+    return -1;
+  }
+  if (r.hasNice && _realtime(r.policy)) {
+    printf("*** TaskPolicy: %s: nice does not apply to sched=%s\n", r.pattern, _policyName(r.policy));
+    return -1;
+  }
+  return 1;
+}
+
+//
+//  Appends the rules of "text" (separated by newlines or ';'); called
+//  with the lock held.  Returns the number parsed or -1 on error.
+//
+static int _parse(const char* text, const char* source)
+{
+  char* buff = strdup(text);
+  char* save;
+  int n = 0;
+  for(char* line = strtok_r(buff, ";\n", &save); line; line = strtok_r(0, ";\n", &save)) {
+    if (_nrules == MaxRules) {
+      printf("*** TaskPolicy: more than %u rules in %s\n", MaxRules, source);
+      n = -1;
+      break;
+    }
+    int r = _parseRule(line, _rules[_nrules]);
+    if (r < 0) {
+      printf("*** TaskPolicy: ignoring the remaining rules of %s\n", source);
+      n = -1;
+      break;
+    }
+    _nrules += r;
+    n       += r;
+  }
+  free(buff);
+  return n;
+}
+
+static void _load()
+{
+  pthread_mutex_lock(&_lock);
+
+  const char* path = getenv("PDS_TASK_POLICY_FILE");
+  if (path) {
+    FILE* f = fopen(path, "r");
+    if (!f)
+      printf("*** TaskPolicy: cannot open %s: %s\n", path, strerror(errno));
+    else {
+      char line[256];
+      while(fgets(line, sizeof(line), f))
+        if (_parse(line, path) < 0)
+          break;
+      fclose(f);
+    }
+  }
+
+  const char* env = getenv("PDS_TASK_POLICY");
+  if (env)
+    _parse(env, "PDS_TASK_POLICY");
+
+  pthread_mutex_unlock(&_lock);
+}
+
+void TaskPolicy::apply(const TaskObject& tobj)
+{
+  //  The thread that made itself a Task has no name and is not placed
+  const char* name = tobj.name();
+  if (!name)
+    return;
+
+  pthread_once(&_once, _load);
+
+  int tid = _gettid();
+
+  { char comm[16];  // the kernel's limit, with the terminator
+    strncpy(comm, name, sizeof(comm)-1);
+    comm[sizeof(comm)-1] = 0;
+    pthread_setname_np(pthread_self(), comm); }
+
+  pthread_mutex_lock(&_lock);
+
+  int irule = -1;
+  for(unsigned i=0; i<_nrules; i++)
+    if (fnmatch(_rules[i].pattern, name, 0)==0) {
+      irule = i;
+      break;
+    }
+
+  if (irule >= 0) {
+    const TaskPolicyRule& r = _rules[irule];
+    int err;
+    if (r.hasCpus &&
+        (err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &r.cpus)))
+      printf("*** TaskPolicy: %s cpus=%s: %s\n", name, r.cpulist, strerror(err));
+    if (r.policy >= 0) {
+      sched_param param;
+      param.sched_priority = 0;
+      if (_realtime(r.policy)) {
+        int lo = sched_get_priority_min(r.policy);
+        int hi = sched_get_priority_max(r.policy);
+        param.sched_priority = r.priority >= 0 ? r.priority : tobj.priority();
+        if (param.sched_priority < lo) param.sched_priority = lo;
+        if (param.sched_priority > hi) param.sched_priority = hi;
+      }
+      if ((err = pthread_setschedparam(pthread_self(), r.policy, &param)))
+        printf("*** TaskPolicy: %s sched=%s prio=%d: %s\n",
+               name, _policyName(r.policy), param.sched_priority, strerror(err));
+    }
+    //  On Linux the nice value belongs to the thread
+    if (r.hasNice && setpriority(PRIO_PROCESS, tid, r.nice))
+      printf("*** TaskPolicy: %s nice=%d: %s\n", name, r.nice, strerror(errno));
+  }
+
+  unsigned i=0;
+  while(i < MaxThreads && _threads[i].tid)
+    i++;
+  if (i < MaxThreads) {
+    TaskThread& t = _threads[i];
+    strncpy(t.name, name, NameSize-1);
+    t.name[NameSize-1] = 0;
+    t.tid  = tid;
+    t.rule = irule;
+  }
+
+  pthread_mutex_unlock(&_lock);
+}
+
+void TaskPolicy::release()
+{
+  int tid = _gettid();
+  pthread_mutex_lock(&_lock);
+  for(unsigned i=0; i<MaxThreads; i++)
+    if (_threads[i].tid == tid)
+      _threads[i].tid = 0;
+  pthread_mutex_unlock(&_lock);
+}
+
+//
+//  Reads the placement of a registered thread by its id, as any thread
+//  may ask; returns false if the thread no longer exists
+//
+static bool _placement(const TaskThread& t, TaskPolicy::Placement& p)
+{
+  //  The kernel's cpu clock of thread "tid" (MAKE_THREAD_CPUCLOCK(tid, CPUCLOCK_SCHED))
+  clockid_t clock = clockid_t((~unsigned(t.tid) << 3) | 6);
+  timespec ts;
+  if (clock_gettime(clock, &ts))
+    return false;
+
+  strcpy(p.name, t.name);
+  p.tid     = t.tid;
+  p.rule    = t.rule;
+  p.cpuTime = uint64_t(ts.tv_sec)*1000000000ULL + ts.tv_nsec;
+
+  cpu_set_t set;
+  p.cpus = 0;
+  if (sched_getaffinity(t.tid, sizeof(set), &set)==0)
+    for(unsigned i=0; i<64; i++)
+      if (CPU_ISSET(i, &set))
+        p.cpus |= 1ULL<<i;
+
+  p.policy = sched_getscheduler(t.tid);
+  if (_realtime(p.policy)) {
+    sched_param param;
+    sched_getparam(t.tid, &param);
+    p.priority = param.sched_priority;
+  }
+  else
+    p.priority = getpriority(PRIO_PROCESS, t.tid);
+  return true;
+}
+
+unsigned TaskPolicy::snapshot(Placement* p, unsigned n)
+{
+  unsigned m = 0;
+  pthread_mutex_lock(&_lock);
+  for(unsigned i=0; i<MaxThreads && m<n; i++)
+    if (_threads[i].tid) {
+      if (_placement(_threads[i], p[m]))
+        m++;
+      else
+        _threads[i].tid = 0;  // exited without release()
+    }
+  pthread_mutex_unlock(&_lock);
+  return m;
+}
+
+void TaskPolicy::dump()
+{
+  Placement* p = new Placement[MaxThreads];
+  unsigned n = snapshot(p, MaxThreads);
+  printf("%-24s %7s %5s %5s %18s %12s %s\n",
+         "task", "tid", "sched", "prio", "cpus", "cpu [ms]", "rule");
+  for(unsigned i=0; i<n; i++) {
+    pthread_mutex_lock(&_lock);
+    const char* rule = p[i].rule >= 0 ? _rules[p[i].rule].pattern : "-";
+    printf("%-24s %7d %5s %5d 0x%016llx %12.1f %s\n",
+           p[i].name, p[i].tid, _policyName(p[i].policy), p[i].priority,
+           (unsigned long long)p[i].cpus, double(p[i].cpuTime)*1.e-6, rule);
+    pthread_mutex_unlock(&_lock);
+  }
+  delete[] p;
+}
+
+int TaskPolicy::rules(const char* text)
+{
+  pthread_once(&_once, _load);
+  pthread_mutex_lock(&_lock);
+  //  Threads keep the index of the rule they matched; it is stale after this
+  for(unsigned i=0; i<MaxThreads; i++)
+    _threads[i].rule = -1;
+  _nrules = 0;
+  int n = _parse(text, "TaskPolicy::rules");
+  pthread_mutex_unlock(&_lock);
+  return n;
+}
@@ -0,0 +1,60 @@
+#ifndef Pds_TaskPolicy_hh
+#define Pds_TaskPolicy_hh
+
+//
+//  Placement of Task threads.  Each new Task thread applies the first
+//  rule whose pattern matches its name, before it runs any routine.
+//  Rules are read once per process from the file named by
+//  $PDS_TASK_POLICY_FILE and from $PDS_TASK_POLICY (rules separated by
+//  ';'), the file first.  One rule per line:
+//
+//    <pattern> [cpus=<list>] [sched=other|batch|idle|fifo|rr] [prio=<n>] [nice=<n>]
+//
+//  <pattern> is a shell wildcard (fnmatch) on the task name, <list> is
+//  a cpu list as in /sys ("2-3,6").  fifo and rr take prio (1-99); without
+//  it the TaskObject priority is used.  other and batch take nice.  '#'
+//  starts a comment.  For example:
+//
+//    oEbEvt*      cpus=2     sched=fifo prio=60
+//    TxScheduler  cpus=3     sched=fifo prio=50
+//    FrameComp*   cpus=4-7
+//
+//  Settings that cannot be applied (no privilege, offline cpus) are
+//  reported and the thread keeps running with what it inherited.  Every
+//  Task thread is registered, whether or not a rule matched, so that its
+//  placement and cpu time can be monitored (see VmonTasks).
+//
+
+#include <stdint.h>
+
+namespace Pds {
+
+  class TaskObject;
+
+  class TaskPolicy {
+  public:
+    enum { MaxThreads = 256, NameSize = 32 };
+    class Placement {
+    public:
+      char     name[NameSize];
+      int      tid;
+      int      policy;     // SCHED_*
+      int      priority;   // sched_priority, or nice for other/batch
+      uint64_t cpus;       // affinity of the first 64 cpus
+      uint64_t cpuTime;    // ns
+      int      rule;       // index of the matching rule, or -1
+    };
+  public:
+    //  Called by the thread itself when it starts and when it exits
+    static void     apply   (const TaskObject&);
+    static void     release ();
+  public:
+    //  Copies the placement and cpu time of up to n registered threads
+    static unsigned snapshot(Placement*, unsigned n);
+    static void     dump    ();
+    //  Replaces the rules; returns the number parsed or -1 on error
+    static int      rules   (const char*);
+  };
+};
+
+#endif
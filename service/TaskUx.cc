@@ -5,6 +5,7 @@
  */
 
 #include "Task.hh"
+#include "TaskPolicy.hh"
 #include <signal.h>
 #include <sched.h>
 
@@ -52,6 +53,8 @@ void Task::deleteTask()
 
   delete this;
 
+  TaskPolicy::release();
+
   int status;
   pthread_exit((void*)&status);
 }
@@ -53,7 +53,12 @@ private:
   enum{_lockRetries=3};
 };
 #else
-class TimerServiceRoutine : private Routine {
+//
+//  The expiry of a timer is a timerfd watched, with those of all the
+//  other timers of the process, by a single service thread which
+//  submits the timer to its task.
+//
+class TimerServiceRoutine {
 public:
   TimerServiceRoutine(Timer* timer);
   virtual ~TimerServiceRoutine();
@@ -63,24 +68,20 @@ public:
 
   void submit();
 
+  // Executed in the service thread
+  void expire();
+
 private:
   Timer* _timer;
 
-  // Service task pointer
-  Task*        _service_task;  // Blocked by pthread_cond_timedwait
+  int      _fd;    // timerfd
+  unsigned _slot;  // in the service thread's table
 
-  // Needed by the pthread mechanism we use for the Unix timer
   enum Status {Off, On};
   Status          _status;
   pthread_mutex_t _status_mutex;
-  pthread_cond_t  _status_cond;
 
-  // Calculate end time of pthread_cond_timedwait
   struct timespec _delay;
-  inline timespec wakeup(); 
-
-  // Implements Routine for the service task
-  virtual void routine();
 };
 #endif
 
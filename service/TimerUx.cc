@@ -1,21 +1,22 @@
-//  This timer has a minimum duration of 20 ms with a resolution of 10
-//  ms (any fraction of 10 ms is rounded up).  It was noticed during
-//  testing that multiple timers within the same process interacted in
-//  some way.  A timer with duration which is an odd multiple of 10 ms
-//  was seen to act as a timer with duration 10 ms greater than
-//  specified, when running with a second timer whose duration was an
-//  even multiple of 10.  Multiple timers whose duration was an even
-//  multiple of 10 did not interact.  When there were multiple timers
-//  with durations that were odd multiples of 10 the behaviour was
-//  unpredictable, although they seemed to have a duration which
-//  fluctuated between the specified and 10 + the specified.  This was
-//  traced to a feature of cond_timed_wait.
+//  Each timer is a timerfd.  A single service thread, shared by all the
+//  timers of the process, waits on them with epoll and submits an expired
+//  timer to its task.  Durations are exact to the millisecond; the former
+//  implementation, a thread per timer in pthread_cond_timedwait, rounded
+//  them to 10 ms.
 
 
 #include <errno.h>
-#include <sys/time.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <vector>
 
 #include "Timer.hh"
+#include "Task.hh"
+#include "TaskObject.hh"
 #include "TaskWait.hh"
 
 using namespace Pds;
@@ -60,47 +61,120 @@ void Timer::routine() {
   }
 }
 
+namespace Pds {
+  //
+  //  The timers are found by slot, not by address, so that an event
+  //  returned by epoll_wait for a timer destroyed meanwhile is ignored
+  //
+  class TimerService : public Routine {
+  public:
+    TimerService() : _epfd(epoll_create1(EPOLL_CLOEXEC)) {
+      pthread_mutex_init(&_lock, 0);
+      if (_epfd < 0)
+        printf("*** TimerService epoll_create error: %s\n", strerror(errno));
+      (new Task(TaskObject("TimerService")))->call(this);
+    }
+  public:
+    unsigned add(TimerServiceRoutine* t, int fd) {
+      pthread_mutex_lock(&_lock);
+      unsigned slot = 0;
+      while(slot < _timers.size() && _timers[slot].timer)
+        slot++;
+      if (slot == _timers.size())
+        _timers.push_back(Slot());
+      _timers[slot].timer = t;
+      _timers[slot].generation++;
+      epoll_event ev;
+      ev.events   = EPOLLIN;
+      ev.data.u64 = (uint64_t(_timers[slot].generation)<<32) | slot;
+      if (epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        printf("*** TimerService epoll_ctl error: %s\n", strerror(errno));
+      pthread_mutex_unlock(&_lock);
+      return slot;
+    }
+    void remove(unsigned slot, int fd) {
+      pthread_mutex_lock(&_lock);
+      epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, 0);
+      _timers[slot].timer = 0;
+      pthread_mutex_unlock(&_lock);
+    }
+    void routine() {
+      enum { MaxEvents = 16 };
+      epoll_event ev[MaxEvents];
+      while(1) {
+        int n = epoll_wait(_epfd, ev, MaxEvents, -1);
+        if (n < 0) {
+          if (errno != EINTR) {
+            printf("*** TimerService epoll_wait error: %s\n", strerror(errno));
+            return;
+          }
+          continue;
+        }
+        pthread_mutex_lock(&_lock);
+        for(int i=0; i<n; i++) {
+          unsigned slot       = ev[i].data.u64 & 0xffffffff;
+          unsigned generation = ev[i].data.u64 >> 32;
+          if (_timers[slot].timer && _timers[slot].generation == generation)
+            _timers[slot].timer->expire();
+        }
+        pthread_mutex_unlock(&_lock);
+      }
+    }
+  private:
+    class Slot {
+    public:
+      Slot() : timer(0), generation(0) {}
+      TimerServiceRoutine* timer;
+      unsigned             generation;
+    };
+    int                 _epfd;
+    pthread_mutex_t     _lock;
+    std::vector<Slot>   _timers;
+  };
+};
+
+static TimerService*  _timerService = 0;
+static pthread_once_t _timerServiceOnce = PTHREAD_ONCE_INIT;
+
+static void _startTimerService() { _timerService = new TimerService; }
+
+// Executed in the work task (main task)
 TimerServiceRoutine::TimerServiceRoutine(Timer* timer) 
-  : _timer(timer)  
-  , _service_task(0)
+  : _timer (timer)  
+  , _fd    (timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
   , _status(Off)
 {
   pthread_mutex_init(&_status_mutex, 0);
-  pthread_cond_init(&_status_cond, 0);
+  if (_fd < 0) {
+    printf("*** Timer timerfd_create error: %s\n", strerror(errno));
+    return;
+  }
+  pthread_once(&_timerServiceOnce, _startTimerService);
+  _slot = _timerService->add(this, _fd);
 }
 
 // Executed in the work task (main task)
 TimerServiceRoutine::~TimerServiceRoutine()
 {
-  pthread_cond_destroy(&_status_cond);
+  if (_fd >= 0) {
+    _timerService->remove(_slot, _fd);
+    ::close(_fd);
+  }
   pthread_mutex_destroy(&_status_mutex);
-  if (_service_task) _service_task->destroy();
 }
 
 // Executed in the work task (main task)
 unsigned TimerServiceRoutine::armTimer() {
-  if (!_service_task) {
-    char taskname[128];
-    if (_timer->task()->parameters().name()) {
-      sprintf(taskname, "%sTimer", _timer->task()->parameters().name());
-    } else {
-      sprintf(taskname, "%lu_Timer", (long unsigned int) _timer->task()->parameters().taskID());
-    }
-    int taskpriority = _timer->task()->parameters().priority();
-    _service_task = new Task(TaskObject(taskname, taskpriority));
-  }
   pthread_mutex_lock(&_status_mutex);
   if (_status == Off) {
     _status = On;
-    pthread_mutex_unlock(&_status_mutex);
-    // cond_timedwait rounds up to the nearest 10 ms and adds 10 ms, so
-    // we remove 10 ms from the duration to get behaviour closer to what
-    // the user expects
     enum {MilliSeconds = 1000, Nsperms = 1000000};
     unsigned delay = _timer->duration();
-    if (delay > 10) delay -= 10;
     _delay.tv_sec  =  delay / MilliSeconds;
     _delay.tv_nsec = (delay - (_delay.tv_sec * MilliSeconds)) * Nsperms;
+    //  A zero value would disarm the timerfd
+    if (delay == 0) _delay.tv_nsec = 1;
+    pthread_mutex_unlock(&_status_mutex);
     submit();
     return 0;
   }
@@ -108,66 +182,44 @@ unsigned TimerServiceRoutine::armTimer() {
   return 1;
 }
 
-// Executed in the work task (main task) or in the timer task
+// Executed in the work task (main task) or in the timer task.  The
+// service thread submits the timer only while it is On, so no
+// submission follows the return.
 unsigned TimerServiceRoutine::disarmTimer() {
   pthread_mutex_lock(&_status_mutex);
   if (_status == On) {
     _status = Off;
+    itimerspec its;
+    memset(&its, 0, sizeof(its));
+    timerfd_settime(_fd, 0, &its, 0);
     pthread_mutex_unlock(&_status_mutex);
-    TaskWait block(_service_task);
-    // Wake up service thread waiting on _status_cond 
-    pthread_cond_signal(&_status_cond);  
-    block.wait();
     return 0;
   }
   pthread_mutex_unlock(&_status_mutex);
   return 1;
 }
 
-// Executed in the timer task
+// Executed in the work task or in the timer task; starts one period.
+// Repetitive timers are rearmed after expired() so that a timer never
+// waits twice in its task's queue.
 void  TimerServiceRoutine::submit() {
   pthread_mutex_lock(&_status_mutex);
   if (_status == On) {
-    _service_task->call(this);
+    itimerspec its;
+    memset(&its.it_interval, 0, sizeof(its.it_interval));
+    its.it_value = _delay;
+    if (timerfd_settime(_fd, 0, &its, 0) < 0)
+      printf("*** Timer timerfd_settime error: %s\n", strerror(errno));
   }
   pthread_mutex_unlock(&_status_mutex);
 }
 
-// Executed in the service task
-void TimerServiceRoutine::routine() {
-  timespec wakeuptime = wakeup();
-  int error;
+// Executed in the service thread
+void TimerServiceRoutine::expire() {
+  uint64_t expirations;
   pthread_mutex_lock(&_status_mutex);
-  while (_status == On) {
-    error = pthread_cond_timedwait(&_status_cond, &_status_mutex, &wakeuptime);
-    if (error == ETIMEDOUT) {
-      pthread_mutex_unlock(&_status_mutex);
-      _timer->task()->call(_timer);
-      return;
-    }
-  }
-  pthread_mutex_unlock(&_status_mutex);  
-}
-
-// Calculation of absolute time for timer expiration
-timespec TimerServiceRoutine::wakeup() {
-  timespec wakeuptime, now;
-
-  clock_gettime(CLOCK_REALTIME, &now);
-
-  wakeuptime.tv_sec  = now.tv_sec  + _delay.tv_sec;
-  wakeuptime.tv_nsec = now.tv_nsec + _delay.tv_nsec; 
-
-  static const long int NanoSeconds  = 1000000000;
-
-  if (wakeuptime.tv_nsec < 0) {
-    wakeuptime.tv_sec--;
-    wakeuptime.tv_nsec += NanoSeconds;
-  } else {
-    if (wakeuptime.tv_nsec >= NanoSeconds) {
-      wakeuptime.tv_sec++;
-      wakeuptime.tv_nsec -= NanoSeconds;
-    }
-  }
-  return wakeuptime;
+  if (::read(_fd, &expirations, sizeof(expirations)) == sizeof(expirations) &&
+      _status == On)
+    _timer->task()->call(_timer);
+  pthread_mutex_unlock(&_status_mutex);
 }
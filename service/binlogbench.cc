@@ -0,0 +1,98 @@
+//
+//  binlogbench - cost of PDS_LOG in the calling thread, compared with
+//  printf to /dev/null.
+//
+//    binlogbench [-n <calls>] [-p <threads>]
+//
+#include "pds/service/BinaryLog.hh"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+
+using namespace Pds;
+
+static unsigned ncalls = 1000000;
+
+static double now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return double(ts.tv_sec)+1.e-9*double(ts.tv_nsec);
+}
+
+static void* _log(void* arg)
+{
+  double* dt = reinterpret_cast<double*>(arg);
+  double t0 = now();
+  for(unsigned i=0; i<ncalls; i++)
+    PDS_LOG("*** binlogbench: call %u of %u at %p value %f\n",
+            i, ncalls, arg, double(i)*0.5);
+  *dt = now()-t0;
+  return 0;
+}
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [-n <calls>] [-p <threads>]\n"
+         "Options:\n"
+         "\t-n <calls>     calls per thread [1000000]\n"
+         "\t-p <threads>   logging threads [1]\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned nthreads = 1;
+
+  int c;
+  while ((c = getopt(argc, argv, "n:p:h")) != -1) {
+    switch(c) {
+    case 'n': ncalls   = strtoul(optarg,NULL,0); break;
+    case 'p': nthreads = strtoul(optarg,NULL,0); break;
+    case 'h':
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  FILE* null = fopen("/dev/null","w");
+  if (!null) {
+    perror("*** binlogbench: /dev/null");
+    return 1;
+  }
+
+  double t0 = now();
+  for(unsigned i=0; i<ncalls; i++)
+    fprintf(null, "*** binlogbench: call %u of %u at %p value %f\n",
+            i, ncalls, (void*)&ncalls, double(i)*0.5);
+  double tprintf = now()-t0;
+  fclose(null);
+
+  //  Both the rate limited and the recorded paths
+  BinaryLog::print(false);
+  static const unsigned limits[] = { 32, 0xffffffff };
+  for(unsigned l=0; l<sizeof(limits)/sizeof(limits[0]); l++) {
+    BinaryLog::limit(limits[l]);
+    pthread_t* threads = new pthread_t[nthreads];
+    double*    dt      = new double   [nthreads];
+    for(unsigned i=0; i<nthreads; i++)
+      pthread_create(&threads[i], 0, _log, &dt[i]);
+    double tlog = 0;
+    for(unsigned i=0; i<nthreads; i++) {
+      pthread_join(threads[i], 0);
+      tlog += dt[i];
+    }
+    BinaryLog::flush();
+    printf("limit %10u : PDS_LOG %.1f ns/call\n", limits[l],
+           tlog/double(nthreads)/double(ncalls)*1.e9);
+    delete[] threads;
+    delete[] dt;
+  }
+  printf("fprintf(/dev/null)  %.1f ns/call\n", tprintf/double(ncalls)*1.e9);
+  printf("%llu records dropped\n", (unsigned long long)BinaryLog::dropped());
+  BinaryLog::dump(4);
+  return 0;
+}
@@ -1,6 +1,12 @@
 libnames := service
 
-ignore_src := BitMaskArray.cc RingPool.cc RingPoolW.cc KStream.cc TStream.cc
+ignore_src := BitMaskArray.cc RingPool.cc RingPoolW.cc KStream.cc TStream.cc binlogbench.cc
 
 libsrcs_service := $(filter-out $(ignore_src),$(wildcard *.cc))
-libincs_service := pdsdata/include ndarray/include
\ No newline at end of file
+libincs_service := pdsdata/include ndarray/include
+
+tgtnames := binlogbench
+
+tgtsrcs_binlogbench := binlogbench.cc
+tgtlibs_binlogbench := pds/service
+tgtslib_binlogbench := $(USRLIBDIR)/rt $(USRLIBDIR)/pthread
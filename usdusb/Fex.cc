@@ -3,7 +3,6 @@
 #include "pds/xtc/InDatagram.hh"
 #include "pds/config/CfgClientNfs.hh"
 #include "pds/config/UsdUsbDataType.hh"
-#include "pds/config/UsdUsbFexDataType.hh"
 
 #include "pdsdata/xtc/DetInfo.hh"
 
@@ -16,9 +15,11 @@ using namespace Pds::UsdUsb;
 Fex::Fex(CfgClientNfs& cfg) :
   _cfg(cfg),
   _usdusb_config(new UsdUsbFexConfigType),
+  _buffer(new char[_kernel.maxSize()]),
   _in(0) {}
 
 Fex::~Fex() {
+  delete[] _buffer;
   delete _usdusb_config;
 }
 
@@ -32,32 +33,21 @@ int Fex::process(Xtc* xtc) {
   if (xtc->contains.id()==TypeId::Id_Xtc)
     iterate(xtc);
   else if(xtc->contains.value() == _usdusbDataType.value()) {
-
-    Xtc tc = Xtc(_usdusbFexDataType, xtc->src);
-    tc.extent += sizeof(UsdUsbFexDataType);
-
-    const UsdUsbDataType* data = reinterpret_cast<const UsdUsbDataType*>(xtc->payload());
-    const ndarray<const int32_t, 1> encoder_count = data->encoder_count();
-
-    const ndarray<const int32_t, 1> offset = _usdusb_config->offset();
-    const ndarray<const double, 1> scale   = _usdusb_config->scale();
-
-    double fex_values[FexConfigV1::NCHANNELS];
-
-    for(int i=0; i<FexConfigV1::NCHANNELS; i++) {
-      fex_values[i] = scale[i] * (encoder_count[i] + offset[i]);
+    if (_kernel.process(*xtc, _buffer)) {
+      const Xtc& tc = *reinterpret_cast<const Xtc*>(_buffer);
+      _in->insert(tc, tc.payload());
     }
-    
-    UsdUsbFexDataType usdusb_fex(fex_values);
-    _in->insert(tc, &usdusb_fex);
-
     return 0;
   }
   return 1;
 }
 
 bool Fex::configure(Transition& tr) {
-  return _cfg.fetch(tr, _usdusbFexConfigType, _usdusb_config, sizeof(UsdUsbFexConfigType)) > 0;
+  bool result = _cfg.fetch(tr, _usdusbFexConfigType, _usdusb_config, sizeof(UsdUsbFexConfigType)) > 0;
+  _kernel.clear();
+  if (result)
+    _kernel.configure(_cfg.src(), *_usdusb_config);
+  return result;
 }
 
 void Fex::recordConfigure(InDatagram* dg) {
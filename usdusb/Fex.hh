@@ -2,6 +2,8 @@
 #define Pds_UsdUsb_Fex_hh
 
 #include "pds/config/UsdUsbFexConfigType.hh"
+#include "pds/usdusb/FexKernel.hh"
+#include "pds/client/ChannelFex.hh"
 #include "pdsdata/xtc/XtcIterator.hh"
 
 namespace Pds {
@@ -24,6 +26,8 @@ namespace Pds {
     private:
       CfgClientNfs&          _cfg;
       UsdUsbFexConfigType*   _usdusb_config;
+      ChannelFex<FexKernel>  _kernel;
+      char*                  _buffer;
       InDatagram*            _in;
     };
   };
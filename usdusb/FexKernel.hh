@@ -0,0 +1,49 @@
+#ifndef Pds_UsdUsb_FexKernel_hh
+#define Pds_UsdUsb_FexKernel_hh
+
+//
+//  ChannelFex kernel for the USDUSB4 encoder counts: the calibration of
+//  each channel is recorded in UsdUsb::FexConfigV1 and the values as
+//  UsdUsb::FexDataV1.
+//
+
+#include "pds/config/UsdUsbDataType.hh"
+#include "pds/config/UsdUsbFexConfigType.hh"
+#include "pds/config/UsdUsbFexDataType.hh"
+
+#include <new>
+
+namespace Pds {
+  namespace UsdUsb {
+    class FexKernel {
+    public:
+      enum { NChannels = UsdUsbFexConfigType::NCHANNELS };
+      typedef UsdUsbDataType      Data;
+      typedef UsdUsbFexConfigType Config;
+      typedef UsdUsbFexDataType   Result;
+    public:
+      static TypeId   dataType   () { return _usdusbDataType; }
+      static TypeId   configType () { return _usdusbFexConfigType; }
+      static TypeId   resultType () { return _usdusbFexDataType; }
+      static bool     calibration(const Config& c, double* scale, double* offset) {
+        for(unsigned i=0; i<NChannels; i++) {
+          scale [i] = c.scale ()[i];
+          offset[i] = c.offset()[i];
+        }
+        return true;
+      }
+      static unsigned raw        (const Config&, const Data& d, double* v) {
+        const ndarray<const int32_t,1> count = d.encoder_count();
+        for(unsigned i=0; i<NChannels; i++)
+          v[i] = count[i];
+        return NChannels;
+      }
+      static unsigned result     (const double* v, unsigned, Result& r) {
+        new (&r) Result(v);
+        return sizeof(Result);
+      }
+    };
+  };
+};
+
+#endif
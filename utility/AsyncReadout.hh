@@ -0,0 +1,41 @@
+#ifndef Pds_AsyncReadout_hh
+#define Pds_AsyncReadout_hh
+
+//
+//  Typed ring for an AsyncReadoutServer.  A driver supplies the element
+//  that holds one raw device readout and two methods:
+//
+//    read  (Element&)                     reader thread; blocks on the device
+//    decode(Element&, payload, Damage&)   server thread; writes the payload
+//
+//  The element is decoded straight into the datagram, so there is no
+//  staging copy between the ring and the event builder.
+//
+
+#include "pds/utility/AsyncReadoutServer.hh"
+
+#include <vector>
+
+namespace Pds {
+
+  template <class Element>
+  class AsyncReadout : public AsyncReadoutServer {
+  public:
+    AsyncReadout(const Src& client, const TypeId& type, unsigned depth, const char* name) :
+      AsyncReadoutServer(client, type, depth, name),
+      _ring(depth+1) {}   // and a spare for overflows
+    virtual ~AsyncReadout() {}
+  protected:
+    //  Returns >0 for an event, 0 on a timeout, <0 on an error
+    virtual int read  (Element&) = 0;
+    //  Returns the payload size in bytes, or <0 to drop the contribution
+    virtual int decode(Element&, char* payload, Damage&) = 0;
+  private:
+    int _read  (unsigned slot) { return read(_ring[slot]); }
+    int _decode(unsigned slot, char* payload, Damage& damage) { return decode(_ring[slot], payload, damage); }
+  private:
+    std::vector<Element> _ring;
+  };
+}
+
+#endif
@@ -0,0 +1,203 @@
+#include "pds/utility/AsyncReadoutServer.hh"
+
+#include "pds/service/Task.hh"
+#include "pds/service/TaskObject.hh"
+#include "pds/mon/MonGroup.hh"
+#include "pds/mon/MonDescTH1F.hh"
+#include "pds/mon/MonEntryTH1F.hh"
+#include "pds/mon/MonDescScalar.hh"
+#include "pds/mon/MonEntryScalar.hh"
+#include "pds/vmon/VmonServerManager.hh"
+#include "pdsdata/xtc/ClockTime.hh"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+using namespace Pds;
+
+static const timespec _idle = {0, 100000000};  // 0.1 sec
+
+AsyncReadoutServer::AsyncReadoutServer(const Src&    client,
+                                       const TypeId& type,
+                                       unsigned      depth,
+                                       const char*   name) :
+  _xtc           (type, client),
+  _depth         (depth),
+  _head          (0),
+  _tail          (0),
+  _stamps        (new timespec[depth+1]),
+  _enabled       (false),
+  _shutdown      (false),
+  _overflows     (0),
+  _overflows_seen(0),
+  _count         (0),
+  _task          (new Task(TaskObject(name)))
+{
+  MonGroup* group = new MonGroup(name);
+  VmonServerManager::instance()->cds().add(group);
+
+  MonDescTH1F vdepth("Depth", "buffers", "", depth+1, -0.5, double(depth)+0.5);
+  _vdepth = new MonEntryTH1F(vdepth);
+  group->add(_vdepth);
+
+  MonDescTH1F vlatency("Latency", "[ms]", "", 64, 0., 32.);
+  _vlatency = new MonEntryTH1F(vlatency);
+  group->add(_vlatency);
+
+  MonDescScalar voverflows("Overflows");
+  _voverflows = new MonEntryScalar(voverflows);
+  group->add(_voverflows);
+
+  int efd = ::eventfd(0, EFD_NONBLOCK | EFD_SEMAPHORE);
+  if (efd < 0)
+    printf("*** AsyncReadoutServer %s eventfd error: %s\n", name, strerror(errno));
+  else {
+    fd(efd);
+    _task->call(this);
+  }
+}
+
+//
+//  The reader must have been shut down
+//
+AsyncReadoutServer::~AsyncReadoutServer()
+{
+  ::close(fd());
+  delete[] _stamps;
+}
+
+void AsyncReadoutServer::dump(int detail) const
+{
+  printf("AsyncReadoutServer %08x.%08x : %u events, %u buffered, %u overflows\n",
+         _xtc.src.log(), _xtc.src.phy(), _count, _head-_tail, _overflows);
+}
+
+unsigned AsyncReadoutServer::count() const
+{
+  return _count-1;
+}
+
+void AsyncReadoutServer::start()
+{
+  _discard();
+  _overflows_seen = _overflows;
+  _xtc.damage     = Damage(0);
+  _count          = 0;
+  _enabled        = true;
+}
+
+void AsyncReadoutServer::stop()
+{
+  _enabled = false;
+  _discard();
+}
+
+void AsyncReadoutServer::shutdown()
+{
+  _enabled  = false;
+  _shutdown = true;
+}
+
+//
+//  Each signal on the eventfd is one published slot
+//
+void AsyncReadoutServer::_discard()
+{
+  uint64_t v;
+  while(::read(fd(), &v, sizeof(v)) == sizeof(v))
+    _tail = _tail+1;
+}
+
+void AsyncReadoutServer::routine()
+{
+  while(!_shutdown) {
+    if (!_enabled || !_ready()) {
+      nanosleep(&_idle, NULL);
+      continue;
+    }
+
+    unsigned head = _head;
+    bool     full = (head - _tail) == _depth;
+    unsigned slot = full ? _depth : head % _depth;
+
+    int result = _read(slot);
+    if (result == 0)
+      continue;
+    if (result < 0) {
+      printf("*** AsyncReadoutServer %08x.%08x read error; stopped until the next configure\n",
+             _xtc.src.log(), _xtc.src.phy());
+      _enabled = false;
+      continue;
+    }
+
+    if (full) {
+      _overflows = _overflows+1;
+      continue;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &_stamps[slot]);
+    __sync_synchronize();  // publish the slot before the index
+    _head = head+1;
+
+    uint64_t one = 1;
+    if (::write(fd(), &one, sizeof(one)) != sizeof(one))
+      printf("*** AsyncReadoutServer eventfd write error: %s\n", strerror(errno));
+  }
+  printf("AsyncReadoutServer %08x.%08x reader shutdown\n",
+         _xtc.src.log(), _xtc.src.phy());
+}
+
+int AsyncReadoutServer::fetch(char* payload, int flags)
+{
+  uint64_t v;
+  if (::read(fd(), &v, sizeof(v)) != sizeof(v))
+    return -1;
+
+  unsigned tail = _tail;
+  unsigned slot = tail % _depth;
+  __sync_synchronize();  // read the slot after the index
+
+  if (_overflows != _overflows_seen) {
+    _voverflows->setvalue(_overflows);
+    if (!(_xtc.damage.value() & (1<<Damage::OutOfSynch)))
+      printf("*** AsyncReadoutServer %08x.%08x buffer overflow; data marked out of synch\n",
+             _xtc.src.log(), _xtc.src.phy());
+    _xtc.damage.increase(Damage::OutOfSynch);
+    _overflows_seen = _overflows;
+  }
+
+  Xtc* xtc = new (payload) Xtc(_xtc.contains, _xtc.src, _xtc.damage);
+  int size = _decode(slot, xtc->payload(), xtc->damage);
+
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double ms = double(now.tv_sec-_stamps[slot].tv_sec)*1.e3 +
+    double(now.tv_nsec-_stamps[slot].tv_nsec)*1.e-6;
+
+  __sync_synchronize();  // release the slot after it is read
+  _tail = tail+1;
+
+  if (size < 0)
+    return -1;
+
+  xtc->extent = sizeof(Xtc) + ((size+3)&~3);
+  _xtc.extent = xtc->extent;
+  ++_count;
+
+  unsigned b = unsigned(ms*2.);
+  if (b < _vlatency->desc().nbins())
+    _vlatency->addcontent(1.,b);
+  else
+    _vlatency->addinfo(1.,MonEntryTH1F::Overflow);
+  _vdepth->addcontent(1.,_head-tail);
+
+  ClockTime clock(now.tv_sec,now.tv_nsec);
+  _vlatency  ->time(clock);
+  _vdepth    ->time(clock);
+  _voverflows->time(clock);
+
+  return xtc->extent;
+}
@@ -0,0 +1,101 @@
+#ifndef Pds_AsyncReadoutServer_hh
+#define Pds_AsyncReadoutServer_hh
+
+//
+//  Segment level server for devices read by a private thread.
+//
+//  The reader thread fills a preallocated ring of "depth" slots and
+//  signals each filled slot on an eventfd, which is the server's fd in
+//  the ServerManager.  The ring has one producer (the reader) and one
+//  consumer (fetch), so the indices need no lock.  fetch() decodes a
+//  slot directly into the contribution's payload.
+//
+//  When the ring is full the reader still drains the device into a spare
+//  slot, so that the hardware does not overflow.  That event is dropped,
+//  and later contributions are marked OutOfSynch until the next start().
+//
+//  The ring depth, readout latency and overflows are published in a Vmon
+//  group named for the server.
+//
+//  Drivers derive from AsyncReadout<Element> (see AsyncReadout.hh).
+//
+
+#include "pds/utility/EbServer.hh"
+#include "pds/utility/EbCountSrv.hh"
+#include "pds/utility/EbEventKey.hh"
+#include "pds/service/Routine.hh"
+#include "pdsdata/xtc/Xtc.hh"
+
+#include <time.h>
+
+namespace Pds {
+
+  class Task;
+  class MonEntryTH1F;
+  class MonEntryScalar;
+
+  class AsyncReadoutServer : public EbServer,
+                             public EbCountSrv,
+                             public Routine {
+  public:
+    AsyncReadoutServer(const Src& client, const TypeId& type, unsigned depth, const char* name);
+    virtual ~AsyncReadoutServer();
+  public:
+    //  Eb interface
+    void       dump    (int detail) const;
+    bool       isValued() const { return true; }
+    const Src& client  () const { return _xtc.src; }
+    //  EbSegment interface
+    const Xtc& xtc     () const { return _xtc; }
+    unsigned   offset  () const { return sizeof(Xtc); }
+    unsigned   length  () const { return _xtc.extent; }
+    //  Eb-key interface
+    EbServerDeclare;
+    //  Server interface
+    int        pend    (int flag = 0) { return -1; }
+    int        fetch   (char* payload, int flags);
+    //  EbCountSrv interface
+    unsigned   count   () const;
+    //  Routine interface
+    void       routine ();
+  public:
+    //  Discards buffered events and starts reading
+    void       start   ();
+    //  Stops reading and discards buffered events
+    void       stop    ();
+    //  The reader thread exits at its next timeout
+    void       shutdown();
+    Task*      task    () { return _task; }
+    unsigned   depth   () const { return _depth; }
+    unsigned   buffered() const { return _head-_tail; }
+    unsigned   overflows() const { return _overflows; }
+  protected:
+    //  Reader thread: true when the device can be read
+    virtual bool _ready () { return true; }
+    //  Reader thread: fills a slot.  Returns >0 for an event, 0 on a
+    //  timeout, <0 on an error that stops the reader until start().
+    virtual int  _read  (unsigned slot) = 0;
+    //  Server thread: writes the payload from a slot and returns its size
+    //  in bytes, or <0 to drop the contribution.
+    virtual int  _decode(unsigned slot, char* payload, Damage&) = 0;
+  private:
+    void         _discard();
+  private:
+    Xtc               _xtc;
+    unsigned          _depth;
+    volatile unsigned _head;         // written by the reader
+    volatile unsigned _tail;         // written by fetch
+    timespec*         _stamps;
+    volatile bool     _enabled;
+    volatile bool     _shutdown;
+    volatile unsigned _overflows;
+    unsigned          _overflows_seen;
+    unsigned          _count;
+    Task*             _task;
+    MonEntryTH1F*     _vdepth;
+    MonEntryTH1F*     _vlatency;
+    MonEntryScalar*   _voverflows;
+  };
+}
+
+#endif
@@ -10,6 +10,9 @@ namespace Pds {
   public:
     virtual ~BldSequenceSrv() {}
     virtual unsigned fiducials() const = 0;
+    //  The contribution's full sequence, or 0 if the server has only the
+    //  fiducials (e.g. from its hardware)
+    virtual const Sequence* sequence() const { return 0; }
   };
 
 }
@@ -35,6 +35,7 @@ namespace Pds {
   public:
     NetServer&      server();
     unsigned        fiducials() const;
+    const Sequence* sequence () const;
   private:
     NetServer   _server;
     Src         _client;
@@ -52,4 +53,9 @@ inline unsigned Pds::BldServer::fiducials() const
   return reinterpret_cast<const Pds::Datagram*>(_server.datagram())->seq.stamp().fiducials();
 }
 
+inline const Pds::Sequence* Pds::BldServer::sequence() const
+{
+  return &reinterpret_cast<const Pds::Datagram*>(_server.datagram())->seq;
+}
+
 #endif
@@ -4,14 +4,15 @@
 #include "pds/utility/EbServer.hh"
 #include "pds/xtc/CDatagram.hh"
 #include "pds/service/SysClk.hh"
+#include "pds/service/BinaryLog.hh"
 #include "pds/service/Client.hh"
 #include "pds/utility/Inlet.hh"
 #include "pds/vmon/VmonEb.hh"
 #include "pds/utility/Occurrence.hh"
+#include "pds/utility/EventLoad.hh"
 
 using namespace Pds;
 
-extern unsigned nEbPrints;
 
 /*
 ** ++
@@ -47,7 +48,8 @@ Eb::Eb(const Src& id,
   EbBase(id, ctns, level, inlet, outlet, stream, ipaddress,
    slowEb, vmoneb, dstack ),
   _datagrams(eventsize, eventpooldepth),
-  _events(sizeof(EbEvent), eventpooldepth)
+  _events(sizeof(EbEvent), eventpooldepth),
+  _load  (0)
 {
 }
 
@@ -122,6 +124,7 @@ int Eb::processIo(Server* serverGeneric)
   if(event == event->forward()) {   // case (1)
     _pending.insert(event);
     server->assign(event->key());
+    _arm(event);
   }
   else if(!server->coincides(event->key())) {
     // case (2):  Remove the contribution from this event.  Now that we have the contribution's
@@ -142,14 +145,12 @@ int Eb::processIo(Server* serverGeneric)
     if (event == 0) {
       event = (EbEvent*)_new_event(serverId, payload, sizeofPayload); // copies payload into new event
       if (!event) {
-        if (nEbPrints) {
-          printf("Eb::processIo unable to reclaim buffer\n");
-          nEbPrints--;
-        }
+        PDS_LOG("Eb::processIo unable to reclaim buffer");
         return 1;
       }
       server->assign(event->key());
       _insert(event);
+      _arm(event);
     }
     else {
       event->recopy(payload, sizeofPayload, serverId);
@@ -201,6 +202,16 @@ int Eb::processIo(Server* serverGeneric)
 
 Eb::~Eb()
 {
+  if (_load) delete _load;
+}
+
+void Eb::report_load(EventLoadReporter* load)
+{
+  if (_load) delete _load;
+  _load = load;
+  //  Wake at least every heartbeat; the timer only expires events whose
+  //  deadline has passed, so a shorter select timeout is harmless
+  if (_load) dotimeout(EventLoadReporter::Heartbeat);
 }
 
 void Eb::_dump(int detail)
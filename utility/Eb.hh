@@ -13,6 +13,7 @@ namespace Pds {
 class OutletWire;
 class EbServer;
 class Client;
+class EventLoadReporter;
 
 class Eb : public EbBase
   {
@@ -32,6 +33,8 @@ class Eb : public EbBase
     virtual ~Eb();
   public:
     int  processIo(Server*);
+    //  Publish the event buffer occupancy (takes ownership)
+    void report_load(EventLoadReporter*);
   private:
     unsigned     _fixup      ( EbEventBase*, const Src&, const EbBitMask& );
     void         _insert     ( EbEventBase* );
@@ -39,6 +42,7 @@ class Eb : public EbBase
   protected:
     GenericPoolW _datagrams;    // Datagram freelist
     GenericPool  _events;
+    EventLoadReporter* _load;
   };
 }
 #endif
@@ -25,6 +25,7 @@
 #include "pds/vmon/VmonEb.hh"
 
 #include "pds/service/SysClk.hh"
+#include "pds/service/BinaryLog.hh"
 #include "pds/service/Client.hh"
 
 #include <string.h>
@@ -58,6 +59,8 @@ static timespec prev_ts;
 //#endif
 
 static const int TaskPriority = 60;
+static const unsigned WheelTick  = 10;    // ms
+static const unsigned WheelSlots = 1024;
 static const char* TaskLevelName[Level::NumberOfLevels+1] = {
   "oEbCtr", "oEbSrc", "oEbSeg", "oEbEvt", "oEbRec", "oEbObs"
 };
@@ -68,9 +71,13 @@ static const char* TaskName(Level::Type level, int stream, Inlet& inlet)
   return name;
 }
 
-int nEbPrints=32;
 static bool lEbPrintSink=true;
 
+static inline unsigned long long _maskValue(const EbBitMask& m)
+{
+  return (static_cast<unsigned long long>(m.value(1))<<32) | m.value(0);
+}
+
 EbBase::EbBase(const Src& id,
          const TypeId& ctns,
          Level::Type level,
@@ -86,6 +93,7 @@ EbBase::EbBase(const Src& id,
       TaskPriority-stream, TaskName(level, stream, inlet),
       EbTimeouts::duration(stream)),
   _ebtimeouts(stream,level, slowEb),
+  _wheel     (WheelTick, WheelSlots),
   _output(inlet),
   _id(id),
   _ctns(ctns),
@@ -94,13 +102,15 @@ EbBase::EbBase(const Src& id,
   _misses(0),
   _discards(0),
   _ack(0),
+  _credit(0,0),
+  _credit_count(0),
   _vmoneb(vmoneb),
   _level           (level),
   _require_in_order(true)
 {
   if (dstack) {
     const unsigned PayloadSize = 0;
-    _ack = new Client(sizeof(Datagram), PayloadSize,
+    _ack = new Client(sizeof(EbCredit), PayloadSize,
        *dstack, Ins(ipaddress));
   }
   printf("EbBase timeouts %d/%d\n",
@@ -143,6 +153,16 @@ Server* EbBase::accept(Server* srv)
   if (accepted->isRequired())
     _required_clients.setBit(id);
 
+  if (id >= _server_tmos.size())
+    _server_tmos.resize(id+1);
+  _server_tmos[id] = 0;
+  _slow_clients.clearBit(id);
+  for(unsigned i=0; i<_client_tmos.size(); i++)
+    if (_client_tmos[i].first == accepted->client()) {
+      _server_tmos[id] = _client_tmos[i].second;
+      _slow_clients.setBit(id);
+    }
+
   manage(accepted);
   ServerManager::arm(accepted);
   _clients = managed();
@@ -181,6 +201,7 @@ void EbBase::remove(unsigned id)
     _valued_clients.clearBit(id);
   if (srv->isRequired())
     _required_clients.clearBit(id);
+  _slow_clients.clearBit(id);
   _remove(srv);
   _clients = managed();
 }
@@ -226,6 +247,22 @@ EbBitMask EbBase::_armMask()
   return participants;
 }
 
+//
+//  The phy of the lowest server in the mask, so that a log record names
+//  a missing contributor and not only its server id
+//
+unsigned EbBase::_firstPhy(const EbBitMask& mask)
+{
+  if (mask.isZero()) return 0;
+  EbBitMask id(EbBitMask::ONE);
+  for(unsigned i=0; i<mask.BitMaskBits; i++, id <<= 1)
+    if ( !(mask & id).isZero() ) {
+      EbServer* srv = (EbServer*)server(i);
+      return srv ? srv->client().phy() : 0;
+    }
+  return 0;
+}
+
 #define PAUSE     (1 << Sequence::Service20)
 #define DISABLE   (1 << Sequence::Service28)
 
@@ -250,28 +287,11 @@ void EbBase::_post(EbEventBase* event)
 #endif
   if (value.isZero() || required!=_required_clients) {  // sink
 
-    if (nEbPrints && lEbPrintSink) {
-      const int buffsize=256;
-      char buff[buffsize];
-      EbBitMask r = remaining;
-      sprintf(buff,"EbBase::_post sink seq %08x remaining ",
-              datagram->seq.stamp().fiducials());
-      r.write(&buff[strlen(buff)]);
-      EbBitMask id(EbBitMask::ONE);
-      for(unsigned i=0; !r.isZero(); i++, id <<= 1) {
-        if ( !(r & id).isZero() ) {
-          EbServer* srv = (EbServer*)server(i);
-          if (srv)
-            snprintf(buff+strlen(buff),buffsize-strlen(buff)," [%x/%x]",
-                     srv->client().log(),srv->client().phy());
-          else
-            snprintf(buff+strlen(buff),buffsize-strlen(buff)," [?/?]");
-          r &= ~id;
-        }
-      }
-      printf("%s\n",buff);
-      --nEbPrints;
-    }
+    //  One record per event; the bits of the mask are the server ids
+    if (lEbPrintSink)
+      PDS_LOG("EbBase::_post sink seq %08x remaining 0x%llx first phy %08x",
+              datagram->seq.stamp().fiducials(), _maskValue(remaining),
+              _firstPhy(remaining));
 
     // statistics
     if (_vmoneb) {
@@ -285,6 +305,8 @@ void EbBase::_post(EbEventBase* event)
       _vmoneb->fixup(-1);
     }
 
+    _acknowledge(*datagram);
+
     delete indatagram;
     delete event;
     return;
@@ -297,29 +319,10 @@ void EbBase::_post(EbEventBase* event)
 
   if(remaining.isNotZero()) {
 
-    if (nEbPrints) {
-      const int buffsize=256;
-      char buff[buffsize];
-      EbBitMask r = remaining;
-      sprintf(buff,"EbBase::_post fixup key %08x seq %08x remaining ",
-              event->key().value(),
-              datagram->seq.stamp().fiducials());
-      r.write(&buff[strlen(buff)]);
-      EbBitMask id(EbBitMask::ONE);
-      for(unsigned i=0; !r.isZero(); i++, id <<= 1) {
-        if ( !(r & id).isZero() ) {
-          EbServer* srv = (EbServer*)server(i);
-          if (srv)
-            snprintf(buff+strlen(buff),buffsize-strlen(buff)," [%x/%x]",
-                srv->client().log(),srv->client().phy());
-          else
-            snprintf(buff+strlen(buff),buffsize-strlen(buff)," [?/?]");
-          r &= ~id;
-        }
-      }
-      printf("%s\n",buff);
-      --nEbPrints;
-    }
+    PDS_LOG("EbBase::_post fixup key %08x seq %08x remaining 0x%llx first phy %08x",
+            event->key().value(),
+            datagram->seq.stamp().fiducials(), _maskValue(remaining),
+            _firstPhy(remaining));
 
     // statistics
     EbBitMask id(EbBitMask::ONE);
@@ -346,6 +349,9 @@ void EbBase::_post(EbEventBase* event)
 
   if (_vmoneb) {
     ClockTime clock(indatagram->datagram().seq.clock());
+    if (event->deadline > event->created)
+      _vmoneb->complete_time(float(EbTimerWheel::now() - event->created)/
+                             float(event->deadline - event->created));
     _vmoneb->post_size(indatagram->datagram().xtc.extent);
     _vmoneb->damage_count(indatagram->datagram().xtc.damage.value());
     unsigned sample = SysClk::sample();
@@ -357,18 +363,46 @@ void EbBase::_post(EbEventBase* event)
     _output.post(indatagram);
   }
 
-  // Send acks on L1Accept, Pause and Disable; the latter two to flush the last
-  // L1Accept.  Since an ack wasn't requested for Pause or Disable, it will be
-  // ignored by the fragment level (ignored counter will increment).
-  Client* ack = _ack;
-  //  if (ack && (!datagram->notEvent() ||
-  //              ((1 << datagram->service()) & (PAUSE | DISABLE))))
-  if (ack && (datagram->seq.isEvent()))
-    ack->send((char*)datagram, (char*) 0, 0);
+  _acknowledge(*datagram);
 
   delete event;
 }
 
+//
+//  Grant credits on the ack channel.  L1Accepts are acknowledged in batches
+//  of a quarter window so that a source waiting on credits is released
+//  before its window drains; transitions are acknowledged immediately.
+//
+void EbBase::_acknowledge(const Datagram& datagram)
+{
+  Client* ack = _ack;
+  if (!ack)
+    return;
+
+  if (datagram.seq.isEvent()) {
+    _credit.posted(datagram.seq.stamp().fiducials());
+    if (++_credit_count < (_credit.window()>>2))
+      return;
+  }
+
+  _credit_count = 0;
+  _credit.granted();
+  ack->send((char*)&_credit, (char*) 0, 0);
+}
+
+void EbBase::credits(const Ins& dst, unsigned node, unsigned window, int interface)
+{
+  const unsigned PayloadSize = 0;
+  Client* ack = _ack;
+  _ack = 0;
+  if (ack) delete ack;
+
+  _credit       = EbCredit(node, window);
+  _credit_count = 0;
+  _ack = new Client(sizeof(EbCredit), PayloadSize, dst, Ins(interface));
+  printf("EbBase granting %u credits to %x/%d\n", window, dst.address(), dst.portId());
+}
+
 #include "pds/utility/EbEvent.hh"
 
 EbBitMask EbBase::_postEvent(EbEventBase* complete)
@@ -431,41 +465,93 @@ EbBitMask EbBase::_postEvent(EbEventBase* complete)
 
 int EbBase::processTmo()
 {
-  EbEventBase* event = _pending.forward();
-  EbEventBase* empty = _pending.empty();
-  if (event != empty) {
-
-    timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    double dts = (ts.tv_sec - prev_ts.tv_sec) + 1.e-9*(ts.tv_nsec - prev_ts.tv_nsec);
-    prev_ts = ts;
-
-    if (event->timeouts(_ebtimeouts) > 0) {
-      //  mw- Recalculate enable mask - could be done faster (not redone)
-      ServerManager::arm(_armMask());
-    } else {
-      //#ifdef VERBOSE
-
-      InDatagram* indatagram   = event->finalize();
-      const Datagram* datagram = &indatagram->datagram();
-      EbBitMask value(event->allocated().remaining() & _valued_clients);
-      if (!value.isZero())
-  printf("EbBase::processTmo seq %x/%x  remaining %08x : %g [%d,%d]\n",
-         datagram->seq.service(), datagram->seq.stamp().fiducials(),
-         event->remaining().value(), dts,
-         _ebtimeouts.duration(), _ebtimeouts.timeouts(0));
-      //#endif
-      _postEvent(event);
-      ServerManager::arm(_armMask());
-
-    }
-
+  if (_pending.forward() != _pending.empty()) {
+    _expire();
+    //  mw- Recalculate enable mask - could be done faster (not redone)
+    ServerManager::arm(_armMask());
   } else {
     ServerManager::arm(managed());
   }
   return 1;
   }
 
+/*
+** ++
+**
+**   Each event is put on the timer wheel when its first contribution
+**   arrives, with the builder's timeout for its sequence.  When that
+**   deadline passes while a client with a longer timeout of its own (a
+**   slow camera, say) is still outstanding, the deadline is extended to
+**   that client's; otherwise the event is completed with whatever has
+**   arrived.  Only the events whose deadline has passed are visited.
+**
+**   The deadlines are wall-clock: an incomplete event times out after
+**   duration x timeouts ms even while other events keep arriving, where
+**   formerly the oldest event aged only on the idle ticks, and under
+**   steady traffic waited until the buffer pool forced it out.  The slowEb
+**   timeouts (120 x 500 ms) are several revolutions of the wheel (10 ms x
+**   1024 slots); such deadlines share a slot with nearer ones and are
+**   skipped until their round comes up (see ebwheeltest).
+**
+** --
+*/
+
+void EbBase::client_timeout(const Src& client, unsigned ms)
+{
+  for(unsigned i=0; i<_client_tmos.size(); i++)
+    if (_client_tmos[i].first == client) {
+      _client_tmos[i].second = ms;
+      return;
+    }
+  _client_tmos.push_back(std::pair<Src,unsigned>(client,ms));
+}
+
+unsigned EbBase::_timeout(EbEventBase* event) const
+{
+  unsigned tmo = _ebtimeouts.duration()*_ebtimeouts.timeouts(&event->datagram()->seq);
+  EbBitMask r = event->remaining() & _slow_clients;
+  EbBitMask id(EbBitMask::ONE);
+  for(unsigned i=0; !r.isZero(); i++, id <<= 1) {
+    if ( !(r & id).isZero() ) {
+      if (_server_tmos[i] > tmo)
+        tmo = _server_tmos[i];
+      r &= ~id;
+    }
+  }
+  return tmo;
+}
+
+void EbBase::_arm(EbEventBase* event)
+{
+  event->created = EbTimerWheel::now();
+  _wheel.arm(*event, event->created +
+             _ebtimeouts.duration()*_ebtimeouts.timeouts(&event->datagram()->seq));
+}
+
+void EbBase::_expire()
+{
+  uint64_t now = EbTimerWheel::now();
+  EbTimerWheel::Entry* e;
+  while((e = _wheel.pop(now))) {
+    EbEventBase* event = static_cast<EbEventBase*>(e);
+    uint64_t deadline = event->created + _timeout(event);
+    if (deadline > now) {
+      _wheel.arm(*event, deadline);
+      continue;
+    }
+
+    InDatagram* indatagram   = event->finalize();
+    const Datagram* datagram = &indatagram->datagram();
+    EbBitMask value(event->allocated().remaining() & _valued_clients);
+    if (!value.isZero())
+      printf("EbBase::processTmo seq %x/%x  remaining %08x : %u [ms]\n",
+             datagram->seq.service(), datagram->seq.stamp().fiducials(),
+             event->remaining().value(), unsigned(now - event->created));
+    //  Posting also completes (and disarms) the older events
+    _postEvent(event);
+  }
+}
+
 /*
 ** ++
 **
@@ -485,6 +571,7 @@ int EbBase::poll()
 
   //  if(active().isZero()) ServerManager::arm(managed());
 
+  _expire();
   ServerManager::arm(_armMask());
 
   return 1;
@@ -687,7 +774,7 @@ EbBase::IsComplete EbBase::_is_complete( EbEventBase* event,
   return remaining.isZero() ? Complete : Incomplete;
 }
 
-void EbBase::printFixups(int n) { nEbPrints=n; }
+void EbBase::printFixups(int n) { BinaryLog::limit(n); }
 void EbBase::printSinks (bool v) { lEbPrintSink=v; }
 
 static const int FLUSH_SIZE=0x1000000;
@@ -748,7 +835,6 @@ void EbBase::_flush_outputs()
     event = _pending.forward();
     n++;
   }
-  nEbPrints = 32;
 }
 
 void EbBase::contains(const TypeId& c) { _ctns=c; }
@@ -6,8 +6,12 @@
 #include "InletWireServer.hh"
 #include "EbEventBase.hh"
 #include "EbTimeouts.hh"
+#include "EbCredit.hh"
+#include "EbTimerWheel.hh"
 #include "pds/service/LinkedList.hh"
 
+#include <vector>
+
 namespace Pds {
 
   class OutletWire;
@@ -15,6 +19,8 @@ namespace Pds {
   class Client;
   class Appliance;
   class VmonEb;
+  class Datagram;
+  class Ins;
 
   class EbBase : public InletWireServer
   {
@@ -46,6 +52,10 @@ namespace Pds {
     static void printFixups(int);
     static void printSinks (bool);
     void require_in_order(bool);
+    //  Grant each source "window" outstanding events on the ack channel
+    void credits(const Ins& dst, unsigned node, unsigned window, int interface);
+    //  Events waiting on "client" are held for at least "ms" before timing out
+    void client_timeout(const Src& client, unsigned ms);
   private:
     void _dump_events() const;
     friend class serverRundown;
@@ -56,11 +66,16 @@ namespace Pds {
     virtual EbEventBase* _seek     (EbServer*);
     virtual EbEventBase* _event    (EbServer*);
     EbBitMask    _armMask  ();
+    void         _acknowledge(const Datagram&);
     void         _iterate_dump();
+    void         _arm      (EbEventBase*);  // start the event's deadline
+    void         _expire   ();              // time out the events past their deadline
   private:
     void         _remove   (EbServer*);
     void         _flush_inputs();
     void         _flush_outputs();
+    unsigned     _timeout  (EbEventBase*) const;
+    unsigned     _firstPhy (const EbBitMask&);  // of the lowest server in the mask
   protected:
     virtual unsigned     _fixup      ( EbEventBase*, const Src&, const EbBitMask& ) = 0;
     virtual EbEventBase* _new_event  ( const EbBitMask& ) = 0;
@@ -76,6 +91,10 @@ namespace Pds {
     EbBitMask   _valued_clients;   // Database of clients valued
     EbBitMask   _required_clients; // Database of clients required
     EbTimeouts  _ebtimeouts;
+    EbTimerWheel _wheel;
+    std::vector<std::pair<Src,unsigned> > _client_tmos; // by client
+    std::vector<unsigned> _server_tmos;  // by server id
+    EbBitMask   _slow_clients; // servers with their own timeout
     Appliance&  _output;       // Destination for datagrams
     Src         _id;           // Our OWN ID
     TypeId      _ctns;         // Our OWN ID
@@ -84,6 +103,8 @@ namespace Pds {
     unsigned    _misses;       // # of cache misses
     unsigned    _discards;     // # of discards due to aged datagram
     Client*     _ack;          // connected port to send ack on.
+    EbCredit    _credit;       // credit grant sent on the ack port
+    unsigned    _credit_count; // events posted since the last grant
     VmonEb*     _vmoneb;
     Level::Type _level;
     bool        _require_in_order;
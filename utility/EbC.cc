@@ -4,10 +4,10 @@
 #include "EbCountKey.hh"
 #include "EbEvent.hh"
 #include "pds/vmon/VmonEb.hh"
+#include "pds/service/BinaryLog.hh"
 
 using namespace Pds;
 
-extern unsigned int nEbPrints;
 
 EbC::EbC(const Src& id,
    const TypeId& ctns,
@@ -39,9 +39,8 @@ EbEventBase* EbC::_new_event(const EbBitMask& serverId, char* payload, unsigned
   if (_vmoneb) _vmoneb->depth(depth);
 
   if (depth<=1 && _pending.forward()!=_pending.empty()) {
-    if (nEbPrints)
-      printf("EbC::new_event claiming buffer for srv %08x payload %d\n",
-             serverId.value(), sizeofPayload);
+    PDS_LOG("EbC::new_event claiming buffer for srv %08x payload %d",
+            serverId.value(), sizeofPayload);
 
     _post(_pending.forward());
   //    arm(_post(_pending.forward()));
@@ -67,9 +66,8 @@ EbEventBase* EbC::_new_event(const EbBitMask& serverId)
   if (_vmoneb) _vmoneb->depth(depth);
 
   if (depth<=1 && _pending.forward()!=_pending.empty()) {
-    if (nEbPrints)
-      printf("EbC::new_event claiming buffer for srv %08x\n",
-             serverId.value());
+    PDS_LOG("EbC::new_event claiming buffer for srv %08x",
+            serverId.value());
 
     _post(_pending.forward());
   //    arm(_post(_pending.forward()));
@@ -99,6 +97,7 @@ EbEventBase* EbC::_new_event(const EbBitMask& serverId)
 int EbC::poll()
 {
   if(!ServerManager::poll()) return 0;
+  _expire();
   if(active().isZero()) ServerManager::arm(managed());
   return 1;
 }
@@ -0,0 +1,47 @@
+#ifndef Pds_EbCredit_hh
+#define Pds_EbCredit_hh
+
+//
+//  Credit grant sent on the event builder's ack channel.
+//
+//  An event node allows each source "window" outstanding events.  A grant
+//  carries the fiducial of the last L1Accept the node has posted: every
+//  event a source sent to that node with an earlier fiducial has been
+//  built (or timed out) and no longer holds a buffer.
+//
+
+#include "pdsdata/xtc/TimeStamp.hh"
+
+#include <stdint.h>
+
+namespace Pds {
+
+  class EbCredit {
+  public:
+    EbCredit() {}
+    EbCredit(unsigned node, unsigned window) :
+      _node(node), _window(window), _fiducials(0), _sequence(0) {}
+  public:
+    unsigned node     () const { return _node; }
+    unsigned window   () const { return _window; }
+    unsigned fiducials() const { return _fiducials; }
+    unsigned sequence () const { return _sequence; }
+  public:
+    void     posted   (unsigned fiducials) { _fiducials = fiducials; }
+    void     granted  () { _sequence++; }
+  public:
+    //  Has the event with "fiducials" been posted by the node?
+    bool     completed(unsigned fiducials) const
+    {
+      unsigned d = (_fiducials + TimeStamp::MaxFiducials - fiducials) % TimeStamp::MaxFiducials;
+      return d < TimeStamp::MaxFiducials/2;
+    }
+  private:
+    uint32_t _node;
+    uint32_t _window;
+    uint32_t _fiducials;
+    uint32_t _sequence;
+  };
+};
+
+#endif
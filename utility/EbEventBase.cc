@@ -1,8 +1,5 @@
 #include "EbEventBase.hh"
 #include "EbServer.hh"
-#include "EbTimeouts.hh"
-
-static const int MaxTimeouts=0xffff;
 
 //#define VERBOSE
 
@@ -38,7 +35,6 @@ EbEventBase::EbEventBase(EbBitMask creator,
   _contributions    (contract),
   _contract         (contract),
   _segments         (),
-  _timeouts         (MaxTimeouts),
   _datagram         (datagram),
   _bClientGroupSet  (false),
   _post             (false)
@@ -66,7 +62,6 @@ EbEventBase::EbEventBase() :
   _contributions    (),
   _contract         (),
   _segments         (),
-  _timeouts         (MaxTimeouts),
   _datagram         (0),
   _bClientGroupSet  (false),
   _post             (false)
@@ -81,15 +76,6 @@ EbEventBase::EbEventBase() :
 ** --
 */
 
-int EbEventBase::timeouts(const EbTimeouts& ebtmo) {
-  if (_timeouts == MaxTimeouts) {
-    int tmo = ebtmo.timeouts(_datagram ? &_datagram->seq : 0);
-    _timeouts = tmo < MaxTimeouts ? tmo : MaxTimeouts;
-  }
-  return --_timeouts;
-}
-
-
 void EbEventBase::setClientGroup(EbBitMask maskClientGroup)
 {
   remaining(~maskClientGroup);
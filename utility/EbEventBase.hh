@@ -6,15 +6,16 @@
 #include "EbEventKey.hh"
 #include "EbClients.hh"
 #include "EbSegment.hh"
+#include "EbTimerWheel.hh"
 #include "pds/service/LinkedList.hh"
 
 namespace Pds {
 
 class EbServer;
-class EbTimeouts;
 class InDatagram;
 
-class EbEventBase : public LinkedList<EbEventBase>
+class EbEventBase : public LinkedList<EbEventBase>,
+                    public EbTimerWheel::Entry
   {
   public:
     EbEventBase();
@@ -25,7 +26,6 @@ class EbEventBase : public LinkedList<EbEventBase>
     EbBitMask        remaining () const;
     EbBitMask        remaining (EbBitMask id);
     EbBitMask        deallocate(EbBitMask id);
-    int              timeouts  (const EbTimeouts& ebtimeouts);
     const EbBitMask& segments  () const;
     EbBitMask&       segments  ();
     EbClients&       allocated ();
@@ -42,7 +42,6 @@ class EbEventBase : public LinkedList<EbEventBase>
     EbClients     _contributions; // List of clients yet to contribute
     EbBitMask     _contract;      // -> potential list of contributors
     EbBitMask     _segments;      // Clients for which a segment already exists
-    int           _timeouts;      // How many counts before event timeouts
     Datagram*     _datagram;
   public:
     void          setClientGroup(EbBitMask maskClientGroup);
@@ -3,10 +3,10 @@
 #include "EbEvent.hh"
 #include "EbClockKey.hh"
 #include "pds/vmon/VmonEb.hh"
+#include "pds/service/BinaryLog.hh"
 
 using namespace Pds;
 
-extern unsigned nEbPrints;
 
 EbK::EbK(const Src& id,
    const TypeId& ctns,
@@ -52,9 +52,8 @@ EbEventBase* EbK::_new_event(const EbBitMask& serverId, char* payload, unsigned
   if (_vmoneb) _vmoneb->depth(depth);
 
   if (depth<=1 && _pending.forward()!=_pending.empty()) {
-    if (nEbPrints)
-      printf("EbK::new_event claiming buffer for srv %08x payload %d\n",
-             serverId.value(),sizeofPayload);
+    PDS_LOG("EbK::new_event claiming buffer for srv %08x payload %d",
+            serverId.value(),sizeofPayload);
 
     _post(_pending.forward());
   //    arm(_post(_pending.forward()));
@@ -72,9 +71,8 @@ EbEventBase* EbK::_new_event(const EbBitMask& serverId)
   if (_vmoneb) _vmoneb->depth(depth);
 
   if (depth==1 && _pending.forward()!=_pending.empty()) { // keep one buffer for recopy possibility
-    if (nEbPrints)
-      printf("EbK::new_event claiming buffer for srv %08x\n",
-             serverId.value());
+    PDS_LOG("EbK::new_event claiming buffer for srv %08x",
+            serverId.value());
 
     _post(_pending.forward());
   //    arm(_post(_pending.forward()));
@@ -3,10 +3,11 @@
 #include "EbEvent.hh"
 #include "EbSequenceKey.hh"
 #include "pds/vmon/VmonEb.hh"
+#include "pds/service/BinaryLog.hh"
+#include "pds/utility/EventLoad.hh"
 
 using namespace Pds;
 
-extern unsigned nEbPrints;
 
 EbS::EbS(const Src& id,
    const TypeId& ctns,
@@ -50,13 +51,11 @@ EbEventBase* EbS::_new_event(const EbBitMask& serverId, char* payload, unsigned
   unsigned depth = _datagrams.depth();
 
   if (_vmoneb) _vmoneb->depth(depth);
+  if (_load)   _load  ->update(depth);
 
   if (depth<=1 && _pending.forward()!=_pending.empty()) {
-    if (nEbPrints) {
-      printf("EbS::new_event claiming buffer for srv %08x payload %d\n",
-             serverId.value(),sizeofPayload);
-      nEbPrints--;
-    }
+    PDS_LOG("EbS::new_event claiming buffer for srv %08x payload %d",
+            serverId.value(),sizeofPayload);
 
     _post(_pending.forward());
   //    arm(_post(_pending.forward()));
@@ -72,13 +71,11 @@ EbEventBase* EbS::_new_event(const EbBitMask& serverId)
   unsigned depth = _datagrams.depth();
 
   if (_vmoneb) _vmoneb->depth(depth);
+  if (_load)   _load  ->update(depth);
 
   if (depth==1 && _pending.forward()!=_pending.empty()) { // keep one buffer for recopy possibility
-    if (nEbPrints) {
-      printf("EbS::new_event claiming buffer for srv %08x\n",
-             serverId.value());
-      nEbPrints--;
-    }
+    PDS_LOG("EbS::new_event claiming buffer for srv %08x",
+            serverId.value());
 
     _post(_pending.forward());
   //    arm(_post(_pending.forward()));
@@ -122,11 +119,17 @@ int EbS::poll()
 {
   if (_level == Level::Segment) {
     if(!ServerManager::poll()) return 0;
+    _expire();
     if(active().isZero()) ServerManager::arm(managed());
     return 1;
   }
-  else
-    return EbBase::poll();
+  else {
+    int result = EbBase::poll();
+    //  Also after the select timeouts, so that the occupancy is reported
+    //  while no events arrive
+    if (_load) _load->update(_datagrams.depth());
+    return result;
+  }
 }
 
 int EbS::processIo(Server* srv)
@@ -19,11 +19,11 @@
 */
 
 #include "EbSegment.hh"
+#include "pds/service/BinaryLog.hh"
 #include <stdio.h>
 using namespace Pds;
 
 
-extern int nEbPrints;
 
 /*
 ** ++
@@ -65,10 +65,6 @@ EbSegment::EbSegment(const Xtc& header,
 
   if(offset != 0)
     {
-//       if (nEbPrints)
-//  	printf("EbSegment::ctor offset %d/%d  %x\n",
-//  	       offset,length,_client.value());
-
       unsigned remaining = (unsigned)sizeofFragment >> 2;
       unsigned* in       = ((unsigned*) base)           + remaining;
       unsigned* out      = ((unsigned*)(base + offset)) + remaining;
@@ -106,9 +102,8 @@ void EbSegment::consume(int sizeofFragment, int expected, const Xtc& xtc)
 
   if(offset != expected)
     {
-      if (nEbPrints)
-	printf("EbSegment::consume offset/expected/recvd %d/%d/%d  %x\n",
-	       offset,expected,_header.extent-_remaining,_client.value());
+      PDS_LOG("EbSegment::consume offset/expected/recvd %d/%d/%d  %x",
+              offset,expected,_header.extent-_remaining,_client.value());
 
       char* base         = _base;
       unsigned* in       = (unsigned*)(base + sizeofFragment + offset);
@@ -131,10 +126,6 @@ void EbSegment::consume(int sizeofFragment, int expected, const Xtc& xtc)
   Xtc& bxtc = *reinterpret_cast<Xtc*>(_base);
   if (bxtc.src == xtc.src)
     bxtc.damage.increase(xtc.damage.value());
-//   else if (nEbPrints)
-//     printf("EbSegment::consume src does not match [%08x.%08x v %08x.%08x]\n",
-//            bxtc.src.log(),bxtc.src.phy(),
-//            xtc .src.log(),xtc .src.phy());
 }
 
 
@@ -146,9 +137,8 @@ bool EbSegment::deallocate(char* payload, int sizeofFragment)
   //
   if (sizeofFragment + _offset > (int)_header.extent) {
     _header.damage.increase(Damage::IncompleteContribution);
-    if (nEbPrints)
-      printf("EbSegment overwrote next %x + %x > %x\n",
-	     _offset,sizeofFragment,_header.extent);
+    PDS_LOG("EbSegment overwrote next %x + %x > %x",
+            _offset,sizeofFragment,_header.extent);
     return false;  // could not cleanly deallocate
   }
   return true;
@@ -167,8 +157,7 @@ bool EbSegment::deallocate(char* payload, int sizeofFragment)
 
 unsigned EbSegment::fixup(){
   Damage dmg(_header.damage.value());  // propagate recorded damage up
-  if (nEbPrints)
-    printf("EbSegment::fixup offset/remaining/size %d/%d/%d  %x\n",_offset,_remaining,_header.extent,_client.value());
+  PDS_LOG("EbSegment::fixup offset/remaining/size %d/%d/%d  %x",_offset,_remaining,_header.extent,_client.value());
   Xtc* xtc = new(_base) Xtc(_header.contains, _header.src, 
 			    Damage(dmg.value() | (1 << Damage::IncompleteContribution)));
   xtc->alloc(_header.sizeofPayload());
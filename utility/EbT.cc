@@ -0,0 +1,111 @@
+#include "EbT.hh"
+
+#include "EbEvent.hh"
+#include "EbTimeKey.hh"
+#include "EbServer.hh"
+#include "pds/vmon/VmonEb.hh"
+#include "pds/service/BinaryLog.hh"
+
+using namespace Pds;
+
+
+EbT::EbT(const Src& id,
+   const TypeId& ctns,
+   Level::Type level,
+   Inlet& inlet,
+   OutletWire& outlet,
+   int stream,
+   int ipaddress,
+   unsigned eventsize,
+   unsigned eventpooldepth,
+   int slowEb,
+   unsigned tolerance,
+   VmonEb* vmoneb) :
+  EbK(id, ctns, level, inlet, outlet,
+      stream, ipaddress,
+      eventsize, eventpooldepth, slowEb, vmoneb),
+  _index( tolerance, vmoneb ),
+  _tkeys( sizeof(EbTimeKey), eventpooldepth )
+{
+}
+
+EbT::~EbT()
+{
+}
+
+void EbT::window(const Src& src, int offset, unsigned tolerance)
+{
+  _index.window(src, offset, tolerance);
+}
+
+//
+//  Allocate a new datagram buffer and copy payload into it (from a previously allocated buffer)
+//
+EbEventBase* EbT::_new_event(const EbBitMask& serverId, char* payload, unsigned sizeofPayload)
+{
+  CDatagram* datagram = new(&_datagrams) CDatagram(_ctns, _id);
+  EbTimeKey* key = new(&_tkeys) EbTimeKey(datagram->dg(), _index);
+  EbEvent* event = new(&_events) EbEvent(serverId, _clients, datagram, key);
+  key->event(event);
+  event->allocated().insert(serverId);
+  event->recopy(payload, sizeofPayload, serverId);
+
+  unsigned depth = _datagrams.depth();
+
+  if (_vmoneb) _vmoneb->depth(depth);
+
+  if (depth<=1 && _pending.forward()!=_pending.empty()) {
+    PDS_LOG("EbT::new_event claiming buffer for srv %08x payload %d",
+            serverId.value(),sizeofPayload);
+
+    _post(_pending.forward());
+  }
+  return event;
+}
+
+//
+//  Allocate a new datagram buffer
+//
+EbEventBase* EbT::_new_event(const EbBitMask& serverId)
+{
+  unsigned depth = _datagrams.depth();
+
+  if (_vmoneb) _vmoneb->depth(depth);
+
+  if (depth==1 && _pending.forward()!=_pending.empty()) { // keep one buffer for recopy possibility
+    PDS_LOG("EbT::new_event claiming buffer for srv %08x",
+            serverId.value());
+
+    _post(_pending.forward());
+  }
+
+  CDatagram* datagram = new(&_datagrams) CDatagram(_ctns, _id);
+  EbTimeKey* key = new(&_tkeys) EbTimeKey(datagram->dg(), _index);
+  EbEvent* event = new(&_events) EbEvent(serverId, _clients, datagram, key);
+  key->event(event);
+  return event;
+}
+
+//
+//  Each contribution is first offered to the oldest event the server has
+//  not contributed to; the key comparisons that follow use the server's
+//  window.
+//
+EbEventBase* EbT::_event(EbServer* server)
+{
+  _index.select(*server);
+  return EbBase::_event(server);
+}
+
+EbEventBase* EbT::_seek(EbServer* server)
+{
+  EbTimeProbe probe;
+  server->assign(probe);
+  if (!probe.valid)
+    return EbBase::_seek(server);
+
+  EbBitMask serverId;
+  serverId.setBit(server->id());
+  _index.select(*server);
+  return _index.seek(probe.time, serverId);
+}
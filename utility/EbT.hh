@@ -0,0 +1,46 @@
+#ifndef PDS_EBT_HH
+#define PDS_EBT_HH
+
+//
+//  Event builder keyed by clock time, matching each contribution to the
+//  event within its source's time window (see EbTimeIndex).  Sources with
+//  offset or jittery clocks, such as slow cameras or BLD, build without
+//  fixups or readout groups.  Unmatched contributions are found through
+//  the time index rather than by scanning the pending events.
+//
+
+#include "EbK.hh"
+#include "EbTimeIndex.hh"
+
+namespace Pds {
+
+class EbT : public EbK
+  {
+  public:
+    EbT(const Src& id,
+  const TypeId& ctns,
+  Level::Type level,
+  Inlet& inlet,
+  OutletWire& outlet,
+  int stream,
+  int ipaddress,
+  unsigned eventsize,
+  unsigned eventpooldepth,
+  int slowEb,
+  unsigned tolerance,   // default match window [ns]
+  VmonEb* vmoneb=0);
+    ~EbT();
+  public:
+    //  Match window of one source; its clock is "offset" ns ahead of the event's
+    void window(const Src&, int offset, unsigned tolerance);
+  protected:
+    EbEventBase* _new_event  ( const EbBitMask& );
+    EbEventBase* _new_event  ( const EbBitMask&, char* payload, unsigned sizeofPayload );
+    EbEventBase* _event      ( EbServer* );
+    EbEventBase* _seek       ( EbServer* );
+  private:
+    EbTimeIndex _index;
+    GenericPool _tkeys;
+  };
+}
+#endif
@@ -0,0 +1,114 @@
+#include "pds/utility/EbTimeIndex.hh"
+
+#include "pds/utility/EbServer.hh"
+#include "pds/utility/EbEventBase.hh"
+#include "pds/vmon/VmonEb.hh"
+#include "pdsdata/xtc/ClockTime.hh"
+
+#include <stdio.h>
+
+using namespace Pds;
+
+EbTimeIndex::EbTimeIndex(unsigned tolerance, VmonEb* vmoneb) :
+  _default(Src(), 0, tolerance),
+  _cur    (&_default),
+  _server (-1),
+  _vmoneb (vmoneb)
+{
+  if (_vmoneb)
+    _vmoneb->match_offsets();
+}
+
+EbTimeIndex::~EbTimeIndex()
+{
+}
+
+void EbTimeIndex::window(const Src& src, int offset, unsigned tolerance)
+{
+  for(unsigned i=0; i<_windows.size(); i++)
+    if (_windows[i].src.level()==src.level() && _windows[i].src.phy()==src.phy()) {
+      _windows[i].offset    = offset;
+      _windows[i].tolerance = tolerance;
+      _servers.clear();
+      _cur = &_default;
+      return;
+    }
+  _windows.push_back(Window(src, offset, tolerance));
+  _servers.clear();
+  _cur = &_default;
+}
+
+//
+//  The window of a server is looked up once, and again if the server's
+//  slot is taken by another client.
+//
+void EbTimeIndex::select(const EbServer& srv)
+{
+  unsigned id = srv.id();
+  if (id >= _servers.size())
+    _servers.resize(id+1);
+
+  Window& w = _servers[id];
+  const Src& src = srv.client();
+  if (w.tolerance==0 || !(w.src==src)) {
+    w = _default;
+    w.src = src;
+    for(unsigned i=0; i<_windows.size(); i++)
+      if (_windows[i].src.level()==src.level() && _windows[i].src.phy()==src.phy()) {
+        w.offset    = _windows[i].offset;
+        w.tolerance = _windows[i].tolerance;
+        break;
+      }
+  }
+  _cur    = &w;
+  _server = id;
+}
+
+bool EbTimeIndex::coincides(int64_t t, int64_t T) const
+{
+  int64_t dt = reference(t) - T;
+  return dt <= int64_t(_cur->tolerance) && -dt <= int64_t(_cur->tolerance);
+}
+
+void EbTimeIndex::matched(int64_t t, int64_t T)
+{
+  if (_vmoneb && _cur->tolerance)
+    _vmoneb->match_offset(_server, float(reference(t) - T)/float(_cur->tolerance));
+}
+
+EbTimeIndex::Map::iterator EbTimeIndex::insert(int64_t T, EbEventBase* event)
+{
+  return _index.insert(Map::value_type(T, event));
+}
+
+void EbTimeIndex::remove(Map::iterator it)
+{
+  _index.erase(it);
+}
+
+EbEventBase* EbTimeIndex::seek(int64_t t, const EbBitMask& serverId)
+{
+  int64_t r  = reference(t);
+  int64_t tol = _cur->tolerance;
+  EbEventBase* best = 0;
+  int64_t      bdt  = 0;
+  for(Map::iterator it=_index.lower_bound(r-tol); it!=_index.end() && it->first <= r+tol; ++it) {
+    EbEventBase* event = it->second;
+    if (!(event->segments() & serverId).isZero() ||
+        event->allocated().present(serverId).isZero()) {
+      int64_t dt = it->first > r ? it->first - r : r - it->first;
+      if (!best || dt < bdt) {
+        best = event;
+        bdt  = dt;
+      }
+    }
+  }
+  if (best)
+    best->allocated().insert(serverId);
+  return best;
+}
+
+int64_t EbTimeIndex::ns(const ClockTime& clk)
+{
+  return int64_t(clk.seconds())*1000000000LL + int64_t(clk.nanoseconds());
+}
@@ -0,0 +1,65 @@
+#ifndef Pds_EbTimeIndex_hh
+#define Pds_EbTimeIndex_hh
+
+//
+//  Clock time index of the events under construction in an EbT, and the
+//  match window of each source.  A contribution at time t from a source
+//  with window (offset, tolerance) matches an event at time T when
+//  |t - offset - T| <= tolerance.  Times are in ns.
+//
+
+#include "pds/service/EbBitMask.hh"
+#include "pdsdata/xtc/Src.hh"
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+namespace Pds {
+
+  class ClockTime;
+  class EbEventBase;
+  class EbServer;
+  class VmonEb;
+
+  class EbTimeIndex {
+  public:
+    typedef std::multimap<int64_t,EbEventBase*> Map;
+  public:
+    EbTimeIndex(unsigned tolerance, VmonEb*);
+    ~EbTimeIndex();
+  public:
+    void     window   (const Src&, int offset, unsigned tolerance);
+    //  Selects the window of the server whose contribution is being built
+    void     select   (const EbServer&);
+    int64_t  reference(int64_t t) const { return t - _cur->offset; }
+    bool     coincides(int64_t t, int64_t T) const;
+    void     matched  (int64_t t, int64_t T);
+  public:
+    Map::iterator insert(int64_t T, EbEventBase*);
+    void          remove(Map::iterator);
+    //  Returns the closest event in the selected window that "serverId" may contribute to
+    EbEventBase*  seek  (int64_t t, const EbBitMask& serverId);
+  public:
+    static int64_t ns(const ClockTime&);
+  private:
+    class Window {
+    public:
+      Window() : offset(0), tolerance(0) {}
+      Window(const Src& s, int o, unsigned t) : src(s), offset(o), tolerance(t) {}
+    public:
+      Src      src;
+      int      offset;
+      unsigned tolerance;
+    };
+    std::vector<Window> _windows;   // configured
+    std::vector<Window> _servers;   // by server id
+    Window   _default;
+    Window*  _cur;
+    int      _server;
+    VmonEb*  _vmoneb;
+    Map      _index;
+  };
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef Pds_EbTimeKey_hh
+#define Pds_EbTimeKey_hh
+
+#include "EbEventKey.hh"
+#include "EbTimeIndex.hh"
+
+#include "pds/xtc/Datagram.hh"
+#include "pds/service/Pool.hh"
+#include "pdsdata/xtc/Sequence.hh"
+#include "EbSequenceSrv.hh"
+#include "BldSequenceSrv.hh"
+#include "EvrServer.hh"
+
+namespace Pds {
+  //
+  //  Matches contributions within the window of their source.  The event
+  //  takes the time of its first contribution, or of the EVR's, and is
+  //  indexed by it once assigned.  BLD servers which have only the
+  //  fiducials are not matched by time.
+  //
+  class EbTimeKey : public EbEventKey {
+  public:
+    EbTimeKey(Datagram& s, EbTimeIndex& index) :
+      key(s), _index(index), _event(0), _indexed(false)
+    { s.seq = Sequence(); s.env = 0; }
+    ~EbTimeKey() { if (_indexed) _index.remove(_entry); }
+    PoolDeclare;
+  public:
+    void event(EbEventBase* e) { _event = e; }
+  public:
+    virtual bool precedes (const EbSequenceSrv& s) { return _precedes (s.sequence()); }
+    virtual bool coincides(const EbSequenceSrv& s) { return _coincides(s.sequence()); }
+    virtual void assign   (const EbSequenceSrv& s) { if (_assign(s.sequence())) key.env = s.env(); }
+
+    //  Only the BLD servers with a full sequence are matched by time
+    virtual bool precedes (const BldSequenceSrv& s) { return s.sequence() && _precedes (*s.sequence()); }
+    virtual bool coincides(const BldSequenceSrv& s) { return s.sequence() && _coincides(*s.sequence()); }
+    virtual void assign   (const BldSequenceSrv& s) { if (s.sequence()) _assign(*s.sequence()); }
+
+    virtual bool precedes (const EvrServer& s) { return !_indexed || !(_index.reference(EbTimeIndex::ns(s.sequence().clock())) < _time); }
+    virtual bool coincides(const EvrServer& s) { return _indexed && _index.coincides(EbTimeIndex::ns(s.sequence().clock()), _time); }
+    virtual void assign   (const EvrServer& s)
+    {
+      int64_t t = EbTimeIndex::ns(s.sequence().clock());
+      if (_indexed) {
+        _index.matched(t, _time);
+        _index.remove(_entry);
+      }
+      key.seq = s.sequence();
+      _insert(t);
+    }
+  public:
+    const Sequence& sequence() const { return key.seq; }
+    const Env&      env     () const { return key.env; }
+    unsigned        value   () const { return key.seq.stamp().fiducials(); }
+  private:
+    bool _precedes (const Sequence& seq) { return !_indexed || !(_index.reference(EbTimeIndex::ns(seq.clock())) < _time); }
+    bool _coincides(const Sequence& seq) { return _indexed && _index.coincides(EbTimeIndex::ns(seq.clock()), _time); }
+    //  Returns true if the event takes the sequence
+    bool _assign   (const Sequence& seq)
+    {
+      if (_indexed) {
+        _index.matched(EbTimeIndex::ns(seq.clock()), _time);
+        return false;
+      }
+      key.seq = seq;
+      _insert(EbTimeIndex::ns(seq.clock()));
+      return true;
+    }
+    void _insert(int64_t t)
+    {
+      _time    = _index.reference(t);
+      _entry   = _index.insert(_time, _event);
+      _indexed = true;
+    }
+  private:
+    Datagram&            key;
+    EbTimeIndex&         _index;
+    EbEventBase*         _event;
+    EbTimeIndex::Map::iterator _entry;
+    int64_t              _time;
+    bool                 _indexed;
+  };
+
+  //
+  //  Captures the time of a contribution
+  //
+  class EbTimeProbe : public EbEventKey {
+  public:
+    EbTimeProbe() : valid(false), time(0) {}
+  public:
+    virtual void assign(const EbSequenceSrv&  s) { _set(s.sequence()); }
+    virtual void assign(const BldSequenceSrv& s) { if (s.sequence()) _set(*s.sequence()); }
+    virtual void assign(const EvrServer&      s) { _set(s.sequence()); }
+  public:
+    const Sequence& sequence() const { return _seq; }
+    unsigned        value   () const { return 0; }
+  private:
+    void _set(const Sequence& seq) { _seq = seq; time = EbTimeIndex::ns(seq.clock()); valid = true; }
+  public:
+    bool     valid;
+    int64_t  time;
+  private:
+    Sequence _seq;
+  };
+}
+#endif
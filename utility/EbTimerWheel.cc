@@ -0,0 +1,63 @@
+#include "pds/utility/EbTimerWheel.hh"
+
+#include <time.h>
+
+using namespace Pds;
+
+EbTimerWheel::EbTimerWheel(unsigned tick, unsigned slots) :
+  _tick  (tick ? tick : 1),
+  _nslots(slots),
+  _slots (new Entry[slots]),
+  _cursor(now()/_tick)
+{
+}
+
+EbTimerWheel::~EbTimerWheel()
+{
+  //  Release any entries still armed before the slot heads go away
+  for(unsigned i=0; i<_nslots; i++)
+    while(_slots[i].armed())
+      _slots[i]._next->unlink();
+  delete[] _slots;
+}
+
+void EbTimerWheel::arm(Entry& e, uint64_t deadline)
+{
+  e.unlink();
+  e.deadline = deadline;
+  uint64_t tick = deadline/_tick;
+  if (tick < _cursor)
+    tick = _cursor;
+  Entry& head = _slots[tick % _nslots];
+  e._next = &head;
+  e._prev = head._prev;
+  head._prev->_next = &e;
+  head._prev = &e;
+}
+
+EbTimerWheel::Entry* EbTimerWheel::pop(uint64_t t)
+{
+  uint64_t tick = t/_tick;
+  //  A full revolution visits every slot
+  if (tick > _cursor + _nslots)
+    _cursor = tick - _nslots;
+
+  while(1) {
+    Entry& head = _slots[_cursor % _nslots];
+    for(Entry* e = head._next; e != &head; e = e->_next)
+      if (e->deadline <= t) {
+        e->unlink();
+        return e;
+      }
+    if (_cursor >= tick)
+      return 0;
+    _cursor++;
+  }
+}
+
+uint64_t EbTimerWheel::now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec)*1000 + uint64_t(ts.tv_nsec)/1000000;
+}
@@ -0,0 +1,54 @@
+#ifndef Pds_EbTimerWheel_hh
+#define Pds_EbTimerWheel_hh
+
+//
+//  Hashed timer wheel for event builder deadlines.
+//
+//  Entries are intrusive and unlink themselves when destroyed, so an event
+//  that completes (or is flushed) leaves the wheel without a search.  Each
+//  slot covers one tick; deadlines more than a revolution away share the
+//  slot and are skipped until their round comes up.  Expiry costs the
+//  ticks elapsed plus the entries in the slots visited, so a deadline that
+//  is many revolutions away is passed over once per revolution.
+//
+
+#include <stdint.h>
+
+namespace Pds {
+
+  class EbTimerWheel {
+  public:
+    class Entry {
+    public:
+      Entry() : created(0), deadline(0), _next(this), _prev(this) {}
+      Entry(const Entry&) : created(0), deadline(0), _next(this), _prev(this) {}
+      ~Entry() { unlink(); }
+    public:
+      bool armed () const { return _next != this; }
+      void unlink() { _prev->_next = _next; _next->_prev = _prev; _next = _prev = this; }
+    public:
+      uint64_t created;   // [ms]
+      uint64_t deadline;  // [ms]
+    private:
+      friend class EbTimerWheel;
+      Entry* _next;
+      Entry* _prev;
+    };
+  public:
+    EbTimerWheel(unsigned tick, unsigned slots);  // [ms]
+    ~EbTimerWheel();
+  public:
+    void     arm (Entry&, uint64_t deadline);
+    //  Unlinks and returns one entry whose deadline has passed, or 0
+    Entry*   pop (uint64_t now);
+  public:
+    static uint64_t now();
+  private:
+    unsigned _tick;
+    unsigned _nslots;
+    Entry*   _slots;
+    uint64_t _cursor;   // tick of the slot being expired
+  };
+};
+
+#endif
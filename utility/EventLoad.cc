@@ -0,0 +1,38 @@
+#include "pds/utility/EventLoad.hh"
+#include "pds/utility/StreamPorts.hh"
+
+using namespace Pds;
+
+EventLoadReporter::EventLoadReporter(unsigned partition,
+                                     unsigned node,
+                                     unsigned capacity,
+                                     int      interface) :
+  _outlet(sizeof(EventLoad), 0, Ins(interface)),
+  _dst   (StreamPorts::eventLoad(partition)),
+  _load  (node, capacity),
+  _sent  (0)
+{
+  _last.tv_sec = _last.tv_nsec = 0;
+}
+
+EventLoadReporter::~EventLoadReporter()
+{
+}
+
+void EventLoadReporter::update(unsigned depth)
+{
+  unsigned inuse = depth < _load._capacity ? _load._capacity - depth : 0;
+
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  long dt = (now.tv_sec - _last.tv_sec)*1000 + (now.tv_nsec - _last.tv_nsec)/1000000;
+
+  if (dt < MinInterval || (inuse == _sent && dt < Heartbeat))
+    return;
+
+  _load._inuse = inuse;
+  _load._sequence++;
+  _outlet.send((char*)&_load, (char*)0, 0, _dst);
+  _sent = inuse;
+  _last = now;
+}
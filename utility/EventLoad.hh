@@ -0,0 +1,60 @@
+#ifndef Pds_EventLoad_hh
+#define Pds_EventLoad_hh
+
+//
+//  Buffer occupancy of an event level node, multicast to the master EVR so
+//  that it can steer L1Accepts away from busy event nodes.  A report is sent
+//  when the occupancy changes (at most every MinInterval) and at least every
+//  Heartbeat.  The event builder updates the reporter on each new event and
+//  after each poll, and wakes at least every Heartbeat, so that an idle
+//  node keeps reporting the events it still holds.
+//
+
+#include "pds/service/Client.hh"
+#include "pds/service/Ins.hh"
+
+#include <stdint.h>
+#include <time.h>
+
+namespace Pds {
+
+  class EventLoad {
+  public:
+    EventLoad() {}
+    EventLoad(unsigned node, unsigned capacity) :
+      _node(node), _inuse(0), _capacity(capacity), _sequence(0) {}
+  public:
+    unsigned node    () const { return _node; }
+    unsigned inuse   () const { return _inuse; }
+    unsigned capacity() const { return _capacity; }
+    unsigned sequence() const { return _sequence; }
+  private:
+    friend class EventLoadReporter;
+    uint32_t _node;
+    uint32_t _inuse;       // event buffers allocated
+    uint32_t _capacity;    // event buffers in the pool
+    uint32_t _sequence;
+  };
+
+  class EventLoadReporter {
+  public:
+    enum { MinInterval = 1, Heartbeat = 100 };  // msec
+  public:
+    EventLoadReporter(unsigned partition,
+                      unsigned node,
+                      unsigned capacity,
+                      int      interface);
+    ~EventLoadReporter();
+  public:
+    ///  Called with the number of free event buffers
+    void update(unsigned depth);
+  private:
+    Client          _outlet;
+    Ins             _dst;
+    EventLoad       _load;
+    unsigned        _sent;
+    timespec        _last;
+  };
+};
+
+#endif
@@ -19,7 +19,7 @@ namespace Pds {
     virtual Occurrence* forward(Occurrence* occ) = 0;
     virtual InDatagram* forward(InDatagram* dg) = 0;
 
-    enum NamedConnection { Bcast };
+    enum NamedConnection { Bcast, Credits };
     virtual void bind(NamedConnection, const Ins& ) = 0;
     virtual void bind(unsigned id, const Ins& node) = 0;
     virtual void unbind(unsigned id) = 0;
@@ -31,6 +31,12 @@ public:
   virtual unsigned module         () const { return -1U; }
   virtual unsigned channel        () const { return -1U; }
   virtual bool     has_fiducial   () const { return false; }
+  //  Threads on which the detector appliances run Configure and
+  //  BeginCalibCycle concurrently; 0 runs them in turn (see ParallelConfigure)
+  virtual unsigned configure_threads() const { return 0; }
+  //  Clock time window [ns] within which the contributions of a segment
+  //  with a fiducial are built together; 0 builds by fiducial (see EbT)
+  virtual unsigned match_tolerance  () const { return 0; }
 };
 }
 #endif
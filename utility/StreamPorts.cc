@@ -32,6 +32,10 @@ static const int EvrMcastAddr      = VmonMcastAddr    +StreamPorts::MaxPartition
 static const int SinkMcastAddr     = EvrMcastAddr     +StreamPorts::MaxPartitions;
 // L2 -> mon
 static const int MonReqMcastAddr   = SinkMcastAddr    +1;
+// L2 -> EVR Master
+static const int EventLoadMcastAddr= MonReqMcastAddr  +StreamPorts::MaxPartitions;
+// L2 -> L1 credits
+static const int EbCreditMcastAddr = EventLoadMcastAddr+StreamPorts::MaxPartitions;
 
 // BLD -> L1,L2 : 0xefff1800
 static const int BLDMcastAddr      = 0xefff1800;  // FIXED value for external code
@@ -45,6 +49,8 @@ static const unsigned VmonPortBase     = ObserverPortBase+StreamPorts::MaxPartit
 static const unsigned EvrPortBase      = VmonPortBase    +1;                                            // 11439
 static const unsigned SinkPortBase     = EvrPortBase     +StreamPorts::MaxPartitions;                   // 11447
 static const unsigned MonReqPortBase   = SinkPortBase    +1;
+static const unsigned EventLoadPortBase= MonReqPortBase  +StreamPorts::MaxPartitions;
+static const unsigned EbCreditPortBase = EventLoadPortBase+StreamPorts::MaxPartitions;
 static const unsigned BLDPortBase      = 10148;   // FIXED value for external code
 
 
@@ -115,6 +121,16 @@ Ins StreamPorts::monRequest(unsigned partition)
   return Ins(MonReqMcastAddr + partition, MonReqPortBase + partition);
 }
 
+Ins StreamPorts::eventLoad(unsigned partition)
+{
+  return Ins(EventLoadMcastAddr + partition, EventLoadPortBase + partition);
+}
+
+Ins StreamPorts::ebCredit(unsigned partition)
+{
+  return Ins(EbCreditMcastAddr + partition, EbCreditPortBase + partition);
+}
+
 StreamPorts::StreamPorts()
 {
   for (int stream=0; stream<StreamParams::NumberOfStreams; stream++) {
@@ -34,6 +34,10 @@ namespace Pds {
     static Ins sink ();
     ///  Mon request service
     static Ins monRequest(unsigned partition);
+    ///  Event level load reports to the master EVR
+    static Ins eventLoad (unsigned partition);
+    ///  Event builder credit grants to the segment levels
+    static Ins ebCredit  (unsigned partition);
   public:
     StreamPorts();
     StreamPorts(const StreamPorts&);
@@ -56,9 +56,10 @@ InDatagram* ToEventWire::forward(InDatagram* dg)
   return 0;
 }
 
-void ToEventWire::bind(NamedConnection, const Ins& ins) 
+void ToEventWire::bind(NamedConnection c, const Ins& ins) 
 {
-  _bcast = ins;
+  if (c == Bcast)
+    _bcast = ins;
 }
 
 void ToEventWire::bind(unsigned id, const Ins& node) 
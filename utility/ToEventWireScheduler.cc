@@ -11,11 +11,12 @@
 #include "pds/xtc/Datagram.hh"
 #include "pds/xtc/InDatagram.hh"
 #include "pds/service/Task.hh"
+#include "pds/service/NetServer.hh"
 
 #include "pds/vmon/VmonServerManager.hh"
 #include "pds/mon/MonCds.hh"
 #include "pds/mon/MonGroup.hh"
-#include "pds/mon/MonEntryTH1F.hh"
+#include "pds/mon/MonShardedTH1F.hh"
 #include "pds/mon/MonDescTH1F.hh"
 
 #include <stdlib.h>
@@ -92,10 +93,13 @@ static unsigned _interval = 8000;  // time interval [us] for traffic shaping
 
 static bool _shape_tmo = false;
 
+static int      _credit_tmo = 1000; // time [ms] an event waits for credits before it is sent anyway
+
 void ToEventWireScheduler::setMaximum (unsigned m) { _maxscheduled = m; }
 void ToEventWireScheduler::setPhase   (unsigned m) { _phase = m; }
 void ToEventWireScheduler::setInterval(unsigned m) { _interval = m; }
 void ToEventWireScheduler::shapeTmo   (bool v) { _shape_tmo = v; }
+void ToEventWireScheduler::creditTmo  (unsigned m) { _credit_tmo = m; }
 
 ToEventWireScheduler::ToEventWireScheduler(Outlet& outlet,
              CollectionManager& collection,
@@ -111,18 +115,44 @@ ToEventWireScheduler::ToEventWireScheduler(Outlet& outlet,
   _nscheduled  (0),
   _scheduled   (0),
   _task        (new Task(TaskObject("TxScheduler"))),
-  _flush_task  (new Task(TaskObject("TxFlush")))
+  _flush_task  (new Task(TaskObject("TxFlush"))),
+  _interface   (interface),
+  _credits     (0),
+  _nheld       (0)
 {
   _flushCount = 0;
 
+  for(unsigned i=0; i<MaxNodes; i++) {
+    _window[i] = 0;
+    _stall [i].tv_sec = 0;
+  }
+
   MonGroup* group = new MonGroup("ToEvent");
   VmonServerManager::instance()->cds().add(group);
 
   MonDescTH1F sendtime("Send Time", "[us]", "", 
                        1<<(tbin_range-tbin_shift), 0., float(1<<tbin_range));
-  _histo = new MonEntryTH1F(sendtime);
+  _histo = new MonShardedTH1F(sendtime);
   group->add(_histo);
 
+  MonDescTH1F stalltime("Credit Stall", "[ms]", "",
+                        100, 0., float(_credit_tmo));
+  _stallTime = new MonShardedTH1F(stalltime);
+  group->add(_stallTime);
+
+  MonDescTH1F stalls("Credit Stalls", "node", "",
+                     MaxNodes, -0.5, float(MaxNodes)-0.5);
+  _stalls = new MonShardedTH1F(stalls);
+  group->add(_stalls);
+
+  MonDescTH1F overruns("Credit Overruns", "node", "",
+                       MaxNodes, -0.5, float(MaxNodes)-0.5);
+  _overruns = new MonShardedTH1F(overruns);
+  group->add(_overruns);
+
+  if (::pipe(_creditfd) < 0)
+    printf("ToEventWireScheduler pipe open error : %s\n",strerror(errno));
+
   if (::pipe(_schedfd) < 0)
     printf("ToEventWireScheduler pipe open error : %s\n",strerror(errno));
   else
@@ -133,7 +163,10 @@ ToEventWireScheduler::~ToEventWireScheduler()
 {
   ::close(_schedfd[0]);
   ::close(_schedfd[1]);
+  ::close(_creditfd[0]);
+  ::close(_creditfd[1]);
   _task->destroy();
+  if (_credits) delete _credits;
 }
 
 Transition* ToEventWireScheduler::forward(Transition* tr)
@@ -153,6 +186,14 @@ Occurrence* ToEventWireScheduler::forward(Occurrence* tr)
 
 void ToEventWireScheduler::_flush(InDatagram* dg)
 {
+  //
+  //  Events held for credits precede the transition
+  //
+  if (_nheld)
+    for(unsigned i=0; i<MaxNodes; i++)
+      if (!_held[i].empty())
+        _release(i, true);
+
   if (_nscheduled) {
     _flush();
 
@@ -183,10 +224,12 @@ void ToEventWireScheduler::_flush()
     return;
 
   //
-  //  Phase delay goes here
+  //  Phase delay goes here, unless the event nodes are granting credits
   //
-  timeval timeSleepMicro = {0, _phase*_interval};
-  select( 0, NULL, NULL, NULL, &timeSleepMicro);
+  if (!_credits) {
+    timeval timeSleepMicro = {0, _phase*_interval};
+    select( 0, NULL, NULL, NULL, &timeSleepMicro);
+  }
 
   _flush_task->call( new FlushRoutine(_list,_client,this) );
   _scheduled  = 0;
@@ -204,43 +247,56 @@ InDatagram* ToEventWireScheduler::forward(InDatagram* dg)
 
 void ToEventWireScheduler::routine()
 {
-  pollfd pfd;
-  pfd.fd      = _schedfd[0];
-  pfd.events  = POLLIN | POLLERR;
-  pfd.revents = 0;
-  int nfd = 1;
+  char* payload = new char[Mtu::Size];
+
+  pollfd pfd[3];
+  pfd[0].fd      = _schedfd[0];
+  pfd[0].events  = POLLIN | POLLERR;
+  pfd[1].fd      = _creditfd[0];
+  pfd[1].events  = POLLIN | POLLERR;
+  pfd[2].events  = POLLIN | POLLERR;
   while(1) {
-    if (::poll(&pfd, nfd, _idol_timeout) > 0) {
-      InDatagram* dg;
-      if (::read(_schedfd[0], &dg, sizeof(dg)) == sizeof(dg)) {
-	//  Flush the set of events if
-	//    (1) we already have queued an event to the same destination
-	//    (2) we have reached the maximum number of queued events
+    int nfd = 2;
+    if (_credits) {
+      pfd[2].fd = _credits->socket();
+      nfd = 3;
+    }
+    pfd[0].revents = pfd[1].revents = pfd[2].revents = 0;
+
+    if (::poll(pfd, nfd, _idol_timeout) > 0) {
+      if (pfd[2].revents & (POLLIN | POLLERR)) {
+        if (_credits->fetch(payload, 0) == 0)
+          _grant(*reinterpret_cast<const EbCredit*>(_credits->datagram()));
+      }
+      if (pfd[1].revents & (POLLIN | POLLERR)) {
+        NetServer* srv;
+        if (::read(_creditfd[0], &srv, sizeof(srv)) == sizeof(srv)) {
+          if (_credits) delete _credits;
+          _credits = srv;
+          for(unsigned i=0; i<MaxNodes; i++) {
+            _release(i, true);
+            _window     [i] = 0;
+            _outstanding[i].clear();
+          }
+        }
+      }
+      if (pfd[0].revents & (POLLIN | POLLERR)) {
+        InDatagram* dg;
+        if (::read(_schedfd[0], &dg, sizeof(dg)) != sizeof(dg)) {
+          printf("ToEventWireScheduler::routine error reading pipe : %s\n",
+                 strerror(errno));
+          break;
+        }
         const Sequence& seq = dg->datagram().seq;
         if (seq.isEvent() && !_nodes.isempty()) {
           OutletWireIns* dst = _nodes.lookup(seq.stamp().vector());
-          unsigned m = 1<<dst->id();
-
-          if ((m & _scheduled) || (_shape_tmo && (_nscheduled>=_maxscheduled)))
-	    _flush();
-
-          TrafficDst* t = dg->traffic(dst->ins());
-          _list.insert(t);
-          _scheduled |= m;
-          ++_nscheduled;
-
-          if (!_shape_tmo && _nscheduled >= _maxscheduled)
-            _flush();
+          if (!_hold(dg, dst->id()))
+            _enqueue(dg, dst);
         }
         else {
           _flush(dg);
         }
       }
-      else {
-        printf("ToEventWireScheduler::routine error reading pipe : %s\n",
-               strerror(errno));
-        break;
-      }
     }
     else {  // timeout
 #if 0
@@ -261,12 +317,147 @@ void ToEventWireScheduler::routine()
 #endif
       _flush();
     }
+    if (_nheld)
+      _expire();
   }
+
+  delete[] payload;
+}
+
+void ToEventWireScheduler::_enqueue(InDatagram* dg, OutletWireIns* dst)
+{
+  //  Flush the set of events if
+  //    (1) we already have queued an event to the same destination
+  //    (2) we have reached the maximum number of queued events
+  unsigned m = 1<<dst->id();
+
+  if ((m & _scheduled) || (_shape_tmo && (_nscheduled>=_maxscheduled)))
+    _flush();
+
+  if (dst->id() < MaxNodes && _window[dst->id()])
+    _outstanding[dst->id()].push_back(dg->datagram().seq.stamp().fiducials());
+
+  TrafficDst* t = dg->traffic(dst->ins());
+  _list.insert(t);
+  _scheduled |= m;
+  ++_nscheduled;
+
+  if (!_shape_tmo && _nscheduled >= _maxscheduled)
+    _flush();
 }
 
-void ToEventWireScheduler::bind(NamedConnection, const Ins& ins)
+//
+//  Hold an event when its node has no credit left, or when earlier events
+//  for that node are already held.
+//
+bool ToEventWireScheduler::_hold(InDatagram* dg, unsigned node)
 {
-  _bcast = ins;
+  if (node >= MaxNodes || !_window[node])
+    return false;
+
+  if (_held[node].empty()) {
+    if (_outstanding[node].size() < _window[node])
+      return false;
+    clock_gettime(CLOCK_REALTIME, &_stall[node]);
+    _stalls->addcontent(1., node);
+    _stalls->time(ClockTime(_stall[node].tv_sec,_stall[node].tv_nsec));
+  }
+
+  _held[node].push_back(dg);
+  _nheld++;
+  return true;
+}
+
+void ToEventWireScheduler::_grant(const EbCredit& credit)
+{
+  unsigned node = credit.node();
+  if (node >= MaxNodes)
+    return;
+
+  _window[node] = credit.window();
+
+  std::deque<unsigned>& q = _outstanding[node];
+  while(!q.empty() && credit.completed(q.front()))
+    q.pop_front();
+
+  if (!_held[node].empty()) {
+    _release(node, false);
+    _flush();
+  }
+}
+
+//
+//  Send held events while credits last (or all of them if forced)
+//
+void ToEventWireScheduler::_release(unsigned node, bool force)
+{
+  std::deque<InDatagram*>& held = _held[node];
+  if (held.empty())
+    return;
+
+  OutletWireIns* dst = _nodes.isempty() ? 0 : _nodes.lookup(held.front()->datagram().seq.stamp().vector());
+  while(!held.empty() &&
+        (force || _outstanding[node].size() < _window[node])) {
+    InDatagram* dg = held.front();
+    held.pop_front();
+    _nheld--;
+    if (dst)
+      _enqueue(dg, dst);
+    else
+      delete dg;
+  }
+
+  if (held.empty()) {
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    double ms = double(now.tv_sec - _stall[node].tv_sec)*1.e3 +
+      double(now.tv_nsec - _stall[node].tv_nsec)*1.e-6;
+    if (ms < double(_credit_tmo))
+      _stallTime->addcontent(1., unsigned(ms*100./double(_credit_tmo)));
+    else
+      _stallTime->addinfo(1., MonEntryTH1F::Overflow);
+    _stallTime->time(ClockTime(now.tv_sec,now.tv_nsec));
+    _stall[node].tv_sec = 0;
+  }
+}
+
+//
+//  A node which grants no credits for longer than the credit timeout is
+//  treated as not granting any; its held events are sent.
+//
+void ToEventWireScheduler::_expire()
+{
+  timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  for(unsigned i=0; i<MaxNodes; i++) {
+    if (_held[i].empty())
+      continue;
+    long ms = (now.tv_sec - _stall[i].tv_sec)*1000 +
+      (now.tv_nsec - _stall[i].tv_nsec)/1000000;
+    if (ms >= _credit_tmo) {
+      printf("ToEventWireScheduler node %u granted no credits for %ld ms; sending %zu events\n",
+             i, ms, _held[i].size());
+      _overruns->addcontent(1., i);
+      _overruns->time(ClockTime(now.tv_sec,now.tv_nsec));
+      _release(i, true);
+      _window     [i] = 0;
+      _outstanding[i].clear();
+      _flush();
+    }
+  }
+}
+
+void ToEventWireScheduler::bind(NamedConnection c, const Ins& ins)
+{
+  if (c == Bcast) {
+    _bcast = ins;
+    return;
+  }
+
+  //  Credits : handed to the scheduler thread
+  NetServer* srv = new NetServer((unsigned)-1, ins, sizeof(EbCredit), Mtu::Size);
+  srv->join(ins, Ins(_interface));
+  ::write(_creditfd[1], &srv, sizeof(srv));
 }
 
 void ToEventWireScheduler::bind(unsigned id, const Ins& node)
@@ -7,8 +7,10 @@
 #include "pds/service/Routine.hh"
 
 #include "pds/utility/OutletWireInsList.hh"
+#include "pds/utility/EbCredit.hh"
 #include "pds/service/Client.hh"
 #include <time.h>
+#include <deque>
 
 namespace Pds {
   class CollectionManager;
@@ -17,7 +19,9 @@ namespace Pds {
   class Task;
   class TrafficDst;
   class TrafficScheduler;
-  class MonEntryTH1F;
+  class MonShardedTH1F;
+  class NetServer;
+  class OutletWireIns;
 
   class ToEventWireScheduler : public OutletWire,
 			       public Routine {
@@ -43,9 +47,15 @@ namespace Pds {
     static void setPhase   (unsigned);
     static void setInterval(unsigned); // microseconds
     static void shapeTmo   (bool);
+    static void creditTmo  (unsigned); // milliseconds
   private:
     void _flush(InDatagram*);
     void _flush();
+    void _enqueue (InDatagram*, OutletWireIns*);
+    bool _hold    (InDatagram*, unsigned node);
+    void _grant   (const EbCredit&);
+    void _release (unsigned node, bool force);
+    void _expire  ();
   public:
     void histo(timespec&, timespec&);
   private:
@@ -62,7 +72,20 @@ namespace Pds {
     Task*                  _flush_task;
     int                    _schedfd[2];
     unsigned               _flushCount;
-    MonEntryTH1F*          _histo;
+    MonShardedTH1F*          _histo;
+    //  Credit flow control
+    enum { MaxNodes = 64 };
+    int                    _interface;
+    NetServer*             _credits;
+    int                    _creditfd[2];
+    unsigned               _window     [MaxNodes]; // 0 = no credits granted
+    std::deque<unsigned>   _outstanding[MaxNodes]; // fiducials sent and not yet built
+    std::deque<InDatagram*> _held      [MaxNodes]; // events waiting for credits
+    timespec               _stall      [MaxNodes];
+    unsigned               _nheld;
+    MonShardedTH1F*        _stallTime;
+    MonShardedTH1F*        _stalls;
+    MonShardedTH1F*        _overruns;
   };
 }
 
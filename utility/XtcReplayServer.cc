@@ -0,0 +1,242 @@
+#include "pds/utility/XtcReplayServer.hh"
+
+#include "pdsdata/xtc/Dgram.hh"
+#include "pdsdata/xtc/XtcIterator.hh"
+#include "pdsdata/xtc/TransitionId.hh"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace Pds;
+
+static const timespec _idle = {0, 100000000};  // 0.1 sec
+static const timespec _wait = {0,    100000};  // 0.1 ms
+static const uint64_t MaxInterval = 1000000000ULL;  // ns, between recorded events
+
+static uint64_t _ns(const timespec& ts) { return uint64_t(ts.tv_sec)*1000000000ULL + ts.tv_nsec; }
+
+static timespec _ts(uint64_t ns)
+{
+  timespec ts;
+  ts.tv_sec  = ns / 1000000000ULL;
+  ts.tv_nsec = ns % 1000000000ULL;
+  return ts;
+}
+
+namespace Pds {
+  //
+  //  Collects the xtcs of one source within a datagram; containers of
+  //  other sources are searched
+  //
+  class XtcReplayFinder : public XtcIterator {
+  public:
+    XtcReplayFinder(const Src& src, std::vector<const Xtc*>& found) :
+      _src(src), _found(found) {}
+  public:
+    int process(Xtc* xtc) {
+      if (xtc->src.level()==_src.level() && xtc->src.phy()==_src.phy())
+        _found.push_back(xtc);
+      else if (xtc->contains.id()==TypeId::Id_Xtc)
+        iterate(xtc);
+      return 1;
+    }
+  private:
+    const Src&               _src;
+    std::vector<const Xtc*>& _found;
+  };
+};
+
+XtcReplayServer::XtcReplayServer(const Src&                      recorded,
+                                 const Src&                      client,
+                                 const std::vector<std::string>& files,
+                                 unsigned                        maxSize,
+                                 double                          rate,
+                                 bool                            loop,
+                                 unsigned                        depth) :
+  AsyncReadout<unsigned>(client, TypeId(TypeId::Id_Xtc,1), depth, "XtcReplay"),
+  _recorded  (recorded),
+  _maxSize   (maxSize),
+  _rate      (rate),
+  _loop      (loop),
+  _maxPayload(0),
+  _rejected  (0),
+  _next      (0),
+  _loops     (0)
+{
+  _due.tv_sec  = 0;
+  _due.tv_nsec = 0;
+
+  for(unsigned i=0; i<files.size(); i++)
+    _map(files[i].c_str());
+
+  if (_events.empty())
+    printf("*** XtcReplayServer: no contributions of %08x.%08x in %zu files\n",
+           recorded.log(), recorded.phy(), files.size());
+  else
+    printf("XtcReplayServer: %zu contributions of %08x.%08x, up to %u bytes, from %zu files\n",
+           _events.size(), recorded.log(), recorded.phy(), _maxPayload, files.size());
+  if (_rejected)
+    printf("*** XtcReplayServer: %u contributions larger than %u bytes left out\n",
+           _rejected, _maxSize);
+}
+
+//
+//  The reader must have been shut down
+//
+XtcReplayServer::~XtcReplayServer()
+{
+  for(unsigned i=0; i<_mappings.size(); i++)
+    ::munmap(_mappings[i].base, _mappings[i].size);
+}
+
+void XtcReplayServer::_map(const char* path)
+{
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    printf("*** XtcReplayServer: cannot open %s: %s\n", path, strerror(errno));
+    return;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) < 0 || st.st_size == 0) {
+    printf("*** XtcReplayServer: %s is empty or cannot be sized\n", path);
+    ::close(fd);
+    return;
+  }
+  void* p = ::mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // the mapping keeps the file
+  if (p == MAP_FAILED) {
+    printf("*** XtcReplayServer: cannot map %s: %s\n", path, strerror(errno));
+    return;
+  }
+
+  Mapping m;
+  m.base = reinterpret_cast<char*>(p);
+  m.size = st.st_size;
+  _mappings.push_back(m);
+
+  const char* next = m.base;
+  const char* end  = m.base + m.size;
+  while(next + sizeof(Dgram) <= end) {
+    const Dgram* dg = reinterpret_cast<const Dgram*>(next);
+    if (dg->xtc.extent < sizeof(Xtc) ||
+        next + sizeof(Dgram) + dg->xtc.sizeofPayload() > end) {
+      printf("*** XtcReplayServer: %s is truncated at offset 0x%zx\n", path, size_t(next - m.base));
+      break;
+    }
+    _index(*dg);
+    next += sizeof(Dgram) + dg->xtc.sizeofPayload();
+  }
+}
+
+void XtcReplayServer::_index(const Dgram& dg)
+{
+  TransitionId::Value service = dg.seq.service();
+  if (service == TransitionId::Configure) {
+    if (_configuration.empty()) {
+      XtcReplayFinder finder(_recorded, _configuration);
+      finder.iterate(const_cast<Xtc*>(&dg.xtc));
+    }
+    return;
+  }
+  if (service != TransitionId::L1Accept)
+    return;
+
+  Event e;
+  e.first = _xtcs.size();
+  XtcReplayFinder finder(_recorded, _xtcs);
+  finder.iterate(const_cast<Xtc*>(&dg.xtc));
+  e.nxtcs = _xtcs.size() - e.first;
+  if (!e.nxtcs)
+    return;
+
+  e.size = 0;
+  for(unsigned i=e.first; i<_xtcs.size(); i++)
+    e.size += _xtcs[i]->extent;
+  //  decode() copies it whole into the datagram
+  if (e.size > _maxSize) {
+    _xtcs.resize(e.first);
+    _rejected++;
+    return;
+  }
+  if (e.size > _maxPayload)
+    _maxPayload = e.size;
+
+  const ClockTime& clock = dg.seq.clock();
+  e.clock = uint64_t(clock.seconds())*1000000000ULL + clock.nanoseconds();
+  _events.push_back(e);
+}
+
+//
+//  Reader thread: waits for room in the ring.  After 0.1 sec the reader
+//  idles, so that it sees stop() and shutdown().
+//
+bool XtcReplayServer::_ready()
+{
+  for(unsigned i=0; i<1000; i++) {
+    if (buffered() < depth())
+      return true;
+    nanosleep(&_wait, NULL);
+  }
+  return false;
+}
+
+//
+//  Reader thread: waits for the contribution's release time
+//
+int XtcReplayServer::read(unsigned& e)
+{
+  if (_events.empty() || (_next == _events.size() && !_loop)) {
+    nanosleep(&_idle, NULL);
+    return 0;
+  }
+  if (_next == _events.size()) {
+    _next = 0;
+    _loops++;
+  }
+
+  uint64_t interval;
+  if (_rate > 0)
+    interval = uint64_t(1.e9/_rate);
+  else {
+    unsigned prev = _next ? _next-1 : _events.size()-1;
+    uint64_t t0 = _events[prev ].clock;
+    uint64_t t1 = _events[_next].clock;
+    interval = (t1 > t0 && t1-t0 < MaxInterval) ? t1-t0 : 0;
+  }
+
+  //  Start over after a pause (or at the first event) instead of catching up
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint64_t due = _ns(_due) + interval;
+  if (due + MaxInterval < _ns(now))
+    due = _ns(now);
+  _due = _ts(due);
+  while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &_due, NULL) == EINTR)
+    ;
+
+  e = _next++;
+  return 1;
+}
+
+//
+//  Server thread: one copy from the mapping into the datagram
+//
+int XtcReplayServer::decode(unsigned& e, char* payload, Damage& damage)
+{
+  const Event& event = _events[e];
+  char* p = payload;
+  for(unsigned i=0; i<event.nxtcs; i++) {
+    const Xtc* xtc = _xtcs[event.first+i];
+    memcpy(p, xtc, xtc->extent);
+    reinterpret_cast<Xtc*>(p)->src = client();
+    damage.increase(xtc->damage.value());
+    p += xtc->extent;
+  }
+  return p - payload;
+}
@@ -0,0 +1,95 @@
+#ifndef Pds_XtcReplayServer_hh
+#define Pds_XtcReplayServer_hh
+
+//
+//  Segment level server that replays one source's contributions from
+//  recorded xtc files, for load tests of the event levels with realistic
+//  payloads.
+//
+//  The files are mapped read-only and the L1Accept contributions of the
+//  "recorded" source are indexed at construction.  A contribution whose
+//  payload exceeds "maxSize", the room in the event builder's datagram,
+//  is left out of the index and counted as rejected.  The reader thread
+//  releases them in order at "rate" Hz, or with the recorded intervals
+//  when rate is 0, and restarts at the first file when "loop" is set.
+//  fetch() copies a contribution from the mapping straight into the
+//  event's datagram, with no read() or staging buffer.  There is no device
+//  to overrun, so the reader waits for the event builder rather than
+//  dropping contributions when the ring is full.
+//
+//  Contributions are counted like those of other AsyncReadoutServers, so
+//  the event builder matches them with the live trigger and they take the
+//  live event's sequence.  The payload is the source's recorded xtcs in
+//  an Id_Xtc container, each restamped with "client".  The source is
+//  matched by level and physical id, since the log word carries the
+//  recording process' id.
+//
+
+#include "pds/utility/AsyncReadout.hh"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Pds {
+
+  class Dgram;
+
+  class XtcReplayServer : public AsyncReadout<unsigned> {
+  public:
+    XtcReplayServer(const Src&                      recorded,
+                    const Src&                      client,
+                    const std::vector<std::string>& files,
+                    unsigned                        maxSize,
+                    double                          rate,
+                    bool                            loop,
+                    unsigned                        depth = 16);
+    ~XtcReplayServer();
+  public:
+    unsigned   contributions() const { return _events.size(); }
+    unsigned   loops        () const { return _loops; }
+    //  Contributions larger than maxSize, left out
+    unsigned   rejected     () const { return _rejected; }
+    //  Largest payload of a contribution, for sizing the event pool
+    unsigned   maxPayload   () const { return _maxPayload; }
+    //  The source's xtcs in the first recorded Configure, if any
+    const std::vector<const Xtc*>& configuration() const { return _configuration; }
+  protected:
+    //  AsyncReadoutServer interface
+    bool       _ready();
+    //  AsyncReadout interface
+    int        read  (unsigned&);
+    int        decode(unsigned&, char* payload, Damage&);
+  private:
+    void       _map  (const char* path);
+    void       _index(const Dgram&);
+  private:
+    class Event {
+    public:
+      unsigned first;     // in _xtcs
+      unsigned nxtcs;
+      unsigned size;
+      uint64_t clock;     // recorded, ns
+    };
+    class Mapping {
+    public:
+      char*    base;
+      size_t   size;
+    };
+    Src                     _recorded;
+    unsigned                _maxSize;
+    double                  _rate;
+    bool                    _loop;
+    std::vector<Mapping>    _mappings;
+    std::vector<const Xtc*> _xtcs;
+    std::vector<Event>      _events;
+    std::vector<const Xtc*> _configuration;
+    unsigned                _maxPayload;
+    unsigned                _rejected;
+    unsigned                _next;
+    unsigned                _loops;
+    timespec                _due;
+  };
+}
+
+#endif
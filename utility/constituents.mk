@@ -8,5 +8,27 @@ libnames := utility
 #CXXFLAGS += -DBUILD_READOUT_GROUP -DBUILD_PRINCETON -DBUILD_PACKAGE_SPACE # for princeton camera and the switch problem
 #CXXFLAGS += -DBUILD_READOUT_GROUP  # for running devices with different readout rate
 
+ignore_src := xtcreplaytest.cc ebwheeltest.cc ebtimetest.cc
+
 libsrcs_utility := $(filter-out $(ignore_src),$(wildcard *.cc))
-libincs_utility := pdsdata/include
\ No newline at end of file
+libincs_utility := pdsdata/include
+
+tgtnames := xtcreplaytest ebwheeltest ebtimetest
+
+tgtsrcs_xtcreplaytest := xtcreplaytest.cc
+tgtlibs_xtcreplaytest := pdsdata/xtcdata
+tgtlibs_xtcreplaytest += pds/utility pds/service pds/collection pds/vmon pds/mon pds/xtc
+tgtslib_xtcreplaytest := $(USRLIBDIR)/rt
+tgtincs_xtcreplaytest := pdsdata/include
+
+tgtsrcs_ebwheeltest := ebwheeltest.cc
+tgtlibs_ebwheeltest := pdsdata/xtcdata
+tgtlibs_ebwheeltest += pds/utility pds/service pds/collection pds/vmon pds/mon pds/xtc
+tgtslib_ebwheeltest := $(USRLIBDIR)/rt
+tgtincs_ebwheeltest := pdsdata/include
+
+tgtsrcs_ebtimetest := ebtimetest.cc
+tgtlibs_ebtimetest := pdsdata/xtcdata
+tgtlibs_ebtimetest += pds/utility pds/service pds/collection pds/vmon pds/mon pds/xtc
+tgtslib_ebtimetest := $(USRLIBDIR)/rt
+tgtincs_ebtimetest := pdsdata/include
@@ -0,0 +1,266 @@
+//
+//  ebtimetest - checks how the clock-time builder (EbT) matches contributions
+//  to events, through its EbTimeIndex and EbTimeKeys.  Contributions are
+//  placed as EbT places them: the index selects the server's window, the
+//  contribution's time is probed, the closest event in the window is sought
+//  and the contribution is assigned to it or starts a new event.  Checks
+//    - the window selected for each server: the default one, a configured
+//      offset and tolerance, and the lookup again when a server's slot is
+//      taken by another client,
+//    - that the closest event in the window is matched,
+//    - that a server is not matched again to an event it has contributed
+//      to, unless it has a segment of that event in progress,
+//    - that a BLD contribution outside every window starts an event of its
+//      own, which expires alone on the timer wheel and leaves the index,
+//    - that BLD without a full sequence is not matched by time.
+//
+//    ebtimetest
+//
+#include "pds/utility/EbTimeIndex.hh"
+#include "pds/utility/EbTimeKey.hh"
+#include "pds/utility/EbEventBase.hh"
+#include "pds/utility/EbServer.hh"
+#include "pds/utility/EbSequenceSrv.hh"
+#include "pds/utility/BldSequenceSrv.hh"
+#include "pds/utility/EbTimerWheel.hh"
+#include "pds/service/GenericPool.hh"
+
+#include "pdsdata/xtc/DetInfo.hh"
+#include "pdsdata/xtc/BldInfo.hh"
+#include "pdsdata/xtc/ClockTime.hh"
+#include "pdsdata/xtc/TimeStamp.hh"
+
+#include <stdio.h>
+#include <list>
+
+using namespace Pds;
+
+static const int64_t ms = 1000000;   // ns
+
+//
+//  A contributor with a full sequence: a detector segment, or BLD.  BLD
+//  may be left without a sequence, as a server which has only the
+//  fiducials from its hardware.
+//
+class TestServer : public EbServer {
+public:
+  TestServer(unsigned id, const Src& src) : _src(src), _xtc(TypeId(TypeId::Any,0), src)
+  { Server::id(id); }
+public:
+  void time(int64_t t) {
+    _seq = Sequence(Sequence::Event, TransitionId::L1Accept,
+                    ClockTime(unsigned(t/1000000000), unsigned(t%1000000000)),
+                    TimeStamp(0, unsigned(t/ms), 0));
+  }
+  void client(const Src& src) { _src = src; }
+public:
+  int         fetch   (char*, int)  { return 0; }
+  void        dump    (int)   const {}
+  bool        isValued()      const { return true; }
+  const Src&  client  ()      const { return _src; }
+  const Xtc&  xtc     ()      const { return _xtc; }
+  int         pend    (int)         { return 0; }
+protected:
+  Src      _src;
+  Xtc      _xtc;
+  Sequence _seq;
+  Env      _env;
+};
+
+class TestSegServer : public TestServer, public EbSequenceSrv {
+public:
+  TestSegServer(unsigned id, const Src& src) : TestServer(id, src) {}
+public:
+  const Sequence& sequence() const { return _seq; }
+  const Env&      env     () const { return _env; }
+  EbServerDeclare;
+};
+
+class TestBldServer : public TestServer, public BldSequenceSrv {
+public:
+  TestBldServer(unsigned id, const Src& src, bool full) : TestServer(id, src), _full(full) {}
+public:
+  unsigned        fiducials() const { return _seq.stamp().fiducials(); }
+  const Sequence* sequence () const { return _full ? &_seq : 0; }
+  EbServerDeclare;
+private:
+  bool _full;
+};
+
+class TestEvent : public EbEventBase {
+public:
+  TestEvent(EbBitMask creator, Datagram* dg, EbEventKey* key) :
+    EbEventBase(creator, EbBitMask(EbBitMask::FULL), dg, key) {}
+  ~TestEvent() { delete datagram(); }
+public:
+  InDatagram* finalize() { return 0; }
+};
+
+//
+//  The events under construction, as EbT keeps them
+//
+class TestBuilder {
+public:
+  TestBuilder(unsigned tolerance) :
+    index (tolerance, 0),
+    _dgs  (sizeof(Datagram), 16),
+    _keys (sizeof(EbTimeKey), 16) {}
+  ~TestBuilder() {
+    for(std::list<TestEvent*>::iterator it=events.begin(); it!=events.end(); it++)
+      delete *it;
+  }
+public:
+  //  Places a contribution at time "t"; returns its event
+  EbEventBase* contribute(TestServer& srv, int64_t t) {
+    srv.time(t);
+    EbBitMask serverId;
+    serverId.setBit(srv.id());
+    index.select(srv);
+    EbTimeProbe probe;
+    srv.assign(probe);
+    EbEventBase* event = probe.valid ? index.seek(probe.time, serverId) : 0;
+    if (!event) {
+      Datagram*  dg  = new(&_dgs) Datagram(TypeId(TypeId::Id_Xtc,0), Src());
+      EbTimeKey* key = new(&_keys) EbTimeKey(*dg, index);
+      TestEvent* ev  = new TestEvent(serverId, dg, key);
+      key->event(ev);
+      events.push_back(ev);
+      event = ev;
+    }
+    srv.assign(event->key());
+    return event;
+  }
+  void remove(EbEventBase* event) {
+    events.remove(static_cast<TestEvent*>(event));
+    delete event;
+  }
+public:
+  EbTimeIndex           index;
+  std::list<TestEvent*> events;
+private:
+  GenericPool _dgs;
+  GenericPool _keys;
+};
+
+static unsigned _failed = 0;
+
+static void check(bool ok, const char* what)
+{
+  printf("%-64s %s\n", what, ok ? "ok" : "FAILED");
+  if (!ok) _failed++;
+}
+
+int main(int argc, char** argv)
+{
+  DetInfo segA (0, DetInfo::XppEndstation, 0, DetInfo::Ipimb , 0);
+  DetInfo segB (0, DetInfo::XppEndstation, 0, DetInfo::Ipimb , 1);
+  DetInfo cam  (0, DetInfo::XppEndstation, 0, DetInfo::Opal1000, 0);
+  DetInfo cam2 (7, DetInfo::XppEndstation, 0, DetInfo::Opal1000, 0);   // same camera, another process
+  BldInfo bld  (0, BldInfo::EBeam);
+
+  TestBuilder eb(1*ms);
+  eb.index.window(cam, 5*ms, 2*ms);
+  eb.index.window(bld, 0   , ms/5);
+
+  TestSegServer a(0, segA), b(1, segB), c(2, cam);
+  TestBldServer d(3, bld, true);
+
+  //  Window selection
+  eb.index.select(a);
+  bool ok = eb.index.reference(10*ms)==10*ms &&
+    eb.index.coincides(10*ms+ms*9/10, 10*ms) && !eb.index.coincides(10*ms+ms*11/10, 10*ms) &&
+    eb.index.coincides(10*ms-ms*9/10, 10*ms) && !eb.index.coincides(10*ms-ms*11/10, 10*ms);
+  check(ok, "unconfigured server has the default window");
+
+  eb.index.select(c);
+  ok = eb.index.reference(15*ms)==10*ms &&
+    eb.index.coincides(15*ms+ms*19/10, 10*ms) && !eb.index.coincides(15*ms+ms*21/10, 10*ms) &&
+    eb.index.coincides(15*ms-ms*19/10, 10*ms) && !eb.index.coincides(15*ms-ms*21/10, 10*ms);
+  check(ok, "configured offset and tolerance");
+
+  c.client(cam2);
+  eb.index.select(c);
+  ok = eb.index.reference(15*ms)==10*ms;
+  c.client(segA);
+  eb.index.select(c);
+  ok &= eb.index.reference(15*ms)==15*ms && !eb.index.coincides(15*ms+ms*19/10, 15*ms);
+  c.client(cam);
+  eb.index.select(c);
+  ok &= eb.index.reference(15*ms)==10*ms;
+  check(ok, "window by level and phy, looked up again for a new client");
+
+  //  Events from A at 10.0, 10.6 and 11.2 ms: A is not matched again to its
+  //  own events, though they are within its window
+  EbEventBase* e0 = eb.contribute(a, 10*ms);
+  EbEventBase* e1 = eb.contribute(a, 10*ms+ms*6/10);
+  EbEventBase* e2 = eb.contribute(a, 10*ms+ms*12/10);
+  check(eb.events.size()==3 && e0!=e1 && e1!=e2 && e0!=e2,
+        "a server does not match its own earlier events");
+
+  //  B at 10.7 ms is within the window of all three; 10.6 is the closest
+  ok = eb.contribute(b, 10*ms+ms*7/10)==e1;
+  eb.index.select(b);
+  ok &= b.coincides(e1->key());
+  check(ok, "closest event in the window is matched");
+
+  //  B again at 10.65 ms: e1 has B, so the next closest, e2
+  ok = eb.contribute(b, 10*ms+ms*65/100)==e2;
+  check(ok, "a server that has contributed is not matched again");
+
+  //  ... unless it has a segment of the event in progress
+  EbBitMask bId;
+  bId.setBit(b.id());
+  e0->allocated().insert(bId);
+  e0->segments() |= bId;
+  ok = eb.contribute(b, 10*ms+ms/10)==e0;
+  e0->segments() = EbBitMask();
+  check(ok, "a server with a segment in progress matches its event");
+
+  //  The camera's clock is 5 ms ahead: at 15.65 ms it belongs with e1
+  ok = eb.contribute(c, 15*ms+ms*65/100)==e1;
+  check(ok, "offset window matches the camera to its event");
+
+  //  BLD at 13 ms is outside every window: an event of its own, which
+  //  expires alone.  Until then, a detector within 1 ms finds it.
+  unsigned nevents = eb.events.size();
+  EbEventBase* eb13 = eb.contribute(d, 13*ms);
+  ok = eb.events.size()==nevents+1 && eb13!=e0 && eb13!=e1 && eb13!=e2;
+  check(ok, "BLD outside the windows starts an event");
+
+  EbTimerWheel wheel(10, 1024);
+  uint64_t t0 = EbTimerWheel::now();
+  unsigned tmo = 500;
+  for(std::list<TestEvent*>::iterator it=eb.events.begin(); it!=eb.events.end(); it++) {
+    (*it)->created = t0;
+    wheel.arm(**it, t0 + ((*it)==eb13 ? tmo : 10*tmo));
+  }
+  EbTimerWheel::Entry* p;
+  unsigned nexpired = 0;
+  bool only = true;
+  while((p = wheel.pop(t0+tmo+10))) {
+    nexpired++;
+    if (static_cast<EbEventBase*>(p)!=eb13) only = false;
+  }
+  check(nexpired==1 && only, "the BLD event expires alone");
+
+  TestSegServer f(4, DetInfo(0, DetInfo::XppEndstation, 0, DetInfo::Ipimb, 2));
+  eb.index.select(f);
+  EbBitMask fId;
+  fId.setBit(f.id());
+  ok = eb.index.seek(13*ms+ms/2, fId)==eb13;
+  eb.remove(eb13);
+  ok &= eb.index.seek(13*ms+ms/2, fId)==0;
+  check(ok, "an expired event leaves the index");
+
+  //  BLD with only its fiducials is not matched by time
+  TestBldServer g(5, BldInfo(0, BldInfo::EBeam), false);
+  nevents = eb.events.size();
+  EbEventBase* eg = eb.contribute(g, 10*ms);
+  eb.index.select(g);
+  ok = eb.events.size()==nevents+1 && !g.coincides(e0->key()) && !g.coincides(eg->key());
+  check(ok, "BLD without a sequence is not matched by time");
+
+  if (_failed)
+    printf("*** %u failures\n", _failed);
+  return _failed ? 1 : 0;
+}
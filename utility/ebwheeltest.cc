@@ -0,0 +1,157 @@
+//
+//  ebwheeltest - checks the event builder's timer wheel against the
+//  builder's own timeouts, for each level, with and without slowEb.  The
+//  slowEb deadlines (about a minute) span several revolutions of the
+//  wheel, so they share slots with nearer deadlines and must be skipped
+//  until their round comes up.
+//
+//  Time is simulated from the wheel's own clock: it advances in poll-sized
+//  steps under traffic and by up to an idle tick when the builder is idle.
+//  An entry fails if it expires before its deadline, or is still armed once
+//  the simulated time has passed its deadline.  Slow clients are simulated
+//  by extending the deadline of an expired entry, as EbBase::_expire does.
+//
+//    ebwheeltest [-n <entries>] [-s <seed>]
+//
+#include "pds/utility/EbTimerWheel.hh"
+#include "pds/utility/EbTimeouts.hh"
+#include "pds/utility/StreamParams.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Pds;
+
+static const unsigned WheelTick  = 10;    // ms, as EbBase
+static const unsigned WheelSlots = 1024;
+
+class TestEntry : public EbTimerWheel::Entry {
+public:
+  TestEntry() : extend(0), expired(false) {}
+public:
+  unsigned extend;    // ms, slow client's timeout, if any
+  bool     expired;
+};
+
+static unsigned _random(unsigned& seed, unsigned n)
+{
+  return n ? unsigned(rand_r(&seed)) % n : 0;
+}
+
+//
+//  Arms "n" entries with the given timeout over the first 2 seconds, some
+//  of them waiting on a slow client, and expires them.  Returns the number
+//  of failures.
+//
+static unsigned _run(const char* name, unsigned tmo, unsigned idle,
+                     unsigned n, unsigned& seed)
+{
+  EbTimerWheel wheel(WheelTick, WheelSlots);
+  std::vector<TestEntry> entries(n);
+
+  uint64_t t0 = EbTimerWheel::now();
+  uint64_t t  = t0;
+  unsigned armed=0, failed=0, extended=0;
+  uint64_t last=0;
+
+  while(armed < n || last >= t) {
+    //  Traffic for the first 2 seconds: a poll every ms, arming as we go
+    if (t < t0+2000) {
+      while(armed < n && t0 + (2000ULL*armed)/n <= t) {
+        TestEntry& e = entries[armed];
+        e.created = t;
+        if (_random(seed, 8) == 0)
+          e.extend = tmo + _random(seed, 4*tmo);
+        wheel.arm(e, t + tmo);
+        if (e.created + tmo + e.extend > last)
+          last = e.created + tmo + e.extend;
+        armed++;
+      }
+      t += 1;
+    }
+    else
+      t += 1 + _random(seed, idle);
+
+    EbTimerWheel::Entry* p;
+    while((p = wheel.pop(t))) {
+      TestEntry& e = *static_cast<TestEntry*>(p);
+      if (e.deadline > t) {
+        printf("*** %s: entry %zu expired at %llu before its deadline %llu\n",
+               name, &e - &entries[0],
+               (unsigned long long)(t-t0), (unsigned long long)(e.deadline-t0));
+        failed++;
+      }
+      uint64_t deadline = e.created + tmo + e.extend;
+      if (deadline > t) {
+        wheel.arm(e, deadline);
+        extended++;
+        continue;
+      }
+      e.expired = true;
+    }
+
+    //  Nothing due may be left on the wheel
+    for(unsigned i=0; i<armed; i++) {
+      TestEntry& e = entries[i];
+      if (!e.expired && e.armed() && e.deadline <= t) {
+        printf("*** %s: entry %u still armed at %llu past its deadline %llu\n",
+               name, i, (unsigned long long)(t-t0), (unsigned long long)(e.deadline-t0));
+        e.expired = true;
+        e.unlink();
+        failed++;
+      }
+    }
+  }
+
+  unsigned expired=0;
+  for(unsigned i=0; i<n; i++)
+    if (entries[i].expired) expired++;
+  if (expired != n) {
+    printf("*** %s: %u of %u entries expired\n", name, expired, n);
+    failed++;
+  }
+
+  printf("%-16s timeout %6u ms (%5.1f revolutions)  %u entries  %u extended  %s\n",
+         name, tmo, double(tmo)/double(WheelTick*WheelSlots), n, extended,
+         failed ? "FAILED" : "ok");
+  return failed;
+}
+
+static void usage(const char* p)
+{
+  printf("Usage: %s [-n <entries>] [-s <seed>]\n", p);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned n    = 2000;
+  unsigned seed = 1;
+
+  int c;
+  while ((c = getopt(argc, argv, "n:s:h")) != -1) {
+    switch (c) {
+    case 'n': n    = strtoul(optarg, NULL, 0); break;
+    case 's': seed = strtoul(optarg, NULL, 0); break;
+    default : usage(argv[0]); return 1;
+    }
+  }
+
+  static const Level::Type levels[] = { Level::Source, Level::Segment, Level::Event, Level::Control };
+
+  unsigned failed=0;
+  for(unsigned slow=0; slow<2; slow++)
+    for(unsigned l=0; l<4; l++) {
+      EbTimeouts tmos(StreamParams::FrameWork, levels[l], slow);
+      unsigned tmo = tmos.duration()*tmos.timeouts(0);
+      char name[64];
+      snprintf(name, sizeof(name), "%s%s", Level::name(levels[l]), slow ? " slowEb" : "");
+      //  The idle tick is the builder's timer, one duration
+      failed += _run(name, tmo, tmos.duration(), n, seed);
+    }
+
+  if (failed)
+    printf("*** %u failures\n", failed);
+  return failed ? 1 : 0;
+}
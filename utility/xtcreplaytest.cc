@@ -0,0 +1,232 @@
+//
+//  xtcreplaytest - serves the contributions of one source from recorded
+//  xtc files through an XtcReplayServer, as the segment event builder
+//  would, and checks each one against the files read with
+//  XtcFileIterator.  A manual tool, run on recorded files: it is not a
+//  self-contained test.
+//
+//    xtcreplaytest -f <file> [-f <file>...] -s <level>,<phy> [-m <bytes>] [-r <Hz>] [-n <events>] [-l]
+//
+#include "pds/utility/XtcReplayServer.hh"
+
+#include "pdsdata/xtc/DetInfo.hh"
+#include "pdsdata/xtc/Dgram.hh"
+#include "pdsdata/xtc/XtcIterator.hh"
+#include "pdsdata/xtc/XtcFileIterator.hh"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+using namespace Pds;
+
+static const unsigned MaxSize = 16*1024*1024;  // as SegStreams
+
+static double now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return double(ts.tv_sec)+1.e-9*double(ts.tv_nsec);
+}
+
+//
+//  A Src with the given level and physical id
+//
+class ReplaySrc : public Src {
+public:
+  ReplaySrc(Level::Type level, uint32_t phy) : Src(level) { _phy = phy; }
+};
+
+class Finder : public XtcIterator {
+public:
+  Finder(const Src& src, std::vector<const Xtc*>& found) : _src(src), _found(found) {}
+  int process(Xtc* xtc) {
+    if (xtc->src.level()==_src.level() && xtc->src.phy()==_src.phy())
+      _found.push_back(xtc);
+    else if (xtc->contains.id()==TypeId::Id_Xtc)
+      iterate(xtc);
+    return 1;
+  }
+private:
+  const Src&               _src;
+  std::vector<const Xtc*>& _found;
+};
+
+//
+//  The source's xtcs in each recorded L1Accept, read from the files, less
+//  those larger than "maxSize"
+//
+class Reference {
+public:
+  Reference(const std::vector<std::string>& files, const Src& src, unsigned maxSize) :
+    _files(files), _src(src), _maxSize(maxSize), _ifile(0), _fd(-1), _it(0) {}
+  ~Reference() { _close(); }
+public:
+  //  Returns false after the last file
+  bool next(std::vector<const Xtc*>& xtcs) {
+    while(1) {
+      if (!_it) {
+        if (_ifile == _files.size())
+          return false;
+        if ((_fd = ::open(_files[_ifile++].c_str(), O_RDONLY)) < 0)
+          continue;
+        _it = new XtcFileIterator(_fd, 0x4000000);
+      }
+      Dgram* dg = _it->next();
+      if (!dg) {
+        _close();
+        continue;
+      }
+      if (dg->seq.service() != TransitionId::L1Accept)
+        continue;
+      xtcs.clear();
+      Finder(_src, xtcs).iterate(&dg->xtc);
+      unsigned size = 0;
+      for(unsigned i=0; i<xtcs.size(); i++)
+        size += xtcs[i]->extent;
+      if (xtcs.size() && size <= _maxSize)
+        return true;
+    }
+  }
+  void rewind() { _close(); _ifile = 0; }
+private:
+  void _close() {
+    if (_it) { delete _it; _it = 0; }
+    if (_fd >= 0) { ::close(_fd); _fd = -1; }
+  }
+private:
+  const std::vector<std::string>& _files;
+  const Src&                      _src;
+  unsigned                        _maxSize;
+  unsigned                        _ifile;
+  int                             _fd;
+  XtcFileIterator*                _it;
+};
+
+static void usage(const char* p)
+{
+  printf("Usage: %s -f <file> [-f <file>...] -s <level>,<phy> [-m <bytes>] [-r <Hz>] [-n <events>] [-l]\n"
+         "Options:\n"
+         "\t-f <file>         recorded xtc file\n"
+         "\t-s <level>,<phy>  source to replay, e.g. 1,0x18000a00\n"
+         "\t-m <bytes>        largest contribution payload [0x%x]\n"
+         "\t-r <Hz>           rate, or 0 for the recorded intervals [0]\n"
+         "\t-n <events>       contributions to fetch [all]\n"
+         "\t-l                loop over the files\n", p, MaxSize);
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> files;
+  int      level  = -1;
+  uint32_t phy    = 0;
+  unsigned maxSize= MaxSize;
+  double   rate   = 0;
+  unsigned nevents= 0;
+  bool     loop   = false;
+
+  int c;
+  char* e;
+  while ((c = getopt(argc, argv, "f:s:m:r:n:lh")) != -1) {
+    switch(c) {
+    case 'f': files.push_back(std::string(optarg)); break;
+    case 's':
+      level = strtoul(optarg, &e, 0);
+      if (*e==',') phy = strtoul(e+1, &e, 0);
+      if (*e || level >= Level::NumberOfLevels) {
+        printf("*** bad source \"%s\"\n", optarg);
+        return 1;
+      }
+      break;
+    case 'm': maxSize = strtoul(optarg,NULL,0); break;
+    case 'r': rate    = strtod (optarg,NULL); break;
+    case 'n': nevents = strtoul(optarg,NULL,0); break;
+    case 'l': loop    = true; break;
+    case 'h':
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+  if (files.empty() || level < 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  ReplaySrc recorded(Level::Type(level), phy);
+  DetInfo   client(getpid(), DetInfo::NoDetector, 0, DetInfo::NoDevice, 0);
+
+  XtcReplayServer* srv = new XtcReplayServer(recorded, client, files, maxSize, rate, loop);
+  if (!srv->contributions())
+    return 1;
+  if (!nevents)
+    nevents = srv->contributions();
+
+  char* payload = new char[sizeof(Xtc)+srv->maxPayload()];
+  Reference reference(files, recorded, maxSize);
+  std::vector<const Xtc*> expected;
+  srv->start();
+
+  unsigned nbad = 0;
+  uint64_t nbytes = 0;
+  double   tfetch = 0;
+  double   t0 = now();
+  for(unsigned i=0; i<nevents; i++) {
+    pollfd pfd;
+    pfd.fd     = srv->fd();
+    pfd.events = POLLIN;
+    if (::poll(&pfd, 1, 2000) <= 0) {
+      printf("*** no contribution %u after 2 s\n", i);
+      nbad++;
+      break;
+    }
+    double tf = now();
+    int extent = srv->fetch(payload, 0);
+    tfetch += now()-tf;
+    if (extent < 0) {
+      printf("*** fetch %u failed\n", i);
+      nbad++;
+      continue;
+    }
+    nbytes += extent;
+
+    if (!reference.next(expected)) {
+      reference.rewind();
+      reference.next(expected);
+    }
+
+    //  The contents, less the restamped sources, are the recorded xtcs
+    const Xtc* root = reinterpret_cast<const Xtc*>(payload);
+    const Xtc* xtc  = reinterpret_cast<const Xtc*>(root->payload());
+    bool ok = root->src == client;
+    for(unsigned j=0; ok && j<expected.size(); j++, xtc = xtc->next()) {
+      const Xtc* x = expected[j];
+      ok = (reinterpret_cast<const char*>(xtc) < root->payload()+root->sizeofPayload() &&
+            xtc->src == client &&
+            xtc->extent == x->extent &&
+            xtc->contains.value() == x->contains.value() &&
+            xtc->damage.value() == x->damage.value() &&
+            memcmp(xtc->payload(), x->payload(), x->sizeofPayload())==0);
+    }
+    if (!ok || reinterpret_cast<const char*>(xtc) != root->payload()+root->sizeofPayload()) {
+      if (nbad < 10)
+        printf("*** contribution %u differs from the file\n", i);
+      nbad++;
+    }
+  }
+  double dt = now()-t0;
+
+  printf("%u contributions, %.3f MB in %.3f s : %.1f Hz, %.1f us/fetch, %u loops\n",
+         nevents, double(nbytes)*1.e-6, dt, double(nevents)/dt,
+         tfetch/double(nevents)*1.e6, srv->loops());
+  printf("%u contributions differ\n", nbad);
+
+  srv->stop();
+  srv->shutdown();
+  delete[] payload;
+  return nbad ? 1 : 0;
+}
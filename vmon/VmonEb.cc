@@ -5,8 +5,10 @@
 #include "pds/mon/MonCds.hh"
 #include "pds/mon/MonGroup.hh"
 #include "pds/mon/MonEntryTH1F.hh"
+#include "pds/mon/MonEntryTH2F.hh"
 #include "pds/mon/MonEntryScalar.hh"
 #include "pds/mon/MonDescTH1F.hh"
+#include "pds/mon/MonDescTH2F.hh"
 #include "pds/mon/MonDescScalar.hh"
 #include "pds/utility/EbServer.hh"
 #include "pds/collection/Node.hh"
@@ -43,10 +45,13 @@ VmonEb::VmonEb(const Src& src,
 	       unsigned maxdepth,
 	       unsigned maxtime,
 	       unsigned maxsize,
-	       const char* group_name)
+	       const char* group_name) :
+  _match_offset(0),
+  _nservers    (nservers)
 {
   MonGroup* group = new MonGroup(group_name);
   VmonServerManager::instance()->cds().add(group);
+  _group = group;
 
   char tmp[32];
   std::vector<std::string> srv_names(nservers);
@@ -127,6 +132,12 @@ VmonEb::VmonEb(const Src& src,
 			maxs>>_sshift, s0, s1);
   _post_size = new MonEntryTH1F(post_size);
   group->add(_post_size);
+
+  //  Events completed at 1 or beyond timed out
+  MonDescTH1F complete_time("Complete Time", "completion/timeout", "",
+                            50, 0., 1.25);
+  _complete_time = new MonEntryTH1F(complete_time);
+  group->add(_complete_time);
 }
 
 VmonEb::~VmonEb()
@@ -208,6 +219,9 @@ void VmonEb::update(const ClockTime& now)
   _fetch_time_long->time(now);
   _damage_count->time(now);
   _post_size ->time(now);
+  _complete_time->time(now);
+  if (_match_offset)
+    _match_offset->time(now);
 }
 
 void VmonEb::server(const Server& srv)
@@ -231,3 +245,38 @@ void VmonEb::server(const Server& srv)
 
   _fixup->desc().set_names(names);
 }
+
+void VmonEb::complete_time(float f)
+{
+  unsigned bin = unsigned(f*40.);
+  if (bin < _complete_time->desc().nbins())
+    _complete_time->addcontent(1, bin);
+  else
+    _complete_time->addinfo(1, MonEntryTH1F::Overflow);
+}
+
+//
+//  Offsets are in units of the source's match tolerance
+//
+void VmonEb::match_offsets()
+{
+  if (_match_offset) return;
+
+  MonDescTH2F match_offset("Match Offset", "offset/tolerance", "server",
+                           64, -1., 1., _nservers, -0.5, float(_nservers)-0.5);
+  _match_offset = new MonEntryTH2F(match_offset);
+  _group->add(_match_offset);
+}
+
+void VmonEb::match_offset(int server, float fraction)
+{
+  if (server<0 || unsigned(server)>=_nservers) return;
+  if (fraction < -1.)
+    _match_offset->addinfo(1, MonEntryTH2F::UnderflowX);
+  else if (fraction > 1.)
+    _match_offset->addinfo(1, MonEntryTH2F::OverflowX);
+  else {
+    unsigned bin = unsigned((fraction+1.)*32.);
+    _match_offset->addcontent(1, bin < 64 ? bin : 63, server);
+  }
+}
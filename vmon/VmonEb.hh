@@ -7,6 +7,8 @@ namespace Pds {
   class Src;
   class MonServerManager;
   class MonEntryTH1F;
+  class MonEntryTH2F;
+  class MonGroup;
   class MonEntryScalar;
   class Server;
 
@@ -28,8 +30,13 @@ namespace Pds {
     void damage_count(unsigned dmg);
     void post_time (unsigned ticks);
     void post_size (unsigned bytes);
+    //  Time to complete an event as a fraction of its timeout
+    void complete_time(float fraction);
     void update    (const ClockTime&);
     void server    (const Server&);
+    //  Match offsets of tolerance-matched contributions, per server
+    void match_offsets();
+    void match_offset (int server, float fraction);
   private:
     MonEntryScalar*   _fixup;
     MonEntryTH1F*     _depth;
@@ -39,6 +46,10 @@ namespace Pds {
     MonEntryTH1F*     _post_time;
     MonEntryTH1F*     _post_time_log;
     MonEntryTH1F*     _post_size;
+    MonEntryTH1F*     _complete_time;
+    MonEntryTH2F*     _match_offset;
+    MonGroup*         _group;
+    unsigned          _nservers;
     unsigned          _tshift;
     unsigned          _sshift;
     unsigned          _fshift;
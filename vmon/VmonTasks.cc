@@ -0,0 +1,124 @@
+#include "pds/vmon/VmonTasks.hh"
+
+#include "pds/vmon/VmonServerManager.hh"
+
+#include "pds/mon/MonCds.hh"
+#include "pds/mon/MonGroup.hh"
+#include "pds/mon/MonEntryScalar.hh"
+#include "pds/mon/MonDescScalar.hh"
+#include "pds/service/Task.hh"
+#include "pds/service/TaskObject.hh"
+#include "pds/service/Semaphore.hh"
+
+#include "pdsdata/xtc/ClockTime.hh"
+
+#include <stdio.h>
+#include <time.h>
+
+using namespace Pds;
+
+static const unsigned Period = 1000;  // ms
+
+enum { Load, Cpus, Cpus32, Policy, Priority, NElements };
+
+static uint64_t _now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec)*1000000000ULL + ts.tv_nsec;
+}
+
+VmonTasks::VmonTasks() :
+  _task     (new Task(TaskObject("VmonTasks"))),
+  _group    (new MonGroup("Tasks")),
+  _placement(new TaskPolicy::Placement[TaskPolicy::MaxThreads]),
+  _last     (_now())
+{
+  VmonServerManager::instance()->cds().add(_group);
+
+  unsigned n = TaskPolicy::snapshot(_placement, TaskPolicy::MaxThreads);
+  for(unsigned i=0; i<n; i++)
+    _add(_placement[i]);
+
+  start();
+}
+
+VmonTasks::~VmonTasks()
+{
+  cancel();
+  _task->destroy();
+  delete[] _placement;
+}
+
+void VmonTasks::_add(const TaskPolicy::Placement& p)
+{
+  std::vector<std::string> names(NElements);
+  names[Load    ] = std::string("load[%]");
+  names[Cpus    ] = std::string("cpus");     // affinity of cpus 0-31
+  names[Cpus32  ] = std::string("cpus32");   // affinity of cpus 32-63
+  names[Policy  ] = std::string("sched");    // SCHED_*
+  names[Priority] = std::string("prio");     // or nice
+
+  //  Names are not unique (several "oEbEvt" tasks, for example)
+  char buff[64];
+  sprintf(buff, "%s.%d", p.name, p.tid);
+  MonDescScalar desc(buff, names);
+  Entry e;
+  e.tid     = p.tid;
+  e.cpuTime = p.cpuTime;
+  e.entry   = new MonEntryScalar(desc);
+  _entries.push_back(e);
+
+  //  Not while the server sends the monitoring data
+  Semaphore& sem = VmonServerManager::instance()->cds().payload_sem();
+  sem.take();
+  _group->add(e.entry);
+  sem.give();
+}
+
+void VmonTasks::expired()
+{
+  uint64_t now = _now();
+  double   dt  = double(now-_last);
+  _last = now;
+
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ClockTime clock(ts.tv_sec, ts.tv_nsec);
+
+  unsigned n = TaskPolicy::snapshot(_placement, TaskPolicy::MaxThreads);
+
+  //  Threads registered since the last pass; their load is from now on
+  for(unsigned j=0; j<n; j++) {
+    unsigned i=0;
+    while(i<_entries.size() && _entries[i].tid != _placement[j].tid)
+      i++;
+    if (i==_entries.size())
+      _add(_placement[j]);
+  }
+
+  for(unsigned i=0; i<_entries.size(); i++) {
+    Entry& e = _entries[i];
+    unsigned j=0;
+    while(j<n && _placement[j].tid != e.tid)
+      j++;
+    if (j==n) {
+      //  The thread has exited
+      e.entry->setvalue(0, Load);
+    }
+    else {
+      const TaskPolicy::Placement& p = _placement[j];
+      e.entry->setvalue(dt > 0 ? 100.*double(p.cpuTime-e.cpuTime)/dt : 0, Load);
+      e.entry->setvalue(double(p.cpus & 0xffffffff), Cpus);
+      e.entry->setvalue(double(p.cpus >> 32)       , Cpus32);
+      e.entry->setvalue(p.policy  , Policy);
+      e.entry->setvalue(p.priority, Priority);
+      e.cpuTime = p.cpuTime;
+    }
+    e.entry->time(clock);
+  }
+}
+
+Task*    VmonTasks::task      () { return _task; }
+unsigned VmonTasks::duration  () const { return Period; }
+unsigned VmonTasks::repetitive() const { return 1; }
@@ -0,0 +1,49 @@
+#ifndef Pds_VmonTasks_hh
+#define Pds_VmonTasks_hh
+
+//
+//  Publishes the placement and cpu load of the Task threads registered
+//  with TaskPolicy, one "Tasks" entry per thread, refreshed every second.
+//  Threads registered after construction get their entry when they are
+//  first seen.  The affinity of the first 64 cpus is published in two
+//  halves, "cpus" for cpus 0-31 and "cpus32" for cpus 32-63.
+//
+
+#include "pds/service/Timer.hh"
+#include "pds/service/TaskPolicy.hh"
+
+#include <stdint.h>
+#include <vector>
+
+namespace Pds {
+
+  class MonGroup;
+  class MonEntryScalar;
+
+  class VmonTasks : public Timer {
+  public:
+    VmonTasks();
+    ~VmonTasks();
+  public:
+    void     expired   ();
+    Task*    task      ();
+    unsigned duration  () const;
+    unsigned repetitive() const;
+  private:
+    void     _add      (const TaskPolicy::Placement&);
+  private:
+    class Entry {
+    public:
+      int             tid;
+      uint64_t        cpuTime;
+      MonEntryScalar* entry;
+    };
+    Task*                   _task;
+    MonGroup*               _group;
+    std::vector<Entry>      _entries;
+    TaskPolicy::Placement*  _placement;
+    uint64_t                _last;      // ns
+  };
+};
+
+#endif